@@ -0,0 +1,399 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "BenchmarkMeshes.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if PROCEDURALTOOLKIT_BENCHMARK_ZLIB
+#include <zlib.h>
+#endif
+
+int FBenchmarkMesh::GetVertexCount() const
+{
+	int VertexCount = 0;
+	for (const auto &Section : Sections) {
+		VertexCount += Section.GetVertexCount();
+	}
+	return VertexCount;
+}
+
+void FBenchmarkMesh::GetBounds(float OutMin[3], float OutMax[3]) const
+{
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		OutMin[Axis] = INFINITY;
+		OutMax[Axis] = -INFINITY;
+	}
+	for (const auto &Section : Sections) {
+		for (size_t Index = 0; Index < Section.Positions.size(); Index += 3) {
+			for (int Axis = 0; Axis < 3; ++Axis) {
+				OutMin[Axis] = std::min(OutMin[Axis], Section.Positions[Index + Axis]);
+				OutMax[Axis] = std::max(OutMax[Axis], Section.Positions[Index + Axis]);
+			}
+		}
+	}
+}
+
+bool CanLoadFbx()
+{
+#if PROCEDURALTOOLKIT_BENCHMARK_ZLIB
+	return true;
+#else
+	return false;
+#endif
+}
+
+/// A minimal reader for the node records of a binary FBX file.
+///
+/// This only understands enough of the format to pull the mesh data out, see
+/// https://code.blender.org/2013/08/fbx-binary-file-format-specification/ for the layout.
+class FFbxReader
+{
+public:
+	FFbxReader(const std::vector<uint8_t> &InData) : Data(InData) {}
+
+	/// Read the file's meshes into sections, returning false and setting *Error* if it can't.
+	bool ReadMeshes(std::vector<FSectionBuffers> &OutSections)
+	{
+		static const char Magic[] = "Kaydara FBX Binary  ";
+		if (Data.size() < 27 || memcmp(Data.data(), Magic, sizeof(Magic) - 1) != 0) {
+			Error = "not a binary FBX file";
+			return false;
+		}
+		Version = ReadU32(23);
+		bWideOffsets = (Version >= 7500);
+
+		// Find the Objects node at the top level, and the Geometry nodes inside it.
+		size_t Offset = 27;
+		FNode Node;
+		while (ReadNodeHeader(Offset, Node)) {
+			if (Node.Name == "Objects") {
+				size_t ChildOffset = Node.ChildrenOffset;
+				FNode Child;
+				while (ChildOffset < Node.EndOffset && ReadNodeHeader(ChildOffset, Child)) {
+					if (Child.Name == "Geometry" && !ReadGeometry(Child, OutSections)) {
+						return false;
+					}
+					ChildOffset = Child.EndOffset;
+				}
+			}
+			Offset = Node.EndOffset;
+		}
+		if (!Error.empty()) {
+			return false;
+		}
+		if (OutSections.empty()) {
+			Error = "no meshes found";
+			return false;
+		}
+		return true;
+	}
+
+	std::string Error;
+
+private:
+	struct FNode
+	{
+		std::string Name;
+		size_t EndOffset;
+		size_t PropertiesOffset;
+		size_t ChildrenOffset;
+		uint64_t NumProperties;
+	};
+
+	uint32_t ReadU32(size_t Offset) const
+	{
+		uint32_t Value;
+		memcpy(&Value, Data.data() + Offset, sizeof(Value));
+		return Value;
+	}
+
+	uint64_t ReadU64(size_t Offset) const
+	{
+		uint64_t Value;
+		memcpy(&Value, Data.data() + Offset, sizeof(Value));
+		return Value;
+	}
+
+	/// Read the header of the node at *Offset*, returning false at the null record ending a list.
+	bool ReadNodeHeader(size_t Offset, FNode &OutNode)
+	{
+		const size_t HeaderSize = bWideOffsets ? 25 : 13;
+		if (Offset + HeaderSize > Data.size()) {
+			return false;
+		}
+		const uint64_t EndOffset = bWideOffsets ? ReadU64(Offset) : ReadU32(Offset);
+		const uint64_t NumProperties = bWideOffsets ? ReadU64(Offset + 8) : ReadU32(Offset + 4);
+		const uint64_t PropertyListLength = bWideOffsets ? ReadU64(Offset + 16) : ReadU32(Offset + 8);
+		const uint8_t NameLength = Data[Offset + HeaderSize - 1];
+		if (EndOffset == 0) {
+			return false;
+		}
+		if (EndOffset > Data.size() || Offset + HeaderSize + NameLength + PropertyListLength > EndOffset) {
+			Error = "corrupt node record";
+			return false;
+		}
+		OutNode.Name.assign((const char *)Data.data() + Offset + HeaderSize, NameLength);
+		OutNode.EndOffset = (size_t)EndOffset;
+		OutNode.NumProperties = NumProperties;
+		OutNode.PropertiesOffset = Offset + HeaderSize + NameLength;
+		OutNode.ChildrenOffset = OutNode.PropertiesOffset + (size_t)PropertyListLength;
+		return true;
+	}
+
+	/// Read the first property of a node as an array of numbers, converting them to *T*.
+	template <typename T>
+	bool ReadArrayProperty(const FNode &Node, std::vector<T> &OutValues)
+	{
+		if (Node.NumProperties < 1 || Node.PropertiesOffset + 13 > Node.ChildrenOffset) {
+			Error = "missing array in " + Node.Name;
+			return false;
+		}
+		const char Type = (char)Data[Node.PropertiesOffset];
+		const uint32_t Length = ReadU32(Node.PropertiesOffset + 1);
+		const uint32_t Encoding = ReadU32(Node.PropertiesOffset + 5);
+		const uint32_t CompressedLength = ReadU32(Node.PropertiesOffset + 9);
+		const uint8_t *Source = Data.data() + Node.PropertiesOffset + 13;
+		if (Node.PropertiesOffset + 13 + CompressedLength > Node.ChildrenOffset) {
+			Error = "corrupt array in " + Node.Name;
+			return false;
+		}
+
+		size_t ElementSize;
+		switch (Type) {
+		case 'd': case 'l': ElementSize = 8; break;
+		case 'f': case 'i': ElementSize = 4; break;
+		default:
+			Error = std::string("unsupported array type in ") + Node.Name;
+			return false;
+		}
+
+		std::vector<uint8_t> Decompressed;
+		if (Encoding == 1) {
+#if PROCEDURALTOOLKIT_BENCHMARK_ZLIB
+			Decompressed.resize(Length * ElementSize);
+			uLongf DecompressedLength = (uLongf)Decompressed.size();
+			if (uncompress(Decompressed.data(), &DecompressedLength, Source, CompressedLength) != Z_OK
+				|| DecompressedLength != Decompressed.size()) {
+				Error = "could not decompress " + Node.Name;
+				return false;
+			}
+			Source = Decompressed.data();
+#else
+			Error = "compressed arrays need zlib";
+			return false;
+#endif
+		} else if (CompressedLength != Length * ElementSize) {
+			Error = "corrupt array in " + Node.Name;
+			return false;
+		}
+
+		OutValues.resize(Length);
+		for (uint32_t Index = 0; Index < Length; ++Index) {
+			const uint8_t *Element = Source + Index * ElementSize;
+			switch (Type) {
+			case 'd': { double Value; memcpy(&Value, Element, 8); OutValues[Index] = (T)Value; break; }
+			case 'l': { int64_t Value; memcpy(&Value, Element, 8); OutValues[Index] = (T)Value; break; }
+			case 'f': { float Value; memcpy(&Value, Element, 4); OutValues[Index] = (T)Value; break; }
+			case 'i': { int32_t Value; memcpy(&Value, Element, 4); OutValues[Index] = (T)Value; break; }
+			}
+		}
+		return true;
+	}
+
+	/// Read a Geometry node's vertices and polygons into a new section.
+	bool ReadGeometry(const FNode &Geometry, std::vector<FSectionBuffers> &OutSections)
+	{
+		std::vector<float> Positions;
+		std::vector<int> PolygonVertexIndices;
+		size_t Offset = Geometry.ChildrenOffset;
+		FNode Child;
+		while (Offset < Geometry.EndOffset && ReadNodeHeader(Offset, Child)) {
+			if (Child.Name == "Vertices" && !ReadArrayProperty(Child, Positions)) {
+				return false;
+			}
+			if (Child.Name == "PolygonVertexIndex" && !ReadArrayProperty(Child, PolygonVertexIndices)) {
+				return false;
+			}
+			Offset = Child.EndOffset;
+		}
+		if (!Error.empty()) {
+			return false;
+		}
+		if (Positions.empty()) {
+			// Not a mesh, such as a NURBS curve.
+			return true;
+		}
+
+		FSectionBuffers Section;
+		Section.Positions = std::move(Positions);
+
+		// The last index of each polygon is stored as -(Index + 1), triangulate each as a fan.
+		const int VertexCount = Section.GetVertexCount();
+		size_t PolygonStart = 0;
+		for (size_t Index = 0; Index < PolygonVertexIndices.size(); ++Index) {
+			const bool bLastInPolygon = PolygonVertexIndices[Index] < 0;
+			if (bLastInPolygon) {
+				PolygonVertexIndices[Index] = -PolygonVertexIndices[Index] - 1;
+			}
+			if (PolygonVertexIndices[Index] >= VertexCount) {
+				Error = "polygon index out of range";
+				return false;
+			}
+			if (bLastInPolygon) {
+				for (size_t Corner = PolygonStart + 1; Corner + 1 <= Index; ++Corner) {
+					Section.Triangles.push_back(PolygonVertexIndices[PolygonStart]);
+					Section.Triangles.push_back(PolygonVertexIndices[Corner]);
+					Section.Triangles.push_back(PolygonVertexIndices[Corner + 1]);
+				}
+				PolygonStart = Index + 1;
+			}
+		}
+
+		CalculateNormals(Section);
+		OutSections.push_back(std::move(Section));
+		return true;
+	}
+
+	const std::vector<uint8_t> &Data;
+	uint32_t Version = 0;
+	bool bWideOffsets = false;
+};
+
+bool LoadFbxMesh(const std::string &Path, FBenchmarkMesh &OutMesh, std::string &OutError)
+{
+	std::ifstream File(Path, std::ios::binary);
+	if (!File) {
+		OutError = "could not open file";
+		return false;
+	}
+	const std::vector<uint8_t> Data((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+
+	// Name the mesh after the file, without the directory or extension.
+	const size_t NameStart = Path.find_last_of("/\\") == std::string::npos ? 0 : Path.find_last_of("/\\") + 1;
+	const size_t NameEnd = Path.find_last_of('.');
+	OutMesh.Name = Path.substr(NameStart, (NameEnd == std::string::npos || NameEnd < NameStart) ? std::string::npos : NameEnd - NameStart);
+	OutMesh.Sections.clear();
+
+	FFbxReader Reader(Data);
+	if (!Reader.ReadMeshes(OutMesh.Sections)) {
+		OutError = Reader.Error;
+		return false;
+	}
+	return true;
+}
+
+FBenchmarkMesh MakeGridMesh(const std::string &Name, int QuadsPerSide, float Size)
+{
+	FBenchmarkMesh Mesh;
+	Mesh.Name = Name;
+	Mesh.Sections.resize(1);
+	FSectionBuffers &Section = Mesh.Sections[0];
+
+	const int VerticesPerSide = QuadsPerSide + 1;
+	const float Spacing = Size / QuadsPerSide;
+	Section.Positions.reserve(VerticesPerSide * VerticesPerSide * 3);
+	Section.UVs.reserve(VerticesPerSide * VerticesPerSide * 2);
+	for (int Y = 0; Y < VerticesPerSide; ++Y) {
+		for (int X = 0; X < VerticesPerSide; ++X) {
+			const float PositionX = X * Spacing - Size * 0.5f;
+			const float PositionY = Y * Spacing - Size * 0.5f;
+			Section.Positions.push_back(PositionX);
+			Section.Positions.push_back(PositionY);
+			Section.Positions.push_back(sinf(PositionX * 0.05f) * cosf(PositionY * 0.05f) * Size * 0.05f);
+			Section.UVs.push_back((float)X / QuadsPerSide);
+			Section.UVs.push_back((float)Y / QuadsPerSide);
+		}
+	}
+
+	Section.Triangles.reserve(QuadsPerSide * QuadsPerSide * 6);
+	for (int Y = 0; Y < QuadsPerSide; ++Y) {
+		for (int X = 0; X < QuadsPerSide; ++X) {
+			const int Corner = Y * VerticesPerSide + X;
+			Section.Triangles.insert(Section.Triangles.end(), {
+				Corner, Corner + VerticesPerSide, Corner + 1,
+				Corner + 1, Corner + VerticesPerSide, Corner + VerticesPerSide + 1
+			});
+		}
+	}
+
+	CalculateNormals(Section);
+	return Mesh;
+}
+
+FBenchmarkMesh ScaleMesh(const FBenchmarkMesh &Mesh, int TargetVertexCount)
+{
+	static const int MaxSectionVertexCount = 1 << 20;
+
+	const int MeshVertexCount = std::max(Mesh.GetVertexCount(), 1);
+	const int CopyCount = std::max((TargetVertexCount + MeshVertexCount - 1) / MeshVertexCount, 1);
+	const int CopiesPerRow = (int)ceil(sqrt((double)CopyCount));
+
+	// Lay the copies out in a grid on the XY plane, leaving a small gap between them.
+	float BoundsMin[3], BoundsMax[3];
+	Mesh.GetBounds(BoundsMin, BoundsMax);
+	const float SpacingX = (BoundsMax[0] - BoundsMin[0]) * 1.1f + 1.0f;
+	const float SpacingY = (BoundsMax[1] - BoundsMin[1]) * 1.1f + 1.0f;
+
+	FBenchmarkMesh Scaled;
+	Scaled.Name = Mesh.Name + "x" + std::to_string(CopyCount);
+	for (int Copy = 0; Copy < CopyCount; ++Copy) {
+		const float OffsetX = (Copy % CopiesPerRow) * SpacingX;
+		const float OffsetY = (Copy / CopiesPerRow) * SpacingY;
+		for (const auto &Section : Mesh.Sections) {
+			if (Scaled.Sections.empty() || Scaled.Sections.back().GetVertexCount() + Section.GetVertexCount() > MaxSectionVertexCount) {
+				Scaled.Sections.emplace_back();
+			}
+			FSectionBuffers &Target = Scaled.Sections.back();
+			const int FirstVertex = Target.GetVertexCount();
+			for (size_t Index = 0; Index < Section.Positions.size(); Index += 3) {
+				Target.Positions.push_back(Section.Positions[Index] + OffsetX);
+				Target.Positions.push_back(Section.Positions[Index + 1] + OffsetY);
+				Target.Positions.push_back(Section.Positions[Index + 2]);
+			}
+			Target.Normals.insert(Target.Normals.end(), Section.Normals.begin(), Section.Normals.end());
+			Target.UVs.insert(Target.UVs.end(), Section.UVs.begin(), Section.UVs.end());
+			for (int VertexIndex : Section.Triangles) {
+				Target.Triangles.push_back(FirstVertex + VertexIndex);
+			}
+		}
+	}
+	return Scaled;
+}
+
+void CalculateNormals(FSectionBuffers &Section)
+{
+	Section.Normals.assign(Section.Positions.size(), 0.0f);
+	for (size_t Index = 0; Index + 2 < Section.Triangles.size(); Index += 3) {
+		const float *Corners[3];
+		for (int Corner = 0; Corner < 3; ++Corner) {
+			Corners[Corner] = &Section.Positions[Section.Triangles[Index + Corner] * 3];
+		}
+		const float EdgeA[3] = { Corners[1][0] - Corners[0][0], Corners[1][1] - Corners[0][1], Corners[1][2] - Corners[0][2] };
+		const float EdgeB[3] = { Corners[2][0] - Corners[0][0], Corners[2][1] - Corners[0][1], Corners[2][2] - Corners[0][2] };
+		// The cross product is weighted by the triangle's area, which is what we want here.
+		const float FaceNormal[3] = {
+			EdgeA[1] * EdgeB[2] - EdgeA[2] * EdgeB[1],
+			EdgeA[2] * EdgeB[0] - EdgeA[0] * EdgeB[2],
+			EdgeA[0] * EdgeB[1] - EdgeA[1] * EdgeB[0]
+		};
+		for (int Corner = 0; Corner < 3; ++Corner) {
+			float *Normal = &Section.Normals[Section.Triangles[Index + Corner] * 3];
+			Normal[0] += FaceNormal[0];
+			Normal[1] += FaceNormal[1];
+			Normal[2] += FaceNormal[2];
+		}
+	}
+	for (size_t Index = 0; Index < Section.Normals.size(); Index += 3) {
+		float *Normal = &Section.Normals[Index];
+		const float Length = sqrtf(Normal[0] * Normal[0] + Normal[1] * Normal[1] + Normal[2] * Normal[2]);
+		if (Length > 1.e-8f) {
+			Normal[0] /= Length;
+			Normal[1] /= Length;
+			Normal[2] /= Length;
+		}
+	}
+}
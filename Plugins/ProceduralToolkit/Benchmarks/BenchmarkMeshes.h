@@ -0,0 +1,55 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include "ToolkitCore/SectionBuffers.h"
+#include <string>
+#include <vector>
+
+/// A mesh for the benchmarks, made of one or more sections like a *UMeshGeometry*.
+struct FBenchmarkMesh
+{
+	/// The name used in the results, such as "Plane128" or "Plane128x64"
+	std::string Name;
+
+	/// The sections of geometry
+	std::vector<FSectionBuffers> Sections;
+
+	/// Return the total number of vertices across all sections.
+	int GetVertexCount() const;
+
+	/// Get the axis-aligned bounds of all of the vertices.
+	void GetBounds(float OutMin[3], float OutMax[3]) const;
+};
+
+/// Return whether FBX files can be loaded, which needs the benchmarks to be built with zlib.
+bool CanLoadFbx();
+
+/// Load the geometry of a binary FBX file, with one section for each mesh in the file.
+///
+/// Only the control points and polygons are read.  Polygons are triangulated as fans and the
+/// normals are recalculated by averaging the normals of the triangles around each vertex, so
+/// the vertex count is that of the FBX rather than what the engine's importer would produce.
+///
+/// \param Path				The file to load
+/// \param OutMesh			The loaded mesh, named after the file
+/// \param OutError			A description of the problem if the load fails
+/// \return					True if the mesh was loaded
+bool LoadFbxMesh(const std::string &Path, FBenchmarkMesh &OutMesh, std::string &OutError);
+
+/// Create a flat grid of quads with a gentle wave across it, for when the FBX files can't be loaded.
+///
+/// \param Name				The name of the mesh
+/// \param QuadsPerSide		The number of quads along each side, giving (QuadsPerSide + 1)^2 vertices
+/// \param Size				The length of each side
+FBenchmarkMesh MakeGridMesh(const std::string &Name, int QuadsPerSide, float Size);
+
+/// Build a bigger mesh by tiling copies of a mesh next to each other until it has at least
+/// *TargetVertexCount* vertices.
+///
+/// Copies are packed into sections of up to about a million vertices, as big meshes imported
+/// into the engine are split into several sections.
+FBenchmarkMesh ScaleMesh(const FBenchmarkMesh &Mesh, int TargetVertexCount);
+
+/// Calculate smooth normals for a section from its triangles.
+void CalculateNormals(FSectionBuffers &Section);
@@ -0,0 +1,1052 @@
+// (c)2017 Paul Golds, released under MIT License.
+//
+// Benchmarks for the toolkit's engine-free core.
+//
+// This times the kernels behind the MeshGeometry Select and transform nodes and the
+// SelectionSetBPLibrary math nodes over the DeformTestMeshes, and over copies of them tiled up
+// to millions of vertices, and reports the throughput of each in vertices per second.  Work is
+// split into chunks spread across threads in the same way as ParallelForVertexChunks does in
+// the plugin.
+//
+// Run with --help for the options.
+
+#include "BenchmarkMeshes.h"
+#include "FastNoise.h"
+#include "ToolkitCore/CurveLookupTable.h"
+#include "ToolkitCore/MeshAdjacency.h"
+#include "ToolkitCore/NoiseKernels.h"
+#include "ToolkitCore/NoiseVolumeCache.h"
+#include "ToolkitCore/PolylineIndex.h"
+#include "ToolkitCore/SelectionKernels.h"
+#include "ToolkitCore/VertexGrid.h"
+#include "ToolkitCore/VertexKernels.h"
+#include "ToolkitCore/WeightExpression.h"
+#include "ToolkitCore/WeightKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef PROCEDURALTOOLKIT_MESH_DIR
+#define PROCEDURALTOOLKIT_MESH_DIR "."
+#endif
+
+/// The meshes shipped in GraphicsResources/DeformTestMeshes.
+static const char *const TestMeshFiles[] = {
+	"Plane128.fbx",
+	"Cube32x32x32.fbx",
+	"SubdividedCylinder.fbx",
+	"Girder.fbx"
+};
+
+struct FBenchmarkOptions
+{
+	std::string MeshDirectory = PROCEDURALTOOLKIT_MESH_DIR;
+	std::vector<int> Sizes = { 100000, 1000000, 10000000 };
+	int MaxVertices = 10000000;
+	int Threads = (int)std::max(std::thread::hardware_concurrency(), 1u);
+	int BatchSize = 8192;
+	int Repetitions = 5;
+	std::string Filter;
+	std::string JsonPath;
+	std::string CsvPath;
+	bool bVerifyNoise = false;
+};
+
+struct FBenchmarkResult
+{
+	std::string Mesh;
+	int Vertices;
+	int Sections;
+	std::string Category;
+	std::string Operation;
+	int Threads;
+	int Repetitions;
+	double BestSeconds;
+	double MedianSeconds;
+	double VerticesPerSecond;
+};
+
+/// A range of vertices within one section, matching FVertexChunk in the plugin.
+struct FChunk
+{
+	int SectionIndex;
+	int FirstVertex;
+	int VertexCount;
+	int FirstWeightIndex;
+};
+
+/// A fixed set of threads which ParallelFor spreads work across, standing in for the task graph.
+class FWorkerPool
+{
+public:
+	explicit FWorkerPool(int ThreadCount)
+	{
+		// The calling thread does work too, so it only needs ThreadCount - 1 workers.
+		for (int Index = 1; Index < ThreadCount; ++Index) {
+			Workers.emplace_back([this]() { WorkerLoop(); });
+		}
+	}
+
+	~FWorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			bStopping = true;
+		}
+		WorkAvailable.notify_all();
+		for (auto &Worker : Workers) {
+			Worker.join();
+		}
+	}
+
+	int GetThreadCount() const
+	{
+		return (int)Workers.size() + 1;
+	}
+
+	/// Call Function(0) to Function(Count - 1) across all of the threads, returning when all are done.
+	void ParallelFor(int Count, const std::function<void(int)> &Function)
+	{
+		if (Workers.empty() || Count <= 1) {
+			for (int Index = 0; Index < Count; ++Index) {
+				Function(Index);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Job = &Function;
+			JobCount = Count;
+			NextIndex = 0;
+			ActiveWorkers = (int)Workers.size();
+			++Generation;
+		}
+		WorkAvailable.notify_all();
+		RunJob(Function, Count);
+
+		std::unique_lock<std::mutex> Lock(Mutex);
+		WorkDone.wait(Lock, [this]() { return ActiveWorkers == 0; });
+		Job = nullptr;
+	}
+
+private:
+	void RunJob(const std::function<void(int)> &Function, int Count)
+	{
+		for (int Index = NextIndex++; Index < Count; Index = NextIndex++) {
+			Function(Index);
+		}
+	}
+
+	void WorkerLoop()
+	{
+		int SeenGeneration = 0;
+		for (;;) {
+			const std::function<void(int)> *CurrentJob;
+			int CurrentCount;
+			{
+				std::unique_lock<std::mutex> Lock(Mutex);
+				WorkAvailable.wait(Lock, [&]() { return bStopping || Generation != SeenGeneration; });
+				if (bStopping) {
+					return;
+				}
+				SeenGeneration = Generation;
+				CurrentJob = Job;
+				CurrentCount = JobCount;
+			}
+			RunJob(*CurrentJob, CurrentCount);
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				--ActiveWorkers;
+			}
+			WorkDone.notify_one();
+		}
+	}
+
+	std::vector<std::thread> Workers;
+	std::mutex Mutex;
+	std::condition_variable WorkAvailable;
+	std::condition_variable WorkDone;
+	const std::function<void(int)> *Job = nullptr;
+	int JobCount = 0;
+	std::atomic<int> NextIndex{ 0 };
+	int ActiveWorkers = 0;
+	int Generation = 0;
+	bool bStopping = false;
+};
+
+/// Everything the operations work on for a single mesh.
+struct FBenchmarkContext
+{
+	FBenchmarkMesh Mesh;
+	std::vector<FSectionBuffers> OriginalSections;
+	std::vector<int> SectionVertexOffsets;
+	std::vector<FChunk> Chunks;
+	int VertexCount = 0;
+	float Center[3];
+	float Extent;
+
+	/// A falloff selection used by the weighted transforms and as an input to the math nodes
+	std::vector<float> Selection;
+
+	/// A second selection for the math nodes taking two
+	std::vector<float> OtherSelection;
+
+	/// *Selection* quantized, as a quantized SelectionSet stores it
+	std::vector<uint16_t> SelectionCodes16;
+	std::vector<uint8_t> SelectionCodes8;
+	FWeightStream Selection16;
+	FWeightStream Selection8;
+
+	/// Where selections and math results are written
+	std::vector<float> Output;
+
+	/// The spatial index used by MeshGeometry's SelectNear and SelectNearLine, over the original positions
+	FVertexGrid Grid;
+
+	/// The baked noise used by SelectByNoise(Cached), standing in for MeshGeometry's shared cache
+	FNoiseVolumeCache NoiseCache;
+
+	FWorkerPool *Pool = nullptr;
+
+	/// Process every chunk of vertices, as ParallelForVertexChunks does in the plugin.
+	void ForEachChunk(const std::function<void(const FChunk &)> &Function)
+	{
+		Pool->ParallelFor((int)Chunks.size(), [&](int ChunkIndex) { Function(Chunks[ChunkIndex]); });
+	}
+
+	float *GetPositions(const FChunk &Chunk)
+	{
+		return Mesh.Sections[Chunk.SectionIndex].Positions.data() + Chunk.FirstVertex * 3;
+	}
+
+	const float *GetNormals(const FChunk &Chunk) const
+	{
+		return Mesh.Sections[Chunk.SectionIndex].Normals.data() + Chunk.FirstVertex * 3;
+	}
+};
+
+/// Build the adjacency of every section, as MeshGeometry's GetAdjacency does.
+static void BuildAdjacency(FBenchmarkContext &Context, bool bWeld, FMeshAdjacency &Adjacency)
+{
+	std::vector<FMeshAdjacency::FSource> Sources;
+	for (const FSectionBuffers &Section : Context.OriginalSections) {
+		Sources.push_back({ Section.Triangles.data(), Section.GetTriangleCount(), Section.Positions.data(), Section.GetVertexCount() });
+	}
+	FWorkerPool *Pool = Context.Pool;
+	Adjacency.Build(Sources.data(), (int)Sources.size(), bWeld, [Pool](int TaskCount, const std::function<void(int Task)> &Task) {
+		Pool->ParallelFor(TaskCount, Task);
+	});
+}
+
+/// Build a spatial index over every section, as MeshGeometry does.
+static void BuildGrid(const std::vector<FSectionBuffers> &Sections, const std::vector<int> &SectionVertexOffsets, FVertexGrid &Grid)
+{
+	std::vector<FVertexGrid::FSource> Sources;
+	for (int SectionIndex = 0; SectionIndex < (int)Sections.size(); ++SectionIndex) {
+		Sources.push_back({ Sections[SectionIndex].Positions.data(), Sections[SectionIndex].GetVertexCount(), SectionVertexOffsets[SectionIndex] });
+	}
+	Grid.Build(Sources.data(), (int)Sources.size());
+}
+
+static void PrepareContext(FBenchmarkContext &Context, int BatchSize)
+{
+	Context.OriginalSections = Context.Mesh.Sections;
+	GetSectionVertexOffsets(Context.Mesh.Sections, Context.SectionVertexOffsets);
+	Context.VertexCount = Context.SectionVertexOffsets.back();
+
+	Context.Chunks.clear();
+	for (int SectionIndex = 0; SectionIndex < (int)Context.Mesh.Sections.size(); ++SectionIndex) {
+		const int SectionVertexCount = Context.Mesh.Sections[SectionIndex].GetVertexCount();
+		for (int FirstVertex = 0; FirstVertex < SectionVertexCount; FirstVertex += BatchSize) {
+			Context.Chunks.push_back({
+				SectionIndex, FirstVertex, std::min(BatchSize, SectionVertexCount - FirstVertex),
+				Context.SectionVertexOffsets[SectionIndex] + FirstVertex
+			});
+		}
+	}
+
+	float BoundsMin[3], BoundsMax[3];
+	Context.Mesh.GetBounds(BoundsMin, BoundsMax);
+	Context.Extent = 0.0f;
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		Context.Center[Axis] = (BoundsMin[Axis] + BoundsMax[Axis]) * 0.5f;
+		Context.Extent = std::max(Context.Extent, BoundsMax[Axis] - BoundsMin[Axis]);
+	}
+
+	Context.Selection.resize(Context.VertexCount);
+	Context.OtherSelection.resize(Context.VertexCount);
+	Context.Output.resize(Context.VertexCount);
+	Context.ForEachChunk([&](const FChunk &Chunk) {
+		SelectionKernels::SelectNear(
+			Context.GetPositions(Chunk), Chunk.VertexCount, Context.Center, 0.0f, Context.Extent * 0.5f,
+			Context.Selection.data() + Chunk.FirstWeightIndex
+		);
+	});
+	for (int Index = 0; Index < Context.VertexCount; ++Index) {
+		Context.OtherSelection[Index] = 0.25f + 0.5f * (float)((Index * 7919) % 1000) / 1000.0f;
+	}
+
+	float SelectionMin, SelectionMax;
+	WeightKernels::MinMax(Context.Selection.data(), Context.VertexCount, SelectionMin, SelectionMax);
+	Context.SelectionCodes16.resize(Context.VertexCount);
+	Context.SelectionCodes8.resize(Context.VertexCount);
+	Context.Selection16 = FWeightStream(
+		Context.SelectionCodes16.data(), SelectionMin,
+		WeightKernels::Quantize(Context.Selection.data(), Context.VertexCount, SelectionMin, SelectionMax, Context.SelectionCodes16.data())
+	);
+	Context.Selection8 = FWeightStream(
+		Context.SelectionCodes8.data(), SelectionMin,
+		WeightKernels::Quantize(Context.Selection.data(), Context.VertexCount, SelectionMin, SelectionMax, Context.SelectionCodes8.data())
+	);
+
+	BuildGrid(Context.OriginalSections, Context.SectionVertexOffsets, Context.Grid);
+}
+
+/// Sample and index a helix around the middle of the mesh, standing in for a spline with a point
+/// every quarter turn as MeshGeometry's SelectNearSpline does.
+static void BuildHelix(const FBenchmarkContext &Context, float Tolerance, FPolylineIndex &Polyline)
+{
+	const int Turns = 3;
+	const float Radius = Context.Extent * 0.3f;
+	const float Height = Context.Extent * 0.5f;
+	std::vector<float> Breaks;
+	for (int Point = 0; Point <= Turns * 4; ++Point) {
+		Breaks.push_back((float)Point / (Turns * 4));
+	}
+
+	const float *Center = Context.Center;
+	std::vector<float> Points;
+	FPolylineIndex::SampleCurve(
+		[Center, Radius, Height](float Along, float OutPoint[3]) {
+			const float Angle = Along * Turns * 2.0f * 3.1415926535897932f;
+			OutPoint[0] = Center[0] + Radius * cosf(Angle);
+			OutPoint[1] = Center[1] + Radius * sinf(Angle);
+			OutPoint[2] = Center[2] + Height * (Along - 0.5f);
+		},
+		Breaks.data(), (int)Breaks.size(), Tolerance, 12, Points
+	);
+	Polyline.Build(Points.data(), (int)(Points.size() / 3));
+}
+
+/// Set up noise as SelectByNoise's defaults, Simplex FBM with three octaves.
+static void SetUpSelectionNoise(FastNoise &Noise)
+{
+	Noise.SetSeed(1337);
+	Noise.SetFrequency(0.01f);
+	Noise.SetNoiseType(FastNoise::SimplexFractal);
+	Noise.SetFractalOctaves(3);
+}
+
+/// Find the box around the mesh's current positions, as SelectByNoiseCached does.
+static void GetPositionBounds(const FBenchmarkContext &Context, float OutMin[3], float OutMax[3])
+{
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		OutMin[Axis] = INFINITY;
+		OutMax[Axis] = -INFINITY;
+	}
+	for (const FSectionBuffers &Section : Context.Mesh.Sections) {
+		FNoiseVolume::ExpandBounds(Section.Positions.data(), Section.GetVertexCount(), OutMin, OutMax);
+	}
+}
+
+/// Bake the default noise over a box a slice per task, as SelectByNoiseCached does on a miss.
+static std::shared_ptr<FNoiseVolume> BakeSelectionNoise(FBenchmarkContext &Context, const float BoxMin[3], const float BoxMax[3], float Spacing)
+{
+	FastNoise Noise;
+	SetUpSelectionNoise(Noise);
+	std::shared_ptr<FNoiseVolume> Volume = std::make_shared<FNoiseVolume>();
+	if (Volume->Allocate(BoxMin, BoxMax, Spacing, Context.NoiseCache.GetMemoryBudget())) {
+		Context.Pool->ParallelFor(Volume->GetSliceCount(), [&](int Slice) { Volume->BakeSlice(Noise, Slice); });
+		Volume->MeasureError(Noise);
+	}
+	return Volume;
+}
+
+/// The graph of SelectionSetBPLibrary nodes timed by the Chain operations, eight nodes reading
+/// both selections: Clamp, Ease, Multiply, Add(Float), OneMinus, Lerp, Max(Float), RemapRange.
+static const int SelectionChainLength = 8;
+
+static FWeightOperation GetSelectionChainOperation(int Node)
+{
+	switch (Node) {
+	case 0:		return FWeightOperation::MakeClamp(0.1f, 0.9f);
+	case 1:		return FWeightOperation::MakeEase(WeightKernels::EEaseFunction::SinusoidalInOut, 4, 2.0f);
+	case 2:		return FWeightOperation::MakeBinary(FWeightOperation::EType::Multiply);
+	case 3:		return FWeightOperation::MakeAddScalar(0.25f);
+	case 4:		return FWeightOperation::MakeOneMinus();
+	case 5:		return FWeightOperation::MakeBinary(FWeightOperation::EType::Lerp, 0.3f);
+	case 6:		return FWeightOperation::MakeMaxScalar(0.2f);
+	default:	return FWeightOperation::MakeRemapRange(0.0f, 1.25f, 0.0f, 1.0f);
+	}
+}
+
+/// Build the expression a deferred SelectionSet would hold for the chain, with the binary nodes
+/// reading the second selection.
+static FWeightExpression::FPtr BuildSelectionChain(const float *A, const float *B, int Count)
+{
+	FWeightExpression::FPtr Expression = FWeightExpression::MakeSource(A, Count);
+	const FWeightExpression::FPtr Other = FWeightExpression::MakeSource(B, Count);
+	for (int Node = 0; Node < SelectionChainLength; ++Node) {
+		const FWeightOperation Operation = GetSelectionChainOperation(Node);
+		Expression = FWeightExpression::Make(Operation, Count, Expression, Operation.GetInputCount() == 2 ? Other : nullptr);
+	}
+	return Expression;
+}
+
+/// A curve with cubic keys found by binary search, standing in for the FRichCurve the
+/// RemapToCurve(Keys) operation would read through UCurveFloat::GetFloatValue.
+struct FBenchmarkCurve
+{
+	static const int KeyCount = 8;
+	float Times[KeyCount];
+	float Values[KeyCount];
+	float Tangents[KeyCount];
+
+	FBenchmarkCurve()
+	{
+		for (int Key = 0; Key < KeyCount; ++Key) {
+			Times[Key] = (float)Key / (KeyCount - 1);
+			Values[Key] = (Key % 2) ? 1.0f - Times[Key] * 0.5f : Times[Key];
+			Tangents[Key] = (Key % 3) - 1.0f;
+		}
+	}
+
+	float Evaluate(float Time) const
+	{
+		if (!(Time > Times[0])) {
+			return Values[0];
+		}
+		if (Time >= Times[KeyCount - 1]) {
+			return Values[KeyCount - 1];
+		}
+		const int Key = (int)(std::upper_bound(Times, Times + KeyCount, Time) - Times) - 1;
+		const float Span = Times[Key + 1] - Times[Key];
+		const float T = (Time - Times[Key]) / Span;
+		const float T2 = T * T;
+		const float T3 = T2 * T;
+		return (2.0f * T3 - 3.0f * T2 + 1.0f) * Values[Key] + (T3 - 2.0f * T2 + T) * Tangents[Key] * Span +
+			(-2.0f * T3 + 3.0f * T2) * Values[Key + 1] + (T3 - T2) * Tangents[Key + 1] * Span;
+	}
+};
+
+struct FOperation
+{
+	const char *Category;
+	std::string Name;
+	std::function<void()> Run;
+};
+
+/// Build the list of operations to time for a mesh.
+static std::vector<FOperation> MakeOperations(FBenchmarkContext &Context)
+{
+	std::vector<FOperation> Operations;
+	FBenchmarkContext *C = &Context;
+	const int Count = Context.VertexCount;
+
+	// Select*
+	Operations.push_back({ "Select", "SelectAll", [C, Count]() {
+		WeightKernels::Fill(C->Output.data(), Count, 1.0f);
+	} });
+	Operations.push_back({ "Select", "SelectNear", [C]() {
+		C->ForEachChunk([C](const FChunk &Chunk) {
+			SelectionKernels::SelectNear(
+				C->GetPositions(Chunk), Chunk.VertexCount, C->Center, C->Extent * 0.1f, C->Extent * 0.4f,
+				C->Output.data() + Chunk.FirstWeightIndex
+			);
+		});
+	} });
+	for (int Infinite = 0; Infinite < 2; ++Infinite) {
+		Operations.push_back({ "Select", Infinite ? "SelectNearLine(Infinite)" : "SelectNearLine", [C, Infinite]() {
+			const float LineStart[3] = { C->Center[0] - C->Extent * 0.5f, C->Center[1], C->Center[2] };
+			const float LineEnd[3] = { C->Center[0] + C->Extent * 0.25f, C->Center[1] + C->Extent * 0.25f, C->Center[2] };
+			C->ForEachChunk([&](const FChunk &Chunk) {
+				SelectionKernels::SelectNearLine(
+					C->GetPositions(Chunk), Chunk.VertexCount, LineStart, LineEnd, Infinite != 0,
+					C->Extent * 0.05f, C->Extent * 0.2f, C->Output.data() + Chunk.FirstWeightIndex
+				);
+			});
+		} });
+	}
+
+	// Brush-sized selections, the case the spatial index is for, with and without it.  The grid
+	// versions run on the calling thread as they do in MeshGeometry.
+	Operations.push_back({ "Select", "SelectNear(Brush)", [C]() {
+		C->ForEachChunk([C](const FChunk &Chunk) {
+			SelectionKernels::SelectNear(
+				C->GetPositions(Chunk), Chunk.VertexCount, C->Center, 0.0f, C->Extent * 0.01f,
+				C->Output.data() + Chunk.FirstWeightIndex
+			);
+		});
+	} });
+	Operations.push_back({ "Select", "SelectNearLine(Brush)", [C]() {
+		const float LineStart[3] = { C->Center[0] - C->Extent * 0.05f, C->Center[1], C->Center[2] };
+		const float LineEnd[3] = { C->Center[0] + C->Extent * 0.05f, C->Center[1] + C->Extent * 0.02f, C->Center[2] };
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			SelectionKernels::SelectNearLine(
+				C->GetPositions(Chunk), Chunk.VertexCount, LineStart, LineEnd, false,
+				0.0f, C->Extent * 0.01f, C->Output.data() + Chunk.FirstWeightIndex
+			);
+		});
+	} });
+	Operations.push_back({ "SpatialIndex", "VertexGrid::Build", [C]() {
+		FVertexGrid Grid;
+		BuildGrid(C->OriginalSections, C->SectionVertexOffsets, Grid);
+	} });
+	Operations.push_back({ "SpatialIndex", "SelectNear(Brush,Grid)", [C]() {
+		if (!SelectionKernels::SelectNear(C->Grid, C->Center, 0.0f, C->Extent * 0.01f, C->Output.data())) {
+			fprintf(stderr, "SelectNear(Brush,Grid): The grid wasn't used\n");
+		}
+	} });
+	Operations.push_back({ "SpatialIndex", "SelectNear(Brush,Grid,Sparse)", [C]() {
+		std::vector<int> Indices;
+		std::vector<float> Weights;
+		if (!SelectionKernels::SelectNear(C->Grid, C->Center, 0.0f, C->Extent * 0.01f, Indices, Weights)) {
+			fprintf(stderr, "SelectNear(Brush,Grid,Sparse): The grid wasn't used\n");
+		}
+	} });
+	Operations.push_back({ "SpatialIndex", "SelectNearLine(Brush,Grid)", [C]() {
+		const float LineStart[3] = { C->Center[0] - C->Extent * 0.05f, C->Center[1], C->Center[2] };
+		const float LineEnd[3] = { C->Center[0] + C->Extent * 0.05f, C->Center[1] + C->Extent * 0.02f, C->Center[2] };
+		if (!SelectionKernels::SelectNearLine(C->Grid, LineStart, LineEnd, 0.0f, C->Extent * 0.01f, C->Output.data())) {
+			fprintf(stderr, "SelectNearLine(Brush,Grid): The grid wasn't used\n");
+		}
+	} });
+	Operations.push_back({ "SpatialIndex", "PolylineIndex::Build", [C]() {
+		FPolylineIndex Polyline;
+		BuildHelix(*C, C->Extent * 0.001f, Polyline);
+	} });
+	Operations.push_back({ "Adjacency", "MeshAdjacency::Build", [C]() {
+		FMeshAdjacency Adjacency;
+		BuildAdjacency(*C, false, Adjacency);
+	} });
+	Operations.push_back({ "Adjacency", "MeshAdjacency::Build(Welded)", [C]() {
+		FMeshAdjacency Adjacency;
+		BuildAdjacency(*C, true, Adjacency);
+	} });
+	Operations.push_back({ "Select", "SelectNearSpline(Polyline)", [C]() {
+		// Sampled on each run, as MeshGeometry does for every call.
+		FPolylineIndex Polyline;
+		BuildHelix(*C, C->Extent * 0.001f, Polyline);
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			SelectionKernels::SelectNearPolyline(
+				Polyline, C->GetPositions(Chunk), Chunk.VertexCount, nullptr, 0.0f, C->Extent * 0.1f,
+				C->Output.data() + Chunk.FirstWeightIndex
+			);
+		});
+	} });
+	Operations.push_back({ "Select", "SelectFacing", [C]() {
+		const float Facing[3] = { 0.0f, 0.0f, 1.0f };
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			SelectionKernels::SelectFacing(
+				C->GetNormals(Chunk), Chunk.VertexCount, Facing, 0.0f, 30.0f,
+				C->Output.data() + Chunk.FirstWeightIndex
+			);
+		});
+	} });
+	Operations.push_back({ "Select", "SelectLinear", [C]() {
+		const float LineStart[3] = { C->Center[0] - C->Extent * 0.5f, C->Center[1], C->Center[2] };
+		const float LineEnd[3] = { C->Center[0] + C->Extent * 0.5f, C->Center[1], C->Center[2] };
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			SelectionKernels::SelectLinear(
+				C->GetPositions(Chunk), Chunk.VertexCount, LineStart, LineEnd, false,
+				C->Output.data() + Chunk.FirstWeightIndex
+			);
+		});
+	} });
+	// Once with the instruction set FastNoise picks, then with each one it could have picked.
+	const NoiseKernels::EInstructionSet NoiseInstructionSets[] = {
+		NoiseKernels::GetSupportedInstructionSet(), NoiseKernels::EInstructionSet::Scalar, NoiseKernels::EInstructionSet::SSE2,
+		NoiseKernels::EInstructionSet::AVX2, NoiseKernels::EInstructionSet::NEON
+	};
+	for (int Index = 0; Index < 5; ++Index) {
+		const NoiseKernels::EInstructionSet InstructionSet = NoiseInstructionSets[Index];
+		if (!NoiseKernels::IsSupported(InstructionSet)) {
+			continue;
+		}
+		const std::string Name = Index == 0 ? "SelectByNoise" : std::string("SelectByNoise(") + NoiseKernels::GetInstructionSetName(InstructionSet) + ")";
+		Operations.push_back({ "Select", Name, [C, InstructionSet]() {
+			FastNoise Noise;
+			SetUpSelectionNoise(Noise);
+			Noise.SetInstructionSet(InstructionSet);
+			C->ForEachChunk([&](const FChunk &Chunk) {
+				SelectionKernels::SelectByNoise(Noise, C->GetPositions(Chunk), Chunk.VertexCount, C->Output.data() + Chunk.FirstWeightIndex);
+			});
+		} });
+	}
+	Operations.push_back({ "Select", "NoiseVolume::Bake", [C]() {
+		float BoxMin[3], BoxMax[3];
+		GetPositionBounds(*C, BoxMin, BoxMax);
+		BakeSelectionNoise(*C, BoxMin, BoxMax, FNoiseVolume::ChooseSpacing(BoxMin, BoxMax, 64));
+	} });
+	Operations.push_back({ "Select", "SelectByNoise(Cached)", [C]() {
+		// The bounds are found on every call, as MeshGeometry does, and the warmup run bakes the volume.
+		float BoxMin[3], BoxMax[3], BakeMin[3], BakeMax[3];
+		GetPositionBounds(*C, BoxMin, BoxMax);
+		const float Spacing = FNoiseVolume::ChooseSpacing(BoxMin, BoxMax, 64);
+		std::shared_ptr<const FNoiseVolume> Volume = C->NoiseCache.Find(1, Spacing, BoxMin, BoxMax, BakeMin, BakeMax);
+		if (!Volume) {
+			Volume = BakeSelectionNoise(*C, BakeMin, BakeMax, Spacing);
+			C->NoiseCache.Add(1, Volume);
+		}
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			Volume->Sample(C->GetPositions(Chunk), Chunk.VertexCount, C->Output.data() + Chunk.FirstWeightIndex);
+		});
+	} });
+
+	// Transforms, all weighted by a selection as they usually are.  The amounts are kept small so
+	// repeated runs don't move the geometry far.
+	Operations.push_back({ "Transform", "Translate", [C]() {
+		const float Delta[3] = { 0.01f, -0.01f, 0.005f };
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			VertexKernels::Translate(C->GetPositions(Chunk), Chunk.VertexCount, Delta, C->Selection.data() + Chunk.FirstWeightIndex);
+		});
+	} });
+	Operations.push_back({ "Transform", "Translate(Unweighted)", [C]() {
+		const float Delta[3] = { 0.01f, -0.01f, 0.005f };
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			VertexKernels::Translate(C->GetPositions(Chunk), Chunk.VertexCount, Delta, nullptr);
+		});
+	} });
+	for (int Bits = 16; Bits >= 8; Bits -= 8) {
+		Operations.push_back({ "Transform", Bits == 16 ? "Translate(UInt16)" : "Translate(UInt8)", [C, Bits]() {
+			const float Delta[3] = { 0.01f, -0.01f, 0.005f };
+			const FWeightStream Weights = Bits == 16 ? C->Selection16 : C->Selection8;
+			C->ForEachChunk([&](const FChunk &Chunk) {
+				VertexKernels::Translate(C->GetPositions(Chunk), Chunk.VertexCount, Delta, Weights + Chunk.FirstWeightIndex);
+			});
+		} });
+	}
+	// Rotate, Scale, Transform, and ScaleAlongAxis all become an affine matrix in the plugin.
+	Operations.push_back({ "Transform", "Rotate/Scale/Transform", [C]() {
+		const float Angle = 0.01f;
+		const float Matrix[12] = {
+			cosf(Angle) * 1.001f, -sinf(Angle), 0.0f, C->Center[0] * 0.001f,
+			sinf(Angle), cosf(Angle) * 1.001f, 0.0f, -C->Center[1] * 0.001f,
+			0.0f, 0.0f, 0.999f, 0.0f
+		};
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			VertexKernels::Affine(C->GetPositions(Chunk), Chunk.VertexCount, Matrix, C->Selection.data() + Chunk.FirstWeightIndex);
+		});
+	} });
+	Operations.push_back({ "Transform", "Spherize", [C]() {
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			VertexKernels::Spherize(
+				C->GetPositions(Chunk), Chunk.VertexCount, C->Center, C->Extent * 0.5f, 0.01f,
+				C->Selection.data() + Chunk.FirstWeightIndex
+			);
+		});
+	} });
+	Operations.push_back({ "Transform", "Inflate", [C]() {
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			VertexKernels::AddScaledDirection(
+				C->GetPositions(Chunk), C->GetNormals(Chunk), Chunk.VertexCount, 0.01f,
+				C->Selection.data() + Chunk.FirstWeightIndex
+			);
+		});
+	} });
+	Operations.push_back({ "Transform", "RotateAroundAxis", [C]() {
+		const float Axis[3] = { 0.0f, 0.0f, 1.0f };
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			VertexKernels::RotateAroundAxis(
+				C->GetPositions(Chunk), Chunk.VertexCount, C->Center, Axis, 1.0f,
+				C->Selection.data() + Chunk.FirstWeightIndex
+			);
+		});
+	} });
+	Operations.push_back({ "Transform", "Lerp", [C]() {
+		C->ForEachChunk([&](const FChunk &Chunk) {
+			VertexKernels::LerpTo(
+				C->GetPositions(Chunk), C->OriginalSections[Chunk.SectionIndex].Positions.data() + Chunk.FirstVertex * 3,
+				Chunk.VertexCount, 0.5f, C->Selection.data() + Chunk.FirstWeightIndex
+			);
+		});
+	} });
+
+	// SelectionSetBPLibrary, which works through the whole selection on the calling thread.
+	const float *A = Context.Selection.data();
+	const float *B = Context.OtherSelection.data();
+	float *Out = Context.Output.data();
+	Operations.push_back({ "SelectionSet", "Clamp", [=]() { WeightKernels::Clamp(A, Count, 0.2f, 0.8f, Out); } });
+	static const char *const EaseNames[] = {
+		"Linear", "Step", "SinusoidalIn", "SinusoidalOut", "SinusoidalInOut", "EaseIn", "EaseOut", "EaseInOut",
+		"ExpoIn", "ExpoOut", "ExpoInOut", "CircularIn", "CircularOut", "CircularInOut"
+	};
+	for (int Function = 0; Function <= (int)WeightKernels::EEaseFunction::CircularInOut; ++Function) {
+		Operations.push_back({ "SelectionSet", std::string("Ease(") + EaseNames[Function] + ")", [=]() {
+			WeightKernels::Ease(A, Count, (WeightKernels::EEaseFunction)Function, 4, 2.0f, Out);
+		} });
+	}
+	Operations.push_back({ "SelectionSet", "Add", [=]() { WeightKernels::Add(A, B, Count, Out); } });
+	Operations.push_back({ "SelectionSet", "Add(Float)", [=]() { WeightKernels::AddScalar(A, Count, 0.5f, Out); } });
+	Operations.push_back({ "SelectionSet", "Subtract", [=]() { WeightKernels::Subtract(A, B, Count, Out); } });
+	Operations.push_back({ "SelectionSet", "Subtract(Float)", [=]() { WeightKernels::SubtractScalar(A, Count, 0.5f, Out); } });
+	Operations.push_back({ "SelectionSet", "Subtract(FloatMinusSet)", [=]() { WeightKernels::SubtractFromScalar(0.5f, A, Count, Out); } });
+	Operations.push_back({ "SelectionSet", "Multiply", [=]() { WeightKernels::Multiply(A, B, Count, Out); } });
+	Operations.push_back({ "SelectionSet", "Multiply(Float)", [=]() { WeightKernels::MultiplyScalar(A, Count, 0.5f, Out); } });
+	Operations.push_back({ "SelectionSet", "Divide", [=]() { WeightKernels::Divide(A, B, Count, Out); } });
+	Operations.push_back({ "SelectionSet", "Divide(Float)", [=]() { WeightKernels::DivideScalar(A, Count, 2.0f, Out); } });
+	Operations.push_back({ "SelectionSet", "OneMinus", [=]() { WeightKernels::OneMinus(A, Count, Out); } });
+	Operations.push_back({ "SelectionSet", "Set", [=]() { WeightKernels::Fill(Out, Count, 0.5f); } });
+	Operations.push_back({ "SelectionSet", "Max", [=]() { WeightKernels::Max(A, B, Count, Out); } });
+	Operations.push_back({ "SelectionSet", "Min", [=]() { WeightKernels::Min(A, B, Count, Out); } });
+	Operations.push_back({ "SelectionSet", "Max(Float)", [=]() { WeightKernels::MaxScalar(A, Count, 0.5f, Out); } });
+	Operations.push_back({ "SelectionSet", "Min(Float)", [=]() { WeightKernels::MinScalar(A, Count, 0.5f, Out); } });
+	Operations.push_back({ "SelectionSet", "Lerp", [=]() { WeightKernels::Lerp(A, B, Count, 0.3f, Out); } });
+	Operations.push_back({ "SelectionSet", "Lerp(Float)", [=]() { WeightKernels::LerpScalar(A, Count, 0.5f, 0.3f, Out); } });
+	Operations.push_back({ "SelectionSet", "Quantize(UInt8)", [=]() {
+		float CurrentMin, CurrentMax;
+		WeightKernels::MinMax(A, Count, CurrentMin, CurrentMax);
+		WeightKernels::Quantize(A, Count, CurrentMin, CurrentMax, reinterpret_cast<uint8_t *>(Out));
+	} });
+	Operations.push_back({ "SelectionSet", "Dequantize(UInt8)", [=]() {
+		WeightKernels::Dequantize(C->Selection8, Count, Out);
+	} });
+	Operations.push_back({ "SelectionSet", "RemapRange", [=]() {
+		float CurrentMin, CurrentMax;
+		WeightKernels::MinMax(A, Count, CurrentMin, CurrentMax);
+		if (CurrentMin != CurrentMax) {
+			WeightKernels::RemapRange(A, Count, CurrentMin, CurrentMax, 0.0f, 1.0f, Out);
+		}
+	} });
+	Operations.push_back({ "SelectionSet", "Statistics", [=]() {
+		WeightKernels::FWeightStatistics Found;
+		WeightKernels::Statistics(A, Count, Found);
+	} });
+
+	// RemapToCurve reading the curve's keys for every weight, and looking up a table baked from it.
+	const std::shared_ptr<FBenchmarkCurve> Curve = std::make_shared<FBenchmarkCurve>();
+	const std::shared_ptr<FCurveLookupTable> CurveTable = std::make_shared<FCurveLookupTable>();
+	CurveTable->Bake([Curve](float Alpha) { return Curve->Evaluate(Alpha); }, 1024);
+	Operations.push_back({ "SelectionSet", "RemapToCurve(Keys)", [=]() {
+		for (int Index = 0; Index < Count; ++Index) {
+			Out[Index] = Curve->Evaluate(A[Index]);
+		}
+	} });
+	Operations.push_back({ "SelectionSet", "RemapToCurve(Table)", [=]() { CurveTable->Sample(A, Count, Out); } });
+
+
+	// A graph of nodes, evaluated eagerly with a new set per node, with the Into nodes writing
+	// over one set in place, and then deferred and fused into a single pass as
+	// USelectionSet::Evaluate does.
+	Operations.push_back({ "SelectionSet", "Chain(Eager)", [=]() {
+		std::vector<float> Values(A, A + Count);
+		for (int Node = 0; Node < SelectionChainLength; ++Node) {
+			std::vector<float> Result(Count);
+			GetSelectionChainOperation(Node).Apply(Values.data(), B, Count, Result.data());
+			Values.swap(Result);
+		}
+		memcpy(Out, Values.data(), Count * sizeof(float));
+	} });
+	Operations.push_back({ "SelectionSet", "Chain(Into)", [=]() {
+		memcpy(Out, A, Count * sizeof(float));
+		for (int Node = 0; Node < SelectionChainLength; ++Node) {
+			GetSelectionChainOperation(Node).Apply(Out, B, Count, Out);
+		}
+	} });
+	Operations.push_back({ "SelectionSet", "Chain(Fused)", [=]() {
+		const FWeightProgram Program(BuildSelectionChain(A, B, Count));
+		std::vector<FWeightProgram::FSource> Sources;
+		for (const void *Source : Program.GetSources()) {
+			Sources.push_back({ (const float *)Source, nullptr, nullptr, 0 });
+		}
+		const int TaskSize = 32 * 1024;
+		C->Pool->ParallelFor((Count + TaskSize - 1) / TaskSize, [&](int Task) {
+			const int First = Task * TaskSize;
+			Program.Evaluate(Sources.data(), First, std::min(TaskSize, Count - First), Out + First);
+		});
+	} });
+
+	return Operations;
+}
+
+/// Time an operation, returning the best and median of the repetitions after one warm-up run.
+static void TimeOperation(const std::function<void()> &Run, int Repetitions, double &OutBestSeconds, double &OutMedianSeconds)
+{
+	Run();
+	std::vector<double> Seconds;
+	for (int Repetition = 0; Repetition < Repetitions; ++Repetition) {
+		const auto Start = std::chrono::steady_clock::now();
+		Run();
+		const auto End = std::chrono::steady_clock::now();
+		Seconds.push_back(std::chrono::duration<double>(End - Start).count());
+	}
+	std::sort(Seconds.begin(), Seconds.end());
+	OutBestSeconds = Seconds.front();
+	OutMedianSeconds = Seconds[Seconds.size() / 2];
+}
+
+static void RunMesh(FBenchmarkMesh &&Mesh, const FBenchmarkOptions &Options, FWorkerPool &Pool, std::vector<FBenchmarkResult> &Results)
+{
+	FBenchmarkContext Context;
+	Context.Mesh = std::move(Mesh);
+	Context.Pool = &Pool;
+	PrepareContext(Context, Options.BatchSize);
+	printf("\n%s: %d vertices in %d sections\n", Context.Mesh.Name.c_str(), Context.VertexCount, (int)Context.Mesh.Sections.size());
+
+	for (const auto &Operation : MakeOperations(Context)) {
+		if (!Options.Filter.empty() && Operation.Name.find(Options.Filter) == std::string::npos) {
+			continue;
+		}
+
+		FBenchmarkResult Result;
+		Result.Mesh = Context.Mesh.Name;
+		Result.Vertices = Context.VertexCount;
+		Result.Sections = (int)Context.Mesh.Sections.size();
+		Result.Category = Operation.Category;
+		Result.Operation = Operation.Name;
+		const bool bSingleThreaded = strcmp(Operation.Category, "SelectionSet") == 0 || strcmp(Operation.Category, "SpatialIndex") == 0;
+		Result.Threads = bSingleThreaded ? 1 : Pool.GetThreadCount();
+		Result.Repetitions = Options.Repetitions;
+		TimeOperation(Operation.Run, Options.Repetitions, Result.BestSeconds, Result.MedianSeconds);
+		Result.VerticesPerSecond = Result.MedianSeconds > 0.0 ? Context.VertexCount / Result.MedianSeconds : 0.0;
+		Results.push_back(Result);
+
+		printf("  %-14s %-28s %12.3f ms %14.1f Mvert/s\n",
+			Result.Category.c_str(), Result.Operation.c_str(), Result.MedianSeconds * 1000.0, Result.VerticesPerSecond / 1.0e6);
+	}
+}
+
+static bool WriteJson(const std::string &Path, const FBenchmarkOptions &Options, const std::vector<FBenchmarkResult> &Results)
+{
+	FILE *File = fopen(Path.c_str(), "w");
+	if (!File) {
+		return false;
+	}
+	fprintf(File, "{\n  \"benchmark\": \"ProceduralToolkitCore\",\n");
+	fprintf(File, "  \"threads\": %d,\n  \"batch_size\": %d,\n  \"repetitions\": %d,\n", Options.Threads, Options.BatchSize, Options.Repetitions);
+	fprintf(File, "  \"results\": [\n");
+	for (size_t Index = 0; Index < Results.size(); ++Index) {
+		const FBenchmarkResult &Result = Results[Index];
+		fprintf(File,
+			"    {\"mesh\": \"%s\", \"vertices\": %d, \"sections\": %d, \"category\": \"%s\", \"operation\": \"%s\", "
+			"\"threads\": %d, \"best_seconds\": %.9g, \"median_seconds\": %.9g, \"vertices_per_second\": %.9g}%s\n",
+			Result.Mesh.c_str(), Result.Vertices, Result.Sections, Result.Category.c_str(), Result.Operation.c_str(),
+			Result.Threads, Result.BestSeconds, Result.MedianSeconds, Result.VerticesPerSecond,
+			(Index + 1 < Results.size()) ? "," : ""
+		);
+	}
+	fprintf(File, "  ]\n}\n");
+	return fclose(File) == 0;
+}
+
+static bool WriteCsv(const std::string &Path, const std::vector<FBenchmarkResult> &Results)
+{
+	FILE *File = fopen(Path.c_str(), "w");
+	if (!File) {
+		return false;
+	}
+	fprintf(File, "mesh,vertices,sections,category,operation,threads,best_seconds,median_seconds,vertices_per_second\n");
+	for (const auto &Result : Results) {
+		fprintf(File, "%s,%d,%d,%s,\"%s\",%d,%.9g,%.9g,%.9g\n",
+			Result.Mesh.c_str(), Result.Vertices, Result.Sections, Result.Category.c_str(), Result.Operation.c_str(),
+			Result.Threads, Result.BestSeconds, Result.MedianSeconds, Result.VerticesPerSecond
+		);
+	}
+	return fclose(File) == 0;
+}
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: ProceduralToolkitBenchmark [options]\n"
+		"\n"
+		"  --mesh-dir DIR        Directory containing the DeformTestMeshes FBX files\n"
+		"  --sizes N,N,...       Vertex counts to scale each mesh up to (default 100000,1000000,10000000)\n"
+		"  --max-vertices N      Skip any size above this (default 10000000)\n"
+		"  --threads N           Threads to spread chunks across (default: all cores)\n"
+		"  --batch-size N        Vertices per chunk, as MeshGeometry's ParallelBatchSize (default 8192)\n"
+		"  --repetitions N       Timed runs of each operation, after one warm-up (default 5)\n"
+		"  --filter TEXT         Only run operations whose name contains TEXT\n"
+		"  --json FILE           Write the results as JSON\n"
+		"  --csv FILE            Write the results as CSV\n"
+		"  --verify-noise        Check the vectorised noise matches FastNoise's scalar code, then exit\n"
+	);
+}
+
+static bool ParseOptions(int ArgumentCount, char **Arguments, FBenchmarkOptions &Options)
+{
+	for (int Index = 1; Index < ArgumentCount; ++Index) {
+		const std::string Argument = Arguments[Index];
+		if (Argument == "--help" || Argument == "-h") {
+			PrintUsage();
+			exit(0);
+		}
+		if (Argument == "--verify-noise") {
+			Options.bVerifyNoise = true;
+			continue;
+		}
+		if (Index + 1 >= ArgumentCount) {
+			fprintf(stderr, "Missing value for %s\n", Argument.c_str());
+			return false;
+		}
+		const std::string Value = Arguments[++Index];
+		if (Argument == "--mesh-dir") {
+			Options.MeshDirectory = Value;
+		} else if (Argument == "--sizes") {
+			Options.Sizes.clear();
+			std::stringstream Stream(Value);
+			std::string Size;
+			while (std::getline(Stream, Size, ',')) {
+				Options.Sizes.push_back(atoi(Size.c_str()));
+			}
+		} else if (Argument == "--max-vertices") {
+			Options.MaxVertices = atoi(Value.c_str());
+		} else if (Argument == "--threads") {
+			Options.Threads = std::max(atoi(Value.c_str()), 1);
+		} else if (Argument == "--batch-size") {
+			Options.BatchSize = std::max(atoi(Value.c_str()), 1);
+		} else if (Argument == "--repetitions") {
+			Options.Repetitions = std::max(atoi(Value.c_str()), 1);
+		} else if (Argument == "--filter") {
+			Options.Filter = Value;
+		} else if (Argument == "--json") {
+			Options.JsonPath = Value;
+		} else if (Argument == "--csv") {
+			Options.CsvPath = Value;
+		} else {
+			fprintf(stderr, "Unknown option %s\n", Argument.c_str());
+			PrintUsage();
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Compare each supported instruction set's noise with FastNoise's scalar code, for every noise
+/// type, fractal and interpolation they handle, returning false if any differ by more than NoiseKernels::Tolerance.
+static bool VerifyNoise()
+{
+	const int PointCount = 10007;
+	std::vector<float> Points(PointCount * 4);
+	std::mt19937 Random(1337);
+	std::uniform_real_distribution<float> Coordinate(-10000.0f, 10000.0f);
+	for (float &Value : Points) {
+		Value = Coordinate(Random);
+	}
+
+	const FastNoise::NoiseType NoiseTypes[] = {
+		FastNoise::Value, FastNoise::ValueFractal, FastNoise::Perlin, FastNoise::PerlinFractal,
+		FastNoise::Simplex, FastNoise::SimplexFractal, FastNoise::Cubic, FastNoise::CubicFractal
+	};
+	const NoiseKernels::EInstructionSet InstructionSets[] = {
+		NoiseKernels::EInstructionSet::SSE2, NoiseKernels::EInstructionSet::AVX2, NoiseKernels::EInstructionSet::NEON
+	};
+
+	bool bPassed = true;
+	std::vector<float> Expected(PointCount), Actual(PointCount);
+	for (NoiseKernels::EInstructionSet InstructionSet : InstructionSets) {
+		if (!NoiseKernels::IsSupported(InstructionSet)) {
+			continue;
+		}
+
+		float MaxDifference = 0.0f;
+		for (FastNoise::NoiseType NoiseType : NoiseTypes) {
+			for (int Fractal = FastNoise::FBM; Fractal <= FastNoise::RigidMulti; ++Fractal) {
+				for (int Interp = FastNoise::Linear; Interp <= FastNoise::Quintic; ++Interp) {
+					for (int Dimensions = 2; Dimensions <= 4; ++Dimensions) {
+						FastNoise Noise;
+						Noise.SetNoiseType(NoiseType);
+						Noise.SetFractalType((FastNoise::FractalType)Fractal);
+						Noise.SetInterp((FastNoise::Interp)Interp);
+						Noise.SetFrequency(0.0123f);
+						Noise.SetFractalOctaves(4);
+
+						// Interleaved XYZW points, so the strided loads are checked too.
+						const float *X = Points.data(), *Y = X + 1, *Z = X + 2, *W = X + 3;
+						for (int Pass = 0; Pass < 2; ++Pass) {
+							float *Output = Pass == 0 ? Expected.data() : Actual.data();
+							Noise.SetInstructionSet(Pass == 0 ? NoiseKernels::EInstructionSet::Scalar : InstructionSet);
+							if (Dimensions == 2) {
+								Noise.FillNoise(X, Y, 4, PointCount, Output);
+							} else if (Dimensions == 3) {
+								Noise.FillNoise(X, Y, Z, 4, PointCount, Output);
+							} else {
+								Noise.FillSimplex(X, Y, Z, W, 4, PointCount, Output);
+							}
+						}
+
+						float Difference = 0.0f;
+						for (int Index = 0; Index < PointCount; ++Index) {
+							Difference = std::max(Difference, std::fabs(Expected[Index] - Actual[Index]));
+						}
+						MaxDifference = std::max(MaxDifference, Difference);
+						if (!(Difference <= NoiseKernels::Tolerance)) {
+							printf("%s: noise type %d, fractal %d, interp %d, %dD differs by %g\n",
+								NoiseKernels::GetInstructionSetName(InstructionSet), (int)NoiseType, Fractal, Interp, Dimensions, Difference);
+							bPassed = false;
+						}
+					}
+				}
+			}
+		}
+		printf("%s: largest difference from scalar %g\n", NoiseKernels::GetInstructionSetName(InstructionSet), MaxDifference);
+	}
+	printf("Noise %s\n", bPassed ? "matches" : "DOES NOT MATCH");
+	return bPassed;
+}
+
+int main(int ArgumentCount, char **Arguments)
+{
+	FBenchmarkOptions Options;
+	if (!ParseOptions(ArgumentCount, Arguments, Options)) {
+		return 1;
+	}
+	if (Options.bVerifyNoise) {
+		return VerifyNoise() ? 0 : 1;
+	}
+
+	// Load the test meshes, falling back to a generated grid if none of them can be read.
+	std::vector<FBenchmarkMesh> BaseMeshes;
+	for (const char *FileName : TestMeshFiles) {
+		FBenchmarkMesh Mesh;
+		std::string Error;
+		if (LoadFbxMesh(Options.MeshDirectory + "/" + FileName, Mesh, Error)) {
+			BaseMeshes.push_back(std::move(Mesh));
+		} else {
+			fprintf(stderr, "Skipping %s: %s\n", FileName, Error.c_str());
+		}
+	}
+	if (BaseMeshes.empty()) {
+		fprintf(stderr, "No test meshes loaded%s, using a generated grid instead\n", CanLoadFbx() ? "" : " (built without zlib)");
+		BaseMeshes.push_back(MakeGridMesh("Grid128", 128, 1000.0f));
+	}
+
+	FWorkerPool Pool(Options.Threads);
+	printf("ProceduralToolkitCore benchmark: %d threads, batch size %d, %d repetitions\n",
+		Pool.GetThreadCount(), Options.BatchSize, Options.Repetitions);
+
+	std::vector<FBenchmarkResult> Results;
+	for (const auto &BaseMesh : BaseMeshes) {
+		RunMesh(FBenchmarkMesh(BaseMesh), Options, Pool, Results);
+		for (int Size : Options.Sizes) {
+			if (Size > Options.MaxVertices || Size <= BaseMesh.GetVertexCount()) {
+				continue;
+			}
+			RunMesh(ScaleMesh(BaseMesh, Size), Options, Pool, Results);
+		}
+	}
+
+	if (!Options.JsonPath.empty() && !WriteJson(Options.JsonPath, Options, Results)) {
+		fprintf(stderr, "Could not write %s\n", Options.JsonPath.c_str());
+		return 1;
+	}
+	if (!Options.CsvPath.empty() && !WriteCsv(Options.CsvPath, Results)) {
+		fprintf(stderr, "Could not write %s\n", Options.CsvPath.c_str());
+		return 1;
+	}
+	return 0;
+}
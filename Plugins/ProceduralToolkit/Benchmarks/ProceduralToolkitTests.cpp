@@ -0,0 +1,1038 @@
+// (c)2017 Paul Golds, released under MIT License.
+//
+// Correctness tests for the toolkit's engine-free core, run by ctest.
+//
+// Each test runs a kernel and a plain scalar reference written straight from what the kernel is
+// documented to do, and fails if any result differs from the reference by more than the test's
+// stated tolerance.  The references are written in doubles where that's possible, so they're
+// the answer the floats are approximating rather than another copy of the same float code.
+//
+// Run with the names of the tests to run, or with no arguments to run all of them.
+
+#include "ToolkitCore/CurveLookupTable.h"
+#include "ToolkitCore/MeshAdjacency.h"
+#include "ToolkitCore/SelectionKernels.h"
+#include "ToolkitCore/VertexGrid.h"
+#include "ToolkitCore/VertexKernels.h"
+#include "ToolkitCore/WeightExpression.h"
+#include "ToolkitCore/WeightKernels.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+/// The largest difference between a kernel's results and its reference, and whether any went
+/// over the tolerance.  Only the first few failures are printed.
+class FComparison
+{
+public:
+	FComparison(const std::string &InName, double InTolerance)
+		: Name(InName), Tolerance(InTolerance)
+	{
+	}
+
+	/// Compare a result with the reference.  For results which are only accurate relative to the
+	/// size of the values they're calculated from, the difference is divided by *Scale* first.
+	void Compare(double Expected, double Actual, int Index, double Scale = 1.0)
+	{
+		const double Difference = std::fabs(Expected - Actual) / Scale;
+		if (Difference > LargestDifference) {
+			LargestDifference = Difference;
+		}
+		// Written so a NaN fails.
+		if (!(Difference <= Tolerance)) {
+			Fail("at %d expected %.9g but got %.9g", Index, Expected, Actual);
+		}
+	}
+
+	/// Record a failure that isn't a difference in value, such as a wrong count.
+	void Fail(const char *Format, ...)
+	{
+		if (FailureCount++ < MaxPrintedFailures) {
+			va_list Arguments;
+			va_start(Arguments, Format);
+			printf("  %s: ", Name.c_str());
+			vprintf(Format, Arguments);
+			printf("\n");
+			va_end(Arguments);
+		}
+	}
+
+	/// Print the result and return whether it passed.
+	bool Report() const
+	{
+		printf("  %-48s largest difference %-10.3g tolerance %-10.3g %s\n",
+			Name.c_str(), LargestDifference, Tolerance, FailureCount == 0 ? "ok" : "FAILED");
+		if (FailureCount > MaxPrintedFailures) {
+			printf("  %s: %d more failures\n", Name.c_str(), FailureCount - MaxPrintedFailures);
+		}
+		return FailureCount == 0;
+	}
+
+private:
+	static const int MaxPrintedFailures = 5;
+
+	std::string Name;
+	double Tolerance;
+	double LargestDifference = 0.0;
+	int FailureCount = 0;
+};
+
+/// Return *Count* random floats from *Min* to *Max*.
+static std::vector<float> MakeRandomFloats(std::mt19937 &Random, int Count, float Min, float Max)
+{
+	std::uniform_real_distribution<float> Distribution(Min, Max);
+	std::vector<float> Values(Count);
+	for (float &Value : Values) {
+		Value = Distribution(Random);
+	}
+	return Values;
+}
+
+/// Return *Count* random codes covering every value of the type.
+template <typename CodeType>
+static std::vector<CodeType> MakeRandomCodes(std::mt19937 &Random, int Count)
+{
+	std::uniform_int_distribution<int> Distribution(0, std::numeric_limits<CodeType>::max());
+	std::vector<CodeType> Codes(Count);
+	for (CodeType &Code : Codes) {
+		Code = (CodeType)Distribution(Random);
+	}
+	return Codes;
+}
+
+// VertexKernels
+//
+// Each kernel is run for every count up to a few SIMD registers and a couple of larger ones, so
+// every length of scalar tail after the SIMD loop is covered, with the positions starting one
+// vertex into the array so they're never aligned.  Every precision of weights is checked, along
+// with no weights.
+
+/// The furthest the positions are from the origin, which the tolerance is relative to.
+static const float VertexPositionRange = 100.0f;
+
+/// The tolerance of the vertex kernels, relative to *VertexPositionRange*.
+static const double VertexKernelTolerance = 1e-6;
+
+/// Weights for every precision, all standing for values from -0.25 to 1.25 so the kernels are
+/// also checked extrapolating past their inputs.
+struct FVertexTestWeights
+{
+	std::vector<float> Floats;
+	std::vector<uint16_t> Codes16;
+	std::vector<uint8_t> Codes8;
+
+	static constexpr float Min = -0.25f;
+	static constexpr float Range = 1.5f;
+
+	/// Return the stream for a precision, or no weights for a precision of -1.
+	FWeightStream GetStream(int Precision) const
+	{
+		switch (Precision) {
+		case 0: return FWeightStream(Floats.data());
+		case 1: return FWeightStream(Codes16.data(), Min, Range / 65535.0f);
+		case 2: return FWeightStream(Codes8.data(), Min, Range / 255.0f);
+		default: return FWeightStream();
+		}
+	}
+
+	/// Return the weight a precision's stream stands for, worked out independently of it.
+	double GetWeight(int Precision, int Index) const
+	{
+		switch (Precision) {
+		case 0: return Floats[Index];
+		case 1: return Min + Codes16[Index] * (double)(Range / 65535.0f);
+		case 2: return Min + Codes8[Index] * (double)(Range / 255.0f);
+		default: return 1.0;
+		}
+	}
+};
+
+static const char *const VertexWeightNames[] = { "no weights", "float weights", "uint16 weights", "uint8 weights" };
+
+/// Run a vertex kernel against a reference which moves a single vertex, given the vertex's
+/// index, its position, and its weight, for every count and precision of weights.
+template <typename KernelType, typename ReferenceType>
+static bool CheckVertexKernel(const char *KernelName, KernelType Kernel, ReferenceType Reference)
+{
+	std::mt19937 Random(1337);
+	std::vector<int> Counts;
+	for (int Count = 0; Count <= 13; ++Count) {
+		Counts.push_back(Count);
+	}
+	Counts.push_back(1024);
+	Counts.push_back(1027);
+
+	bool bPassed = true;
+	for (int Precision = -1; Precision <= 2; ++Precision) {
+		FComparison Comparison(std::string(KernelName) + ", " + VertexWeightNames[Precision + 1], VertexKernelTolerance);
+		for (int Count : Counts) {
+			// One spare vertex at the start, which mustn't be touched.
+			const std::vector<float> Original = MakeRandomFloats(Random, (Count + 1) * 3, -VertexPositionRange, VertexPositionRange);
+			FVertexTestWeights Weights;
+			Weights.Floats = MakeRandomFloats(Random, Count, FVertexTestWeights::Min, FVertexTestWeights::Min + FVertexTestWeights::Range);
+			Weights.Codes16 = MakeRandomCodes<uint16_t>(Random, Count);
+			Weights.Codes8 = MakeRandomCodes<uint8_t>(Random, Count);
+
+			std::vector<float> Positions = Original;
+			Kernel(Positions.data() + 3, Count, Weights.GetStream(Precision));
+
+			for (int Axis = 0; Axis < 3; ++Axis) {
+				Comparison.Compare(Original[Axis], Positions[Axis], -1);
+			}
+			for (int Index = 0; Index < Count; ++Index) {
+				double Expected[3] = { Original[(Index + 1) * 3], Original[(Index + 1) * 3 + 1], Original[(Index + 1) * 3 + 2] };
+				Reference(Index, Expected, Weights.GetWeight(Precision, Index));
+				for (int Axis = 0; Axis < 3; ++Axis) {
+					Comparison.Compare(Expected[Axis], Positions[(Index + 1) * 3 + Axis], Index, VertexPositionRange);
+				}
+			}
+		}
+		bPassed &= Comparison.Report();
+	}
+	return bPassed;
+}
+
+static bool TestVertexKernels()
+{
+	std::mt19937 Random(42);
+	bool bPassed = true;
+
+	const float Delta[3] = { 12.5f, -3.25f, 7.0f };
+	bPassed &= CheckVertexKernel("Translate",
+		[&](float *Positions, int Count, FWeightStream Weights) { VertexKernels::Translate(Positions, Count, Delta, Weights); },
+		[&](int, double Vertex[3], double Weight) {
+			for (int Axis = 0; Axis < 3; ++Axis) {
+				Vertex[Axis] += Delta[Axis] * Weight;
+			}
+		}
+	);
+
+	const std::vector<float> Matrix = MakeRandomFloats(Random, 12, -2.0f, 2.0f);
+	bPassed &= CheckVertexKernel("Affine",
+		[&](float *Positions, int Count, FWeightStream Weights) { VertexKernels::Affine(Positions, Count, Matrix.data(), Weights); },
+		[&](int, double Vertex[3], double Weight) {
+			double Target[3];
+			for (int Row = 0; Row < 3; ++Row) {
+				Target[Row] = Matrix[Row * 4] * Vertex[0] + Matrix[Row * 4 + 1] * Vertex[1] + Matrix[Row * 4 + 2] * Vertex[2] + Matrix[Row * 4 + 3];
+			}
+			for (int Axis = 0; Axis < 3; ++Axis) {
+				Vertex[Axis] += (Target[Axis] - Vertex[Axis]) * Weight;
+			}
+		}
+	);
+
+	const std::vector<float> Directions = MakeRandomFloats(Random, 1027 * 3, -1.0f, 1.0f);
+	bPassed &= CheckVertexKernel("AddScaledDirection",
+		[&](float *Positions, int Count, FWeightStream Weights) {
+			VertexKernels::AddScaledDirection(Positions, Directions.data(), Count, 4.5f, Weights);
+		},
+		[&](int Index, double Vertex[3], double Weight) {
+			for (int Axis = 0; Axis < 3; ++Axis) {
+				Vertex[Axis] += Directions[Index * 3 + Axis] * 4.5 * Weight;
+			}
+		}
+	);
+
+	// One of the vertices is put on the center, which has to be left where it is.
+	const float Center[3] = { 5.0f, -10.0f, 2.5f };
+	bPassed &= CheckVertexKernel("Spherize",
+		[&](float *Positions, int Count, FWeightStream Weights) {
+			if (Count > 2) {
+				memcpy(Positions + 2 * 3, Center, sizeof(Center));
+			}
+			VertexKernels::Spherize(Positions, Count, Center, 60.0f, 0.75f, Weights);
+		},
+		[&](int Index, double Vertex[3], double Weight) {
+			if (Index == 2) {
+				for (int Axis = 0; Axis < 3; ++Axis) {
+					Vertex[Axis] = Center[Axis];
+				}
+				return;
+			}
+			const double Relative[3] = { Vertex[0] - Center[0], Vertex[1] - Center[1], Vertex[2] - Center[2] };
+			const double Length = std::sqrt(Relative[0] * Relative[0] + Relative[1] * Relative[1] + Relative[2] * Relative[2]);
+			const double TargetLength = Length + (60.0 - Length) * 0.75 * Weight;
+			for (int Axis = 0; Axis < 3; ++Axis) {
+				Vertex[Axis] = Center[Axis] + Relative[Axis] * TargetLength / Length;
+			}
+		}
+	);
+
+	const std::vector<float> Targets = MakeRandomFloats(Random, 1027 * 3, -VertexPositionRange, VertexPositionRange);
+	bPassed &= CheckVertexKernel("LerpTo",
+		[&](float *Positions, int Count, FWeightStream Weights) { VertexKernels::LerpTo(Positions, Targets.data(), Count, 0.6f, Weights); },
+		[&](int Index, double Vertex[3], double Weight) {
+			for (int Axis = 0; Axis < 3; ++Axis) {
+				Vertex[Axis] += (Targets[Index * 3 + Axis] - Vertex[Axis]) * 0.6 * Weight;
+			}
+		}
+	);
+
+	// Rodrigues' rotation formula about the closest point on the axis.
+	const float Axis[3] = { 0.48f, 0.6f, 0.64f };
+	bPassed &= CheckVertexKernel("RotateAroundAxis",
+		[&](float *Positions, int Count, FWeightStream Weights) {
+			VertexKernels::RotateAroundAxis(Positions, Count, Center, Axis, 70.0f, Weights);
+		},
+		[&](int, double Vertex[3], double Weight) {
+			const double Angle = 70.0 * Weight * 3.14159265358979323846 / 180.0;
+			const double Relative[3] = { Vertex[0] - Center[0], Vertex[1] - Center[1], Vertex[2] - Center[2] };
+			const double Along = Relative[0] * Axis[0] + Relative[1] * Axis[1] + Relative[2] * Axis[2];
+			const double Cross[3] = {
+				Axis[1] * Relative[2] - Axis[2] * Relative[1],
+				Axis[2] * Relative[0] - Axis[0] * Relative[2],
+				Axis[0] * Relative[1] - Axis[1] * Relative[0]
+			};
+			for (int Component = 0; Component < 3; ++Component) {
+				Vertex[Component] = Center[Component] + Relative[Component] * std::cos(Angle) + Cross[Component] * std::sin(Angle) +
+					Axis[Component] * Along * (1.0 - std::cos(Angle));
+			}
+		}
+	);
+
+	return bPassed;
+}
+
+// VertexKernels::ComposeAffine, which is how FDeformationCommandList merges unweighted
+// transformations.  Applying the composed matrix has to move vertices to the same place as
+// applying each matrix in turn.
+
+/// The tolerance of composing two transformations, relative to *VertexPositionRange*.
+static const double ComposeAffineTolerance = 4e-6;
+
+static bool TestComposeAffine()
+{
+	std::mt19937 Random(7);
+	const int Count = 1027;
+	FComparison Comparison("ComposeAffine against Affine applied twice", ComposeAffineTolerance);
+
+	for (int Pair = 0; Pair < 16; ++Pair) {
+		std::vector<float> First = MakeRandomFloats(Random, 12, -1.5f, 1.5f);
+		const std::vector<float> Second = MakeRandomFloats(Random, 12, -1.5f, 1.5f);
+		// Every other pair starts with a translation, which is how a Translate command is merged.
+		if (Pair % 2 == 0) {
+			for (int Row = 0; Row < 3; ++Row) {
+				for (int Column = 0; Column < 3; ++Column) {
+					First[Row * 4 + Column] = (Row == Column) ? 1.0f : 0.0f;
+				}
+			}
+		}
+
+		const std::vector<float> Original = MakeRandomFloats(Random, Count * 3, -VertexPositionRange, VertexPositionRange);
+		std::vector<float> InTurn = Original;
+		VertexKernels::Affine(InTurn.data(), Count, First.data(), nullptr);
+		VertexKernels::Affine(InTurn.data(), Count, Second.data(), nullptr);
+
+		float Composed[12];
+		VertexKernels::ComposeAffine(First.data(), Second.data(), Composed);
+		std::vector<float> AtOnce = Original;
+		VertexKernels::Affine(AtOnce.data(), Count, Composed, nullptr);
+
+		for (int Index = 0; Index < Count * 3; ++Index) {
+			Comparison.Compare(InTurn[Index], AtOnce[Index], Index / 3, VertexPositionRange);
+		}
+	}
+	return Comparison.Report();
+}
+
+// WeightKernels::Quantize and Dequantize, which should round to the nearest code so weights come
+// back within half a step, with weights outside the range clamped to its ends.
+
+/// Check quantizing and dequantizing weights to one type of code.
+template <typename CodeType>
+static bool CheckQuantize(const char *TypeName)
+{
+	std::mt19937 Random(99);
+	const float Min = -0.5f;
+	const float Max = 1.5f;
+	const int Count = 10007;
+	std::vector<float> Values = MakeRandomFloats(Random, Count, Min - 0.25f, Max + 0.25f);
+	Values[0] = Min;
+	Values[1] = Max;
+
+	// Half a step, with a little room for the rounding of the dequantized weight itself.
+	const double HalfStep = (Max - Min) / (double)std::numeric_limits<CodeType>::max() * 0.5;
+	FComparison Comparison(std::string("Quantize and Dequantize, ") + TypeName, HalfStep * 1.001 + 1e-7);
+
+	std::vector<CodeType> Codes(Count);
+	const float Step = WeightKernels::Quantize(Values.data(), Count, Min, Max, Codes.data());
+	std::vector<float> Dequantized(Count);
+	const FWeightStream Stream(Codes.data(), Min, Step);
+	WeightKernels::Dequantize(Stream, Count, Dequantized.data());
+
+	for (int Index = 0; Index < Count; ++Index) {
+		const double Expected = std::min(std::max((double)Values[Index], (double)Min), (double)Max);
+		Comparison.Compare(Expected, Dequantized[Index], Index);
+		if (Stream[Index] != Dequantized[Index]) {
+			Comparison.Fail("at %d the stream gives %.9g but Dequantize gives %.9g", Index, Stream[Index], Dequantized[Index]);
+		}
+	}
+
+	// An empty range quantizes everything to its one value.
+	const float EmptyStep = WeightKernels::Quantize(Values.data(), Count, 0.25f, 0.25f, Codes.data());
+	WeightKernels::Dequantize(FWeightStream(Codes.data(), 0.25f, EmptyStep), Count, Dequantized.data());
+	for (int Index = 0; Index < Count; ++Index) {
+		Comparison.Compare(0.25, Dequantized[Index], Index);
+	}
+	return Comparison.Report();
+}
+
+static bool TestQuantize()
+{
+	bool bPassed = CheckQuantize<uint16_t>("uint16");
+	bPassed &= CheckQuantize<uint8_t>("uint8");
+	return bPassed;
+}
+
+// WeightKernels::Ease, whose polynomial approximations should stay within 1e-6 of the FMath::Interp*
+// functions for weights from 0 to 1.  The references below are those functions from
+// UnrealMathUtility.h with A of 0 and B of 1, worked out in doubles.
+
+/// The tolerance of the eased weights, as documented for *WeightKernels::Ease*.
+static const double EaseTolerance = 1e-6;
+
+static double InterpEaseInReference(double Alpha, double Exp)
+{
+	return std::pow(Alpha, Exp);
+}
+
+static double InterpEaseOutReference(double Alpha, double Exp)
+{
+	return 1.0 - std::pow(1.0 - Alpha, Exp);
+}
+
+static double InterpSinInReference(double Alpha)
+{
+	return 1.0 - std::cos(Alpha * 3.14159265358979323846 * 0.5);
+}
+
+static double InterpSinOutReference(double Alpha)
+{
+	return std::sin(Alpha * 3.14159265358979323846 * 0.5);
+}
+
+static double InterpExpoInReference(double Alpha)
+{
+	return Alpha == 0.0 ? 0.0 : std::pow(2.0, 10.0 * (Alpha - 1.0));
+}
+
+static double InterpExpoOutReference(double Alpha)
+{
+	return Alpha == 1.0 ? 1.0 : 1.0 - std::pow(2.0, -10.0 * Alpha);
+}
+
+static double InterpCircularInReference(double Alpha)
+{
+	return 1.0 - std::sqrt(1.0 - Alpha * Alpha);
+}
+
+static double InterpCircularOutReference(double Alpha)
+{
+	return std::sqrt(1.0 - (Alpha - 1.0) * (Alpha - 1.0));
+}
+
+/// FMath's in-out functions are the in function over the first half and the out function over the second.
+template <typename InType, typename OutType>
+static double InterpInOutReference(double Alpha, InType In, OutType Out)
+{
+	return Alpha < 0.5 ? In(Alpha * 2.0) * 0.5 : Out(Alpha * 2.0 - 1.0) * 0.5 + 0.5;
+}
+
+/// The reference for an easing function, as *ULerpEaseFunctionLibrary* maps them onto FMath.
+static double EaseReference(WeightKernels::EEaseFunction Function, float Alpha, int Steps, double Exp)
+{
+	using WeightKernels::EEaseFunction;
+	switch (Function) {
+	case EEaseFunction::Step:
+		// FMath::InterpStep works in floats, and the steps change exactly where its floats do.
+		if (Steps <= 1 || Alpha <= 0.0f) {
+			return 0.0;
+		}
+		if (Alpha >= 1.0f) {
+			return 1.0;
+		}
+		return std::floor(Alpha * (float)Steps) / (double)(Steps - 1);
+	case EEaseFunction::SinusoidalIn: return InterpSinInReference(Alpha);
+	case EEaseFunction::SinusoidalOut: return InterpSinOutReference(Alpha);
+	case EEaseFunction::SinusoidalInOut: return InterpInOutReference(Alpha, InterpSinInReference, InterpSinOutReference);
+	case EEaseFunction::EaseIn: return InterpEaseInReference(Alpha, Exp);
+	case EEaseFunction::EaseOut: return InterpEaseOutReference(Alpha, Exp);
+	case EEaseFunction::EaseInOut:
+		return InterpInOutReference(Alpha,
+			[Exp](double Value) { return InterpEaseInReference(Value, Exp); },
+			[Exp](double Value) { return InterpEaseOutReference(Value, Exp); });
+	case EEaseFunction::ExpoIn: return InterpExpoInReference(Alpha);
+	case EEaseFunction::ExpoOut: return InterpExpoOutReference(Alpha);
+	case EEaseFunction::ExpoInOut: return InterpInOutReference(Alpha, InterpExpoInReference, InterpExpoOutReference);
+	case EEaseFunction::CircularIn: return InterpCircularInReference(Alpha);
+	case EEaseFunction::CircularOut: return InterpCircularOutReference(Alpha);
+	case EEaseFunction::CircularInOut: return InterpInOutReference(Alpha, InterpCircularInReference, InterpCircularOutReference);
+	default: return Alpha;
+	}
+}
+
+static bool TestEase()
+{
+	using WeightKernels::EEaseFunction;
+	static const char *const FunctionNames[] = {
+		"Linear", "Step", "SinusoidalIn", "SinusoidalOut", "SinusoidalInOut", "EaseIn", "EaseOut", "EaseInOut",
+		"ExpoIn", "ExpoOut", "ExpoInOut", "CircularIn", "CircularOut", "CircularInOut"
+	};
+
+	// Evenly spaced weights, which include 0, 0.5 and 1 exactly, followed by an odd number of
+	// random ones so the SIMD tail is covered too.
+	std::mt19937 Random(2017);
+	std::vector<float> Values;
+	for (int Index = 0; Index <= 4096; ++Index) {
+		Values.push_back(Index / 4096.0f);
+	}
+	const std::vector<float> RandomValues = MakeRandomFloats(Random, 1001, 0.0f, 1.0f);
+	Values.insert(Values.end(), RandomValues.begin(), RandomValues.end());
+	const int Count = (int)Values.size();
+
+	// Whole exponents have versions of their own, the others use powf.
+	const float Exponents[] = { 1.0f, 2.0f, 3.0f, 4.0f, 2.5f, 0.7f };
+	const int StepCounts[] = { 0, 1, 2, 5, 10 };
+
+	bool bPassed = true;
+	std::vector<float> Eased(Count);
+	for (int FunctionIndex = 0; FunctionIndex <= (int)EEaseFunction::CircularInOut; ++FunctionIndex) {
+		const EEaseFunction Function = (EEaseFunction)FunctionIndex;
+		const bool bUsesExponent = (Function == EEaseFunction::EaseIn || Function == EEaseFunction::EaseOut || Function == EEaseFunction::EaseInOut);
+		const bool bUsesSteps = (Function == EEaseFunction::Step);
+
+		FComparison Comparison(std::string("Ease ") + FunctionNames[FunctionIndex], EaseTolerance);
+		for (float Exponent : Exponents) {
+			for (int Steps : StepCounts) {
+				WeightKernels::Ease(Values.data(), Count, Function, Steps, Exponent, Eased.data());
+				for (int Index = 0; Index < Count; ++Index) {
+					Comparison.Compare(EaseReference(Function, Values[Index], Steps, Exponent), Eased[Index], Index);
+				}
+				if (!bUsesSteps) {
+					break;
+				}
+			}
+			if (!bUsesExponent) {
+				break;
+			}
+		}
+		bPassed &= Comparison.Report();
+	}
+	return bPassed;
+}
+
+// FCurveLookupTable against the curve it was baked from.  FRichCurve::Eval needs the engine, so
+// the curve here is a cubic Hermite spline through three keys, which is what a curve with cubic
+// keys evaluates.  The table should be within *GetMaxError* of the curve everywhere, with a
+// little room as it's only measured at a few points between each pair of samples.
+
+/// How far beyond *GetMaxError* the table may be from the curve, as a fraction of it.  Between
+/// two samples of a cubic the error can peak about 6% beyond the points it's measured at.
+static const double CurveLookupTableErrorMargin = 0.1;
+
+/// A cubic Hermite spline through keys at 0, 0.3 and 1.
+static double EvaluateTestCurve(double Alpha)
+{
+	const double Times[3] = { 0.0, 0.3, 1.0 };
+	const double Values[3] = { 0.0, 0.8, 0.2 };
+	const double Tangents[3] = { 0.0, 1.0, -2.0 };
+
+	Alpha = std::min(std::max(Alpha, 0.0), 1.0);
+	const int Key = Alpha < Times[1] ? 0 : 1;
+	const double Length = Times[Key + 1] - Times[Key];
+	const double T = (Alpha - Times[Key]) / Length;
+	const double T2 = T * T;
+	const double T3 = T2 * T;
+	return (2.0 * T3 - 3.0 * T2 + 1.0) * Values[Key] + (T3 - 2.0 * T2 + T) * Length * Tangents[Key] +
+		(-2.0 * T3 + 3.0 * T2) * Values[Key + 1] + (T3 - T2) * Length * Tangents[Key + 1];
+}
+
+static bool TestCurveLookupTable()
+{
+	std::mt19937 Random(5);
+	std::vector<float> Values = MakeRandomFloats(Random, 10007, 0.0f, 1.0f);
+	// Either end, and outside the table which should give the value at the nearest end.
+	const float EdgeValues[] = { 0.0f, 1.0f, -0.5f, 1.5f, -1e30f, 1e30f };
+	Values.insert(Values.begin(), std::begin(EdgeValues), std::end(EdgeValues));
+	const int Count = (int)Values.size();
+
+	bool bPassed = true;
+	const int Resolutions[] = { 2, 17, 256, 1024 };
+	std::vector<float> Sampled(Count);
+	for (int Resolution : Resolutions) {
+		FCurveLookupTable Table;
+		Table.Bake([](float Alpha) { return (float)EvaluateTestCurve(Alpha); }, Resolution);
+		const double Tolerance = Table.GetMaxError() * (1.0 + CurveLookupTableErrorMargin) + 1e-6;
+
+		FComparison Comparison("CurveLookupTable, resolution " + std::to_string(Resolution), Tolerance);
+		if (Table.GetResolution() != Resolution) {
+			Comparison.Fail("has a resolution of %d", Table.GetResolution());
+		}
+		Table.Sample(Values.data(), Count, Sampled.data());
+		for (int Index = 0; Index < Count; ++Index) {
+			Comparison.Compare(EvaluateTestCurve(Values[Index]), Sampled[Index], Index);
+		}
+
+		// Sampling in place gives the same results.
+		std::vector<float> InPlace = Values;
+		Table.Sample(InPlace.data(), Count, InPlace.data());
+		if (InPlace != Sampled) {
+			Comparison.Fail("sampling in place gives different results");
+		}
+		bPassed &= Comparison.Report();
+	}
+	return bPassed;
+}
+
+// WeightKernels::Statistics against a plain loop in doubles.  The minimum, maximum and counts
+// must match exactly, and the sum within a relative tolerance as it's added up in floats a
+// block at a time.
+
+/// The tolerance of the sum, relative to the sum of the weights' sizes.
+static const double StatisticsSumTolerance = 1e-6;
+
+static bool TestStatistics()
+{
+	std::mt19937 Random(11);
+	std::vector<int> Counts;
+	for (int Count = 0; Count <= 13; ++Count) {
+		Counts.push_back(Count);
+	}
+	const int LargeCounts[] = { 1023, 1024, 1025, 4099, 100003 };
+	Counts.insert(Counts.end(), std::begin(LargeCounts), std::end(LargeCounts));
+
+	FComparison Comparison("Statistics", StatisticsSumTolerance);
+	for (int Count : Counts) {
+		// Mostly weights from 0 to 1 with a share of zeros, and a few negative ones.
+		std::vector<float> Values = MakeRandomFloats(Random, Count, -0.1f, 1.0f);
+		for (int Index = 0; Index < Count; Index += 3) {
+			Values[Index] = 0.0f;
+		}
+
+		double Min = Count > 0 ? Values[0] : 0.0;
+		double Max = Count > 0 ? Values[0] : 0.0;
+		double Sum = 0.0;
+		double SizeSum = 0.0;
+		int NonZeroCount = 0;
+		for (float Value : Values) {
+			Min = std::min(Min, (double)Value);
+			Max = std::max(Max, (double)Value);
+			Sum += Value;
+			SizeSum += std::fabs(Value);
+			NonZeroCount += (Value != 0.0f) ? 1 : 0;
+		}
+
+		WeightKernels::FWeightStatistics Found;
+		WeightKernels::Statistics(Values.data(), Count, Found);
+		if (Found.Min != Min || Found.Max != Max || Found.Count != Count || Found.NonZeroCount != NonZeroCount) {
+			Comparison.Fail("of %d weights found min %g, max %g, count %d, non-zero %d but expected %g, %g, %d, %d",
+				Count, Found.Min, Found.Max, Found.Count, Found.NonZeroCount, Min, Max, Count, NonZeroCount);
+		}
+		Comparison.Compare(Sum, Found.Sum, Count, std::max(SizeSum, 1.0));
+
+		// Combining the statistics of two halves gives the statistics of the whole.
+		WeightKernels::FWeightStatistics Halves[2];
+		WeightKernels::Statistics(Values.data(), Count / 3, Halves[0]);
+		WeightKernels::Statistics(Values.data() + Count / 3, Count - Count / 3, Halves[1]);
+		Halves[0].Combine(Halves[1]);
+		if (Halves[0].Min != Found.Min || Halves[0].Max != Found.Max || Halves[0].Count != Count || Halves[0].NonZeroCount != NonZeroCount) {
+			Comparison.Fail("of %d weights combined differently from the whole", Count);
+		}
+		Comparison.Compare(Sum, Halves[0].Sum, Count, std::max(SizeSum, 1.0));
+
+		float MinMaxMin = 0.0f, MinMaxMax = 0.0f;
+		WeightKernels::MinMax(Values.data(), Count, MinMaxMin, MinMaxMax);
+		if (MinMaxMin != Found.Min || MinMaxMax != Found.Max) {
+			Comparison.Fail("of %d weights MinMax found %g to %g", Count, MinMaxMin, MinMaxMax);
+		}
+	}
+	return Comparison.Report();
+}
+
+// The grid versions of the SelectionKernels, dense and sparse, against the plain dense kernels
+// run over every vertex.  They calculate each weight the same way, so they should match exactly.
+
+/// Check the dense and sparse grid results of one query against the plain kernel's weights.
+static void CompareGridSelection(
+	FComparison &Comparison, const std::vector<float> &Expected, bool bUsedDenseGrid, const std::vector<float> &DenseGrid,
+	bool bUsedSparseGrid, const std::vector<int> &SparseIndices, const std::vector<float> &SparseWeights
+) {
+	if (bUsedDenseGrid != bUsedSparseGrid) {
+		Comparison.Fail("the dense and sparse grid versions disagree about using the grid");
+	}
+	if (bUsedDenseGrid) {
+		for (size_t Index = 0; Index < Expected.size(); ++Index) {
+			Comparison.Compare(Expected[Index], DenseGrid[Index], (int)Index);
+		}
+	}
+	if (bUsedSparseGrid) {
+		if (SparseIndices.size() != SparseWeights.size()) {
+			Comparison.Fail("has %d sparse indices but %d weights", (int)SparseIndices.size(), (int)SparseWeights.size());
+			return;
+		}
+		std::vector<float> Expanded(Expected.size(), 0.0f);
+		for (size_t Entry = 0; Entry < SparseIndices.size(); ++Entry) {
+			if (Entry > 0 && SparseIndices[Entry] <= SparseIndices[Entry - 1]) {
+				Comparison.Fail("sparse index %d isn't in increasing order", SparseIndices[Entry]);
+			}
+			if (SparseWeights[Entry] == 0.0f) {
+				Comparison.Fail("sparse index %d has a weight of zero", SparseIndices[Entry]);
+			}
+			Expanded[SparseIndices[Entry]] = SparseWeights[Entry];
+		}
+		for (size_t Index = 0; Index < Expected.size(); ++Index) {
+			Comparison.Compare(Expected[Index], Expanded[Index], (int)Index);
+		}
+	}
+}
+
+static bool TestSparseSelection()
+{
+	// Two sections, one spread out and one a tight cluster inside it, so the grid has both
+	// empty and crowded cells.
+	std::mt19937 Random(3);
+	const int FirstCount = 20000;
+	const int SecondCount = 5003;
+	const std::vector<float> First = MakeRandomFloats(Random, FirstCount * 3, -500.0f, 500.0f);
+	const std::vector<float> Second = MakeRandomFloats(Random, SecondCount * 3, 100.0f, 150.0f);
+	std::vector<float> Positions = First;
+	Positions.insert(Positions.end(), Second.begin(), Second.end());
+	const int Count = FirstCount + SecondCount;
+
+	FVertexGrid Grid;
+	const FVertexGrid::FSource Sources[2] = { { First.data(), FirstCount, 0 }, { Second.data(), SecondCount, FirstCount } };
+	Grid.Build(Sources, 2);
+
+	FComparison NearComparison("SelectNear, grid against every vertex", 0.0);
+	FComparison LineComparison("SelectNearLine, grid against every vertex", 0.0);
+	std::uniform_real_distribution<float> Coordinate(-550.0f, 550.0f);
+	std::uniform_real_distribution<float> Radius(0.0f, 120.0f);
+	int GridQueryCount = 0;
+	std::vector<float> Expected(Count), DenseGrid(Count);
+	std::vector<int> SparseIndices;
+	std::vector<float> SparseWeights;
+	for (int Query = 0; Query < 200; ++Query) {
+		float Start[3], End[3];
+		for (int Axis = 0; Axis < 3; ++Axis) {
+			Start[Axis] = Coordinate(Random);
+			End[Axis] = Start[Axis] + Coordinate(Random) * 0.2f;
+		}
+		// Every fourth query is around the cluster, and a few have no falloff at all.
+		if (Query % 4 == 0) {
+			for (int Axis = 0; Axis < 3; ++Axis) {
+				Start[Axis] = 125.0f + Coordinate(Random) * 0.05f;
+			}
+		}
+		const float Inner = Radius(Random);
+		const float Outer = (Query % 10 == 0) ? Inner : Inner + Radius(Random);
+
+		SelectionKernels::SelectNear(Positions.data(), Count, Start, Inner, Outer, Expected.data());
+		bool bUsedDenseGrid = SelectionKernels::SelectNear(Grid, Start, Inner, Outer, DenseGrid.data());
+		bool bUsedSparseGrid = SelectionKernels::SelectNear(Grid, Start, Inner, Outer, SparseIndices, SparseWeights);
+		CompareGridSelection(NearComparison, Expected, bUsedDenseGrid, DenseGrid, bUsedSparseGrid, SparseIndices, SparseWeights);
+		GridQueryCount += bUsedDenseGrid ? 1 : 0;
+
+		SelectionKernels::SelectNearLine(Positions.data(), Count, Start, End, false, Inner, Outer, Expected.data());
+		bUsedDenseGrid = SelectionKernels::SelectNearLine(Grid, Start, End, Inner, Outer, DenseGrid.data());
+		bUsedSparseGrid = SelectionKernels::SelectNearLine(Grid, Start, End, Inner, Outer, SparseIndices, SparseWeights);
+		CompareGridSelection(LineComparison, Expected, bUsedDenseGrid, DenseGrid, bUsedSparseGrid, SparseIndices, SparseWeights);
+		GridQueryCount += bUsedDenseGrid ? 1 : 0;
+	}
+
+	// Make sure the grid was actually tried, rather than every query falling back.
+	if (GridQueryCount < 100) {
+		NearComparison.Fail("only %d of 400 queries used the grid", GridQueryCount);
+	}
+	bool bPassed = NearComparison.Report();
+	bPassed &= LineComparison.Report();
+	return bPassed;
+}
+
+// FWeightProgram with its sources given dense, sparse, and quantized, against the same
+// expression worked out a weight at a time.  Sparse and dense sets with the same weights have to
+// give the same results, over more than one chunk and starting part way into the weights.
+
+/// The tolerance of an evaluated expression, which is mostly the quantized source's half step.
+static const double WeightProgramTolerance = 1e-6;
+
+/// One source of weights in every form *FWeightProgram* reads them in.
+struct FWeightProgramTestSource
+{
+	std::vector<float> Dense;
+	std::vector<int> SparseIndices;
+	std::vector<float> SparseWeights;
+	std::vector<uint16_t> Codes;
+	float Min = 0.0f;
+	float Step = 0.0f;
+
+	/// Make weights with only one in *Spacing* not zero, which are also exactly representable
+	/// as 16 bit codes so every form has the same weights.
+	FWeightProgramTestSource(std::mt19937 &Random, int Count, int Spacing)
+	{
+		std::uniform_int_distribution<int> Code(1, 65535);
+		std::uniform_int_distribution<int> Skip(0, Spacing - 1);
+		Step = 1.0f / 65535.0f;
+		Dense.assign(Count, 0.0f);
+		Codes.assign(Count, 0);
+		for (int Index = Skip(Random); Index < Count; Index += 1 + Skip(Random) * 2) {
+			Codes[Index] = (uint16_t)Code(Random);
+			Dense[Index] = Min + Codes[Index] * Step;
+			SparseIndices.push_back(Index);
+			SparseWeights.push_back(Dense[Index]);
+		}
+	}
+
+	/// Return the source in one of its forms: dense floats, sparse, or quantized.
+	FWeightProgram::FSource GetSource(int Form) const
+	{
+		FWeightProgram::FSource Source = { FWeightStream(), nullptr, nullptr, 0 };
+		if (Form == 0) {
+			Source.Dense = FWeightStream(Dense.data());
+		} else if (Form == 1) {
+			Source.SparseIndices = SparseIndices.data();
+			Source.SparseWeights = SparseWeights.data();
+			Source.SparseCount = (int)SparseIndices.size();
+		} else {
+			Source.Dense = FWeightStream(Codes.data(), Min, Step);
+		}
+		return Source;
+	}
+};
+
+static bool TestWeightProgram()
+{
+	std::mt19937 Random(23);
+	const int Count = FWeightProgram::ChunkSize * 2 + 517;
+	const FWeightProgramTestSource A(Random, Count, 1);
+	const FWeightProgramTestSource B(Random, Count, 10);
+	const FWeightProgramTestSource C(Random, Count, 50);
+
+	// Lerp(Max(A * B, 1 - C), B + 0.25, 0.3), with B used twice.
+	typedef FWeightOperation::EType EType;
+	const FWeightExpression::FPtr SourceA = FWeightExpression::MakeSource(&A, Count);
+	const FWeightExpression::FPtr SourceB = FWeightExpression::MakeSource(&B, Count);
+	const FWeightExpression::FPtr SourceC = FWeightExpression::MakeSource(&C, Count);
+	const FWeightExpression::FPtr Product = FWeightExpression::Make(FWeightOperation::MakeBinary(EType::Multiply), Count, SourceA, SourceB);
+	const FWeightExpression::FPtr Inverse = FWeightExpression::Make(FWeightOperation::MakeOneMinus(), Count, SourceC);
+	const FWeightExpression::FPtr Larger = FWeightExpression::Make(FWeightOperation::MakeBinary(EType::Max), Count, Product, Inverse);
+	const FWeightExpression::FPtr Offset = FWeightExpression::Make(FWeightOperation::MakeAddScalar(0.25f), Count, SourceB);
+	const FWeightExpression::FPtr Root = FWeightExpression::Make(FWeightOperation::MakeBinary(EType::Lerp, 0.3f), Count, Larger, Offset);
+	const FWeightProgram Program(Root);
+
+	std::vector<double> Expected(Count);
+	for (int Index = 0; Index < Count; ++Index) {
+		const double Left = std::max((double)A.Dense[Index] * B.Dense[Index], 1.0 - C.Dense[Index]);
+		const double Right = B.Dense[Index] + 0.25;
+		Expected[Index] = Left + (Right - Left) * 0.3;
+	}
+
+	FComparison Comparison("FWeightProgram, every form of source", WeightProgramTolerance);
+	if (Program.GetSources().size() != 3) {
+		Comparison.Fail("found %d sources", (int)Program.GetSources().size());
+		return Comparison.Report();
+	}
+
+	// Every combination of forms, which are the digits of *Forms* in base 3, for the whole array
+	// and for a range starting part way into a chunk.
+	std::vector<float> Out(Count);
+	for (int Forms = 0; Forms < 27; ++Forms) {
+		std::vector<FWeightProgram::FSource> Sources;
+		for (const void *Source : Program.GetSources()) {
+			const FWeightProgramTestSource *TestSource = static_cast<const FWeightProgramTestSource *>(Source);
+			const int Digit = TestSource == &A ? 1 : TestSource == &B ? 3 : 9;
+			Sources.push_back(TestSource->GetSource(Forms / Digit % 3));
+		}
+		const int Ranges[2][2] = { { 0, Count }, { 300, Count - 400 } };
+		for (const auto &Range : Ranges) {
+			std::fill(Out.begin(), Out.end(), -1.0f);
+			Program.Evaluate(Sources.data(), Range[0], Range[1], Out.data());
+			for (int Index = 0; Index < Range[1]; ++Index) {
+				Comparison.Compare(Expected[Range[0] + Index], Out[Index], Range[0] + Index);
+			}
+		}
+	}
+	return Comparison.Report();
+}
+
+// FMeshAdjacency against adjacency worked out with sets, with and without welding and with the
+// build's tasks run in reverse order as well as in turn.
+
+/// Make a section that's a grid of quads, each with four vertices of its own as if every quad
+/// had its own UVs, so welding joins them all up.
+static void MakeUnweldedGrid(int QuadsPerSide, float XSign, std::vector<float> &OutPositions, std::vector<int> &OutTriangles)
+{
+	for (int Y = 0; Y < QuadsPerSide; ++Y) {
+		for (int X = 0; X < QuadsPerSide; ++X) {
+			const int First = (int)OutPositions.size() / 3;
+			for (int Corner = 0; Corner < 4; ++Corner) {
+				// With XSign negative the column at zero is -0, which has to weld with 0.
+				OutPositions.push_back(XSign * (float)(X + (Corner & 1)));
+				OutPositions.push_back((float)(Y + (Corner >> 1)));
+				OutPositions.push_back(0.0f);
+			}
+			const int Triangles[6] = { First, First + 1, First + 3, First, First + 3, First + 2 };
+			OutTriangles.insert(OutTriangles.end(), std::begin(Triangles), std::end(Triangles));
+		}
+	}
+}
+
+static bool TestMeshAdjacency()
+{
+	// Two sections sharing an edge along X = 0, with enough vertices and triangles for the
+	// build to be split into several tasks.
+	const int QuadsPerSide = 70;
+	std::vector<float> Positions[2];
+	std::vector<int> Triangles[2];
+	MakeUnweldedGrid(QuadsPerSide, 1.0f, Positions[0], Triangles[0]);
+	MakeUnweldedGrid(QuadsPerSide, -1.0f, Positions[1], Triangles[1]);
+
+	// Triangles with an index outside the section, and with corners on the same vertex.
+	const int SecondVertexCount = (int)Positions[1].size() / 3;
+	const int ExtraTriangles[] = { 0, 1, SecondVertexCount, -1, 2, 3, 5, 5, 6, 7, 7, 7, 8, 9, 8 };
+	Triangles[1].insert(Triangles[1].end(), std::begin(ExtraTriangles), std::end(ExtraTriangles));
+
+	const FMeshAdjacency::FSource Sources[2] = {
+		{ Triangles[0].data(), (int)Triangles[0].size() / 3, Positions[0].data(), (int)Positions[0].size() / 3 },
+		{ Triangles[1].data(), (int)Triangles[1].size() / 3, Positions[1].data(), SecondVertexCount }
+	};
+	const int VertexCount = Sources[0].VertexCount + Sources[1].VertexCount;
+	const int TriangleCount = Sources[0].TriangleCount + Sources[1].TriangleCount;
+
+	const FMeshAdjacency::FParallelFor InReverse = [](int TaskCount, const std::function<void(int Task)> &Task) {
+		for (int TaskIndex = TaskCount - 1; TaskIndex >= 0; --TaskIndex) {
+			Task(TaskIndex);
+		}
+	};
+
+	bool bPassed = true;
+	for (int bWeld = 0; bWeld <= 1; ++bWeld) {
+		// The reference: the first vertex at each position stands in for the rest.
+		std::vector<int> Representatives(VertexCount);
+		std::map<std::array<float, 3>, int> FirstAtPosition;
+		for (int SourceIndex = 0, Vertex = 0; SourceIndex < 2; ++SourceIndex) {
+			for (int Local = 0; Local < Sources[SourceIndex].VertexCount; ++Local, ++Vertex) {
+				const float *Position = Sources[SourceIndex].Positions + Local * 3;
+				const std::array<float, 3> Key = { { Position[0], Position[1], Position[2] } };
+				Representatives[Vertex] = bWeld ? FirstAtPosition.insert(std::make_pair(Key, Vertex)).first->second : Vertex;
+			}
+		}
+		std::vector<std::set<int>> Neighbours(VertexCount), VertexTriangles(VertexCount);
+		std::vector<std::vector<int>> Copies(VertexCount);
+		for (int Vertex = 0; Vertex < VertexCount; ++Vertex) {
+			Copies[Representatives[Vertex]].push_back(Vertex);
+		}
+		for (int SourceIndex = 0, Triangle = 0, FirstVertex = 0; SourceIndex < 2; FirstVertex += Sources[SourceIndex++].VertexCount) {
+			for (int Local = 0; Local < Sources[SourceIndex].TriangleCount; ++Local, ++Triangle) {
+				const int *Indices = Sources[SourceIndex].Triangles + Local * 3;
+				if (std::any_of(Indices, Indices + 3, [&](int Index) { return Index < 0 || Index >= Sources[SourceIndex].VertexCount; })) {
+					continue;
+				}
+				std::set<int> Corners;
+				for (int Corner = 0; Corner < 3; ++Corner) {
+					Corners.insert(Representatives[FirstVertex + Indices[Corner]]);
+				}
+				for (int Corner : Corners) {
+					VertexTriangles[Corner].insert(Triangle);
+					for (int Other : Corners) {
+						if (Other != Corner) {
+							Neighbours[Corner].insert(Other);
+						}
+					}
+				}
+			}
+		}
+
+		for (int Order = 0; Order < 2; ++Order) {
+			FMeshAdjacency Adjacency;
+			Adjacency.Build(Sources, 2, bWeld != 0, Order == 0 ? FMeshAdjacency::FParallelFor() : InReverse);
+
+			FComparison Comparison(std::string("MeshAdjacency, ") + (bWeld ? "welded" : "not welded") +
+				(Order == 0 ? ", tasks in turn" : ", tasks in reverse"), 0.0);
+			if (Adjacency.GetVertexCount() != VertexCount || Adjacency.GetTriangleCount() != TriangleCount || Adjacency.IsWelded() != (bWeld != 0)) {
+				Comparison.Fail("has %d vertices and %d triangles", Adjacency.GetVertexCount(), Adjacency.GetTriangleCount());
+				bPassed &= Comparison.Report();
+				continue;
+			}
+			for (int Vertex = 0; Vertex < VertexCount; ++Vertex) {
+				const int Representative = Representatives[Vertex];
+				if (Adjacency.GetRepresentative(Vertex) != Representative) {
+					Comparison.Fail("vertex %d is represented by %d rather than %d", Vertex, Adjacency.GetRepresentative(Vertex), Representative);
+				}
+				const int *Row;
+				int RowCount = Adjacency.GetVertexNeighbours(Vertex, Row);
+				if (std::vector<int>(Row, Row + RowCount) != std::vector<int>(Neighbours[Representative].begin(), Neighbours[Representative].end())) {
+					Comparison.Fail("vertex %d has the wrong neighbours", Vertex);
+				}
+				RowCount = Adjacency.GetVertexTriangles(Vertex, Row);
+				if (std::vector<int>(Row, Row + RowCount) != std::vector<int>(VertexTriangles[Representative].begin(), VertexTriangles[Representative].end())) {
+					Comparison.Fail("vertex %d has the wrong triangles", Vertex);
+				}
+				RowCount = Adjacency.GetWeldedCopies(Vertex, Row);
+				if (std::vector<int>(Row, Row + RowCount) != Copies[Representative]) {
+					Comparison.Fail("vertex %d has the wrong welded copies", Vertex);
+				}
+			}
+			bPassed &= Comparison.Report();
+		}
+	}
+	return bPassed;
+}
+
+struct FTest
+{
+	const char *Name;
+	bool (*Run)();
+};
+
+static const FTest Tests[] = {
+	{ "VertexKernels", TestVertexKernels },
+	{ "ComposeAffine", TestComposeAffine },
+	{ "Quantize", TestQuantize },
+	{ "Ease", TestEase },
+	{ "CurveLookupTable", TestCurveLookupTable },
+	{ "Statistics", TestStatistics },
+	{ "SparseSelection", TestSparseSelection },
+	{ "WeightProgram", TestWeightProgram },
+	{ "MeshAdjacency", TestMeshAdjacency }
+};
+
+int main(int ArgumentCount, char **Arguments)
+{
+	std::vector<const FTest *> ToRun;
+	for (int Index = 1; Index < ArgumentCount; ++Index) {
+		const FTest *Found = nullptr;
+		for (const FTest &Test : Tests) {
+			if (strcmp(Test.Name, Arguments[Index]) == 0) {
+				Found = &Test;
+			}
+		}
+		if (!Found) {
+			fprintf(stderr, "Unknown test: %s\n", Arguments[Index]);
+			return 1;
+		}
+		ToRun.push_back(Found);
+	}
+	if (ToRun.empty()) {
+		for (const FTest &Test : Tests) {
+			ToRun.push_back(&Test);
+		}
+	}
+
+	int FailedCount = 0;
+	for (const FTest *Test : ToRun) {
+		printf("%s\n", Test->Name);
+		const bool bPassed = Test->Run();
+		printf("%s %s\n", Test->Name, bPassed ? "passed" : "FAILED");
+		FailedCount += bPassed ? 0 : 1;
+	}
+	return FailedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ProceduralToolkit.h"
+#include "ToolkitCore/VertexKernels.h"
+#include "VertexChunks.h"
+#include "DeformationCommandList.h"
+
+/// The number of vertices processed by all of the commands before moving on.
+///
+/// 1024 vertices is 12KB of positions and 12KB of normals which, with the weights, keeps
+/// the working set for a chunk inside a typical 32KB L1 cache.
+static const int32 DeformationChunkSize = 1024;
+
+/// The number of vertices of a sparse selection gathered together before being deformed.
+static const int32 SparseGatherSize = 256;
+
+/// Make the 3x4 matrix for an unweighted command so it can be merged with another.
+static void GetCommandMatrix(const FDeformationCommand &Command, float OutMatrix[12])
+{
+	if (Command.Type == EDeformationCommandType::Affine) {
+		FMemory::Memcpy(OutMatrix, Command.Matrix, sizeof(Command.Matrix));
+		return;
+	}
+
+	// Translate, which is an identity matrix with a translation.
+	for (int32 Row = 0; Row < 3; ++Row) {
+		for (int32 Column = 0; Column < 3; ++Column) {
+			OutMatrix[Row * 4 + Column] = (Row == Column) ? 1.0f : 0.0f;
+		}
+		OutMatrix[Row * 4 + 3] = Command.Vector0[Row];
+	}
+}
+
+void FDeformationCommand::Execute(FSectionGeometry &Section, int32 FirstVertex, int32 VertexCount, int32 FirstWeightIndex) const
+{
+	if (Selection && Selection->IsSparse()) {
+		ExecuteSparse(Section, FirstVertex, VertexCount, FirstWeightIndex);
+		return;
+	}
+
+	ExecuteKernel(
+		GetVectorArrayData(Section.vertices) + FirstVertex * 3,
+		Type == EDeformationCommandType::Inflate ? GetVectorArrayData(Section.normals) + FirstVertex * 3 : nullptr,
+		VertexCount, Selection ? Selection->GetWeightStream() + FirstWeightIndex : FWeightStream()
+	);
+}
+
+void FDeformationCommand::ExecuteSparse(FSectionGeometry &Section, int32 FirstVertex, int32 VertexCount, int32 FirstWeightIndex) const
+{
+	int32 Begin, End;
+	Selection->GetSparseRange(FirstWeightIndex, VertexCount, Begin, End);
+	const int32 *Indices = Selection->GetSparseIndices().GetData();
+	const float *Weights = Selection->GetSparseWeights().GetData();
+	const int32 WeightToVertex = FirstVertex - FirstWeightIndex;
+	const bool bNeedsNormals = (Type == EDeformationCommandType::Inflate);
+
+	// Gather the selected vertices together so the kernels can run over them, and then put them back.
+	FVector GatheredPositions[SparseGatherSize];
+	FVector GatheredNormals[SparseGatherSize];
+	for (int32 PieceStart = Begin; PieceStart < End; PieceStart += SparseGatherSize) {
+		const int32 PieceCount = FMath::Min(SparseGatherSize, End - PieceStart);
+		for (int32 Index = 0; Index < PieceCount; ++Index) {
+			const int32 VertexIndex = Indices[PieceStart + Index] + WeightToVertex;
+			GatheredPositions[Index] = Section.vertices[VertexIndex];
+			if (bNeedsNormals) {
+				GatheredNormals[Index] = Section.normals[VertexIndex];
+			}
+		}
+		ExecuteKernel(
+			reinterpret_cast<float *>(GatheredPositions), reinterpret_cast<const float *>(GatheredNormals),
+			PieceCount, Weights + PieceStart
+		);
+		for (int32 Index = 0; Index < PieceCount; ++Index) {
+			Section.vertices[Indices[PieceStart + Index] + WeightToVertex] = GatheredPositions[Index];
+		}
+	}
+}
+
+void FDeformationCommand::ExecuteKernel(float *Positions, const float *Normals, int32 VertexCount, FWeightStream Weights) const
+{
+	switch (Type) {
+	case EDeformationCommandType::Translate:
+		VertexKernels::Translate(Positions, VertexCount, &Vector0.X, Weights);
+		break;
+	case EDeformationCommandType::Affine:
+		VertexKernels::Affine(Positions, VertexCount, Matrix, Weights);
+		break;
+	case EDeformationCommandType::Inflate:
+		VertexKernels::AddScaledDirection(Positions, Normals, VertexCount, Scalar0, Weights);
+		break;
+	case EDeformationCommandType::Spherize:
+		VertexKernels::Spherize(Positions, VertexCount, &Vector0.X, Scalar0, Scalar1, Weights);
+		break;
+	case EDeformationCommandType::RotateAroundAxis:
+		VertexKernels::RotateAroundAxis(Positions, VertexCount, &Vector0.X, &Vector1.X, Scalar0, Weights);
+		break;
+	}
+}
+
+bool FDeformationCommand::TryMerge(const FDeformationCommand &Next)
+{
+	// Weighted commands blend per-vertex and so can't be combined.
+	if (Selection || Next.Selection) {
+		return false;
+	}
+	const bool bThisIsAffine = (Type == EDeformationCommandType::Translate || Type == EDeformationCommandType::Affine);
+	const bool bNextIsAffine = (Next.Type == EDeformationCommandType::Translate || Next.Type == EDeformationCommandType::Affine);
+	if (!bThisIsAffine || !bNextIsAffine) {
+		return false;
+	}
+
+	// Combine as Next * This, as This is applied first.
+	float First[12];
+	float Second[12];
+	GetCommandMatrix(*this, First);
+	GetCommandMatrix(Next, Second);
+	VertexKernels::ComposeAffine(First, Second, Matrix);
+	Type = EDeformationCommandType::Affine;
+	return true;
+}
+
+void FDeformationCommandList::Add(const FDeformationCommand &Command)
+{
+	if (Commands.Num() > 0 && Commands.Last().TryMerge(Command)) {
+		return;
+	}
+	Commands.Add(Command);
+}
+
+void FDeformationCommandList::Execute(TArray<FSectionGeometry> &Sections, const TArray<int32> &SectionVertexOffsets, int32 BatchSize, bool bAllowParallel)
+{
+	Apply(Sections, SectionVertexOffsets, BatchSize, bAllowParallel);
+	Commands.Reset();
+}
+
+void FDeformationCommandList::Apply(TArray<FSectionGeometry> &Sections, const TArray<int32> &SectionVertexOffsets, int32 BatchSize, bool bAllowParallel) const
+{
+	if (Commands.Num() == 0) {
+		return;
+	}
+
+	// Each batch is worked through a chunk at a time, applying every command to the chunk.
+	ParallelForVertexChunks(Sections, SectionVertexOffsets, BatchSize, bAllowParallel, [this, &Sections](const FVertexChunk &Batch) {
+		FSectionGeometry &Section = Sections[Batch.SectionIndex];
+		for (int32 ChunkStart = 0; ChunkStart < Batch.VertexCount; ChunkStart += DeformationChunkSize) {
+			const int32 ChunkCount = FMath::Min(DeformationChunkSize, Batch.VertexCount - ChunkStart);
+			for (const auto &Command : Commands) {
+				Command.Execute(Section, Batch.FirstVertex + ChunkStart, ChunkCount, Batch.FirstWeightIndex + ChunkStart);
+			}
+		}
+	});
+}
+
+bool FDeformationCommandList::NeedsNormals() const
+{
+	return Commands.ContainsByPredicate([](const FDeformationCommand &Command) {
+		return Command.Type == EDeformationCommandType::Inflate;
+	});
+}
+
+void FDeformationCommandList::Reset()
+{
+	Commands.Reset();
+}
+
+int32 FDeformationCommandList::Num() const
+{
+	return Commands.Num();
+}
+
+bool FDeformationCommandList::IsEmpty() const
+{
+	return Commands.Num() == 0;
+}
@@ -26,12 +26,14 @@
 // off every 'zix'.)
 //
 
-// PaulG: Include the same precompiled header as all other files here.
-#include "ProceduralToolkit.h"
+// PaulG: This is part of the toolkit's engine-free core, so it doesn't include the module's
+// precompiled header and can also be built by the plugin's standalone CMake project.
 
 // Disable warning message 4701 - "Potentially uninitialized local variable".
 // \todo Fix this..
+#if defined(_MSC_VER)
 #pragma warning( disable : 4701 )  
+#endif
 
 #include "FastNoise.h"
 #include <math.h>
@@ -476,6 +478,224 @@ FN_DECIMAL FastNoise::GetNoise(FN_DECIMAL x, FN_DECIMAL y)
 	return 0;
 }
 
+// PaulG: The loops behind FillNoise(...), with the noise function picked by the caller so that
+// it's a direct call rather than going back through the switch for every point.
+template <typename NoiseFunction>
+static void FillNoiseLoop(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, int stride, int count, FN_DECIMAL frequency, FN_DECIMAL* output, NoiseFunction noise)
+{
+	for (int i = 0; i < count; i++)
+	{
+		const int offset = i * stride;
+		output[i] = noise(x[offset] * frequency, y[offset] * frequency, z[offset] * frequency);
+	}
+}
+
+template <typename NoiseFunction>
+static void FillNoiseLoop(const FN_DECIMAL* x, const FN_DECIMAL* y, int stride, int count, FN_DECIMAL frequency, FN_DECIMAL* output, NoiseFunction noise)
+{
+	for (int i = 0; i < count; i++)
+	{
+		const int offset = i * stride;
+		output[i] = noise(x[offset] * frequency, y[offset] * frequency);
+	}
+}
+
+void FastNoise::FillNoise(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, int stride, int count, FN_DECIMAL* output)
+{
+	typedef FN_DECIMAL D;
+
+	const FN_DECIMAL* coordinates[4] = { x, y, z, nullptr };
+	if (FillNoiseVectorized(3, coordinates, stride, count, output))
+		return;
+
+	switch (m_noiseType)
+	{
+	case Value:
+		FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleValue(0, x, y, z); });
+		return;
+	case Perlin:
+		FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SinglePerlin(0, x, y, z); });
+		return;
+	case Simplex:
+		FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleSimplex(0, x, y, z); });
+		return;
+	case Cubic:
+		FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleCubic(0, x, y, z); });
+		return;
+	case ValueFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleValueFractalFBM(x, y, z); });
+			return;
+		case Billow:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleValueFractalBillow(x, y, z); });
+			return;
+		case RigidMulti:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleValueFractalRigidMulti(x, y, z); });
+			return;
+		default:
+			break;
+		}
+		break;
+	case PerlinFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SinglePerlinFractalFBM(x, y, z); });
+			return;
+		case Billow:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SinglePerlinFractalBillow(x, y, z); });
+			return;
+		case RigidMulti:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SinglePerlinFractalRigidMulti(x, y, z); });
+			return;
+		default:
+			break;
+		}
+		break;
+	case SimplexFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleSimplexFractalFBM(x, y, z); });
+			return;
+		case Billow:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleSimplexFractalBillow(x, y, z); });
+			return;
+		case RigidMulti:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleSimplexFractalRigidMulti(x, y, z); });
+			return;
+		default:
+			break;
+		}
+		break;
+	case CubicFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleCubicFractalFBM(x, y, z); });
+			return;
+		case Billow:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleCubicFractalBillow(x, y, z); });
+			return;
+		case RigidMulti:
+			FillNoiseLoop(x, y, z, stride, count, m_frequency, output, [this](D x, D y, D z) { return SingleCubicFractalRigidMulti(x, y, z); });
+			return;
+		default:
+			break;
+		}
+		break;
+	default:
+		break;
+	}
+
+	// Cellular and white noise, and any settings GetNoise(...) doesn't recognise, go point by point.
+	for (int i = 0; i < count; i++)
+	{
+		const int offset = i * stride;
+		output[i] = GetNoise(x[offset], y[offset], z[offset]);
+	}
+}
+
+void FastNoise::FillNoise(const FN_DECIMAL* x, const FN_DECIMAL* y, int stride, int count, FN_DECIMAL* output)
+{
+	typedef FN_DECIMAL D;
+
+	const FN_DECIMAL* coordinates[4] = { x, y, nullptr, nullptr };
+	if (FillNoiseVectorized(2, coordinates, stride, count, output))
+		return;
+
+	switch (m_noiseType)
+	{
+	case Value:
+		FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleValue(0, x, y); });
+		return;
+	case Perlin:
+		FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SinglePerlin(0, x, y); });
+		return;
+	case Simplex:
+		FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleSimplex(0, x, y); });
+		return;
+	case Cubic:
+		FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleCubic(0, x, y); });
+		return;
+	case ValueFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleValueFractalFBM(x, y); });
+			return;
+		case Billow:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleValueFractalBillow(x, y); });
+			return;
+		case RigidMulti:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleValueFractalRigidMulti(x, y); });
+			return;
+		default:
+			break;
+		}
+		break;
+	case PerlinFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SinglePerlinFractalFBM(x, y); });
+			return;
+		case Billow:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SinglePerlinFractalBillow(x, y); });
+			return;
+		case RigidMulti:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SinglePerlinFractalRigidMulti(x, y); });
+			return;
+		default:
+			break;
+		}
+		break;
+	case SimplexFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleSimplexFractalFBM(x, y); });
+			return;
+		case Billow:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleSimplexFractalBillow(x, y); });
+			return;
+		case RigidMulti:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleSimplexFractalRigidMulti(x, y); });
+			return;
+		default:
+			break;
+		}
+		break;
+	case CubicFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleCubicFractalFBM(x, y); });
+			return;
+		case Billow:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleCubicFractalBillow(x, y); });
+			return;
+		case RigidMulti:
+			FillNoiseLoop(x, y, stride, count, m_frequency, output, [this](D x, D y) { return SingleCubicFractalRigidMulti(x, y); });
+			return;
+		default:
+			break;
+		}
+		break;
+	default:
+		break;
+	}
+
+	// Cellular and white noise, and any settings GetNoise(...) doesn't recognise, go point by point.
+	for (int i = 0; i < count; i++)
+	{
+		const int offset = i * stride;
+		output[i] = GetNoise(x[offset], y[offset]);
+	}
+}
+
 // White Noise
 FN_DECIMAL FastNoise::GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w)
 {
@@ -1437,6 +1657,111 @@ FN_DECIMAL FastNoise::SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIM
 	return 27 * (n0 + n1 + n2 + n3 + n4);
 }
 
+// PaulG: The vectorised kernels follow the Single* functions above, and take pointers to the
+// tables here so there's only one copy of them.
+bool FastNoise::FillNoiseVectorized(int dimensions, const FN_DECIMAL* const coordinates[4], int stride, int count, FN_DECIMAL* output) const
+{
+#ifdef FN_USE_DOUBLES
+	return false;
+#else
+	typedef NoiseKernels::FNoiseSettings Settings;
+
+	if (m_instructionSet == NoiseKernels::EInstructionSet::Scalar)
+		return false;
+
+	Settings settings;
+	switch (m_noiseType)
+	{
+	case Value:
+	case ValueFractal:
+		settings.Noise = Settings::ENoise::Value;
+		break;
+	case Perlin:
+	case PerlinFractal:
+		settings.Noise = Settings::ENoise::Perlin;
+		break;
+	case Simplex:
+	case SimplexFractal:
+		settings.Noise = Settings::ENoise::Simplex;
+		break;
+	case Cubic:
+	case CubicFractal:
+		settings.Noise = Settings::ENoise::Cubic;
+		break;
+	default:
+		return false;
+	}
+
+	settings.Fractal = Settings::EFractal::None;
+	if (m_noiseType == ValueFractal || m_noiseType == PerlinFractal || m_noiseType == SimplexFractal || m_noiseType == CubicFractal)
+	{
+		switch (m_fractalType)
+		{
+		case FBM:
+			settings.Fractal = Settings::EFractal::FBM;
+			break;
+		case Billow:
+			settings.Fractal = Settings::EFractal::Billow;
+			break;
+		case RigidMulti:
+			settings.Fractal = Settings::EFractal::RigidMulti;
+			break;
+		default:
+			return false;
+		}
+	}
+
+	// 4D noise is only ever Simplex, whatever the noise type.
+	if (dimensions == 4)
+	{
+		settings.Noise = Settings::ENoise::Simplex;
+		settings.Fractal = Settings::EFractal::None;
+	}
+
+	switch (m_interp)
+	{
+	case Linear:
+		settings.Interp = Settings::EInterp::Linear;
+		break;
+	case Hermite:
+		settings.Interp = Settings::EInterp::Hermite;
+		break;
+	default:
+		settings.Interp = Settings::EInterp::Quintic;
+		break;
+	}
+
+	settings.Frequency = m_frequency;
+	settings.Octaves = m_octaves;
+	settings.Lacunarity = m_lacunarity;
+	settings.Gain = m_gain;
+	settings.FractalBounding = m_fractalBounding;
+	settings.Perm = m_perm;
+	settings.Perm12 = m_perm12;
+	settings.ValueLUT = VAL_LUT;
+	settings.GradX = GRAD_X;
+	settings.GradY = GRAD_Y;
+	settings.GradZ = GRAD_Z;
+	settings.Grad4D = GRAD_4D;
+	settings.Simplex4D = SIMPLEX_4D;
+
+	return NoiseKernels::FillNoise(m_instructionSet, settings, dimensions, coordinates, stride, count, output);
+#endif
+}
+
+void FastNoise::FillSimplex(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, const FN_DECIMAL* w, int stride, int count, FN_DECIMAL* output)
+{
+	const FN_DECIMAL* coordinates[4] = { x, y, z, w };
+	if (FillNoiseVectorized(4, coordinates, stride, count, output))
+		return;
+
+	for (int i = 0; i < count; i++)
+	{
+		const int offset = i * stride;
+		output[i] = GetSimplex(x[offset], y[offset], z[offset], w[offset]);
+	}
+}
+
 // Cubic Noise
 FN_DECIMAL FastNoise::GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
 {
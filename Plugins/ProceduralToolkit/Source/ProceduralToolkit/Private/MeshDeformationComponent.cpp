@@ -1,15 +1,53 @@
 // (c)2017 Paul Golds, released under MIT License.
 
 #include "ProceduralToolkit.h"
+#include "LatentActions.h"
+#include "Engine/LatentActionManager.h"
 #include "MeshGeometry.h"
 #include "MeshDeformationComponent.h"
 
+/// Latent action for *ExecuteDeformationBatchAsync*, which waits for the deformations to be applied.
+class FAsyncDeformationLatentAction : public FPendingLatentAction
+{
+public:
+	FAsyncDeformationLatentAction(UMeshDeformationComponent *InComponent, const FLatentActionInfo &LatentInfo)
+		: Component(InComponent)
+		, ExecutionFunction(LatentInfo.ExecutionFunction)
+		, OutputLink(LatentInfo.Linkage)
+		, CallbackTarget(LatentInfo.CallbackTarget)
+	{
+	}
+
+	virtual void UpdateOperation(FLatentResponse &Response) override
+	{
+		UMeshDeformationComponent *component = Component.Get();
+		if (component) {
+			component->UpdateAsyncDeformation();
+		}
+		Response.FinishAndTriggerIf(!component || !component->IsAsyncDeformationInProgress(), ExecutionFunction, OutputLink, CallbackTarget);
+	}
+
+#if WITH_EDITOR
+	virtual FString GetDescription() const override
+	{
+		return TEXT("Applying deformations");
+	}
+#endif
+
+private:
+	TWeakObjectPtr<UMeshDeformationComponent> Component;
+	FName ExecutionFunction;
+	int32 OutputLink;
+	FWeakObjectPtr CallbackTarget;
+};
+
 
 // Sets default values for this component's properties
 UMeshDeformationComponent::UMeshDeformationComponent()
 {
-	// This component can never tick, it doesn't update itself.
-	PrimaryComponentTick.bCanEverTick = false;
+	// This component only ticks while waiting for async deformations to finish.
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
 
 	// ...
 }
@@ -38,6 +76,104 @@ bool UMeshDeformationComponent::UpdateProceduralMeshComponent(UMeshDeformationCo
 	return MeshGeometry->UpdateProceduralMeshComponent(proceduralMeshComponent, createCollision);
 }
 
+void UMeshDeformationComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	UpdateAsyncDeformation();
+}
+
+UMeshGeometrySnapshot *UMeshDeformationComponent::Snapshot()
+{
+	if (!MeshGeometry) {
+		UE_LOG(LogTemp, Warning, TEXT("Snapshot: No meshGeometry loaded"));
+		return nullptr;
+	}
+	return MeshGeometry->Snapshot();
+}
+
+bool UMeshDeformationComponent::Restore(UMeshDeformationComponent *&MeshDeformationComponent, UMeshGeometrySnapshot *Snapshot)
+{
+	MeshDeformationComponent = this;
+	if (!MeshGeometry) {
+		UE_LOG(LogTemp, Warning, TEXT("Restore: No meshGeometry loaded"));
+		return false;
+	}
+	return MeshGeometry->Restore(Snapshot);
+}
+
+void UMeshDeformationComponent::BeginDeformationBatch(UMeshDeformationComponent *&MeshDeformationComponent)
+{
+	MeshDeformationComponent = this;
+	if (!MeshGeometry) {
+		UE_LOG(LogTemp, Warning, TEXT("BeginDeformationBatch: No meshGeometry loaded"));
+		return;
+	}
+	MeshGeometry->BeginDeformationBatch();
+}
+
+void UMeshDeformationComponent::ExecuteDeformationBatch(UMeshDeformationComponent *&MeshDeformationComponent)
+{
+	MeshDeformationComponent = this;
+	if (!MeshGeometry) {
+		UE_LOG(LogTemp, Warning, TEXT("ExecuteDeformationBatch: No meshGeometry loaded"));
+		return;
+	}
+	MeshGeometry->ExecuteDeformationBatch();
+}
+
+void UMeshDeformationComponent::ExecuteDeformationBatchAsync(UMeshDeformationComponent *&MeshDeformationComponent, FLatentActionInfo LatentInfo)
+{
+	MeshDeformationComponent = this;
+	if (!MeshGeometry) {
+		UE_LOG(LogTemp, Warning, TEXT("ExecuteDeformationBatchAsync: No meshGeometry loaded"));
+		return;
+	}
+
+	// Start the work, and tick until it's finished.
+	MeshGeometry->ExecuteDeformationBatchAsync();
+	bAsyncDeformationPending = true;
+	SetComponentTickEnabled(true);
+
+	UWorld *world = GetWorld();
+	if (world) {
+		FLatentActionManager &latentActionManager = world->GetLatentActionManager();
+		if (!latentActionManager.FindExistingAction<FAsyncDeformationLatentAction>(LatentInfo.CallbackTarget, LatentInfo.UUID)) {
+			latentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID, new FAsyncDeformationLatentAction(this, LatentInfo));
+		}
+	}
+}
+
+bool UMeshDeformationComponent::IsAsyncDeformationInProgress() const
+{
+	return MeshGeometry && MeshGeometry->IsAsyncDeformationInProgress();
+}
+
+void UMeshDeformationComponent::WaitForAsyncDeformation(UMeshDeformationComponent *&MeshDeformationComponent)
+{
+	MeshDeformationComponent = this;
+	if (!MeshGeometry) {
+		UE_LOG(LogTemp, Warning, TEXT("WaitForAsyncDeformation: No meshGeometry loaded"));
+		return;
+	}
+	MeshGeometry->WaitForAsyncDeformation();
+	UpdateAsyncDeformation();
+}
+
+void UMeshDeformationComponent::UpdateAsyncDeformation()
+{
+	if (!bAsyncDeformationPending) {
+		return;
+	}
+	if (MeshGeometry && MeshGeometry->IsAsyncDeformationInProgress() && !MeshGeometry->PollAsyncDeformation()) {
+		// Still running.
+		return;
+	}
+
+	bAsyncDeformationPending = false;
+	SetComponentTickEnabled(false);
+	OnAsyncDeformationComplete.Broadcast(this);
+}
+
 USelectionSet * UMeshDeformationComponent::SelectAll()
 {
 	if (!MeshGeometry) {
@@ -58,7 +194,7 @@ USelectionSet * UMeshDeformationComponent::SelectNear(FVector center /*= FVector
 	return MeshGeometry->SelectNear(center, innerRadius, outerRadius);
 }
 
-USelectionSet * UMeshDeformationComponent::SelectNearSpline(USplineComponent *spline, float innerRadius /*= 0*/, float outerRadius /*= 100*/)
+USelectionSet * UMeshDeformationComponent::SelectNearSpline(USplineComponent *spline, float innerRadius /*= 0*/, float outerRadius /*= 100*/, float tolerance /*= 1.0f*/)
 {
 	if (!MeshGeometry) {
 		UE_LOG(LogTemp, Warning, TEXT("SelectNearSpline: No meshGeometry loaded"));
@@ -67,7 +203,7 @@ USelectionSet * UMeshDeformationComponent::SelectNearSpline(USplineComponent *sp
 	// Get the actor's local->world transform- we're going to need it for the spline.
 	FTransform actorTransform  = this->GetOwner()->GetTransform();
 
-	return MeshGeometry->SelectNearSpline(spline, actorTransform, innerRadius, outerRadius);
+	return MeshGeometry->SelectNearSpline(spline, actorTransform, innerRadius, outerRadius, tolerance);
 }
 
 USelectionSet * UMeshDeformationComponent::SelectNearLine(FVector lineStart, FVector lineEnd, float innerRadius /*=0*/, float outerRadius/*= 100*/, bool lineIsInfinite/* = false */)
@@ -111,6 +247,29 @@ USelectionSet * UMeshDeformationComponent::SelectByNoise(
 	);
 }
 
+USelectionSet * UMeshDeformationComponent::SelectByNoiseCached(
+	int32 Seed /*= 1337*/,
+	float Frequency /*= 0.01*/,
+	ENoiseInterpolation NoiseInterpolation /*= ENoiseInterpolation::Quintic*/,
+	ENoiseType NoiseType /*= ENoiseType::Simplex */,
+	uint8 FractalOctaves /*= 3*/,
+	float FractalLacunarity /*= 2.0*/,
+	float FractalGain /*= 0.5*/,
+	EFractalType FractalType /*= EFractalType::FBM*/,
+	ECellularDistanceFunction CellularDistanceFunction /*= ECellularDistanceFunction::Euclidian*/,
+	int32 Resolution /*= 64*/
+) {
+	if (!MeshGeometry) {
+		UE_LOG(LogTemp, Warning, TEXT("SelectByNoiseCached: No meshGeometry loaded"));
+		return nullptr;
+	}
+	return MeshGeometry->SelectByNoiseCached(
+		Seed, Frequency, NoiseInterpolation, NoiseType,
+		FractalOctaves, FractalLacunarity, FractalGain, FractalType,
+		CellularDistanceFunction, Resolution
+	);
+}
+
 USelectionSet * UMeshDeformationComponent::SelectByTexture(UTexture2D *Texture2D, ETextureChannel TextureChannel /*= ETextureChannel::Red*/)
 {
 	if (!MeshGeometry) {
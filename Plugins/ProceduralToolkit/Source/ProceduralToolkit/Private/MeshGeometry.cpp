@@ -1,12 +1,169 @@
 // (c)2017 Paul Golds, released under MIT License.
 
 #include "ProceduralToolkit.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
 #include "Engine/StaticMesh.h"
 #include "KismetProceduralMeshLibrary.h"
-#include "Runtime/Core/Public/Math/UnrealMathUtility.h" // ClosestPointOnLine/ClosestPointOnInfiniteLine
 #include "SelectionSet.h"
 #include "FastNoise.h"
 #include "MeshGeometry.h"
+#include "MeshGeometrySnapshot.h"
+#include "ToolkitCore/NoiseVolumeCache.h"
+#include "ToolkitCore/PolylineIndex.h"
+#include "ToolkitCore/SelectionKernels.h"
+#include "ToolkitCore/VertexKernels.h"
+#include "VertexChunks.h"
+
+/// Check that a SelectionSet, if one is provided, has a weight for every vertex of the geometry,
+/// and evaluate it if it's deferred.
+///
+/// The VertexKernels read the weights directly and so this needs checking up front.
+static bool SelectionIsValid(const UMeshGeometry *MeshGeometry, USelectionSet *Selection, const TCHAR *Caller)
+{
+	if (Selection) {
+		Selection->Evaluate();
+	}
+	if (Selection && Selection->Num() < MeshGeometry->TotalVertexCount()) {
+		UE_LOG(
+			LogTemp, Error, TEXT("%s: SelectionSet has %d weights but the geometry has %d vertices"),
+			Caller, Selection->Num(), MeshGeometry->TotalVertexCount()
+		);
+		return false;
+	}
+	return true;
+}
+
+/// Call a function for every chunk of the geometry's vertices, in parallel if the geometry allows it.
+static void ParallelForVertices(const UMeshGeometry *MeshGeometry, TFunctionRef<void(const FVertexChunk &Chunk)> Function)
+{
+	ParallelForVertexChunks(
+		MeshGeometry->sections, MeshGeometry->GetSectionVertexOffsets(),
+		MeshGeometry->ParallelBatchSize, MeshGeometry->bAllowParallel, Function
+	);
+}
+
+/// Create a new SelectionSet with an uninitialized weight for every vertex, ready to be filled in.
+static USelectionSet *CreateUninitializedSelectionSet(UMeshGeometry *MeshGeometry)
+{
+	USelectionSet *NewSelectionSet = NewObject<USelectionSet>(MeshGeometry);
+	NewSelectionSet->ResetDense(MeshGeometry->TotalVertexCount());
+	return NewSelectionSet;
+}
+
+/// Create a sparse SelectionSet from the non-zero weights found by a grid query.
+static USelectionSet *CreateSparseSelectionSet(UMeshGeometry *MeshGeometry, const std::vector<int> &Indices, const std::vector<float> &Weights)
+{
+	USelectionSet *NewSelectionSet = NewObject<USelectionSet>(MeshGeometry);
+	int32 *NewIndices;
+	float *NewWeights;
+	NewSelectionSet->ResetSparse(MeshGeometry->TotalVertexCount(), (int32)Indices.size(), NewIndices, NewWeights);
+	FMemory::Memcpy(NewIndices, Indices.data(), Indices.size() * sizeof(int32));
+	FMemory::Memcpy(NewWeights, Weights.data(), Weights.size() * sizeof(float));
+	return NewSelectionSet;
+}
+
+/// Create a sparse SelectionSet by weighting every chunk of vertices and keeping the weights which aren't zero.
+///
+/// *Function* writes the weights for a chunk, as the dense *Select* functions do, and is called
+/// in parallel if the geometry allows it.
+static USelectionSet *CreateSparseSelectionSet(UMeshGeometry *MeshGeometry, TFunctionRef<void(const FVertexChunk &Chunk, float *OutWeights)> Function)
+{
+	TArray<FVertexChunk> Chunks;
+	MakeVertexChunks(MeshGeometry->sections, MeshGeometry->GetSectionVertexOffsets(), MeshGeometry->ParallelBatchSize, Chunks);
+
+	// Each chunk keeps its own weights, and as the chunks are in order joining them keeps the
+	// indices sorted.  The weights are counted before they're kept so each array is only
+	// allocated once, at the size it needs to be.
+	TArray<TArray<int32>> ChunkIndices;
+	TArray<TArray<float>> ChunkWeights;
+	ChunkIndices.SetNum(Chunks.Num());
+	ChunkWeights.SetNum(Chunks.Num());
+	ParallelFor(Chunks.Num(), [&](int32 ChunkIndex) {
+		const FVertexChunk &Chunk = Chunks[ChunkIndex];
+		TArray<float> Weights;
+		Weights.SetNumUninitialized(Chunk.VertexCount);
+		Function(Chunk, Weights.GetData());
+
+		int32 Count = 0;
+		for (int32 Index = 0; Index < Chunk.VertexCount; ++Index) {
+			Count += Weights[Index] != 0.0f ? 1 : 0;
+		}
+		ChunkIndices[ChunkIndex].Reserve(Count);
+		ChunkWeights[ChunkIndex].Reserve(Count);
+		for (int32 Index = 0; Index < Chunk.VertexCount; ++Index) {
+			if (Weights[Index] != 0.0f) {
+				ChunkIndices[ChunkIndex].Add(Chunk.FirstWeightIndex + Index);
+				ChunkWeights[ChunkIndex].Add(Weights[Index]);
+			}
+		}
+	}, !MeshGeometry->bAllowParallel || Chunks.Num() <= 1);
+
+	int32 Count = 0;
+	for (const TArray<int32> &Indices : ChunkIndices) {
+		Count += Indices.Num();
+	}
+
+	USelectionSet *NewSelectionSet = NewObject<USelectionSet>(MeshGeometry);
+	int32 *Indices;
+	float *Weights;
+	NewSelectionSet->ResetSparse(MeshGeometry->TotalVertexCount(), Count, Indices, Weights);
+	for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex) {
+		const int32 ChunkCount = ChunkIndices[ChunkIndex].Num();
+		FMemory::Memcpy(Indices, ChunkIndices[ChunkIndex].GetData(), ChunkCount * sizeof(int32));
+		FMemory::Memcpy(Weights, ChunkWeights[ChunkIndex].GetData(), ChunkCount * sizeof(float));
+		Indices += ChunkCount;
+		Weights += ChunkCount;
+	}
+	return NewSelectionSet;
+}
+
+/// Pack the arguments of a *Select* function into bytes for *FindOrAddCachedSelection*.
+///
+/// The arguments are compared byte for byte, so they need to be types without padding such as
+/// floats, integers, enums, and FVectors.
+static void PackSelectionArguments(TArray<uint8> &OutArguments)
+{
+}
+
+template <typename ArgumentType, typename... OtherArgumentTypes>
+static void PackSelectionArguments(TArray<uint8> &OutArguments, const ArgumentType &Argument, const OtherArgumentTypes &... OtherArguments)
+{
+	OutArguments.Append((const uint8 *)&Argument, sizeof(ArgumentType));
+	PackSelectionArguments(OutArguments, OtherArguments...);
+}
+
+template <typename... ArgumentTypes>
+static TArray<uint8> MakeSelectionArguments(const ArgumentTypes &... Arguments)
+{
+	TArray<uint8> arguments;
+	PackSelectionArguments(arguments, Arguments...);
+	return arguments;
+}
+
+/// Build the matrix for VertexKernels::Affine for a transformation of the form
+/// `Center + LinearPart(Vertex - Center) + Offset`.
+///
+/// The linear part is sampled with the unit axes, the center is folded into the translation
+/// column so that the kernel doesn't need to handle it.
+static void MakeAffineMatrix(
+	TFunctionRef<FVector(const FVector &)> LinearPart, const FVector &Center, const FVector &Offset,
+	float OutMatrix[12]
+) {
+	const FVector Columns[3] = {
+		LinearPart(FVector(1.0f, 0.0f, 0.0f)),
+		LinearPart(FVector(0.0f, 1.0f, 0.0f)),
+		LinearPart(FVector(0.0f, 0.0f, 1.0f))
+	};
+	const FVector Translation = Center - LinearPart(Center) + Offset;
+
+	for (int32 Row = 0; Row < 3; ++Row) {
+		OutMatrix[Row * 4 + 0] = Columns[0][Row];
+		OutMatrix[Row * 4 + 1] = Columns[1][Row];
+		OutMatrix[Row * 4 + 2] = Columns[2][Row];
+		OutMatrix[Row * 4 + 3] = Translation[Row];
+	}
+}
 
 UMeshGeometry::UMeshGeometry()
 {
@@ -24,8 +181,20 @@ bool UMeshGeometry::LoadFromStaticMesh(UStaticMesh *staticMesh, int32 LOD /*= 0*
 
 	UE_LOG(LogTemp, Log, TEXT("Reading mesh geometry from static mesh '%s'"), *staticMesh->GetName());
 
-	// Clear any existing geometry.
+	// Clear any existing geometry, along with any deformations waiting to be applied to it.  Any
+	// snapshots that are still using the old geometry take it over.
+	WaitForAsyncDeformation();
+	this->PendingDeformations.Reset();
+	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+		CaptureSectionForSnapshots(sectionIndex, AllMeshGeometryAttributes, true);
+	}
 	this->sections.Empty();
+	this->SectionStates.Empty();
+	this->SpatialIndex.Reset();
+	this->SpatialIndexVersions.Empty();
+	this->SpatialIndexRequestVersions.Empty();
+	ClearSelectionCache();
+	MarkTopologyChanged();
 
 	const int32 numSections = staticMesh->GetNumSections(LOD);
 	UE_LOG(LogTemp, Log, TEXT("Found %d sections for LOD %d"), numSections, LOD);
@@ -46,8 +215,9 @@ bool UMeshGeometry::LoadFromStaticMesh(UStaticMesh *staticMesh, int32 LOD /*= 0*
 		// Load vertex colors with default values for as many vertices as needed
 		sectionGeometry.vertexColors.InsertDefaulted(0, sectionGeometry.vertices.Num());
 
-		// Add the finished struct to the mesh's section list
+		// Add the finished struct to the mesh's section list, everything in it is new.
 		this->sections.Emplace(sectionGeometry);
+		MarkSectionModified(meshSectionIndex, AllMeshGeometryAttributes);
 	}
 
 	// All done
@@ -62,35 +232,96 @@ bool UMeshGeometry::UpdateProceduralMeshComponent(UProceduralMeshComponent *proc
 		return false;
 	}
 
-	// Clear the geometry
-	proceduralMeshComponent->ClearAllMeshSections();
+	FlushDeformations();
+
+	// Find what we last wrote to this PMC, forgetting about any PMCs which have been destroyed.
+	this->OutputStates.RemoveAll([](const FMeshGeometryOutputState &OutputState) {
+		return !OutputState.Component.IsValid();
+	});
+	FMeshGeometryOutputState *outputState = this->OutputStates.FindByPredicate([proceduralMeshComponent](const FMeshGeometryOutputState &OutputState) {
+		return OutputState.Component.Get() == proceduralMeshComponent;
+	});
+
+	// We can only update what's already there if we've written to this PMC before, with the same
+	// collision settings, and nothing else has added or removed sections.  If not clear the geometry
+	// and rebuild it all.
+	const bool fullRebuild =
+		!outputState ||
+		createCollision != outputState->bCollision ||
+		proceduralMeshComponent->GetNumSections() != this->sections.Num();
+	if (!outputState) {
+		outputState = &this->OutputStates[this->OutputStates.AddDefaulted()];
+		outputState->Component = proceduralMeshComponent;
+	}
+	if (fullRebuild) {
+		proceduralMeshComponent->ClearAllMeshSections();
+	}
+	outputState->bCollision = createCollision;
+	outputState->AttributeVersions.SetNumZeroed(this->sections.Num() * MeshGeometryAttributeCount);
+
+	// Empty arrays tell UpdateMeshSection_LinearColor to leave that attribute alone.
+	const TArray<FVector> unchangedVectors;
+	const TArray<FVector2D> unchangedUVs;
+	const TArray<FLinearColor> unchangedColors;
+	const TArray<FProcMeshTangent> unchangedTangents;
+
+	// Iterate over the mesh sections, creating or updating a PMC MeshSection for each one that's changed.
+	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+		const FSectionGeometry &section = this->sections[sectionIndex];
+
+		// Anything with a different version to what was last written has changed.
+		int32 *writtenVersions = &outputState->AttributeVersions[sectionIndex * MeshGeometryAttributeCount];
+		uint8 dirtyAttributes = 0;
+		for (int32 attribute = 0; attribute < MeshGeometryAttributeCount; ++attribute) {
+			const int32 version = GetAttributeVersion(sectionIndex, (EMeshGeometryAttribute)attribute);
+			if (fullRebuild || writtenVersions[attribute] != version) {
+				dirtyAttributes |= 1 << attribute;
+				writtenVersions[attribute] = version;
+			}
+		}
+		if (!dirtyAttributes) {
+			continue;
+		}
 
-	// Iterate over the mesh sections, creating a PMC MeshSection for each one.
-	int32 nextSectionIndex = 0;
-	for (auto section : this->sections) {
-		UE_LOG(LogTemp, Log, TEXT("Rebuilding section.."));
-		// Create the PMC section with the StaticMesh's data.
-		proceduralMeshComponent->CreateMeshSection_LinearColor(
-			nextSectionIndex++, section.vertices, section.triangles, section.normals, section.uvs,
-			section.vertexColors, section.tangents, createCollision
-		);
+		// Changes to the triangles or number of vertices need the section recreating.
+		FProcMeshSection *existingSection = proceduralMeshComponent->GetProcMeshSection(sectionIndex);
+		const bool recreateSection =
+			fullRebuild ||
+			(dirtyAttributes & GetAttributeMask(EMeshGeometryAttribute::Triangles)) ||
+			!existingSection ||
+			existingSection->ProcVertexBuffer.Num() != section.vertices.Num();
+
+		if (recreateSection) {
+			UE_LOG(LogTemp, Log, TEXT("Rebuilding section %d.."), sectionIndex);
+			proceduralMeshComponent->CreateMeshSection_LinearColor(
+				sectionIndex, section.vertices, section.triangles, section.normals, section.uvs,
+				section.vertexColors, section.tangents, createCollision
+			);
+		} else {
+			proceduralMeshComponent->UpdateMeshSection_LinearColor(
+				sectionIndex,
+				(dirtyAttributes & GetAttributeMask(EMeshGeometryAttribute::Positions)) ? section.vertices : unchangedVectors,
+				(dirtyAttributes & GetAttributeMask(EMeshGeometryAttribute::Normals)) ? section.normals : unchangedVectors,
+				(dirtyAttributes & GetAttributeMask(EMeshGeometryAttribute::UVs)) ? section.uvs : unchangedUVs,
+				(dirtyAttributes & GetAttributeMask(EMeshGeometryAttribute::Colors)) ? section.vertexColors : unchangedColors,
+				(dirtyAttributes & GetAttributeMask(EMeshGeometryAttribute::Tangents)) ? section.tangents : unchangedTangents
+			);
+		}
 	}
+
 	return true;
 }
 
 int32 UMeshGeometry::TotalVertexCount() const
 {
-	int32 totalVertexCount = 0;
-	for (auto section : this->sections) {
-		totalVertexCount += section.vertices.Num();
-	}
-	return totalVertexCount;
+	// The last offset is the end of the last section.
+	return GetSectionVertexOffsets().Last();
 }
 
 int32 UMeshGeometry::TotalTriangleCount() const
 {
 	int32 totalTriangleCount = 0;
-	for (auto section : this->sections) {
+	for (const auto &section : this->sections) {
 		totalTriangleCount += section.triangles.Num();
 	}
 	return totalTriangleCount / 3; // 3pts per triangle
@@ -101,125 +332,787 @@ FString UMeshGeometry::GetSummary() const
 	return FString::Printf(TEXT("%d sections, %d vertices, %d triangles"), this->sections.Num(), this->TotalVertexCount(), this->TotalTriangleCount());
 }
 
-USelectionSet *UMeshGeometry::SelectAll()
+const TArray<int32> &UMeshGeometry::GetSectionVertexOffsets() const
 {
-	USelectionSet *newSelectionSet = NewObject<USelectionSet>(this);
-	newSelectionSet->CreateSelectionSet(this->TotalVertexCount());
-	newSelectionSet->SetAllWeights(1.0f);
-	return newSelectionSet;
+	// Also rebuild if sections have been added or removed without MarkTopologyChanged being called,
+	// as that's cheap to spot.
+	if (!bSectionVertexOffsetsValid || SectionVertexOffsets.Num() != this->sections.Num() + 1) {
+		SectionVertexOffsets.SetNumUninitialized(this->sections.Num() + 1);
+		int32 nextOffset = 0;
+		for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+			SectionVertexOffsets[sectionIndex] = nextOffset;
+			nextOffset += this->sections[sectionIndex].vertices.Num();
+		}
+		SectionVertexOffsets[this->sections.Num()] = nextOffset;
+		bSectionVertexOffsetsValid = true;
+	}
+	return SectionVertexOffsets;
 }
 
-USelectionSet * UMeshGeometry::SelectNear(FVector center /*=FVector::ZeroVector*/, float innerRadius/*=0*/, float outerRadius/*=100*/)
+int32 UMeshGeometry::GetSectionVertexOffset(int32 SectionIndex) const
 {
-	USelectionSet *newSelectionSet = NewObject<USelectionSet>(this);
+	const TArray<int32> &offsets = GetSectionVertexOffsets();
+	if (!offsets.IsValidIndex(SectionIndex)) {
+		UE_LOG(LogTemp, Warning, TEXT("GetSectionVertexOffset: Section %d out of range, geometry has %d sections"), SectionIndex, this->sections.Num());
+		return 0;
+	}
+	return offsets[SectionIndex];
+}
+
+const float *UMeshGeometry::GetSectionWeights(const USelectionSet *Selection, int32 SectionIndex) const
+{
+	check(!Selection || (!Selection->IsSparse() && !Selection->IsDeferred() && Selection->GetPrecision() == ESelectionSetPrecision::Float));
+	return Selection ? Selection->GetWeightStream().GetFloats() + GetSectionVertexOffsets()[SectionIndex] : nullptr;
+}
+
+void UMeshGeometry::MarkTopologyChanged()
+{
+	bSectionVertexOffsetsValid = false;
+	bAdjacencyValid[0] = false;
+	bAdjacencyValid[1] = false;
+}
 
-	// Iterate over the sections, and the vertices in each section.
-	float distanceFromCenter;
-	float distanceBias;
-	float selectionRadius = outerRadius - innerRadius;
-
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			distanceFromCenter = (vertex - center).Size();
-			// Apply bias to map distance to 0-1 based on innerRadius and outerRadius
-			distanceBias = 1.0f - FMath::Clamp((distanceFromCenter - innerRadius) / selectionRadius, 0.0f, 1.0f);
-			newSelectionSet->weights.Emplace(distanceBias);
+const FMeshAdjacency &UMeshGeometry::GetAdjacency(bool bWelded)
+{
+	// Welding reads the positions, so they need to be up to date.
+	if (bWelded) {
+		FlushDeformations();
+	}
+
+	const int32 cacheIndex = bWelded ? 1 : 0;
+	TArray<int32> trianglesVersions;
+	GetAttributeVersions(EMeshGeometryAttribute::Triangles, trianglesVersions);
+	const TArray<int32> &sectionVertexOffsets = GetSectionVertexOffsets();
+	if (bAdjacencyValid[cacheIndex] && trianglesVersions == AdjacencyVersions[cacheIndex] && sectionVertexOffsets == AdjacencyVertexOffsets[cacheIndex]) {
+		return Adjacency[cacheIndex];
+	}
+
+	TArray<FMeshAdjacency::FSource> sources;
+	sources.SetNumUninitialized(this->sections.Num());
+	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+		FSectionGeometry &section = this->sections[sectionIndex];
+		sources[sectionIndex] = {
+			section.triangles.GetData(), section.triangles.Num() / 3, GetVectorArrayData(section.vertices), section.vertices.Num()
+		};
+	}
+	const bool allowParallel = bAllowParallel;
+	Adjacency[cacheIndex].Build(sources.GetData(), sources.Num(), bWelded, [allowParallel](int TaskCount, const std::function<void(int Task)> &Task) {
+		ParallelFor(TaskCount, [&](int32 TaskIndex) {
+			Task(TaskIndex);
+		}, !allowParallel || TaskCount <= 1);
+	});
+	AdjacencyVersions[cacheIndex] = MoveTemp(trianglesVersions);
+	AdjacencyVertexOffsets[cacheIndex] = sectionVertexOffsets;
+	bAdjacencyValid[cacheIndex] = true;
+	return Adjacency[cacheIndex];
+}
+
+/// Get the mask of attributes a snapshot has captured for a section.
+static uint8 GetCapturedAttributes(const FMeshGeometrySectionSnapshot &SnapshotSection)
+{
+	uint8 capturedAttributes = 0;
+	ForEachSnapshotAttribute([&](EMeshGeometryAttribute Attribute, auto SectionMember, auto SnapshotMember) {
+		if ((SnapshotSection.*SnapshotMember).IsValid()) {
+			capturedAttributes |= GetAttributeMask(Attribute);
 		}
+	});
+	return capturedAttributes;
+}
+
+UMeshGeometrySnapshot *UMeshGeometry::Snapshot()
+{
+	FlushDeformations();
+
+	// Nothing is copied yet, that happens in CaptureSectionForSnapshots when something changes.
+	UMeshGeometrySnapshot *newSnapshot = NewObject<UMeshGeometrySnapshot>(this);
+	newSnapshot->SourceGeometry = this;
+	newSnapshot->Sections.SetNum(this->sections.Num());
+	LiveSnapshots.Add(newSnapshot);
+	return newSnapshot;
+}
+
+bool UMeshGeometry::Restore(UMeshGeometrySnapshot *Snapshot)
+{
+	if (!Snapshot) {
+		UE_LOG(LogTemp, Warning, TEXT("Restore: No Snapshot provided"));
+		return false;
+	}
+	if (Snapshot->SourceGeometry.Get() != this) {
+		UE_LOG(LogTemp, Error, TEXT("Restore: Snapshot was taken from a different MeshGeometry"));
+		return false;
 	}
 
-	return newSelectionSet;
+	// Anything recorded since the snapshot is thrown away along with everything else.
+	WaitForAsyncDeformation();
+	PendingDeformations.Reset();
+
+	// Any other snapshots need a copy of what we're about to overwrite.  Sections the snapshot
+	// doesn't have are about to be removed, so can be handed over completely.
+	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+		if (Snapshot->Sections.IsValidIndex(sectionIndex)) {
+			CaptureSectionForSnapshots(sectionIndex, GetCapturedAttributes(Snapshot->Sections[sectionIndex]), false);
+		} else {
+			CaptureSectionForSnapshots(sectionIndex, AllMeshGeometryAttributes, true);
+		}
+	}
+
+	// Copy back everything the snapshot captured.  Once restored the geometry matches the snapshot
+	// again, so the snapshot can let go of its copies.
+	this->sections.SetNum(Snapshot->Sections.Num());
+	this->SectionStates.SetNum(this->sections.Num());
+	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+		FSectionGeometry &section = this->sections[sectionIndex];
+		FMeshGeometrySectionSnapshot &snapshotSection = Snapshot->Sections[sectionIndex];
+		ForEachSnapshotAttribute([&](EMeshGeometryAttribute Attribute, auto SectionMember, auto SnapshotMember) {
+			auto &captured = snapshotSection.*SnapshotMember;
+			if (!captured.IsValid()) {
+				return;
+			}
+			MarkSectionModified(sectionIndex, GetAttributeMask(Attribute));
+			// If no other snapshot shares the data it can be moved rather than copied.
+			if (captured.IsUnique()) {
+				section.*SectionMember = MoveTemp(*captured);
+			} else {
+				section.*SectionMember = *captured;
+			}
+			captured.Reset();
+		});
+	}
+
+	MarkTopologyChanged();
+	return true;
 }
 
-USelectionSet * UMeshGeometry::SelectNearSpline(USplineComponent *spline, FTransform transform, float innerRadius /*= 0*/, float outerRadius /*= 100*/)
+void UMeshGeometry::PrepareSectionForWrite(int32 SectionIndex, uint8 AttributeMask)
 {
-	USelectionSet *newSelectionSet = NewObject<USelectionSet>(this);
+	CaptureSectionForSnapshots(SectionIndex, AttributeMask, false);
+	MarkSectionModified(SectionIndex, AttributeMask);
+}
 
-	// Iterate over the sections, and the vertices in each section.
-	float distanceFromSpline;
-	float distanceBias;
-	FVector closestPointOnSpline;
-	float selectionRadius = outerRadius - innerRadius;
-
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			// Convert the vertex location to local space- and then get the nearest point on the spline in local space.
-			closestPointOnSpline = spline->FindLocationClosestToWorldLocation(
-				transform.TransformPosition(vertex),
-				ESplineCoordinateSpace::Local
-			);
-			distanceFromSpline = (vertex - closestPointOnSpline).Size();
-			// Apply bias to map distance to 0-1 based on innerRadius and outerRadius
-			distanceBias = 1.0f - FMath::Clamp((distanceFromSpline - innerRadius) / selectionRadius, 0.0f, 1.0f);
-			newSelectionSet->weights.Emplace(distanceBias);
+void UMeshGeometry::MarkSectionModified(int32 SectionIndex, uint8 AttributeMask)
+{
+	if (SectionStates.Num() <= SectionIndex) {
+		SectionStates.SetNum(SectionIndex + 1);
+	}
+
+	// Every change gets a new version, so versions are never reused even if the section is replaced.
+	++LatestVersion;
+	FMeshGeometrySectionState &state = SectionStates[SectionIndex];
+	for (int32 attribute = 0; attribute < MeshGeometryAttributeCount; ++attribute) {
+		if (AttributeMask & (1 << attribute)) {
+			state.AttributeVersions[attribute] = LatestVersion;
 		}
 	}
+	state.DirtyAttributes |= AttributeMask;
+}
 
-	return newSelectionSet;
+int32 UMeshGeometry::GetAttributeVersion(int32 SectionIndex, EMeshGeometryAttribute Attribute) const
+{
+	return SectionStates.IsValidIndex(SectionIndex) ? SectionStates[SectionIndex].AttributeVersions[(uint8)Attribute] : 0;
 }
 
-USelectionSet * UMeshGeometry::SelectNearLine(FVector lineStart, FVector lineEnd, float innerRadius /*=0*/, float outerRadius/*= 100*/, bool lineIsInfinite/* = false */)
+int32 UMeshGeometry::GetSectionVersion(int32 SectionIndex) const
 {
-	USelectionSet *newSelectionSet = NewObject<USelectionSet>(this);
+	int32 sectionVersion = 0;
+	for (int32 attribute = 0; attribute < MeshGeometryAttributeCount; ++attribute) {
+		sectionVersion = FMath::Max(sectionVersion, GetAttributeVersion(SectionIndex, (EMeshGeometryAttribute)attribute));
+	}
+	return sectionVersion;
+}
 
-	// Iterate over the sections, and the vertices in each section.
-	FVector nearestPointOnLine;
-	float distanceToLine;
-	float distanceBias;
-	float selectionRadius = outerRadius - innerRadius;
-
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			// Get the distance from the line based on whether we're looking at an infinite line or not.
-			if (lineIsInfinite) {
-				nearestPointOnLine = FMath::ClosestPointOnInfiniteLine(lineStart, lineEnd, vertex);
-			} else {
-				nearestPointOnLine = FMath::ClosestPointOnLine(lineStart, lineEnd, vertex);
+int32 UMeshGeometry::GetLatestVersion() const
+{
+	return LatestVersion;
+}
+
+void UMeshGeometry::GetPositionsVersions(TArray<int32> &OutVersions) const
+{
+	GetAttributeVersions(EMeshGeometryAttribute::Positions, OutVersions);
+}
+
+void UMeshGeometry::GetAttributeVersions(EMeshGeometryAttribute Attribute, TArray<int32> &OutVersions) const
+{
+	OutVersions.SetNumUninitialized(this->sections.Num());
+	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+		OutVersions[sectionIndex] = GetAttributeVersion(sectionIndex, Attribute);
+	}
+}
+
+void UMeshGeometry::ClearSelectionCache()
+{
+	CachedSelections.Empty();
+}
+
+USelectionSet *UMeshGeometry::FindOrAddCachedSelection(
+	FName Function, EMeshGeometryAttribute Attribute, TArray<uint8> &&Arguments, TFunctionRef<USelectionSet *()> Select
+) {
+	if (!bCacheSelections || MaxCachedSelections <= 0) {
+		CachedSelections.Empty();
+		return Select();
+	}
+
+	// The versions are of the vertices as they'll be selected from, after any recorded deformations.
+	FlushDeformations();
+	TArray<int32> attributeVersions[MeshGeometryAttributeCount];
+	uint8 foundVersions = 0;
+	auto getVersions = [&](EMeshGeometryAttribute VersionsAttribute) -> const TArray<int32> & {
+		if (!(foundVersions & GetAttributeMask(VersionsAttribute))) {
+			GetAttributeVersions(VersionsAttribute, attributeVersions[(uint8)VersionsAttribute]);
+			foundVersions |= GetAttributeMask(VersionsAttribute);
+		}
+		return attributeVersions[(uint8)VersionsAttribute];
+	};
+
+	// Drop every selection made from vertices which have changed since, as none of those can be
+	// returned again.
+	CachedSelections.RemoveAll([&](const FMeshGeometryCachedSelection &Cached) {
+		return !Cached.Weights.IsValid() || Cached.Versions != getVersions(Cached.Attribute);
+	});
+
+	const uint32 argumentsHash = FCrc::MemCrc32(Arguments.GetData(), Arguments.Num());
+	for (FMeshGeometryCachedSelection &cached : CachedSelections) {
+		if (cached.Function == Function && cached.Attribute == Attribute && cached.ArgumentsHash == argumentsHash && cached.Arguments == Arguments) {
+			cached.LastUsed = ++SelectionCacheUseCount;
+			USelectionSet *selection = NewObject<USelectionSet>(this);
+			selection->SetShared(cached.Weights);
+			return selection;
+		}
+	}
+
+	// *Select* can call other *Select* functions, which may change *CachedSelections*.
+	USelectionSet *selection = Select();
+	if (!selection) {
+		return nullptr;
+	}
+
+	while (CachedSelections.Num() >= MaxCachedSelections) {
+		int32 oldest = 0;
+		for (int32 index = 1; index < CachedSelections.Num(); ++index) {
+			if (CachedSelections[index].LastUsed < CachedSelections[oldest].LastUsed) {
+				oldest = index;
 			}
-			// Apply bias to map distance to 0-1 based on innerRadius and outerRadius
-			distanceToLine = (vertex - nearestPointOnLine).Size();
-			distanceBias = 1.0f - FMath::Clamp((distanceToLine - innerRadius) / selectionRadius, 0.0f, 1.0f);
-			newSelectionSet->weights.Emplace(distanceBias);
 		}
+		CachedSelections.RemoveAt(oldest);
 	}
 
-	return newSelectionSet;
+	FMeshGeometryCachedSelection cached;
+	cached.Function = Function;
+	cached.Arguments = MoveTemp(Arguments);
+	cached.ArgumentsHash = argumentsHash;
+	cached.Attribute = Attribute;
+	cached.Versions = getVersions(Attribute);
+	cached.LastUsed = ++SelectionCacheUseCount;
+
+	// The selection's weights are moved to where every caller given it can share them, and a
+	// caller changing its selection in place copies them first, so never changes anyone else's.
+	cached.Weights = selection->Share();
+	CachedSelections.Add(MoveTemp(cached));
+	return selection;
 }
 
-USelectionSet * UMeshGeometry::SelectFacing(FVector Facing /*= FVector::UpVector*/, float InnerRadiusInDegrees /*= 0*/, float OuterRadiusInDegrees /*= 30.0f*/)
+const FVertexGrid *UMeshGeometry::GetSpatialIndex()
 {
-	// TODO: Check geometry looks valid (normals.Num == vertices.Num)
-	USelectionSet *newSelectionSet = NewObject<USelectionSet>(this);
-	
-	// Normalize the facing vector.
-	if (!Facing.Normalize()) {
-		// TODO: Better error handling.
-		return newSelectionSet;
+	// Below this many vertices visiting every vertex is cheap enough that the index isn't worth its memory.
+	static const int32 MinSpatialIndexVertexCount = 16384;
+
+	const int32 vertexCount = this->TotalVertexCount();
+	if (!bUseSpatialIndex || vertexCount < MinSpatialIndexVertexCount) {
+		return nullptr;
 	}
 
-	// Iterate over the sections, and the the normals in the sections.
-	float selectionRadius = OuterRadiusInDegrees - InnerRadiusInDegrees;
-	float angleBias;
-	float angleToNormal;
-	FVector normalizedNormal;
-	// As we need normals to we'll use an index-based for loop here for verts.
-	for (auto &section : this->sections) {
-		for (auto normal : section.normals) {
-			normalizedNormal = normal;
-
-			if (normalizedNormal.Normalize()) {
-				// Calculate the dot product between the normal and the Facing.
-				angleToNormal = FMath::RadiansToDegrees(FMath::Acos(FVector::DotProduct(normal, Facing)));
-				angleBias = 1.0f - FMath::Clamp((angleToNormal - InnerRadiusInDegrees) / selectionRadius, 0.0f, 1.0f);
-				newSelectionSet->weights.Emplace(angleBias);
-			} else {
-				newSelectionSet->weights.Emplace(0);
+	TArray<int32> positionsVersions;
+	GetPositionsVersions(positionsVersions);
+	if (positionsVersions == SpatialIndexVersions && SpatialIndex.GetVertexCount() == vertexCount) {
+		return &SpatialIndex;
+	}
+
+	// Building the index costs several brute force selections, so only do it once the positions
+	// have gone unchanged between two selections.  Meshes deformed after every selection never pay for it.
+	if (positionsVersions != SpatialIndexRequestVersions) {
+		SpatialIndexRequestVersions = MoveTemp(positionsVersions);
+		SpatialIndex.Reset();
+		SpatialIndexVersions.Empty();
+		return nullptr;
+	}
+
+	const TArray<int32> &sectionVertexOffsets = GetSectionVertexOffsets();
+	TArray<FVertexGrid::FSource> sources;
+	sources.SetNumUninitialized(this->sections.Num());
+	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+		TArray<FVector> &vertices = this->sections[sectionIndex].vertices;
+		sources[sectionIndex] = { GetVectorArrayData(vertices), vertices.Num(), sectionVertexOffsets[sectionIndex] };
+	}
+	SpatialIndex.Build(sources.GetData(), sources.Num());
+	SpatialIndexVersions = MoveTemp(positionsVersions);
+	return &SpatialIndex;
+}
+
+uint8 UMeshGeometry::GetDirtyAttributes(int32 SectionIndex) const
+{
+	return SectionStates.IsValidIndex(SectionIndex) ? SectionStates[SectionIndex].DirtyAttributes : 0;
+}
+
+bool UMeshGeometry::IsAttributeDirty(int32 SectionIndex, EMeshGeometryAttribute Attribute) const
+{
+	return (GetDirtyAttributes(SectionIndex) & GetAttributeMask(Attribute)) != 0;
+}
+
+bool UMeshGeometry::IsSectionDirty(int32 SectionIndex) const
+{
+	return GetDirtyAttributes(SectionIndex) != 0;
+}
+
+void UMeshGeometry::ClearDirty()
+{
+	for (auto &state : SectionStates) {
+		state.DirtyAttributes = 0;
+	}
+}
+
+void UMeshGeometry::PrepareAllSectionsForWrite(uint8 AttributeMask)
+{
+	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+		PrepareSectionForWrite(sectionIndex, AttributeMask);
+	}
+}
+
+void UMeshGeometry::CaptureSectionForSnapshots(int32 SectionIndex, uint8 AttributeMask, bool bMoveData)
+{
+	// Forget about any snapshots which have been destroyed.
+	LiveSnapshots.RemoveAll([](const TWeakObjectPtr<UMeshGeometrySnapshot> &Snapshot) {
+		return !Snapshot.IsValid();
+	});
+	if (LiveSnapshots.Num() == 0) {
+		return;
+	}
+
+	// Every snapshot which hasn't already captured an attribute shares a single copy of it.
+	FSectionGeometry &section = this->sections[SectionIndex];
+	ForEachSnapshotAttribute([&](EMeshGeometryAttribute Attribute, auto SectionMember, auto SnapshotMember) {
+		if (!(AttributeMask & GetAttributeMask(Attribute))) {
+			return;
+		}
+
+		auto &liveData = section.*SectionMember;
+		typedef typename TDecay<decltype(liveData)>::Type ArrayType;
+		TSharedPtr<ArrayType> capturedData;
+		for (const auto &weakSnapshot : LiveSnapshots) {
+			UMeshGeometrySnapshot *snapshot = weakSnapshot.Get();
+			if (!snapshot->Sections.IsValidIndex(SectionIndex)) {
+				continue;
 			}
+			auto &snapshotData = snapshot->Sections[SectionIndex].*SnapshotMember;
+			if (snapshotData.IsValid()) {
+				continue;
+			}
+			if (!capturedData.IsValid()) {
+				capturedData = bMoveData ? MakeShareable(new ArrayType(MoveTemp(liveData))) : MakeShareable(new ArrayType(liveData));
+			}
+			snapshotData = capturedData;
+		}
+	});
+}
+
+void UMeshGeometry::BeginDeformationBatch()
+{
+	bRecordingDeformations = true;
+}
+
+void UMeshGeometry::ExecuteDeformationBatch()
+{
+	bRecordingDeformations = false;
+	FlushDeformations();
+}
+
+void UMeshGeometry::ExecuteDeformationBatchAsync()
+{
+	bRecordingDeformations = false;
+
+	// Only one batch runs at a time, so finish off any previous one first.
+	WaitForAsyncDeformation();
+	if (PendingDeformations.IsEmpty()) {
+		return;
+	}
+
+	// The worker has its own copy of the commands, and of the vertices to deform.  The back buffer
+	// is kept between batches so the allocations can be reused.
+	AsyncDeformations = MoveTemp(PendingDeformations);
+	PendingDeformations.Reset();
+	const bool needsNormals = AsyncDeformations.NeedsNormals();
+	AsyncBackBuffer.SetNum(this->sections.Num());
+	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+		AsyncBackBuffer[sectionIndex].vertices = this->sections[sectionIndex].vertices;
+		if (needsNormals) {
+			AsyncBackBuffer[sectionIndex].normals = this->sections[sectionIndex].normals;
+		} else {
+			AsyncBackBuffer[sectionIndex].normals.Reset();
 		}
 	}
 
+	const TArray<int32> sectionVertexOffsets = GetSectionVertexOffsets();
+	const int32 batchSize = ParallelBatchSize;
+	const bool allowParallel = bAllowParallel;
+	bAsyncDeformationInProgress = true;
+	AsyncDeformationResult = Async<void>(EAsyncExecution::ThreadPool, [this, sectionVertexOffsets, batchSize, allowParallel]() {
+		AsyncDeformations.Apply(AsyncBackBuffer, sectionVertexOffsets, batchSize, allowParallel);
+	});
+}
+
+bool UMeshGeometry::IsAsyncDeformationInProgress() const
+{
+	return bAsyncDeformationInProgress;
+}
+
+bool UMeshGeometry::PollAsyncDeformation()
+{
+	if (!bAsyncDeformationInProgress || !AsyncDeformationResult.IsReady()) {
+		return false;
+	}
+	CompleteAsyncDeformation();
+	return true;
+}
+
+void UMeshGeometry::WaitForAsyncDeformation()
+{
+	if (!bAsyncDeformationInProgress) {
+		return;
+	}
+	AsyncDeformationResult.Wait();
+	CompleteAsyncDeformation();
+}
+
+void UMeshGeometry::CompleteAsyncDeformation()
+{
+	AsyncDeformationResult = TFuture<void>();
+	AsyncDeformations.Reset();
+	bAsyncDeformationInProgress = false;
+
+	// Anything which changes the sections waits for the worker first, so the back buffer still
+	// matches them and the vertices can just be swapped over.
+	PrepareAllSectionsForWrite(GetAttributeMask(EMeshGeometryAttribute::Positions));
+	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+		Swap(this->sections[sectionIndex].vertices, AsyncBackBuffer[sectionIndex].vertices);
+	}
+}
+
+void UMeshGeometry::BeginDestroy()
+{
+	// The worker thread mustn't be left using our data.
+	if (bAsyncDeformationInProgress) {
+		AsyncDeformationResult.Wait();
+	}
+	Super::BeginDestroy();
+}
+
+bool UMeshGeometry::IsRecordingDeformations() const
+{
+	return bRecordingDeformations;
+}
+
+void UMeshGeometry::FlushDeformations()
+{
+	if (PendingDeformations.IsEmpty()) {
+		return;
+	}
+	WaitForAsyncDeformation();
+	PrepareAllSectionsForWrite(GetAttributeMask(EMeshGeometryAttribute::Positions));
+	PendingDeformations.Execute(this->sections, GetSectionVertexOffsets(), ParallelBatchSize, bAllowParallel);
+}
+
+void UMeshGeometry::ApplyDeformation(const FDeformationCommand &Command)
+{
+	PendingDeformations.Add(Command);
+	if (!bRecordingDeformations) {
+		FlushDeformations();
+	}
+}
+
+USelectionSet *UMeshGeometry::SelectAll()
+{
+	TArray<uint8> arguments = MakeSelectionArguments();
+	return FindOrAddCachedSelection(TEXT("SelectAll"), EMeshGeometryAttribute::Positions, MoveTemp(arguments), [&]() -> USelectionSet * {
+		FlushDeformations();
+		USelectionSet *newSelectionSet = NewObject<USelectionSet>(this);
+		newSelectionSet->ResetDense(this->TotalVertexCount());
+		newSelectionSet->SetAllWeights(1.0f);
+		return newSelectionSet;
+	});
+}
+
+USelectionSet * UMeshGeometry::SelectNear(FVector center /*=FVector::ZeroVector*/, float innerRadius/*=0*/, float outerRadius/*=100*/)
+{
+	TArray<uint8> arguments = MakeSelectionArguments(center, innerRadius, outerRadius, bProduceSparseSelections);
+	return FindOrAddCachedSelection(TEXT("SelectNear"), EMeshGeometryAttribute::Positions, MoveTemp(arguments), [&]() -> USelectionSet * {
+		FlushDeformations();
+		auto selectChunk = [&](const FVertexChunk &Chunk, float *OutWeights) {
+			SelectionKernels::SelectNear(
+				GetVectorArrayData(this->sections[Chunk.SectionIndex].vertices) + Chunk.FirstVertex * 3, Chunk.VertexCount,
+				&center.X, innerRadius, outerRadius, OutWeights
+			);
+		};
+
+		// Only the vertices near the center have any weight, so if there's a spatial index just visit those.
+		const FVertexGrid *spatialIndex = GetSpatialIndex();
+		if (bProduceSparseSelections) {
+			std::vector<int> sparseIndices;
+			std::vector<float> sparseWeights;
+			if (spatialIndex && SelectionKernels::SelectNear(*spatialIndex, &center.X, innerRadius, outerRadius, sparseIndices, sparseWeights)) {
+				return CreateSparseSelectionSet(this, sparseIndices, sparseWeights);
+			}
+			return CreateSparseSelectionSet(this, selectChunk);
+		}
+
+		USelectionSet *newSelectionSet = CreateUninitializedSelectionSet(this);
+		float *weights = newSelectionSet->weights.GetData();
+		if (spatialIndex && SelectionKernels::SelectNear(*spatialIndex, &center.X, innerRadius, outerRadius, weights)) {
+			return newSelectionSet;
+		}
+
+		// Iterate over the chunks of each section, weighting the vertices in each chunk.
+		ParallelForVertices(this, [&](const FVertexChunk &Chunk) {
+			selectChunk(Chunk, weights + Chunk.FirstWeightIndex);
+		});
+
+		return newSelectionSet;
+	});
+}
+
+/// The most times a span of the spline between two of its points is halved when sampling it,
+/// which limits it to 4096 segments.
+static const int32 MaxSplineSampleDepth = 12;
+
+USelectionSet * UMeshGeometry::SelectNearSpline(USplineComponent *spline, FTransform transform, float innerRadius /*= 0*/, float outerRadius /*= 100*/, float tolerance /*= 1.0f*/)
+{
+	if (!spline) {
+		UE_LOG(LogTemp, Warning, TEXT("SelectNearSpline: No spline provided"));
+		return nullptr;
+	}
+	FlushDeformations();
+
+	// Sample the spline once into a polyline in its local space, with a hierarchy over the segments,
+	// rather than searching the spline itself for every vertex.  The spline points are always
+	// sampled so that any corners at them are kept.
+	TArray<float> breaks;
+	const int32 splinePointCount = spline->GetNumberOfSplinePoints();
+	for (int32 pointIndex = 0; pointIndex < splinePointCount; ++pointIndex) {
+		breaks.Add(spline->GetDistanceAlongSplineAtSplinePoint(pointIndex));
+	}
+	const float splineLength = spline->GetSplineLength();
+	if (breaks.Num() == 0 || breaks.Last() < splineLength) {
+		// Closed loops finish back at the first point.
+		breaks.Add(splineLength);
+	}
+
+	std::vector<float> polylinePoints;
+	FPolylineIndex::SampleCurve(
+		[spline](float distance, float OutPoint[3]) {
+			const FVector location = spline->GetLocationAtDistanceAlongSpline(distance, ESplineCoordinateSpace::Local);
+			OutPoint[0] = location.X;
+			OutPoint[1] = location.Y;
+			OutPoint[2] = location.Z;
+		},
+		breaks.GetData(), breaks.Num(), tolerance, MaxSplineSampleDepth, polylinePoints
+	);
+	FPolylineIndex polyline;
+	polyline.Build(polylinePoints.data(), (int)(polylinePoints.size() / 3));
+
+	// Vertices are taken to world space by the transform and from there into the spline's local
+	// space to find the closest point, which is then compared with the untransformed vertex.
+	const FMatrix queryTransform = transform.ToMatrixWithScale() * spline->GetComponentTransform().ToInverseMatrixWithScale();
+	float queryMatrix[12];
+	MakeAffineMatrix(
+		[&queryTransform](const FVector &Vector) { return queryTransform.TransformVector(Vector); },
+		FVector::ZeroVector, queryTransform.GetOrigin(), queryMatrix
+	);
+
+	// The polyline is only read so this is safe to do across threads.
+	auto selectChunk = [&](const FVertexChunk &Chunk, float *OutWeights) {
+		SelectionKernels::SelectNearPolyline(
+			polyline, GetVectorArrayData(this->sections[Chunk.SectionIndex].vertices) + Chunk.FirstVertex * 3, Chunk.VertexCount,
+			queryMatrix, innerRadius, outerRadius, OutWeights
+		);
+	};
+	if (bProduceSparseSelections) {
+		return CreateSparseSelectionSet(this, selectChunk);
+	}
+
+	USelectionSet *newSelectionSet = CreateUninitializedSelectionSet(this);
+	float *weights = newSelectionSet->weights.GetData();
+	ParallelForVertices(this, [&](const FVertexChunk &Chunk) {
+		selectChunk(Chunk, weights + Chunk.FirstWeightIndex);
+	});
+
 	return newSelectionSet;
 }
 
+USelectionSet * UMeshGeometry::SelectNearLine(FVector lineStart, FVector lineEnd, float innerRadius /*=0*/, float outerRadius/*= 100*/, bool lineIsInfinite/* = false */)
+{
+	TArray<uint8> arguments = MakeSelectionArguments(lineStart, lineEnd, innerRadius, outerRadius, lineIsInfinite, bProduceSparseSelections);
+	return FindOrAddCachedSelection(TEXT("SelectNearLine"), EMeshGeometryAttribute::Positions, MoveTemp(arguments), [&]() -> USelectionSet * {
+		FlushDeformations();
+		auto selectChunk = [&](const FVertexChunk &Chunk, float *OutWeights) {
+			SelectionKernels::SelectNearLine(
+				GetVectorArrayData(this->sections[Chunk.SectionIndex].vertices) + Chunk.FirstVertex * 3, Chunk.VertexCount,
+				&lineStart.X, &lineEnd.X, lineIsInfinite, innerRadius, outerRadius, OutWeights
+			);
+		};
+
+		// An infinite line can pass near any vertex, but a finite one can use the spatial index like *SelectNear*.
+		const FVertexGrid *spatialIndex = lineIsInfinite ? nullptr : GetSpatialIndex();
+		if (bProduceSparseSelections) {
+			std::vector<int> sparseIndices;
+			std::vector<float> sparseWeights;
+			if (spatialIndex && SelectionKernels::SelectNearLine(*spatialIndex, &lineStart.X, &lineEnd.X, innerRadius, outerRadius, sparseIndices, sparseWeights)) {
+				return CreateSparseSelectionSet(this, sparseIndices, sparseWeights);
+			}
+			return CreateSparseSelectionSet(this, selectChunk);
+		}
+
+		USelectionSet *newSelectionSet = CreateUninitializedSelectionSet(this);
+		float *weights = newSelectionSet->weights.GetData();
+		if (spatialIndex && SelectionKernels::SelectNearLine(*spatialIndex, &lineStart.X, &lineEnd.X, innerRadius, outerRadius, weights)) {
+			return newSelectionSet;
+		}
+
+		// Iterate over the chunks of each section, weighting the vertices in each chunk.
+		ParallelForVertices(this, [&](const FVertexChunk &Chunk) {
+			selectChunk(Chunk, weights + Chunk.FirstWeightIndex);
+		});
+
+		return newSelectionSet;
+	});
+}
+
+USelectionSet * UMeshGeometry::SelectFacing(FVector Facing /*= FVector::UpVector*/, float InnerRadiusInDegrees /*= 0*/, float OuterRadiusInDegrees /*= 30.0f*/)
+{
+	TArray<uint8> arguments = MakeSelectionArguments(Facing, InnerRadiusInDegrees, OuterRadiusInDegrees);
+	return FindOrAddCachedSelection(TEXT("SelectFacing"), EMeshGeometryAttribute::Normals, MoveTemp(arguments), [&]() -> USelectionSet * {
+		FlushDeformations();
+		USelectionSet *newSelectionSet = CreateUninitializedSelectionSet(this);
+	
+		// Normalize the facing vector.
+		if (!Facing.Normalize()) {
+			// TODO: Better error handling.
+			newSelectionSet->SetAllWeights(0.0f);
+			return newSelectionSet;
+		}
+
+		// Iterate over the chunks of each section, and the the normals in each chunk.  Any vertex
+		// without a normal is left unselected.
+		float *weights = newSelectionSet->weights.GetData();
+		ParallelForVertices(this, [&](const FVertexChunk &Chunk) {
+			const TArray<FVector> &normals = this->sections[Chunk.SectionIndex].normals;
+			const int32 normalCount = FMath::Clamp(normals.Num() - Chunk.FirstVertex, 0, Chunk.VertexCount);
+			if (normalCount > 0) {
+				SelectionKernels::SelectFacing(
+					GetVectorArrayData(normals) + Chunk.FirstVertex * 3, normalCount,
+					&Facing.X, InnerRadiusInDegrees, OuterRadiusInDegrees, weights + Chunk.FirstWeightIndex
+				);
+			}
+			for (int32 index = normalCount; index < Chunk.VertexCount; ++index) {
+				weights[Chunk.FirstWeightIndex + index] = 0.0f;
+			}
+		});
+
+		return newSelectionSet;
+	});
+}
+
+/// Set up a FastNoise from the parameters of the *SelectByNoise* functions.
+static void ConfigureSelectionNoise(
+	FastNoise &Noise, int32 Seed, float Frequency, ENoiseInterpolation NoiseInterpolation, ENoiseType NoiseType,
+	uint8 FractalOctaves, float FractalLacunarity, float FractalGain, EFractalType FractalType,
+	ECellularDistanceFunction CellularDistanceFunction
+) {
+	Noise.SetSeed(Seed);
+	Noise.SetFrequency(Frequency);
+	Noise.SetInterp((FastNoise::Interp)NoiseInterpolation);
+	Noise.SetNoiseType((FastNoise::NoiseType)NoiseType);
+	Noise.SetFractalOctaves(FractalOctaves);
+	Noise.SetFractalLacunarity(FractalLacunarity);
+	Noise.SetFractalGain(FractalGain);
+	Noise.SetFractalType((FastNoise::FractalType) FractalType);
+	Noise.SetCellularDistanceFunction((FastNoise::CellularDistanceFunction) CellularDistanceFunction);
+	/// \todo Is this needed.. ?  FastNoise doesn't seem to have a SetPositionWarpAmp param
+	///Noise.SetPositionWarpAmp(PositionWarpAmp);
+}
+
+/// The baked noise volumes shared by every geometry's *SelectByNoiseCached*
+static FNoiseVolumeCache &GetSelectionNoiseCache()
+{
+	static FNoiseVolumeCache Cache;
+	return Cache;
+}
+
+/// Find the cached volume *SelectByNoiseCached* samples a geometry's noise from, baking it if needed.
+///
+/// \return The volume, or null if it wouldn't fit in the cache's memory budget
+static std::shared_ptr<const FNoiseVolume> FindOrBakeSelectionNoise(
+	UMeshGeometry *MeshGeometry,
+	int32 Seed,
+	float Frequency,
+	ENoiseInterpolation NoiseInterpolation,
+	ENoiseType NoiseType,
+	uint8 FractalOctaves,
+	float FractalLacunarity,
+	float FractalGain,
+	EFractalType FractalType,
+	ECellularDistanceFunction CellularDistanceFunction,
+	int32 Resolution
+) {
+	// The box the vertices need the noise over, which alone decides the spacing of the samples.
+	float BoxMin[3] = { INFINITY, INFINITY, INFINITY };
+	float BoxMax[3] = { -INFINITY, -INFINITY, -INFINITY };
+	for (const FSectionGeometry &Section : MeshGeometry->sections) {
+		FNoiseVolume::ExpandBounds(GetVectorArrayData(Section.vertices), Section.vertices.Num(), BoxMin, BoxMax);
+	}
+	const float Spacing = FNoiseVolume::ChooseSpacing(BoxMin, BoxMax, Resolution);
+
+	// Every field is four bytes so there's no padding to leave uninitialized in the key.
+	const struct
+	{
+		int32 Seed;
+		float Frequency;
+		int32 NoiseInterpolation;
+		int32 NoiseType;
+		int32 FractalOctaves;
+		float FractalLacunarity;
+		float FractalGain;
+		int32 FractalType;
+		int32 CellularDistanceFunction;
+	} Settings = {
+		Seed, Frequency, (int32)NoiseInterpolation, (int32)NoiseType, FractalOctaves,
+		FractalLacunarity, FractalGain, (int32)FractalType, (int32)CellularDistanceFunction
+	};
+	const uint64 Key = FNoiseVolumeCache::HashBytes(&Settings, sizeof(Settings));
+
+	FNoiseVolumeCache &Cache = GetSelectionNoiseCache();
+	float BakeMin[3], BakeMax[3];
+	std::shared_ptr<const FNoiseVolume> Volume = Cache.Find(Key, Spacing, BoxMin, BoxMax, BakeMin, BakeMax);
+	if (!Volume) {
+		std::shared_ptr<FNoiseVolume> NewVolume = std::make_shared<FNoiseVolume>();
+		if (!NewVolume->Allocate(BakeMin, BakeMax, Spacing, Cache.GetMemoryBudget())) {
+			return nullptr;
+		}
+
+		// Bake a slice of the volume at a time, these only read the FastNoise so can share it.
+		FastNoise Noise;
+		ConfigureSelectionNoise(
+			Noise, Seed, Frequency, NoiseInterpolation, NoiseType,
+			FractalOctaves, FractalLacunarity, FractalGain, FractalType, CellularDistanceFunction
+		);
+		ParallelFor(NewVolume->GetSliceCount(), [&](int32 Slice) {
+			NewVolume->BakeSlice(Noise, Slice);
+		}, !MeshGeometry->bAllowParallel);
+		NewVolume->MeasureError(Noise);
+		UE_LOG(LogTemp, Log, TEXT("SelectByNoiseCached: Baked noise into %dx%dx%d samples %f apart, within %f of the noise"),
+			NewVolume->GetDimension(0), NewVolume->GetDimension(1), NewVolume->GetDimension(2), Spacing, NewVolume->GetMaxError());
+		Cache.Add(Key, NewVolume);
+		Volume = MoveTemp(NewVolume);
+	}
+	return Volume;
+}
+
 USelectionSet * UMeshGeometry::SelectByNoise(
 	int32 Seed /*= 1337*/,
 	float Frequency /*= 0.01*/,
@@ -231,38 +1124,130 @@ USelectionSet * UMeshGeometry::SelectByNoise(
 	EFractalType FractalType /*= EFractalType::FBM*/,
 	ECellularDistanceFunction CellularDistanceFunction /*= ECellularDistanceFunction::Euclidian*/
 ) {
-	USelectionSet *newSelectionSet = NewObject<USelectionSet>(this);
+	TArray<uint8> arguments = MakeSelectionArguments(
+		Seed, Frequency, NoiseInterpolation, NoiseType,
+		FractalOctaves, FractalLacunarity, FractalGain, FractalType, CellularDistanceFunction
+	);
+	return FindOrAddCachedSelection(TEXT("SelectByNoise"), EMeshGeometryAttribute::Positions, MoveTemp(arguments), [&]() -> USelectionSet * {
+		FlushDeformations();
+		USelectionSet *newSelectionSet = CreateUninitializedSelectionSet(this);
+
+		FastNoise noise;
+		ConfigureSelectionNoise(
+			noise, Seed, Frequency, NoiseInterpolation, NoiseType,
+			FractalOctaves, FractalLacunarity, FractalGain, FractalType, CellularDistanceFunction
+		);
 
-	// TODO: Lots of work here!
-	FastNoise noise;
-
-	// Set up all of the noise details from the parameters provided
-	noise.SetSeed(Seed);
-	noise.SetFrequency(Frequency);
-	noise.SetInterp((FastNoise::Interp)NoiseInterpolation);
-	noise.SetNoiseType((FastNoise::NoiseType)NoiseType);
-	noise.SetFractalOctaves(FractalOctaves);
-	noise.SetFractalLacunarity(FractalLacunarity);
-	noise.SetFractalGain(FractalGain);
-	noise.SetFractalType((FastNoise::FractalType) FractalType);
-	noise.SetCellularDistanceFunction((FastNoise::CellularDistanceFunction) CellularDistanceFunction);
-	/// \todo Is this needed.. ?  FastNoise doesn't seem to have a SetPositionWarpAmp param
-	///noise.SetPositionWarpAmp(PositionWarpAmp);
-
-	// Iterate over the sections, and the vertices in each section.
-	float NoiseValue;
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			NoiseValue = noise.GetNoise(vertex.X, vertex.Y, vertex.Z);
-			newSelectionSet->weights.Emplace(NoiseValue);
+		// Iterate over the chunks of each section, and the vertices in each chunk.  GetNoise doesn't
+		// modify the FastNoise object so it can be shared between threads.
+		float *Weights = newSelectionSet->weights.GetData();
+		ParallelForVertices(this, [&](const FVertexChunk &Chunk) {
+			SelectionKernels::SelectByNoise(
+				noise, GetVectorArrayData(this->sections[Chunk.SectionIndex].vertices) + Chunk.FirstVertex * 3,
+				Chunk.VertexCount, Weights + Chunk.FirstWeightIndex
+			);
+		});
+
+		return newSelectionSet;
+	});
+}
+
+USelectionSet * UMeshGeometry::SelectByNoiseCached(
+	int32 Seed /*= 1337*/,
+	float Frequency /*= 0.01*/,
+	ENoiseInterpolation NoiseInterpolation /*= ENoiseInterpolation::Quintic*/,
+	ENoiseType NoiseType /*= ENoiseType::Simplex */,
+	uint8 FractalOctaves /*= 3*/,
+	float FractalLacunarity /*= 2.0*/,
+	float FractalGain /*= 0.5*/,
+	EFractalType FractalType /*= EFractalType::FBM*/,
+	ECellularDistanceFunction CellularDistanceFunction /*= ECellularDistanceFunction::Euclidian*/,
+	int32 Resolution /*= 64*/
+) {
+	TArray<uint8> arguments = MakeSelectionArguments(
+		Seed, Frequency, NoiseInterpolation, NoiseType,
+		FractalOctaves, FractalLacunarity, FractalGain, FractalType, CellularDistanceFunction, Resolution
+	);
+	return FindOrAddCachedSelection(TEXT("SelectByNoiseCached"), EMeshGeometryAttribute::Positions, MoveTemp(arguments), [&]() -> USelectionSet * {
+		FlushDeformations();
+		if (Resolution < 2) {
+			UE_LOG(LogTemp, Warning, TEXT("SelectByNoiseCached: Resolution must be at least 2"));
+			return nullptr;
 		}
+
+		if (TotalVertexCount() == 0) {
+			return CreateUninitializedSelectionSet(this);
+		}
+		std::shared_ptr<const FNoiseVolume> Volume = FindOrBakeSelectionNoise(
+			this, Seed, Frequency, NoiseInterpolation, NoiseType,
+			FractalOctaves, FractalLacunarity, FractalGain, FractalType, CellularDistanceFunction, Resolution
+		);
+		if (!Volume) {
+			// The volume wouldn't fit in the cache, so evaluate the noise directly instead.
+			return SelectByNoise(
+				Seed, Frequency, NoiseInterpolation, NoiseType,
+				FractalOctaves, FractalLacunarity, FractalGain, FractalType, CellularDistanceFunction
+			);
+		}
+
+		USelectionSet *NewSelectionSet = CreateUninitializedSelectionSet(this);
+		float *Weights = NewSelectionSet->weights.GetData();
+		ParallelForVertices(this, [&](const FVertexChunk &Chunk) {
+			Volume->Sample(
+				GetVectorArrayData(this->sections[Chunk.SectionIndex].vertices) + Chunk.FirstVertex * 3,
+				Chunk.VertexCount, Weights + Chunk.FirstWeightIndex
+			);
+		});
+
+		return NewSelectionSet;
+	});
+}
+
+float UMeshGeometry::GetNoiseCacheError(
+	int32 Seed /*= 1337*/,
+	float Frequency /*= 0.01*/,
+	ENoiseInterpolation NoiseInterpolation /*= ENoiseInterpolation::Quintic*/,
+	ENoiseType NoiseType /*= ENoiseType::Simplex */,
+	uint8 FractalOctaves /*= 3*/,
+	float FractalLacunarity /*= 2.0*/,
+	float FractalGain /*= 0.5*/,
+	EFractalType FractalType /*= EFractalType::FBM*/,
+	ECellularDistanceFunction CellularDistanceFunction /*= ECellularDistanceFunction::Euclidian*/,
+	int32 Resolution /*= 64*/
+) {
+	FlushDeformations();
+	if (Resolution < 2) {
+		UE_LOG(LogTemp, Warning, TEXT("GetNoiseCacheError: Resolution must be at least 2"));
+		return 0.0f;
+	}
+	if (TotalVertexCount() == 0) {
+		return 0.0f;
 	}
+	std::shared_ptr<const FNoiseVolume> Volume = FindOrBakeSelectionNoise(
+		this, Seed, Frequency, NoiseInterpolation, NoiseType,
+		FractalOctaves, FractalLacunarity, FractalGain, FractalType, CellularDistanceFunction, Resolution
+	);
+	// A volume too big for the cache means SelectByNoiseCached evaluates the noise exactly.
+	return Volume ? Volume->GetMaxError() : 0.0f;
+}
 
-	return newSelectionSet;
+void UMeshGeometry::ClearNoiseCache()
+{
+	GetSelectionNoiseCache().Clear();
+}
+
+void UMeshGeometry::SetNoiseCacheMemoryBudget(int32 MegaBytes)
+{
+	if (MegaBytes < 0) {
+		UE_LOG(LogTemp, Warning, TEXT("SetNoiseCacheMemoryBudget: MegaBytes can't be negative"));
+		return;
+	}
+	GetSelectionNoiseCache().SetMemoryBudget((size_t)MegaBytes * 1024 * 1024);
 }
 
 USelectionSet * UMeshGeometry::SelectByTexture(UTexture2D *Texture2D, ETextureChannel TextureChannel /*=ETextureChannel::Red*/)
 {
+	FlushDeformations();
 	USelectionSet *newSelectionSet = NewObject<USelectionSet>(this);
 
 	// Check we have a texture and that it's in the right format
@@ -289,10 +1274,20 @@ USelectionSet * UMeshGeometry::SelectByTexture(UTexture2D *Texture2D, ETextureCh
 	}
 	FColor *colorArray = static_cast<FColor*>(BulkData->Lock(LOCK_READ_ONLY));
 
-	// Iterate over the sections, and the vertices in each section.
-	for (auto &section : this->sections) {
-		for (auto &uv : section.uvs) {
+	// Iterate over the chunks of each section, and the UVs in each chunk.  Any vertex without a UV
+	// is left unselected.
+	float *weights = newSelectionSet->ResetDense(this->TotalVertexCount());
+	ParallelForVertices(this, [&](const FVertexChunk &Chunk) {
+		const TArray<FVector2D> &uvs = this->sections[Chunk.SectionIndex].uvs;
+		for (int32 vertexIndex = Chunk.FirstVertex; vertexIndex < Chunk.FirstVertex + Chunk.VertexCount; ++vertexIndex) {
+			float &weight = weights[Chunk.FirstWeightIndex + vertexIndex - Chunk.FirstVertex];
+			if (!uvs.IsValidIndex(vertexIndex)) {
+				weight = 0.0f;
+				continue;
+			}
+
 			// Convert our UV to a texture index.
+			const FVector2D &uv = uvs[vertexIndex];
 			int32 textureX = (int32)FMath::RoundHalfFromZero(uv.X * textureWidth);
 			int32 textureY = (int32)FMath::RoundHalfFromZero(uv.Y * textureHeight);
 
@@ -302,28 +1297,24 @@ USelectionSet * UMeshGeometry::SelectByTexture(UTexture2D *Texture2D, ETextureCh
 
 			// Get the color and access the correct channel.
 			int32 index = (textureY * textureWidth) + textureX;
-			//UE_LOG(LogTemp, Log, TEXT("UV %f,%f = %d,%d (%d)"), uv.X, uv.Y, textureX, textureY, index);
-			
 			FLinearColor color = colorArray[index];
-			//UE_LOG(LogTemp, Log, TEXT("Color %f,%f,%f / %f"), color.R, color.G, color.B, color.A);
-			
+
 			switch (TextureChannel) {
 			case ETextureChannel::Red:
-				newSelectionSet->weights.Emplace(color.R);
+				weight = color.R;
 				break;
 			case ETextureChannel::Green:
-				newSelectionSet->weights.Emplace(color.G);
+				weight = color.G;
 				break;
 			case ETextureChannel::Blue:
-				newSelectionSet->weights.Emplace(color.B);
+				weight = color.B;
 				break;
 			case ETextureChannel::Alpha:
-				newSelectionSet->weights.Emplace(color.A);
+				weight = color.A;
 				break;
 			}
-			//newSelectionSet->weights.Emplace(0);
 		}
-	}
+	});
 
 	// Unlock the texture data
 	BulkData->Unlock();
@@ -333,67 +1324,75 @@ USelectionSet * UMeshGeometry::SelectByTexture(UTexture2D *Texture2D, ETextureCh
 
 USelectionSet * UMeshGeometry::SelectLinear(FVector LineStart, FVector LineEnd, bool Reverse /*= false*/, bool LimitToLine /*= false*/)
 {
+	TArray<uint8> arguments = MakeSelectionArguments(LineStart, LineEnd, Reverse, LimitToLine);
+	return FindOrAddCachedSelection(TEXT("SelectLinear"), EMeshGeometryAttribute::Positions, MoveTemp(arguments), [&]() -> USelectionSet * {
+		FlushDeformations();
 
-	USelectionSet *newSelectionSet = NewObject<USelectionSet>(this);
-
-	// Do the reverse if needed..
-	if (Reverse) {
-		FVector TmpVector = LineStart;
-		LineStart = LineEnd;
-		LineEnd = TmpVector;
-	}
+		USelectionSet *newSelectionSet = NewObject<USelectionSet>(this);
 
-	// Calculate the length of the line.
-	float LineLength = (LineEnd - LineStart).Size();
-	if (LineLength < 0.1) {
-		// Lines too close..
-		/// \todo Log error message..
-		return nullptr;
-	}
-
-	// Iterate over the sections, and the vertices in each section
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			// Get the nearest point on the line
-			FVector NearestPointOnLine = FMath::ClosestPointOnLine(LineStart, LineEnd, vertex);
+		// Do the reverse if needed..
+		if (Reverse) {
+			FVector TmpVector = LineStart;
+			LineStart = LineEnd;
+			LineEnd = TmpVector;
+		}
 
-			// If we've hit one of the end points then return the limits
-			if (NearestPointOnLine == LineEnd) {
-				newSelectionSet->weights.Emplace(LimitToLine ? 0.0f : 1.0f);
-			}
-			else if (NearestPointOnLine == LineStart) {
-				newSelectionSet->weights.Emplace(0.0f);
-			}
-			else {
-				// Get the distance to the two start point- it's the ratio we're after.
-				float DistanceToLineStart = (NearestPointOnLine - LineStart).Size();
-				newSelectionSet->weights.Emplace(DistanceToLineStart / LineLength);
-			}
+		// Calculate the length of the line.
+		float LineLength = (LineEnd - LineStart).Size();
+		if (LineLength < 0.1) {
+			// Lines too close..
+			/// \todo Log error message..
+			return nullptr;
 		}
-	}
 
-	return newSelectionSet;
+		// Iterate over the chunks of each section, and the vertices in each chunk
+		float *Weights = newSelectionSet->ResetDense(this->TotalVertexCount());
+		ParallelForVertices(this, [&](const FVertexChunk &Chunk) {
+			SelectionKernels::SelectLinear(
+				GetVectorArrayData(this->sections[Chunk.SectionIndex].vertices) + Chunk.FirstVertex * 3, Chunk.VertexCount,
+				&LineStart.X, &LineEnd.X, LimitToLine, Weights + Chunk.FirstWeightIndex
+			);
+		});
+
+		return newSelectionSet;
+	});
 }
 
 void UMeshGeometry::Jitter(FRandomStream &randomStream, FVector min, FVector max, USelectionSet *selection /*=nullptr*/)
 {
-	// TODO: Check selectionSet size.
+	if (!SelectionIsValid(this, selection, TEXT("Jitter"))) {
+		return;
+	}
+
+	// An async batch may still be reading the selection, so wait for it before the selection
+	// is made dense.
+	FlushDeformations();
+	WaitForAsyncDeformation();
+
+	// Every vertex draws from the stream whatever its weight, so this needs every weight.  Dense
+	// floats, even shared ones, can be read as they are.
+	if (selection && (selection->IsSparse() || selection->GetPrecision() != ESelectionSetPrecision::Float)) {
+		selection->EnsureDense();
+	}
+	PrepareAllSectionsForWrite(GetAttributeMask(EMeshGeometryAttribute::Positions));
 
 	// Iterate over the sections, and the the vertices in the sections.
-	int32 nextSelectionIndex = 0;
+	//
+	// This stays as a serial scalar loop as the random numbers have to be drawn from the stream in order.
 	FVector randomJitter;
-	// Iterate over the sections, and the vertices in each section.
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
+	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+		TArray<FVector> &vertices = this->sections[sectionIndex].vertices;
+		const float *weights = GetSectionWeights(selection, sectionIndex);
+		for (int32 vertexIndex = 0; vertexIndex < vertices.Num(); ++vertexIndex) {
 			randomJitter = FVector(
 				randomStream.FRandRange(min.X, max.X),
 				randomStream.FRandRange(min.Y, max.Y),
 				randomStream.FRandRange(min.Z, max.Z)
 			);
-			vertex = FMath::Lerp(
-				vertex,
-				vertex + randomJitter,
-				selection ? selection->weights[nextSelectionIndex++] : 1.0f
+			vertices[vertexIndex] = FMath::Lerp(
+				vertices[vertexIndex],
+				vertices[vertexIndex] + randomJitter,
+				weights ? weights[vertexIndex] : 1.0f
 			);
 		}
 	}
@@ -401,132 +1400,132 @@ void UMeshGeometry::Jitter(FRandomStream &randomStream, FVector min, FVector max
 
 void UMeshGeometry::Translate(FVector delta, USelectionSet *selection)
 {
-	// TODO: Check selectionSet size.
-
-	// Iterate over the sections, and the the vertices in the sections.
-	int32 nextSelectionIndex = 0;
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			vertex = FMath::Lerp(
-				vertex,
-				vertex + delta,
-				selection ? selection->weights[nextSelectionIndex++] : 1.0f
-			);
-		}
+	if (!SelectionIsValid(this, selection, TEXT("Translate"))) {
+		return;
 	}
+
+	FDeformationCommand Command;
+	Command.Type = EDeformationCommandType::Translate;
+	Command.Vector0 = delta;
+	Command.Selection = selection;
+	ApplyDeformation(Command);
 }
 
 void UMeshGeometry::Rotate(FRotator Rotation /*= FRotator::ZeroRotator*/, FVector CenterOfRotation /*= FVector::ZeroVector*/, USelectionSet *Selection)
 {
-	// TODO: Check SelectionSet size.
-
-	// Iterate over the sections, and the the vertices in the sections.
-	int32 nextSelectionIndex = 0;
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			vertex = FMath::Lerp(
-				vertex,
-				CenterOfRotation + Rotation.RotateVector(vertex - CenterOfRotation),
-				Selection ? Selection->weights[nextSelectionIndex++] : 1.0f
-			);
-		}
+	if (!SelectionIsValid(this, Selection, TEXT("Rotate"))) {
+		return;
 	}
+
+	FDeformationCommand Command;
+	Command.Type = EDeformationCommandType::Affine;
+	Command.Selection = Selection;
+	MakeAffineMatrix(
+		[&Rotation](const FVector &Offset) { return Rotation.RotateVector(Offset); },
+		CenterOfRotation, FVector::ZeroVector, Command.Matrix
+	);
+	ApplyDeformation(Command);
 }
 
 void UMeshGeometry::Scale(FVector Scale3d /*= FVector(1, 1, 1)*/, FVector CenterOfScale /*= FVector::ZeroVector*/, USelectionSet *Selection /*= nullptr*/)
 {
-	// TODO: Check selectionSet size.
-
-	// Iterate over the sections, and the the vertices in the sections.
-	int32 nextSelectionIndex = 0;
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			vertex = FMath::Lerp(
-				vertex,
-				CenterOfScale + (vertex - CenterOfScale) * Scale3d,
-				Selection ? Selection->weights[nextSelectionIndex++] : 1.0f
-			);
-		}
+	if (!SelectionIsValid(this, Selection, TEXT("Scale"))) {
+		return;
 	}
+
+	FDeformationCommand Command;
+	Command.Type = EDeformationCommandType::Affine;
+	Command.Selection = Selection;
+	MakeAffineMatrix(
+		[&Scale3d](const FVector &Offset) { return Offset * Scale3d; },
+		CenterOfScale, FVector::ZeroVector, Command.Matrix
+	);
+	ApplyDeformation(Command);
 }
 
 void UMeshGeometry::Transform(FTransform Transform /*= FTransform::Identity*/, FVector CenterOfTransform /*= FVector::ZeroVector*/, USelectionSet *Selection /*= nullptr*/)
 {
-	// TODO: Check selectionSet size.
-
-	// Iterate over the sections, and the the vertices in the sections.
-	int32 nextSelectionIndex = 0;
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			vertex = FMath::Lerp(
-				vertex,
-				CenterOfTransform + Transform.TransformPosition(vertex - CenterOfTransform),
-				Selection ? Selection->weights[nextSelectionIndex++] : 1.0f
-			);
-		}
+	if (!SelectionIsValid(this, Selection, TEXT("Transform"))) {
+		return;
 	}
+
+	// TransformPosition is Scale/Rotate followed by the translation, so split it up that way.
+	FDeformationCommand Command;
+	Command.Type = EDeformationCommandType::Affine;
+	Command.Selection = Selection;
+	MakeAffineMatrix(
+		[&Transform](const FVector &Offset) { return Transform.TransformVector(Offset); },
+		CenterOfTransform, Transform.GetTranslation(), Command.Matrix
+	);
+	ApplyDeformation(Command);
 }
 
 void UMeshGeometry::Spherize(float SphereRadius /*= 100.0f*/, float FilterStrength /*= 1.0f*/, FVector SphereCenter /*= FVector::ZeroVector*/, USelectionSet *Selection)
 {
-	// TODO: Check selectionSet size.
-
-	// Iterate over the sections, and the the vertices in the sections.
-	int32 nextSelectionIndex = 0;
-	FVector vertexRelativeToCenter;
-	float targetVectorLength;
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			vertexRelativeToCenter = vertex - SphereCenter;
-			// Calculate the required length- incorporating both the SphereRadius and Selection.
-			targetVectorLength = FMath::Lerp(vertexRelativeToCenter.Size(), SphereRadius, FilterStrength * (Selection ? Selection->weights[nextSelectionIndex++] : 1.0f));
-			// TODO: Think what happens when this fails?
-			if (vertexRelativeToCenter.Normalize()) {
-				vertex = SphereCenter + (vertexRelativeToCenter * targetVectorLength);
-			}
-		}
+	if (!SelectionIsValid(this, Selection, TEXT("Spherize"))) {
+		return;
 	}
+
+	// Vertices at the center of the sphere can't be normalized, and so are left where they are.
+	FDeformationCommand Command;
+	Command.Type = EDeformationCommandType::Spherize;
+	Command.Vector0 = SphereCenter;
+	Command.Scalar0 = SphereRadius;
+	Command.Scalar1 = FilterStrength;
+	Command.Selection = Selection;
+	ApplyDeformation(Command);
 }
 
 void UMeshGeometry::Inflate(float Offset /*= 0.0f*/, USelectionSet *Selection /*= nullptr*/)
 {
-	// TODO: Check selectionSet size.
-	// TODO: Check normals size.
+	if (!SelectionIsValid(this, Selection, TEXT("Inflate"))) {
+		return;
+	}
 
-	// Iterate over the sections, and the the vertices in the sections.
-	// As we need normals to we'll use an index-based for loop here for verts.
-	for (auto &section : this->sections) {
-		for (int32 vertexIndex = 0; vertexIndex < section.vertices.Num(); ++vertexIndex) {
-			section.vertices[vertexIndex] = FMath::Lerp(
-				section.vertices[vertexIndex],
-				section.vertices[vertexIndex] + (section.normals[vertexIndex] * Offset),
-				Selection ? Selection->weights[vertexIndex] : 1.0f
+	// We need a normal for every vertex.
+	for (auto &Section : this->sections) {
+		if (Section.normals.Num() != Section.vertices.Num()) {
+			UE_LOG(
+				LogTemp, Error, TEXT("Inflate: Section has %d normals for %d vertices"),
+				Section.normals.Num(), Section.vertices.Num()
 			);
+			return;
 		}
 	}
+
+	FDeformationCommand Command;
+	Command.Type = EDeformationCommandType::Inflate;
+	Command.Scalar0 = Offset;
+	Command.Selection = Selection;
+	ApplyDeformation(Command);
 }
 
 void UMeshGeometry::ScaleAlongAxis(FVector CenterOfScale /*= FVector::ZeroVector*/, FVector Axis /*= FVector::UpVector*/, float Scale /*= 1.0f*/, USelectionSet *Selection /*= nullptr*/)
 {
-	// TODO Check SelectionSet size
-	// TODO: Check non-zero vectors.
-
-	// Iterate over the sections, and the the vertices in the sections.
-	int32 nextSelectionIndex = 0;
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			FVector closestPointOnLine = FMath::ClosestPointOnInfiniteLine(CenterOfScale, CenterOfScale + Axis, vertex);
-			FVector offsetFromClosestPoint = vertex - closestPointOnLine;
-			FVector scaledPointOnLine = Scale * (closestPointOnLine - CenterOfScale) + CenterOfScale;
-			vertex = FMath::Lerp(vertex, scaledPointOnLine + offsetFromClosestPoint, Selection ? Selection->weights[nextSelectionIndex++] : 1.0f);
-		}
+	if (!SelectionIsValid(this, Selection, TEXT("ScaleAlongAxis"))) {
+		return;
 	}
+
+	// Only the component of each offset along the axis is scaled.  A zero axis leaves everything
+	// unchanged, the same as projecting onto a zero-length line would.
+	const FVector NormalizedAxis = Axis.GetSafeNormal();
+	FDeformationCommand Command;
+	Command.Type = EDeformationCommandType::Affine;
+	Command.Selection = Selection;
+	MakeAffineMatrix(
+		[&NormalizedAxis, Scale](const FVector &Offset) {
+			return Offset + NormalizedAxis * (FVector::DotProduct(Offset, NormalizedAxis) * (Scale - 1.0f));
+		},
+		CenterOfScale, FVector::ZeroVector, Command.Matrix
+	);
+	ApplyDeformation(Command);
 }
 
 void UMeshGeometry::RotateAroundAxis(FVector CenterOfRotation /*= FVector::ZeroVector*/, FVector Axis /*= FVector::UpVector*/, float AngleInDegrees /*= 0.0f*/, USelectionSet *Selection /*= nullptr*/)
 {
-	// TODO Check SelectionSet size
-	// TODO: Check non-zero vectors.
+	if (!SelectionIsValid(this, Selection, TEXT("RotateAroundAxis"))) {
+		return;
+	}
 
 	// Normalize the axis direction.
 	auto normalizedAxis = Axis.GetSafeNormal();
@@ -535,33 +1534,23 @@ void UMeshGeometry::RotateAroundAxis(FVector CenterOfRotation /*= FVector::ZeroV
 		return;
 	}
 
-	// Iterate over the sections, and the vertices in the sections.
-	int32 nextSelectionIndex = 0;
-	for (auto &section : this->sections) {
-		for (auto &vertex : section.vertices) {
-			FVector closestPointOnLine = FMath::ClosestPointOnInfiniteLine(CenterOfRotation, CenterOfRotation + Axis, vertex);
-			FVector offsetFromClosestPoint = vertex - closestPointOnLine;
-			float scaledRotation = FMath::Lerp(
-				0.0f, AngleInDegrees,
-				Selection ? Selection->weights[nextSelectionIndex++] : 1.0f
-			);
-			FVector rotatedOffset = offsetFromClosestPoint.RotateAngleAxis(scaledRotation, normalizedAxis);
-			vertex = closestPointOnLine + rotatedOffset;
-		}
-	}
+	FDeformationCommand Command;
+	Command.Type = EDeformationCommandType::RotateAroundAxis;
+	Command.Vector0 = CenterOfRotation;
+	Command.Vector1 = normalizedAxis;
+	Command.Scalar0 = AngleInDegrees;
+	Command.Selection = Selection;
+	ApplyDeformation(Command);
 }
 
 void UMeshGeometry::Lerp(UMeshGeometry *TargetMeshGeometry, float Alpha /*= 0.0f*/, USelectionSet *Selection /*= nullptr*/) {
-	// TODO: Check SelectionSet size
-
-	// Iterate over the sections, and the vertices in the sections.  Do it by index so we
-	// can access the same data from TargetMeshGeometry
-	int32 nextSelectionIndex = 0;
-
 	if (!TargetMeshGeometry) {
 		UE_LOG(LogTemp, Error, TEXT("Lerp: No TargetMeshGeometry"));
 		return;
 	}
+	if (!SelectionIsValid(this, Selection, TEXT("Lerp"))) {
+		return;
+	}
 	if (this->sections.Num() != TargetMeshGeometry->sections.Num()) {
 		UE_LOG(
 			LogTemp, Error, TEXT("Lerp: Cannot lerp geometries with different numbers of sections, %d compared to %d"),
@@ -570,12 +1559,8 @@ void UMeshGeometry::Lerp(UMeshGeometry *TargetMeshGeometry, float Alpha /*= 0.0f
 		return;
 	}
 
+	// Check all of the sections match before we change anything.
 	for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); sectionIndex++) {
-		UE_LOG(
-			LogTemp, Error, TEXT("Lerp: SECTION INDEX %d"),
-			sectionIndex
-		);
-
 		if (this->sections[sectionIndex].vertices.Num() != TargetMeshGeometry->sections[sectionIndex].vertices.Num()) {
 			UE_LOG(
 				LogTemp, Error, TEXT("Lerp: Cannot lerp geometries with different numbers of vertices, %d compared to %d for section %d"),
@@ -583,21 +1568,38 @@ void UMeshGeometry::Lerp(UMeshGeometry *TargetMeshGeometry, float Alpha /*= 0.0f
 			);
 			return;
 		}
+	}
 
-		for (int32 vertexIndex = 0; vertexIndex < this->sections[sectionIndex].vertices.Num(); ++vertexIndex) {
-			// Get the existing data from the two components.
-			FVector vertexFromThis = this->sections[sectionIndex].vertices[vertexIndex];
-			FVector vertexFromTarget = TargetMeshGeometry->sections[sectionIndex].vertices[vertexIndex];
-
-			UE_LOG(
-				LogTemp, Error, TEXT("Lerp: Vertex index %d"),
-				vertexIndex
-			);
-			// TODO: World/local logic should live here.
-			this->sections[sectionIndex].vertices[vertexIndex] = FMath::Lerp(
-				vertexFromThis, vertexFromTarget,
-				Alpha * (Selection ? Selection->weights[nextSelectionIndex++] : 1.0f)
-			);
+	// Both geometries need to be up to date before we blend them.
+	FlushDeformations();
+	WaitForAsyncDeformation();
+	TargetMeshGeometry->FlushDeformations();
+	PrepareAllSectionsForWrite(GetAttributeMask(EMeshGeometryAttribute::Positions));
+
+	// TODO: World/local logic should live here.
+	if (Selection && Selection->IsSparse()) {
+		// Only the vertices with a weight move, so visit just those.
+		const TArray<int32> &sparseIndices = Selection->GetSparseIndices();
+		const TArray<float> &sparseWeights = Selection->GetSparseWeights();
+		const TArray<int32> &sectionVertexOffsets = GetSectionVertexOffsets();
+		for (int32 sectionIndex = 0; sectionIndex < this->sections.Num(); ++sectionIndex) {
+			const int32 sectionOffset = sectionVertexOffsets[sectionIndex];
+			int32 begin, end;
+			Selection->GetSparseRange(sectionOffset, this->sections[sectionIndex].vertices.Num(), begin, end);
+			float *positions = GetVectorArrayData(this->sections[sectionIndex].vertices);
+			const float *targetPositions = GetVectorArrayData(TargetMeshGeometry->sections[sectionIndex].vertices);
+			for (int32 entry = begin; entry < end; ++entry) {
+				const int32 vertexIndex = sparseIndices[entry] - sectionOffset;
+				VertexKernels::LerpTo(positions + vertexIndex * 3, targetPositions + vertexIndex * 3, 1, Alpha, &sparseWeights[entry]);
+			}
 		}
+		return;
 	}
-}
\ No newline at end of file
+	ParallelForVertices(this, [&](const FVertexChunk &Chunk) {
+		VertexKernels::LerpTo(
+			GetVectorArrayData(this->sections[Chunk.SectionIndex].vertices) + Chunk.FirstVertex * 3,
+			GetVectorArrayData(TargetMeshGeometry->sections[Chunk.SectionIndex].vertices) + Chunk.FirstVertex * 3,
+			Chunk.VertexCount, Alpha, Selection ? Selection->GetWeightStream() + Chunk.FirstWeightIndex : FWeightStream()
+		);
+	});
+}
@@ -0,0 +1,23 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ProceduralToolkit.h"
+#include "MeshGeometry.h"
+#include "MeshGeometrySnapshot.h"
+
+UMeshGeometry *UMeshGeometrySnapshot::GetSourceGeometry() const
+{
+	return SourceGeometry.Get();
+}
+
+int32 UMeshGeometrySnapshot::GetCapturedAttributeCount() const
+{
+	int32 capturedAttributeCount = 0;
+	for (const auto &section : Sections) {
+		ForEachSnapshotAttribute([&](EMeshGeometryAttribute Attribute, auto SectionMember, auto SnapshotMember) {
+			if ((section.*SnapshotMember).IsValid()) {
+				++capturedAttributeCount;
+			}
+		});
+	}
+	return capturedAttributeCount;
+}
@@ -1,18 +1,23 @@
 // Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
 
 #include "ProceduralToolkit.h"
+#include "Misc/CoreDelegates.h"
+#include "SelectionSetWeightPool.h"
 
 #define LOCTEXT_NAMESPACE "FProceduralToolkitModule"
 
 void FProceduralToolkitModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	TrimWeightPoolHandle = FCoreDelegates::OnEndFrame.AddRaw(&FSelectionSetWeightPool::Get(), &FSelectionSetWeightPool::Trim);
 }
 
 void FProceduralToolkitModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FCoreDelegates::OnEndFrame.Remove(TrimWeightPoolHandle);
+	FSelectionSetWeightPool::Get().Empty();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -1,33 +1,502 @@
 // (c)2017 Paul Golds, released under MIT License.
 
 #include "ProceduralToolkit.h"
+#include "Async/ParallelFor.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "SelectionSet.h"
+#include "SelectionSetWeightPool.h"
 
+/// Return the number of bytes of each code of a quantized set.
+static int32 GetQuantizedCodeSize(ESelectionSetPrecision Precision)
+{
+	return Precision == ESelectionSetPrecision::UInt16 ? sizeof(uint16) : sizeof(uint8);
+}
+
+FSelectionSetSharedWeights::~FSelectionSetSharedWeights()
+{
+	FSelectionSetWeightPool::Get().Release(Weights);
+	FSelectionSetWeightPool::Get().Release(SparseWeights);
+}
 
 void USelectionSet::CreateSelectionSet(int32 size)
 {
 	this->Empty();
+	FSelectionSetWeightPool::Get().Reserve(weights, size);
 	weights.AddZeroed(size);
+	MarkModified();
 }
 
 void USelectionSet::Empty()
 {
-	weights.Empty();
+	FSelectionSetWeightPool::Get().Release(weights);
+	bSparse = false;
+	SparseSize = 0;
+	SparseIndices.Empty();
+	FSelectionSetWeightPool::Get().Release(SparseWeights);
+	Precision = ESelectionSetPrecision::Float;
+	QuantizedWeights.Empty();
+	DeferredExpression.reset();
+	DeferredReferences.Empty();
+	SharedWeights.Reset();
+	MarkModified();
+}
+
+int32 USelectionSet::Num() const
+{
+	if (DeferredExpression) {
+		return DeferredExpression->GetSize();
+	}
+	if (Precision != ESelectionSetPrecision::Float) {
+		return GetQuantizedCodes().Num() / GetQuantizedCodeSize(Precision);
+	}
+	return bSparse ? SparseSize : GetStoredWeights().Num();
+}
+
+bool USelectionSet::IsSparse() const
+{
+	return bSparse;
+}
+
+USelectionSet *USelectionSet::EnsureDense()
+{
+	Evaluate();
+	Unshare();
+	if (bSparse) {
+		// The weights are the same ones stored another way, so the revision stays the same.
+		TArray<float> denseWeights;
+		FSelectionSetWeightPool::Get().Reserve(denseWeights, SparseSize);
+		GetDenseWeights(denseWeights);
+		const int32 revision = Revision;
+		Empty();
+		weights = MoveTemp(denseWeights);
+		Revision = revision;
+	}
+	if (Precision != ESelectionSetPrecision::Float) {
+		// The weights are the ones the codes stand for, so the revision stays the same.
+		const int32 size = Num();
+		TArray<float> denseWeights;
+		FSelectionSetWeightPool::Get().Reserve(denseWeights, size);
+		denseWeights.SetNumUninitialized(size);
+		WeightKernels::Dequantize(GetWeightStream(), size, denseWeights.GetData());
+		const int32 revision = Revision;
+		Empty();
+		weights = MoveTemp(denseWeights);
+		Revision = revision;
+	}
+	return this;
+}
+
+int32 USelectionSet::GetRevision() const
+{
+	return Revision;
+}
+
+USelectionSet *USelectionSet::MarkModified()
+{
+	++Revision;
+	return this;
+}
+
+bool USelectionSet::IsDeferred() const
+{
+	return DeferredExpression != nullptr;
+}
+
+USelectionSet *USelectionSet::Evaluate()
+{
+	if (!DeferredExpression) {
+		return this;
+	}
+
+	// The sources are the snapshots of SelectionSets *DeferWeights* took, which share the weights
+	// the sets had then.  Nothing else holds the snapshots, and changing one would have taken
+	// back its weights, so a snapshot which isn't shared any more means something has gone wrong.
+	const FWeightProgram program(DeferredExpression);
+	const int32 size = program.GetSize();
+	TArray<FWeightProgram::FSource> sources;
+	for (int32 sourceIndex = 0; sourceIndex < (int32)program.GetSources().size(); ++sourceIndex) {
+		const USelectionSet *source = (const USelectionSet *)program.GetSources()[sourceIndex];
+		check(source->IsShared() && source->Num() == program.GetSourceSizes()[sourceIndex]);
+		FWeightProgram::FSource &weightSource = sources[sources.AddUninitialized()];
+		weightSource.Dense = source->IsSparse() ? FWeightStream() : source->GetWeightStream();
+		weightSource.SparseIndices = source->GetSparseIndices().GetData();
+		weightSource.SparseWeights = source->GetSparseWeights().GetData();
+		weightSource.SparseCount = source->GetSparseIndices().Num();
+	}
+
+	// Each task evaluates its range a chunk at a time, so tasks only need to be big enough to be
+	// worth scheduling.
+	const int32 taskSize = 32 * 1024;
+	TArray<float> results;
+	FSelectionSetWeightPool::Get().Reserve(results, size);
+	results.SetNumUninitialized(size);
+	ParallelFor((size + taskSize - 1) / taskSize, [&](int32 task) {
+		const int32 first = task * taskSize;
+		program.Evaluate(sources.GetData(), first, FMath::Min(taskSize, size - first), results.GetData() + first);
+	});
+
+	// The weights are the ones the set already represented, so the revision stays the same.
+	const int32 revision = Revision;
+	Empty();
+	weights = MoveTemp(results);
+	Revision = revision;
+	return this;
+}
+
+void USelectionSet::SetDeferred(FWeightExpression::FPtr Expression, TArray<UObject *> &&References)
+{
+	check(Expression);
+	Empty();
+	DeferredExpression = MoveTemp(Expression);
+	DeferredReferences = MoveTemp(References);
+	MarkModified();
+}
+
+void USelectionSet::CopyFrom(const USelectionSet *Source)
+{
+	check(Source && Source != this);
+	if (Source->SharedWeights.IsValid()) {
+		SetShared(Source->SharedWeights);
+	} else {
+		Empty();
+		FSelectionSetWeightPool::Get().Reserve(weights, Source->weights.Num());
+		weights.Append(Source->weights);
+		bSparse = Source->bSparse;
+		SparseSize = Source->SparseSize;
+		SparseIndices = Source->SparseIndices;
+		FSelectionSetWeightPool::Get().Reserve(SparseWeights, Source->SparseWeights.Num());
+		SparseWeights.Append(Source->SparseWeights);
+		Precision = Source->Precision;
+		QuantizedWeights = Source->QuantizedWeights;
+		QuantizedMin = Source->QuantizedMin;
+		QuantizedStep = Source->QuantizedStep;
+		DeferredExpression = Source->DeferredExpression;
+		DeferredReferences = Source->DeferredReferences;
+		MarkModified();
+	}
+
+	// Statistics the source has kept are just as true of the copy.
+	if (Source->bStatisticsValid && Source->StatisticsRevision == Source->Revision) {
+		Statistics = Source->Statistics;
+		StatisticsRevision = Revision;
+		bStatisticsValid = true;
+	}
+}
+
+void USelectionSet::SetSparse(int32 Size, TArray<int32> &&Indices, TArray<float> &&Weights)
+{
+	check(Indices.Num() == Weights.Num());
+	Empty();
+	bSparse = true;
+	SparseSize = Size;
+	SparseIndices = MoveTemp(Indices);
+	SparseWeights = MoveTemp(Weights);
+	MarkModified();
+}
+
+float *USelectionSet::ResetDense(int32 Size)
+{
+	// Taking back shared weights keeps them where the caller may be reading them from, for
+	// writing over a set in place.
+	Unshare();
+	bSparse = false;
+	SparseSize = 0;
+	SparseIndices.Reset();
+	FSelectionSetWeightPool::Get().Release(SparseWeights);
+	Precision = ESelectionSetPrecision::Float;
+	QuantizedWeights.Empty();
+	DeferredExpression.reset();
+	DeferredReferences.Reset();
+	if (weights.Max() < Size) {
+		FSelectionSetWeightPool::Get().Reserve(weights, Size);
+	}
+	weights.SetNumUninitialized(Size, false);
+	MarkModified();
+	return weights.GetData();
+}
+
+void USelectionSet::ResetSparse(int32 Size, int32 Count, int32 *&OutIndices, float *&OutWeights)
+{
+	Unshare();
+	FSelectionSetWeightPool::Get().Release(weights);
+	Precision = ESelectionSetPrecision::Float;
+	QuantizedWeights.Empty();
+	DeferredExpression.reset();
+	DeferredReferences.Reset();
+	bSparse = true;
+	SparseSize = Size;
+	if (SparseWeights.Max() < Count) {
+		FSelectionSetWeightPool::Get().Reserve(SparseWeights, Count);
+	}
+	SparseIndices.SetNumUninitialized(Count, false);
+	SparseWeights.SetNumUninitialized(Count, false);
+	MarkModified();
+	OutIndices = SparseIndices.GetData();
+	OutWeights = SparseWeights.GetData();
+}
+
+void USelectionSet::GetSparseRange(int32 FirstIndex, int32 Count, int32 &OutBegin, int32 &OutEnd) const
+{
+	// Binary search for the first stored index at or after each end of the range.
+	const TArray<int32> &indices = GetSparseIndices();
+	auto lowerBound = [&indices](int32 Index) {
+		int32 low = 0;
+		int32 high = indices.Num();
+		while (low < high) {
+			const int32 middle = low + (high - low) / 2;
+			if (indices[middle] < Index) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+		return low;
+	};
+	OutBegin = lowerBound(FirstIndex);
+	OutEnd = lowerBound(FirstIndex + Count);
+}
+
+const float *USelectionSet::GetDenseWeights(TArray<float> &Scratch) const
+{
+	check(!DeferredExpression);
+	if (Precision != ESelectionSetPrecision::Float) {
+		Scratch.SetNumUninitialized(Num());
+		WeightKernels::Dequantize(GetWeightStream(), Num(), Scratch.GetData());
+		return Scratch.GetData();
+	}
+	if (!bSparse) {
+		return GetStoredWeights().GetData();
+	}
+	const TArray<int32> &indices = GetSparseIndices();
+	const TArray<float> &storedWeights = GetSparseWeights();
+	Scratch.SetNumZeroed(SparseSize);
+	for (int32 entry = 0; entry < indices.Num(); ++entry) {
+		Scratch[indices[entry]] = storedWeights[entry];
+	}
+	return Scratch.GetData();
+}
+
+USelectionSet *USelectionSet::Quantize(ESelectionSetPrecision InPrecision)
+{
+	Evaluate();
+	if (bSparse || InPrecision == Precision) {
+		return this;
+	}
+
+	// Changing from one precision to another goes back to the floats first.
+	EnsureDense();
+	const int32 size = weights.Num();
+	if (InPrecision == ESelectionSetPrecision::Float || size == 0) {
+		return this;
+	}
+
+	const FSelectionSetStatistics &statistics = GetStatistics();
+	const float min = statistics.Min;
+	const float max = statistics.Max;
+	QuantizedWeights.SetNumUninitialized(size * GetQuantizedCodeSize(InPrecision));
+	if (InPrecision == ESelectionSetPrecision::UInt16) {
+		QuantizedStep = WeightKernels::Quantize(weights.GetData(), size, min, max, reinterpret_cast<uint16 *>(QuantizedWeights.GetData()));
+	} else {
+		QuantizedStep = WeightKernels::Quantize(weights.GetData(), size, min, max, QuantizedWeights.GetData());
+	}
+	QuantizedMin = min;
+	Precision = InPrecision;
+	FSelectionSetWeightPool::Get().Release(weights);
+	return MarkModified();
+}
+
+ESelectionSetPrecision USelectionSet::GetPrecision() const
+{
+	return Precision;
+}
+
+bool USelectionSet::IsShared() const
+{
+	return SharedWeights.IsValid();
+}
+
+FSelectionSetSharedWeightsPtr USelectionSet::Share()
+{
+	Evaluate();
+	if (!SharedWeights.IsValid()) {
+		// The weights are moved rather than copied, and are still the same weights, so the
+		// revision stays the same.
+		SharedWeights = MakeShareable(new FSelectionSetSharedWeights());
+		SharedWeights->bSparse = bSparse;
+		SharedWeights->SparseSize = SparseSize;
+		SharedWeights->Precision = Precision;
+		SharedWeights->QuantizedMin = QuantizedMin;
+		SharedWeights->QuantizedStep = QuantizedStep;
+		SharedWeights->Weights = MoveTemp(weights);
+		SharedWeights->SparseIndices = MoveTemp(SparseIndices);
+		SharedWeights->SparseWeights = MoveTemp(SparseWeights);
+		SharedWeights->QuantizedWeights = MoveTemp(QuantizedWeights);
+	}
+	return SharedWeights;
+}
+
+void USelectionSet::SetShared(const FSelectionSetSharedWeightsPtr &Weights)
+{
+	check(Weights.IsValid());
+	Empty();
+	SharedWeights = Weights;
+	bSparse = Weights->bSparse;
+	SparseSize = Weights->SparseSize;
+	Precision = Weights->Precision;
+	QuantizedMin = Weights->QuantizedMin;
+	QuantizedStep = Weights->QuantizedStep;
+	MarkModified();
+}
+
+void USelectionSet::Unshare()
+{
+	if (!SharedWeights.IsValid()) {
+		return;
+	}
+
+	// The weights are the same ones, only no longer shared, so the revision stays the same.
+	if (SharedWeights.IsUnique()) {
+		// No other set is reading them, so they can be taken rather than copied.
+		weights = MoveTemp(SharedWeights->Weights);
+		SparseIndices = MoveTemp(SharedWeights->SparseIndices);
+		SparseWeights = MoveTemp(SharedWeights->SparseWeights);
+		QuantizedWeights = MoveTemp(SharedWeights->QuantizedWeights);
+	} else {
+		FSelectionSetWeightPool::Get().Reserve(weights, SharedWeights->Weights.Num());
+		weights.Append(SharedWeights->Weights);
+		SparseIndices = SharedWeights->SparseIndices;
+		FSelectionSetWeightPool::Get().Reserve(SparseWeights, SharedWeights->SparseWeights.Num());
+		SparseWeights.Append(SharedWeights->SparseWeights);
+		QuantizedWeights = SharedWeights->QuantizedWeights;
+	}
+	SharedWeights.Reset();
+}
+
+FWeightStream USelectionSet::GetWeightStream() const
+{
+	check(!bSparse && !DeferredExpression);
+	switch (Precision) {
+	case ESelectionSetPrecision::UInt16:
+		return FWeightStream(reinterpret_cast<const uint16 *>(GetQuantizedCodes().GetData()), QuantizedMin, QuantizedStep);
+	case ESelectionSetPrecision::UInt8:
+		return FWeightStream(GetQuantizedCodes().GetData(), QuantizedMin, QuantizedStep);
+	default:
+		return GetStoredWeights().GetData();
+	}
+}
+
+void USelectionSet::GetQuantizedRange(float &OutMin, float &OutMax) const
+{
+	check(Precision != ESelectionSetPrecision::Float);
+	const int32 maxCode = Precision == ESelectionSetPrecision::UInt16 ? MAX_uint16 : MAX_uint8;
+	OutMin = QuantizedMin;
+	OutMax = QuantizedMin + maxCode * QuantizedStep;
+}
+
+/// Find the statistics of weights which may be quantized, splitting large arrays across tasks
+/// and turning codes back into floats a block at a time.
+static WeightKernels::FWeightStatistics FindWeightStatistics(const FWeightStream &Weights, int32 Count)
+{
+	const int32 taskSize = 64 * 1024;
+	const int32 taskCount = (Count + taskSize - 1) / taskSize;
+	TArray<WeightKernels::FWeightStatistics> taskStatistics;
+	taskStatistics.SetNum(taskCount);
+	ParallelFor(taskCount, [&](int32 task) {
+		const int32 first = task * taskSize;
+		const int32 count = FMath::Min(taskSize, Count - first);
+		if (Weights.GetFloats()) {
+			WeightKernels::Statistics(Weights.GetFloats() + first, count, taskStatistics[task]);
+			return;
+		}
+
+		const int32 blockSize = 256;
+		float values[blockSize];
+		for (int32 blockStart = 0; blockStart < count; blockStart += blockSize) {
+			const int32 blockCount = FMath::Min(blockSize, count - blockStart);
+			WeightKernels::Dequantize(Weights + (first + blockStart), blockCount, values);
+			WeightKernels::FWeightStatistics blockStatistics;
+			WeightKernels::Statistics(values, blockCount, blockStatistics);
+			taskStatistics[task].Combine(blockStatistics);
+		}
+	});
+
+	// Combine the tasks in order, so the sum is the same whichever threads ran them.
+	WeightKernels::FWeightStatistics found;
+	for (const WeightKernels::FWeightStatistics &statistics : taskStatistics) {
+		found.Combine(statistics);
+	}
+	return found;
+}
+
+const FSelectionSetStatistics &USelectionSet::GetStatistics()
+{
+	// Dense float weights can be written to directly without the revision changing, so they're
+	// always searched again.  Sparse, quantized, and shared weights can only be changed through the set.
+	Evaluate();
+	const bool bKeepStatistics = bSparse || Precision != ESelectionSetPrecision::Float || SharedWeights.IsValid();
+	if (bKeepStatistics && bStatisticsValid && StatisticsRevision == Revision) {
+		return Statistics;
+	}
+
+	WeightKernels::FWeightStatistics found;
+	if (bSparse) {
+		found = FindWeightStatistics(GetSparseWeights().GetData(), GetSparseWeights().Num());
+
+		// The weights which aren't stored are all zero.
+		WeightKernels::FWeightStatistics zeros;
+		zeros.Count = SparseSize - GetSparseWeights().Num();
+		found.Combine(zeros);
+	} else {
+		found = FindWeightStatistics(GetWeightStream(), Num());
+	}
+
+	Statistics.Min = found.Min;
+	Statistics.Max = found.Max;
+	Statistics.Sum = (float)found.Sum;
+	Statistics.Mean = found.Count > 0 ? (float)(found.Sum / found.Count) : 0.0f;
+	Statistics.NonZeroCount = found.NonZeroCount;
+	Statistics.Count = found.Count;
+	StatisticsRevision = Revision;
+	bStatisticsValid = bKeepStatistics;
+	return Statistics;
 }
 
 USelectionSet *USelectionSet::SetAllWeights(float weight)
 {
+	EnsureDense();
 	for (auto &weightItr : weights) {
 		weightItr = weight;
 	}
-	return this;
+	return MarkModified();
 }
 
 USelectionSet *USelectionSet::RandomizeWeights(FRandomStream randomStream, float min /*= 0*/, float max /*= 1*/)
 {
+	EnsureDense();
 	for (auto &weight : weights) {
 		weight = randomStream.FRandRange(min, max);
 	}
-	return this;
+	return MarkModified();
+}
+
+void USelectionSet::SetWeightPoolMemoryBudget(int32 MegaBytes)
+{
+	if (MegaBytes < 0) {
+		UE_LOG(LogTemp, Warning, TEXT("SetWeightPoolMemoryBudget: MegaBytes can't be negative"));
+		return;
+	}
+	FSelectionSetWeightPool::Get().SetMemoryBudget((SIZE_T)MegaBytes * 1024 * 1024);
+}
+
+void USelectionSet::EmptyWeightPool()
+{
+	FSelectionSetWeightPool::Get().Empty();
+}
+
+void USelectionSet::BeginDestroy()
+{
+	FSelectionSetWeightPool::Get().Release(weights);
+	FSelectionSetWeightPool::Get().Release(SparseWeights);
+	SharedWeights.Reset();
+	Super::BeginDestroy();
 }
@@ -2,421 +2,705 @@
 
 #include "ProceduralToolkit.h"
 #include "SelectionSetBPLibrary.h"
+#include "ToolkitCore/CurveLookupTable.h"
+#include "ToolkitCore/WeightExpression.h"
+#include "Async/ParallelFor.h"
+
+// The Ease node casts the engine's easing enum straight to the kernel's one.
+static_assert((int32)EEasingFunc::CircularInOut == (int32)WeightKernels::EEaseFunction::CircularInOut, "EEaseFunction must match EEasingFunc");
+
+/// Whether the operations return deferred SelectionSets, see *SetDeferredEvaluation*
+static bool bDeferSelectionSetMath = false;
+
+/// Record an operation in a new deferred SelectionSet rather than applying it.
+///
+/// Inputs which are deferred themselves have their expressions built on rather than being
+/// evaluated, so a whole graph of operations ends up as one expression evaluated in one pass.
+///
+/// Other inputs are read through a snapshot sharing their weights, so the expression gives the
+/// same result however the inputs are modified before it's evaluated, such as by an *Into*
+/// node writing over one of them.  The weights are only copied if an input is modified.
+static USelectionSet *DeferWeights(const FWeightOperation &Operation, int32 Size, USelectionSet *A, USelectionSet *B, UObject *Reference)
+{
+	USelectionSet *result = NewObject<USelectionSet>(A->GetOuter());
+	TArray<UObject *> references;
+	if (Reference) {
+		references.Add(Reference);
+	}
+
+	FWeightExpression::FPtr inputs[2];
+	USelectionSet *inputSets[2] = { A, B };
+	for (int32 input = 0; input < Operation.GetInputCount(); ++input) {
+		USelectionSet *inputSet = inputSets[input];
+		if (input == 1 && inputSet == A) {
+			inputs[input] = inputs[0];
+		} else if (inputSet->IsDeferred()) {
+			inputs[input] = inputSet->GetDeferredExpression();
+			for (UObject *inputReference : inputSet->GetDeferredReferences()) {
+				references.AddUnique(inputReference);
+			}
+		} else {
+			USelectionSet *snapshot = NewObject<USelectionSet>(inputSet->GetOuter());
+			snapshot->SetShared(inputSet->Share());
+			inputs[input] = FWeightExpression::MakeSource(snapshot, snapshot->Num());
+			references.Add(snapshot);
+		}
+	}
 
+	result->SetDeferred(FWeightExpression::Make(Operation, Size, inputs[0], inputs[1]), MoveTemp(references));
+	return result;
+}
 
+/// The number of weights *TransformWeights* and *MergeSparseWeights* work through at a time in
+/// buffers on the stack, so they don't need to allocate any
+static const int32 SelectionSetMathBlockSize = 256;
 
+/// The number of weights an operation is applied to by each task, with anything larger split
+/// across tasks.  Smaller sets are quicker to do on the calling thread than to schedule.
+static const int32 SelectionSetMathParallelSize = 64 * 1024;
 
-USelectionSet * USelectionSetBPLibrary::Clamp(USelectionSet *Value, float Min/*=0*/, float Max/*=1*/)
+/// Apply an operation to a range of weights which may be quantized, turning them back into
+/// floats a block at a time so they're never all expanded at once.
+static void ApplyToWeightStreamRange(const FWeightOperation &Operation, const FWeightStream &A, const FWeightStream &B, int32 Count, float *Out)
 {
-	// Need a SelectionSet
-	if (!Value) {
-		return nullptr;
+	const bool bQuantizedA = A && !A.GetFloats();
+	const bool bQuantizedB = B && !B.GetFloats();
+	if (!bQuantizedA && !bQuantizedB) {
+		Operation.Apply(A.GetFloats(), B.GetFloats(), Count, Out);
+		return;
+	}
+
+	float valuesA[SelectionSetMathBlockSize];
+	float valuesB[SelectionSetMathBlockSize];
+	for (int32 blockStart = 0; blockStart < Count; blockStart += SelectionSetMathBlockSize) {
+		const int32 blockCount = FMath::Min(SelectionSetMathBlockSize, Count - blockStart);
+		if (bQuantizedA) {
+			WeightKernels::Dequantize(A + blockStart, blockCount, valuesA);
+		}
+		if (bQuantizedB) {
+			WeightKernels::Dequantize(B + blockStart, blockCount, valuesB);
+		}
+		Operation.Apply(
+			bQuantizedA ? valuesA : A ? A.GetFloats() + blockStart : nullptr,
+			bQuantizedB ? valuesB : B ? B.GetFloats() + blockStart : nullptr,
+			blockCount, Out + blockStart
+		);
 	}
+}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
+/// Apply an operation to weights which may be quantized, splitting large sets across tasks.
+static void ApplyToWeightStreams(const FWeightOperation &Operation, const FWeightStream &A, const FWeightStream &B, int32 Count, float *Out)
+{
+	if (Count <= SelectionSetMathParallelSize) {
+		ApplyToWeightStreamRange(Operation, A, B, Count, Out);
+		return;
+	}
+
+	ParallelFor((Count + SelectionSetMathParallelSize - 1) / SelectionSetMathParallelSize, [&](int32 task) {
+		const int32 first = task * SelectionSetMathParallelSize;
+		ApplyToWeightStreamRange(
+			Operation, A ? A + first : A, B ? B + first : B,
+			FMath::Min(SelectionSetMathParallelSize, Count - first), Out + first
+		);
+	});
+}
 
-	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = FMath::Clamp(Value->weights[i], Min, Max);
+/// The number of samples *RemapToCurve* bakes curves into, or 0 to read them directly
+static int32 CurveLookupResolution = 1024;
+
+typedef TSharedPtr<const FCurveLookupTable, ESPMode::ThreadSafe> FCurveLookupTablePtr;
+
+/// A curve baked by *RemapToCurve*, kept until the curve is destroyed or changes
+struct FCurveLookupEntry
+{
+	TWeakObjectPtr<const UCurveFloat> Curve;
+
+	/// The hash of the curve's keys and the resolution the table was baked with, see *HashCurveLookup*
+	uint32 Hash;
+
+	FCurveLookupTablePtr Table;
+};
+
+/// The curves baked by *RemapToCurve*, which is only called from the game thread
+static TArray<FCurveLookupEntry> CurveLookupEntries;
+
+/// Return a hash of everything a curve's value between 0 and its last key depends on, along with
+/// the resolution, to tell when its table needs baking again.  UCurveFloat doesn't count its
+/// changes, but hashing a curve's keys is nothing next to remapping a mesh's weights.
+static uint32 HashCurveLookup(const UCurveFloat *Curve, int32 Resolution)
+{
+	const FRichCurve &richCurve = Curve->FloatCurve;
+	uint32 hash = HashCombine(GetTypeHash(Resolution), GetTypeHash(richCurve.DefaultValue));
+	hash = HashCombine(hash, GetTypeHash((int32)richCurve.PreInfinityExtrap));
+	hash = HashCombine(hash, GetTypeHash((int32)richCurve.PostInfinityExtrap));
+	for (const FRichCurveKey &key : richCurve.GetConstRefOfKeys()) {
+		hash = HashCombine(hash, GetTypeHash(key.Time));
+		hash = HashCombine(hash, GetTypeHash(key.Value));
+		hash = HashCombine(hash, GetTypeHash(key.ArriveTangent));
+		hash = HashCombine(hash, GetTypeHash(key.LeaveTangent));
+		hash = HashCombine(hash, GetTypeHash(((int32)key.InterpMode << 8) | (int32)key.TangentMode));
+	}
+	return hash;
+}
+
+/// Return the table a curve is baked into at *CurveLookupResolution*, baking it if the curve is
+/// new or has changed since it was last baked.
+static FCurveLookupTablePtr GetCurveLookupTable(const UCurveFloat *Curve)
+{
+	const uint32 hash = HashCurveLookup(Curve, CurveLookupResolution);
+
+	// Drop the tables of curves which have been destroyed while looking for this one's.
+	FCurveLookupEntry *found = nullptr;
+	for (int32 entryIndex = CurveLookupEntries.Num() - 1; entryIndex >= 0; --entryIndex) {
+		FCurveLookupEntry &entry = CurveLookupEntries[entryIndex];
+		if (!entry.Curve.IsValid()) {
+			CurveLookupEntries.RemoveAtSwap(entryIndex);
+		} else if (entry.Curve.Get() == Curve) {
+			found = &entry;
+		}
+	}
+	if (found && found->Hash == hash) {
+		return found->Table;
+	}
+	if (!found) {
+		found = &CurveLookupEntries[CurveLookupEntries.AddDefaulted()];
+		found->Curve = Curve;
 	}
 
-	return result;
+	float curveTimeStart, curveTimeEnd;
+	Curve->GetTimeRange(curveTimeStart, curveTimeEnd);
+	TSharedRef<FCurveLookupTable, ESPMode::ThreadSafe> table = MakeShareable(new FCurveLookupTable());
+	table->Bake([Curve, curveTimeEnd](float Alpha) { return Curve->GetFloatValue(Alpha * curveTimeEnd); }, CurveLookupResolution);
+	UE_LOG(LogTemp, Log, TEXT("RemapToCurve: Baked %s into %d samples, within %f of the curve"), *Curve->GetName(), CurveLookupResolution, table->GetMaxError());
+
+	// A table already in use by a deferred SelectionSet stays alive until it's evaluated.
+	found->Hash = hash;
+	found->Table = table;
+	return found->Table;
 }
 
-USelectionSet * USelectionSetBPLibrary::Ease(USelectionSet *Value, EEasingFunc::Type EaseFunction /*= EEasingFunc::Linear*/, int32 Steps /*= 2*/, float BlendExp /*= 2.0f*/)
+/// Return every weight of a SelectionSet which isn't deferred, expanding a sparse set into *Scratch*.
+static FWeightStream GetWeightStream(const USelectionSet *Value, TArray<float> &Scratch)
 {
-	// Need a SelectionSet
-	if (!Value) {
-		return nullptr;
+	return Value->IsSparse() ? FWeightStream(Value->GetDenseWeights(Scratch)) : Value->GetWeightStream();
+}
+
+/// Return the SelectionSet to write an operation's results to, the one provided or a new one.
+static USelectionSet *GetOutputSelectionSet(USelectionSet *Value, USelectionSet *Output)
+{
+	return Output ? Output : NewObject<USelectionSet>(Value->GetOuter());
+}
+
+/// Apply an operation to every weight of a SelectionSet.
+///
+/// A sparse set stays sparse if the operation leaves zero as zero, so only the stored weights
+/// are visited, otherwise the result is dense.  With deferred evaluation on, an operation
+/// without an *Output* is recorded instead, see *DeferWeights*.
+///
+/// \param Value			The SelectionSet
+/// \param Operation		The operation
+/// \param Output			The SelectionSet to write the results to, which can be *Value*, or null for a new one
+/// \param Reference		Anything else the operation reads, which a deferred set needs to keep alive
+/// \return The SelectionSet holding the results
+static USelectionSet *TransformWeights(USelectionSet *Value, const FWeightOperation &Operation, USelectionSet *Output, UObject *Reference = nullptr)
+{
+	if (bDeferSelectionSetMath && !Output) {
+		return DeferWeights(Operation, Value->Num(), Value, nullptr, Reference);
+	}
+
+	Value->Evaluate();
+	if (Value->IsSparse()) {
+		const float zero = 0.0f;
+		float zeroResult;
+		Operation.Apply(&zero, nullptr, 1, &zeroResult);
+
+		if (zeroResult == 0.0f) {
+			// Only the stored weights change.  Writing over the set in place reads and writes the
+			// same arrays, which the kernels allow.
+			USelectionSet *result = GetOutputSelectionSet(Value, Output);
+			const int32 count = Value->GetSparseIndices().Num();
+			int32 *indices;
+			float *storedResults;
+			result->ResetSparse(Value->Num(), count, indices, storedResults);
+			if (result != Value) {
+				FMemory::Memcpy(indices, Value->GetSparseIndices().GetData(), count * sizeof(int32));
+			}
+			ApplyToWeightStreams(Operation, Value->GetSparseWeights().GetData(), FWeightStream(), count, storedResults);
+			return result;
+		}
+
+		if (Output == Value) {
+			// Writing over the set in place needs its stored weights expanding first.
+			Value->EnsureDense();
+		} else {
+			// Every weight which wasn't stored becomes the same value.
+			USelectionSet *result = GetOutputSelectionSet(Value, Output);
+			float *results = result->ResetDense(Value->Num());
+			WeightKernels::Fill(results, Value->Num(), zeroResult);
+
+			const TArray<int32> &indices = Value->GetSparseIndices();
+			float storedResults[SelectionSetMathBlockSize];
+			for (int32 blockStart = 0; blockStart < indices.Num(); blockStart += SelectionSetMathBlockSize) {
+				const int32 blockCount = FMath::Min(SelectionSetMathBlockSize, indices.Num() - blockStart);
+				Operation.Apply(Value->GetSparseWeights().GetData() + blockStart, nullptr, blockCount, storedResults);
+				for (int32 entry = 0; entry < blockCount; ++entry) {
+					results[indices[blockStart + entry]] = storedResults[entry];
+				}
+			}
+			return result;
+		}
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
-	
-	// TODO: This can be more efficient with lambdas.
-	for (int32 i = 0; i < size; i++) {
-		switch (EaseFunction)
-		{
-		case EEasingFunc::Step:
-			result->weights[i] = FMath::InterpStep<float>(0.f, 1.f, Value->weights[i], Steps);
-			break;
-		case EEasingFunc::SinusoidalIn:
-			result->weights[i] = FMath::InterpSinIn<float>(0.f, 1.f, Value->weights[i]);
-			break;
-		case EEasingFunc::SinusoidalOut:
-			result->weights[i] = FMath::InterpSinOut<float>(0.f, 1.f, Value->weights[i]);
-			break;
-		case EEasingFunc::SinusoidalInOut:
-			result->weights[i] = FMath::InterpSinInOut<float>(0.f, 1.f, Value->weights[i]);
-			break;
-		case EEasingFunc::EaseIn:
-			result->weights[i] = FMath::InterpEaseIn<float>(0.f, 1.f, Value->weights[i], BlendExp);
-			break;
-		case EEasingFunc::EaseOut:
-			result->weights[i] = FMath::InterpEaseOut<float>(0.f, 1.f, Value->weights[i], BlendExp);
-			break;
-		case EEasingFunc::EaseInOut:
-			result->weights[i] = FMath::InterpEaseInOut<float>(0.f, 1.f, Value->weights[i], BlendExp);
-			break;
-		case EEasingFunc::ExpoIn:
-			result->weights[i] = FMath::InterpExpoIn<float>(0.f, 1.f, Value->weights[i]);
-			break;
-		case EEasingFunc::ExpoOut:
-			result->weights[i] = FMath::InterpExpoOut<float>(0.f, 1.f, Value->weights[i]);
-			break;
-		case EEasingFunc::ExpoInOut:
-			result->weights[i] = FMath::InterpExpoInOut<float>(0.f, 1.f, Value->weights[i]);
-			break;
-		case EEasingFunc::CircularIn:
-			result->weights[i] = FMath::InterpCircularIn<float>(0.f, 1.f, Value->weights[i]);
-			break;
-		case EEasingFunc::CircularOut:
-			result->weights[i] = FMath::InterpCircularOut<float>(0.f, 1.f, Value->weights[i]);
-			break;
-		case EEasingFunc::CircularInOut:
-			result->weights[i] = FMath::InterpCircularInOut<float>(0.f, 1.f, Value->weights[i]);
-			break;
-		default:
-			// Do nothing: linear.
-			result->weights[i] = Value->weights[i];
+	if (Output == Value && Value->GetPrecision() != ESelectionSetPrecision::Float) {
+		// The results are floats, so writing over a quantized set in place needs it turning back
+		// into floats first.
+		Value->EnsureDense();
+	}
+	USelectionSet *result = GetOutputSelectionSet(Value, Output);
+	const int32 size = Value->Num();
+	const FWeightStream values = Value->GetWeightStream();
+	ApplyToWeightStreams(Operation, values, FWeightStream(), size, result->ResetDense(size));
+	return result;
+}
+
+/// Merge the stored weights of two sparse SelectionSets, applying an operation to each pair with
+/// zero used where a set doesn't store a weight.
+///
+/// \param A				The first SelectionSet
+/// \param B				The second SelectionSet
+/// \param Size			The number of weights to merge
+/// \param Operation		The operation, or null to only count the stored weights of the result
+/// \param OutIndices		The indices of the stored weights of the result, if there's an operation
+/// \param OutWeights		The stored weights of the result, if there's an operation
+/// \return The number of stored weights of the result
+static int32 MergeSparseWeights(
+	const USelectionSet *A, const USelectionSet *B, int32 Size, const FWeightOperation *Operation,
+	int32 *OutIndices, float *OutWeights
+) {
+	const TArray<int32> &indicesA = A->GetSparseIndices();
+	const TArray<int32> &indicesB = B->GetSparseIndices();
+	float valuesA[SelectionSetMathBlockSize];
+	float valuesB[SelectionSetMathBlockSize];
+	int32 entryA = 0;
+	int32 entryB = 0;
+	int32 count = 0;
+	int32 blockStart = 0;
+	while (true) {
+		const int32 indexA = entryA < indicesA.Num() ? indicesA[entryA] : Size;
+		const int32 indexB = entryB < indicesB.Num() ? indicesB[entryB] : Size;
+		const int32 index = FMath::Min(indexA, indexB);
+		if (index >= Size) {
 			break;
 		}
+		if (Operation) {
+			OutIndices[count] = index;
+			valuesA[count - blockStart] = indexA == index ? A->GetSparseWeights()[entryA] : 0.0f;
+			valuesB[count - blockStart] = indexB == index ? B->GetSparseWeights()[entryB] : 0.0f;
+		}
+		entryA += indexA == index ? 1 : 0;
+		entryB += indexB == index ? 1 : 0;
+		++count;
+
+		if (Operation && count - blockStart == SelectionSetMathBlockSize) {
+			Operation->Apply(valuesA, valuesB, SelectionSetMathBlockSize, OutWeights + blockStart);
+			blockStart = count;
+		}
+	}
+	if (Operation && count > blockStart) {
+		Operation->Apply(valuesA, valuesB, count - blockStart, OutWeights + blockStart);
+	}
+	return count;
+}
+
+/// Apply an operation to each pair of weights from two SelectionSets, giving a set the size of
+/// the smaller one.
+///
+/// Two sparse sets give a sparse result if the operation of two zeros is zero, and only the
+/// weights stored by either set are visited.  Otherwise sparse sets are expanded as needed.
+/// With deferred evaluation on, an operation without an *Output* is recorded instead, see
+/// *DeferWeights*.
+///
+/// \param A				The first SelectionSet
+/// \param B				The second SelectionSet
+/// \param Operation		The operation
+/// \param Output			The SelectionSet to write the results to, which can be *A* or *B*, or null for a new one
+/// \return The SelectionSet holding the results
+static USelectionSet *CombineWeights(USelectionSet *A, USelectionSet *B, const FWeightOperation &Operation, USelectionSet *Output)
+{
+	const int32 smallestSize = FMath::Min(A->Num(), B->Num());
+	if (bDeferSelectionSetMath && !Output) {
+		return DeferWeights(Operation, smallestSize, A, B, nullptr);
+	}
+
+	A->Evaluate();
+	B->Evaluate();
+	if (A->IsSparse() && B->IsSparse()) {
+		const float zero = 0.0f;
+		float zeroResult;
+		Operation.Apply(&zero, &zero, 1, &zeroResult);
+
+		if (zeroResult == 0.0f) {
+			USelectionSet *result = GetOutputSelectionSet(A, Output);
+			const int32 count = MergeSparseWeights(A, B, smallestSize, nullptr, nullptr, nullptr);
+			if (result == A || result == B) {
+				// The merge reads both sets while it writes the results, so writing over one of them
+				// needs the results building separately.
+				TArray<int32> indices;
+				TArray<float> results;
+				indices.SetNumUninitialized(count);
+				results.SetNumUninitialized(count);
+				MergeSparseWeights(A, B, smallestSize, &Operation, indices.GetData(), results.GetData());
+				result->SetSparse(smallestSize, MoveTemp(indices), MoveTemp(results));
+			} else {
+				int32 *indices;
+				float *results;
+				result->ResetSparse(smallestSize, count, indices, results);
+				MergeSparseWeights(A, B, smallestSize, &Operation, indices, results);
+			}
+			return result;
+		}
 	}
 
+	// The inputs are found before the output is reset as it can be one of them.  Resetting a
+	// dense set to the same size or smaller leaves its weights where they are, but a quantized
+	// set needs turning back into floats first.
+	if ((Output == A || Output == B) && Output->GetPrecision() != ESelectionSetPrecision::Float) {
+		Output->EnsureDense();
+	}
+	TArray<float> scratchA, scratchB;
+	const FWeightStream valuesA = GetWeightStream(A, scratchA);
+	const FWeightStream valuesB = GetWeightStream(B, scratchB);
+	USelectionSet *result = GetOutputSelectionSet(A, Output);
+	ApplyToWeightStreams(Operation, valuesA, valuesB, smallestSize, result->ResetDense(smallestSize));
 	return result;
 }
 
-USelectionSet *USelectionSetBPLibrary::Add_SelectionSets(USelectionSet *A, USelectionSet *B)
+void USelectionSetBPLibrary::SetDeferredEvaluation(bool bDeferred)
 {
-	// Need both provided
-	if (!A || !B) {
+	bDeferSelectionSetMath = bDeferred;
+}
+
+bool USelectionSetBPLibrary::IsDeferredEvaluationEnabled()
+{
+	return bDeferSelectionSetMath;
+}
+
+USelectionSet * USelectionSetBPLibrary::Clamp(USelectionSet *Value, float Min/*=0*/, float Max/*=1*/)
+{
+	return ClampInto(Value, nullptr, Min, Max);
+}
+
+USelectionSet * USelectionSetBPLibrary::ClampInto(USelectionSet *Value, USelectionSet *Output, float Min/*=0*/, float Max/*=1*/)
+{
+	// Need a SelectionSet
+	if (!Value) {
 		return nullptr;
 	}
 
-	auto result = NewObject<USelectionSet>(A->GetOuter());
-	int32 smallestSize = A->weights.Num() < B->weights.Num() ? A->weights.Num() : B->weights.Num();
-	result->weights.SetNumZeroed(smallestSize);
+	return TransformWeights(Value, FWeightOperation::MakeClamp(Min, Max), Output);
+}
+
+USelectionSet * USelectionSetBPLibrary::Ease(USelectionSet *Value, EEasingFunc::Type EaseFunction /*= EEasingFunc::Linear*/, int32 Steps /*= 2*/, float BlendExp /*= 2.0f*/)
+{
+	return EaseInto(Value, nullptr, EaseFunction, Steps, BlendExp);
+}
 
-	for (int32 i = 0; i < smallestSize; i++) {
-		result->weights[i] = A->weights[i] + B->weights[i];
+USelectionSet * USelectionSetBPLibrary::EaseInto(USelectionSet *Value, USelectionSet *Output, EEasingFunc::Type EaseFunction /*= EEasingFunc::Linear*/, int32 Steps /*= 2*/, float BlendExp /*= 2.0f*/)
+{
+	// Need a SelectionSet
+	if (!Value) {
+		return nullptr;
 	}
 
-	return result;
+	return TransformWeights(Value, FWeightOperation::MakeEase((WeightKernels::EEaseFunction)EaseFunction, Steps, BlendExp), Output);
 }
 
-USelectionSet * USelectionSetBPLibrary::Subtract_SelectionSets(USelectionSet *A, USelectionSet *B)
+USelectionSet * USelectionSetBPLibrary::Add_SelectionSets(USelectionSet *A, USelectionSet *B)
+{
+	return Add_SelectionSetsInto(A, B, nullptr);
+}
+
+USelectionSet * USelectionSetBPLibrary::Add_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output)
 {
 	// Need both provided
 	if (!A || !B) {
 		return nullptr;
 	}
 
-	auto result = NewObject<USelectionSet>(A->GetOuter());
-	int32 smallestSize = A->weights.Num() < B->weights.Num() ? A->weights.Num() : B->weights.Num();
-	result->weights.SetNumZeroed(smallestSize);
+	return CombineWeights(A, B, FWeightOperation::MakeBinary(FWeightOperation::EType::Add), Output);
+}
+
+USelectionSet * USelectionSetBPLibrary::Subtract_SelectionSets(USelectionSet *A, USelectionSet *B)
+{
+	return Subtract_SelectionSetsInto(A, B, nullptr);
+}
 
-	for (int32 i = 0; i < smallestSize; i++) {
-		result->weights[i] = A->weights[i] - B->weights[i];
+USelectionSet * USelectionSetBPLibrary::Subtract_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output)
+{
+	// Need both provided
+	if (!A || !B) {
+		return nullptr;
 	}
 
-	return result;
+	return CombineWeights(A, B, FWeightOperation::MakeBinary(FWeightOperation::EType::Subtract), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Add_FloatToSelectionSet(USelectionSet *Value, float Float/*=0*/)
+{
+	return Add_FloatToSelectionSetInto(Value, nullptr, Float);
+}
+
+USelectionSet * USelectionSetBPLibrary::Add_FloatToSelectionSetInto(USelectionSet *Value, USelectionSet *Output, float Float/*=0*/)
 {
 	// Need a SelectionSet
 	if (!Value) {
 		return nullptr;
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
-
-	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = Value->weights[i] + Float;
-	}
-
-	return result;
+	return TransformWeights(Value, FWeightOperation::MakeAddScalar(Float), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Subtract_FloatFromSelectionSet(USelectionSet *Value, float Float/*=0*/)
+{
+	return Subtract_FloatFromSelectionSetInto(Value, nullptr, Float);
+}
+
+USelectionSet * USelectionSetBPLibrary::Subtract_FloatFromSelectionSetInto(USelectionSet *Value, USelectionSet *Output, float Float/*=0*/)
 {
 	// Need a SelectionSet
 	if (!Value) {
 		return nullptr;
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
-
-	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = Value->weights[i] - Float;
-	}
-
-	return result;
+	return TransformWeights(Value, FWeightOperation::MakeSubtractScalar(Float), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Subtract_SelectionSetFromFloat(float Float, USelectionSet *Value)
+{
+	return Subtract_SelectionSetFromFloatInto(Float, Value, nullptr);
+}
+
+USelectionSet * USelectionSetBPLibrary::Subtract_SelectionSetFromFloatInto(float Float, USelectionSet *Value, USelectionSet *Output)
 {
 	// Need a SelectionSet
 	if (!Value) {
 		return nullptr;
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
-
-	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = Float - Value->weights[i];
-	}
-
-	return result;
+	return TransformWeights(Value, FWeightOperation::MakeSubtractFromScalar(Float), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Multiply_SelectionSets(USelectionSet *A, USelectionSet *B)
+{
+	return Multiply_SelectionSetsInto(A, B, nullptr);
+}
+
+USelectionSet * USelectionSetBPLibrary::Multiply_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output)
 {
 	// Need both provided
 	if (!A || !B) {
 		return nullptr;
 	}
 
-	auto result = NewObject<USelectionSet>(A->GetOuter());
-	int32 smallestSize = A->weights.Num() < B->weights.Num() ? A->weights.Num() : B->weights.Num();
-	result->weights.SetNumZeroed(smallestSize);
-	for (int32 i = 0; i < smallestSize; i++) {
-		result->weights[i] = A->weights[i] * B->weights[i];
-	}
-
-	return result;
+	return CombineWeights(A, B, FWeightOperation::MakeBinary(FWeightOperation::EType::Multiply), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Multiply_SelctionSetByFloat(USelectionSet *Value, float Float/*=1*/)
+{
+	return Multiply_SelectionSetByFloatInto(Value, nullptr, Float);
+}
+
+USelectionSet * USelectionSetBPLibrary::Multiply_SelectionSetByFloatInto(USelectionSet *Value, USelectionSet *Output, float Float/*=1*/)
 {
 	// Need a SelectionSet
 	if (!Value) {
 		return nullptr;
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
-
-	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = Value->weights[i] * Float;
-	}
-
-	return result;
+	return TransformWeights(Value, FWeightOperation::MakeMultiplyScalar(Float), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Divide_SelectionSets(USelectionSet *A, USelectionSet *B)
+{
+	return Divide_SelectionSetsInto(A, B, nullptr);
+}
+
+USelectionSet * USelectionSetBPLibrary::Divide_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output)
 {
 	// Need both provided
 	if (!A || !B) {
 		return nullptr;
 	}
 
-	auto result = NewObject<USelectionSet>(A->GetOuter());
-	int32 smallestSize = A->weights.Num() < B->weights.Num() ? A->weights.Num() : B->weights.Num();
-	result->weights.SetNumZeroed(smallestSize);
-
-	for (int32 i = 0; i < smallestSize; i++) {
-		result->weights[i] = A->weights[i] / B->weights[i];
-	}
-
-	return result;
+	return CombineWeights(A, B, FWeightOperation::MakeBinary(FWeightOperation::EType::Divide), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Divide_SelctionSetByFloat(USelectionSet *Value, float Float /*= 1*/)
+{
+	return Divide_SelectionSetByFloatInto(Value, nullptr, Float);
+}
+
+USelectionSet * USelectionSetBPLibrary::Divide_SelectionSetByFloatInto(USelectionSet *Value, USelectionSet *Output, float Float /*= 1*/)
 {
 	// Need a SelectionSet
 	if (!Value) {
 		return nullptr;
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
-
-	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = Value->weights[i] / Float;
-	}
-
-	return result;
+	return TransformWeights(Value, FWeightOperation::MakeDivideScalar(Float), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::OneMinus(USelectionSet *Value)
+{
+	return OneMinusInto(Value, nullptr);
+}
+
+USelectionSet * USelectionSetBPLibrary::OneMinusInto(USelectionSet *Value, USelectionSet *Output)
 {
 	// Need a SelectionSet
 	if (!Value) {
 		return nullptr;
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
-
-	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = 1.0f - Value->weights[i];
-	}
-
-	return result;
+	return TransformWeights(Value, FWeightOperation::MakeOneMinus(), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Set(USelectionSet *Value, float Float/*=0*/)
+{
+	return SetInto(Value, nullptr, Float);
+}
+
+USelectionSet * USelectionSetBPLibrary::SetInto(USelectionSet *Value, USelectionSet *Output, float Float/*=0*/)
 {
 	// Need a SelectionSet
 	if (!Value) {
 		return nullptr;
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
-
-	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = Float;
-	}
-
-	return result;
+	return TransformWeights(Value, FWeightOperation::MakeFill(Float), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Randomize(USelectionSet *Value, FRandomStream RandomStream, float Min/*=0*/, float Max/*=1*/)
+{
+	return RandomizeInto(Value, nullptr, RandomStream, Min, Max);
+}
+
+USelectionSet * USelectionSetBPLibrary::RandomizeInto(USelectionSet *Value, USelectionSet *Output, FRandomStream RandomStream, float Min/*=0*/, float Max/*=1*/)
 {
 	// Need a SelectionSet
 	if (!Value) {
 		return nullptr;
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
+	// Every weight gets a random value, so the result is never sparse.  The values don't depend
+	// on the weights so a deferred set doesn't need evaluating.
+	USelectionSet *result = GetOutputSelectionSet(Value, Output);
+	auto size = Value->Num();
+	float *weights = result->ResetDense(size);
 
 	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = RandomStream.FRandRange(Min, Max);
+		weights[i] = RandomStream.FRandRange(Min, Max);
 	}
 
 	return result;
 }
 
 USelectionSet * USelectionSetBPLibrary::Max_SelectionSets(USelectionSet *A, USelectionSet *B)
+{
+	return Max_SelectionSetsInto(A, B, nullptr);
+}
+
+USelectionSet * USelectionSetBPLibrary::Max_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output)
 {
 	// Need both provided
 	if (!A || !B) {
 		return nullptr;
 	}
 
-	auto result = NewObject<USelectionSet>(A->GetOuter());
-	int32 smallestSize = A->weights.Num() < B->weights.Num() ? A->weights.Num() : B->weights.Num();
-	result->weights.SetNumZeroed(smallestSize);
-
-	for (int32 i = 0; i < smallestSize; i++) {
-		//result->weights[i] = A->weights[i] > B->weights[i] ? A->weights[i] : B->weights[i];
-		result->weights[i] = FMath::Max(A->weights[i], B->weights[i]);
-	}
-
-	return result;
+	return CombineWeights(A, B, FWeightOperation::MakeBinary(FWeightOperation::EType::Max), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Min_SelectionSets(USelectionSet *A, USelectionSet *B)
+{
+	return Min_SelectionSetsInto(A, B, nullptr);
+}
+
+USelectionSet * USelectionSetBPLibrary::Min_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output)
 {
 	// Need both provided
 	if (!A || !B) {
 		return nullptr;
 	}
 
-	auto result = NewObject<USelectionSet>(A->GetOuter());
-	int32 smallestSize = A->weights.Num() < B->weights.Num() ? A->weights.Num() : B->weights.Num();
-	result->weights.SetNumZeroed(smallestSize);
-
-	for (int32 i = 0; i < smallestSize; i++) {
-		//result->weights[i] = A->weights[i] < B->weights[i] ? A->weights[i] : B->weights[i];
-		result->weights[i] = FMath::Min(A->weights[i], B->weights[i]);
-	}
-
-	return result;
+	return CombineWeights(A, B, FWeightOperation::MakeBinary(FWeightOperation::EType::Min), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Max_SelectionSetAgainstFloat(USelectionSet *Value, float Float)
+{
+	return Max_SelectionSetAgainstFloatInto(Value, nullptr, Float);
+}
+
+USelectionSet * USelectionSetBPLibrary::Max_SelectionSetAgainstFloatInto(USelectionSet *Value, USelectionSet *Output, float Float)
 {
 	// Need a SelectionSet
 	if (!Value) {
 		return nullptr;
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
-
-	for (int32 i = 0; i < size; i++) {
-		//result->weights[i] = Value->weights[i] > Float ? Value->weights[i] : Float;
-		result->weights[i] = FMath::Max(Value->weights[i], Float);
-	}
-
-	return result;
+	return TransformWeights(Value, FWeightOperation::MakeMaxScalar(Float), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Min_SelectionSetAgainstFloat(USelectionSet *Value, float Float)
+{
+	return Min_SelectionSetAgainstFloatInto(Value, nullptr, Float);
+}
+
+USelectionSet * USelectionSetBPLibrary::Min_SelectionSetAgainstFloatInto(USelectionSet *Value, USelectionSet *Output, float Float)
 {
 	// Need a SelectionSet
 	if (!Value) {
 		return nullptr;
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
-
-	for (int32 i = 0; i < size; i++) {
-		//result->weights[i] = Value->weights[i] < Float ? Value->weights[i] : Float;
-		result->weights[i] = FMath::Min(Value->weights[i], Float);
-	}
-
-	return result;
+	return TransformWeights(Value, FWeightOperation::MakeMinScalar(Float), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Lerp_SelectionSets(USelectionSet *A, USelectionSet *B, float Alpha/*=0*/)
+{
+	return Lerp_SelectionSetsInto(A, B, nullptr, Alpha);
+}
+
+USelectionSet * USelectionSetBPLibrary::Lerp_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output, float Alpha/*=0*/)
 {
 	// Need both provided
 	if (!A || !B) {
 		return nullptr;
 	}
 
-	auto result = NewObject<USelectionSet>(A->GetOuter());
-	int32 smallestSize = A->weights.Num() < B->weights.Num() ? A->weights.Num() : B->weights.Num();
-	result->weights.SetNumZeroed(smallestSize);
-
-	for (int32 i = 0; i < smallestSize; i++) {
-		result->weights[i] = FMath::Lerp(A->weights[i], B->weights[i], Alpha);
-	}
-
-	return result;
-
+	return CombineWeights(A, B, FWeightOperation::MakeBinary(FWeightOperation::EType::Lerp, Alpha), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Lerp_SelectionSetWithFloat(USelectionSet *Value, float Float, float Alpha /*= 0*/)
+{
+	return Lerp_SelectionSetWithFloatInto(Value, nullptr, Float, Alpha);
+}
+
+USelectionSet * USelectionSetBPLibrary::Lerp_SelectionSetWithFloatInto(USelectionSet *Value, USelectionSet *Output, float Float, float Alpha /*= 0*/)
 {
 	// Need a SelectionSet
 	if (!Value) {
 		return nullptr;
 	}
 
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
-
-	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = FMath::Lerp(Value->weights[i], Float, Alpha);
-	}
-
-	return result;
+	return TransformWeights(Value, FWeightOperation::MakeLerpScalar(Float, Alpha), Output);
 }
 
 USelectionSet * USelectionSetBPLibrary::Remap_SelectionSetToCurve(USelectionSet *Value, UCurveFloat *Curve)
+{
+	return Remap_SelectionSetToCurveInto(Value, nullptr, Curve);
+}
+
+USelectionSet * USelectionSetBPLibrary::Remap_SelectionSetToCurveInto(USelectionSet *Value, USelectionSet *Output, UCurveFloat *Curve)
 {
 	// Need a SelectionSet
 	if (!Value) {
@@ -431,54 +715,99 @@ USelectionSet * USelectionSetBPLibrary::Remap_SelectionSetToCurve(USelectionSet
 	// Get the time limits of the curve- we'll scale by the end
 	float CurveTimeStart, CurveTimeEnd;
 	Curve->GetTimeRange(CurveTimeStart, CurveTimeEnd);
-	UE_LOG(LogTemp, Log, TEXT("Curve: %f - %f"), CurveTimeStart, CurveTimeEnd);
 
-	// Create the results at the correct size and zero it.
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	auto size = Value->weights.Num();
-	result->weights.SetNumZeroed(size);
+	// Apply the curve mapping, with a deferred set keeping the curve alive until it's evaluated.
+	if (CurveLookupResolution == 0) {
+		const FWeightOperation remap = FWeightOperation::MakeMap([Curve, CurveTimeEnd](const float *Values, int Count, float *Out) {
+			for (int32 i = 0; i < Count; i++) {
+				Out[i] = Curve->GetFloatValue(Values[i] * CurveTimeEnd);
+			}
+		});
+		return TransformWeights(Value, remap, Output, Curve);
+	}
+
+	const FCurveLookupTablePtr table = GetCurveLookupTable(Curve);
+	const FWeightOperation remap = FWeightOperation::MakeMap([Curve, CurveTimeEnd, table](const float *Values, int Count, float *Out) {
+		// The table only covers weights from 0 to 1, and the curve may carry on past its ends, so
+		// any other weights read the curve itself.  They're noted before looking up the block as
+		// *Out* can be *Values*.
+		int32 outsideIndices[SelectionSetMathBlockSize];
+		float outsideValues[SelectionSetMathBlockSize];
+		for (int32 blockStart = 0; blockStart < Count; blockStart += SelectionSetMathBlockSize) {
+			const int32 blockCount = FMath::Min(SelectionSetMathBlockSize, Count - blockStart);
+			int32 outsideCount = 0;
+			for (int32 i = 0; i < blockCount; i++) {
+				const float value = Values[blockStart + i];
+				if (!(value >= 0.0f && value <= 1.0f)) {
+					outsideIndices[outsideCount] = blockStart + i;
+					outsideValues[outsideCount++] = value;
+				}
+			}
+			table->Sample(Values + blockStart, blockCount, Out + blockStart);
+			for (int32 i = 0; i < outsideCount; i++) {
+				Out[outsideIndices[i]] = Curve->GetFloatValue(outsideValues[i] * CurveTimeEnd);
+			}
+		}
+	});
+	return TransformWeights(Value, remap, Output, Curve);
+}
 
-	// Apply the curve mapping
-	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = Curve->GetFloatValue(Value->weights[i] * CurveTimeEnd);
+void USelectionSetBPLibrary::SetCurveLookupResolution(int32 Resolution /*= 1024*/)
+{
+	if (Resolution < 0 || Resolution == 1) {
+		UE_LOG(LogTemp, Warning, TEXT("SetCurveLookupResolution: Resolution must be 0 or at least 2"));
+		return;
 	}
+	CurveLookupResolution = Resolution;
+}
 
-	return result;
+float USelectionSetBPLibrary::GetCurveLookupError(UCurveFloat *Curve)
+{
+	// Need a Curve
+	if (!Curve || CurveLookupResolution == 0) {
+		return 0.0f;
+	}
+
+	return GetCurveLookupTable(Curve)->GetMaxError();
 }
 
 USelectionSet * USelectionSetBPLibrary::Remap_Range(USelectionSet *Value, float Min /*= 0.0f*/, float Max /*= 1.0f*/)
+{
+	return Remap_RangeInto(Value, nullptr, Min, Max);
+}
+
+USelectionSet * USelectionSetBPLibrary::Remap_RangeInto(USelectionSet *Value, USelectionSet *Output, float Min /*= 0.0f*/, float Max /*= 1.0f*/)
 {
 	// Need a SelectionSet, and it needs at least one value.
 	if (!Value) {
 		return nullptr;
 	}
-	int32 size = Value->weights.Num();
+	int32 size = Value->Num();
 	if (size == 0) {
 		return nullptr;
 	}
 
-	// Find the current minimum and maximum.
-	float CurrentMinimum = Value->weights[0];
-	float CurrentMaximum = Value->weights[0];
-	for (int32 i = 1; i < size; i++) {
-		CurrentMinimum = FMath::Min(CurrentMinimum, Value->weights[i]);
-		CurrentMaximum = FMath::Max(CurrentMaximum, Value->weights[i]);
-	}
-
-	// Create the results at the correct size and zero it.
-	USelectionSet *result = NewObject<USelectionSet>(Value->GetOuter());
-	result->weights.SetNumZeroed(size);
+	// Find the current minimum and maximum, which are kept on sparse and quantized sets until
+	// they're modified.
+	const FSelectionSetStatistics &statistics = Value->GetStatistics();
+	const float CurrentMinimum = statistics.Min;
+	const float CurrentMaximum = statistics.Max;
 
 	// Check if all values are the same- if so just return a flat result equal to Min.
 	if (CurrentMinimum == CurrentMaximum) {
-		return Set(result, Min);
+		return SetInto(Value, Output, Min);
 	}
 
 	// Perform the remapping
-	float Scale = (Max-Min) / (CurrentMaximum - CurrentMinimum);
-	for (int32 i = 0; i < size; i++) {
-		result->weights[i] = (Value->weights[i] - CurrentMinimum) * Scale + Min;
+	return TransformWeights(Value, FWeightOperation::MakeRemapRange(CurrentMinimum, CurrentMaximum, Min, Max), Output);
+}
+
+FSelectionSetStatistics USelectionSetBPLibrary::GetSelectionStatistics(USelectionSet *Value)
+{
+	// Need a SelectionSet
+	if (!Value) {
+		return FSelectionSetStatistics();
 	}
 
-	return result;
+	return Value->GetStatistics();
 }
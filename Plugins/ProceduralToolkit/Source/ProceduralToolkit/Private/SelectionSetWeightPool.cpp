@@ -0,0 +1,138 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ProceduralToolkit.h"
+#include "SelectionSetWeightPool.h"
+
+FSelectionSetWeightPool &FSelectionSetWeightPool::Get()
+{
+	static FSelectionSetWeightPool Pool;
+	return Pool;
+}
+
+int32 FSelectionSetWeightPool::RoundUpToSizeClass(int32 Size)
+{
+	if (Size <= 4) {
+		return Size;
+	}
+	const int32 Octave = 1 << FMath::FloorLog2(Size);
+	const int32 Step = Octave / 4;
+	return Octave + (Size - Octave + Step - 1) / Step * Step;
+}
+
+int32 FSelectionSetWeightPool::RoundDownToSizeClass(int32 Size)
+{
+	if (Size <= 4) {
+		return Size;
+	}
+	const int32 Octave = 1 << FMath::FloorLog2(Size);
+	const int32 Step = Octave / 4;
+	return Octave + (Size - Octave) / Step * Step;
+}
+
+void FSelectionSetWeightPool::Reserve(TArray<float> &Weights, int32 Size)
+{
+	if (Weights.Max() >= Size) {
+		Weights.Reset();
+		return;
+	}
+	Release(Weights);
+	if (Size < MinPooledSize) {
+		Weights.Reserve(Size);
+		return;
+	}
+
+	// New arrays are made the size of their class, so they can be reused for anything in it.
+	const int32 SizeClassSize = RoundUpToSizeClass(Size);
+	{
+		FScopeLock Lock(&Mutex);
+		FSizeClass *SizeClass = SizeClasses.Find(SizeClassSize);
+		if (SizeClass && SizeClass->Arrays.Num() > 0) {
+			Weights = SizeClass->Arrays.Pop(false);
+			SizeClass->LastUsedFrame = GFrameCounter;
+			MemoryUsed -= Weights.GetAllocatedSize();
+			return;
+		}
+	}
+	Weights.Reserve(SizeClassSize);
+}
+
+void FSelectionSetWeightPool::Release(TArray<float> &Weights)
+{
+	const SIZE_T Size = Weights.GetAllocatedSize();
+	if (Weights.Max() < MinPooledSize) {
+		Weights.Empty();
+		return;
+	}
+
+	// The array is the most recently used, so older size classes make room for it.
+	FScopeLock Lock(&Mutex);
+	const int32 SizeClassSize = RoundDownToSizeClass(Weights.Max());
+	if (MemoryUsed + Size > MemoryBudget && (Size > MemoryBudget || !FreeLeastRecentlyUsed(MemoryBudget - Size, SizeClassSize))) {
+		Weights.Empty();
+		return;
+	}
+	FSizeClass &SizeClass = SizeClasses.FindOrAdd(SizeClassSize);
+	Weights.Reset();
+	SizeClass.Arrays.Add(MoveTemp(Weights));
+	SizeClass.LastUsedFrame = GFrameCounter;
+	MemoryUsed += Size;
+}
+
+void FSelectionSetWeightPool::Trim()
+{
+	FScopeLock Lock(&Mutex);
+	for (auto SizeClass = SizeClasses.CreateIterator(); SizeClass; ++SizeClass) {
+		if (SizeClass.Value().LastUsedFrame + MaxIdleFrames < GFrameCounter) {
+			FreeSizeClass(SizeClass.Value());
+			SizeClass.RemoveCurrent();
+		}
+	}
+}
+
+void FSelectionSetWeightPool::Empty()
+{
+	FScopeLock Lock(&Mutex);
+	SizeClasses.Empty();
+	MemoryUsed = 0;
+}
+
+void FSelectionSetWeightPool::SetMemoryBudget(SIZE_T InMemoryBudget)
+{
+	FScopeLock Lock(&Mutex);
+	MemoryBudget = InMemoryBudget;
+	FreeLeastRecentlyUsed(MemoryBudget, -1);
+}
+
+SIZE_T FSelectionSetWeightPool::GetMemoryUsed() const
+{
+	FScopeLock Lock(&Mutex);
+	return MemoryUsed;
+}
+
+bool FSelectionSetWeightPool::FreeLeastRecentlyUsed(SIZE_T Budget, int32 KeptSizeClass)
+{
+	while (MemoryUsed > Budget) {
+		int32 OldestKey = -1;
+		uint64 OldestFrame = MAX_uint64;
+		for (const auto &SizeClass : SizeClasses) {
+			if (SizeClass.Key != KeptSizeClass && SizeClass.Value.LastUsedFrame < OldestFrame) {
+				OldestKey = SizeClass.Key;
+				OldestFrame = SizeClass.Value.LastUsedFrame;
+			}
+		}
+		if (OldestKey < 0) {
+			return false;
+		}
+		FreeSizeClass(SizeClasses[OldestKey]);
+		SizeClasses.Remove(OldestKey);
+	}
+	return true;
+}
+
+void FSelectionSetWeightPool::FreeSizeClass(FSizeClass &SizeClass)
+{
+	for (const TArray<float> &Weights : SizeClass.Arrays) {
+		MemoryUsed -= Weights.GetAllocatedSize();
+	}
+	SizeClass.Arrays.Empty();
+}
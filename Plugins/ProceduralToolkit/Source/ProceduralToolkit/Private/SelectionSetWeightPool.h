@@ -0,0 +1,88 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// Weight arrays given up by SelectionSets, kept to be reused by new SelectionSets rather than
+/// freed and allocated again.
+///
+/// Arrays are grouped into size classes, a quarter of an octave apart, so a SelectionSet for a
+/// mesh reuses the memory of earlier SelectionSets for the same mesh or one of a similar size.
+/// Size classes which haven't been used for *MaxIdleFrames* frames have their arrays freed at
+/// the end of the frame.  An array given back when the pool is at its memory budget makes room
+/// by freeing the arrays of the size classes used least recently, and is only freed itself if
+/// there's nothing else to free.  Arrays smaller than *MinPooledSize* aren't worth keeping and
+/// are left to the allocator.
+///
+/// This is thread-safe.
+class FSelectionSetWeightPool
+{
+public:
+	/// The number of frames a size class can go unused before its arrays are freed
+	static const uint64 MaxIdleFrames = 120;
+
+	/// The smallest number of weights an array is pooled for
+	static const int32 MinPooledSize = 1024;
+
+	/// Return the pool shared by every SelectionSet.
+	static FSelectionSetWeightPool &Get();
+
+	/// Empty an array, making sure it has room for *Size* weights.  An array without room is
+	/// given back to the pool and replaced with one from the pool, or a new one if there isn't
+	/// one, so filling it in doesn't allocate.
+	///
+	/// \param Weights			The array
+	/// \param Size				The number of weights it needs room for
+	void Reserve(TArray<float> &Weights, int32 Size);
+
+	/// Give an array's memory to the pool, leaving the array empty.
+	void Release(TArray<float> &Weights);
+
+	/// Free the arrays of size classes which haven't been used recently, called at the end of every frame.
+	void Trim();
+
+	/// Free every array in the pool.
+	void Empty();
+
+	/// Set the most memory the arrays in the pool can take, freeing arrays if they now take more.
+	void SetMemoryBudget(SIZE_T InMemoryBudget);
+
+	/// Return the memory taken by the arrays in the pool.
+	SIZE_T GetMemoryUsed() const;
+
+private:
+	struct FSizeClass
+	{
+		/// Empty arrays with room for at least the size class's weights
+		TArray<TArray<float>> Arrays;
+
+		/// The frame an array was last taken from or given to the class
+		uint64 LastUsedFrame = 0;
+	};
+
+	/// Return the number of weights in the smallest size class at least *Size*.
+	static int32 RoundUpToSizeClass(int32 Size);
+
+	/// Return the number of weights in the largest size class no more than *Size*.
+	static int32 RoundDownToSizeClass(int32 Size);
+
+	/// Free the arrays of a size class.  Called with *Mutex* held.
+	void FreeSizeClass(FSizeClass &SizeClass);
+
+	/// Free the arrays of the least recently used size classes until the pool takes no more than
+	/// *Budget*.  Called with *Mutex* held.
+	///
+	/// \param Budget			The most memory the pool can be left taking
+	/// \param KeptSizeClass	A size class which isn't freed, or -1 to allow any
+	/// \return Whether the pool now fits in *Budget*
+	bool FreeLeastRecentlyUsed(SIZE_T Budget, int32 KeptSizeClass);
+
+	mutable FCriticalSection Mutex;
+
+	/// The arrays of each size class, by the number of weights they have room for
+	TMap<int32, FSizeClass> SizeClasses;
+
+	SIZE_T MemoryBudget = 64 * 1024 * 1024;
+	SIZE_T MemoryUsed = 0;
+};
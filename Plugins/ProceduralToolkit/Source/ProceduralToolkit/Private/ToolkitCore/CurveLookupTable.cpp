@@ -0,0 +1,118 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ToolkitCore/CurveLookupTable.h"
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CURVELOOKUPTABLE_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CURVELOOKUPTABLE_NEON 1
+#include <arm_neon.h>
+#endif
+
+void FCurveLookupTable::Bake(const std::function<float(float Alpha)> &Evaluate, int Resolution)
+{
+	if (Resolution < 2) {
+		Resolution = 2;
+	}
+	const float Spacing = 1.0f / (float)(Resolution - 1);
+
+	Entries.resize((size_t)Resolution * 2);
+	for (int Sample = 0; Sample < Resolution; ++Sample) {
+		// The last sample is exactly 1, so a weight of 1 gets the end of the curve.
+		Entries[Sample * 2] = Evaluate(Sample == Resolution - 1 ? 1.0f : Sample * Spacing);
+	}
+	for (int Sample = 0; Sample < Resolution - 1; ++Sample) {
+		Entries[Sample * 2 + 1] = Entries[Sample * 2 + 2] - Entries[Sample * 2];
+	}
+	Entries[Resolution * 2 - 1] = 0.0f;
+
+	MaxError = 0.0f;
+	for (int Sample = 0; Sample < Resolution - 1; ++Sample) {
+		for (int Quarter = 1; Quarter < 4; ++Quarter) {
+			const float Fraction = Quarter * 0.25f;
+			const float Interpolated = Entries[Sample * 2] + Entries[Sample * 2 + 1] * Fraction;
+			const float Error = fabsf(Evaluate((Sample + Fraction) * Spacing) - Interpolated);
+			if (Error > MaxError) {
+				MaxError = Error;
+			}
+		}
+	}
+}
+
+void FCurveLookupTable::Sample(const float *Values, int Count, float *Out) const
+{
+	const int Resolution = GetResolution();
+	if (Resolution == 0) {
+		for (int Index = 0; Index < Count; ++Index) {
+			Out[Index] = 0.0f;
+		}
+		return;
+	}
+
+	// A baked table has at least two samples.  A weight of 1 would land on the last sample, so use
+	// the pair before it with a fraction of 1 instead, keeping every lookup inside the table.
+	const float *Pairs = Entries.data();
+	const float Scale = (float)(Resolution - 1);
+	const int LastPair = Resolution - 2;
+	int Index = 0;
+
+#if defined(CURVELOOKUPTABLE_SSE)
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 One = _mm_set1_ps(1.0f);
+	const __m128 ScaleLanes = _mm_set1_ps(Scale);
+	const __m128i LastPairLanes = _mm_set1_epi32(LastPair);
+	for (; Index + 4 <= Count; Index += 4) {
+		int Pair[4];
+		// Max returns its second operand for a NaN, so NaNs become zero here.
+		const __m128 Alpha = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(Values + Index), Zero), One);
+		const __m128 Position = _mm_mul_ps(Alpha, ScaleLanes);
+		__m128i PairLanes = _mm_cvttps_epi32(Position);
+		// SSE2 has no integer min, so compare and blend.
+		const __m128i Over = _mm_cmpgt_epi32(PairLanes, LastPairLanes);
+		PairLanes = _mm_or_si128(_mm_and_si128(Over, LastPairLanes), _mm_andnot_si128(Over, PairLanes));
+		const __m128 Fraction = _mm_sub_ps(Position, _mm_cvtepi32_ps(PairLanes));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(Pair), PairLanes);
+
+		// There's no gather, so load the pairs two at a time and split them into samples and differences.
+		const __m128 Pairs01 = _mm_loadh_pi(_mm_loadl_pi(Zero, reinterpret_cast<const __m64 *>(Pairs + Pair[0] * 2)), reinterpret_cast<const __m64 *>(Pairs + Pair[1] * 2));
+		const __m128 Pairs23 = _mm_loadh_pi(_mm_loadl_pi(Zero, reinterpret_cast<const __m64 *>(Pairs + Pair[2] * 2)), reinterpret_cast<const __m64 *>(Pairs + Pair[3] * 2));
+		const __m128 Samples = _mm_shuffle_ps(Pairs01, Pairs23, _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 Differences = _mm_shuffle_ps(Pairs01, Pairs23, _MM_SHUFFLE(3, 1, 3, 1));
+		_mm_storeu_ps(Out + Index, _mm_add_ps(Samples, _mm_mul_ps(Differences, Fraction)));
+	}
+#elif defined(CURVELOOKUPTABLE_NEON)
+	const float32x4_t Zero = vdupq_n_f32(0.0f);
+	const float32x4_t One = vdupq_n_f32(1.0f);
+	const float32x4_t ScaleLanes = vdupq_n_f32(Scale);
+	const int32x4_t LastPairLanes = vdupq_n_s32(LastPair);
+	for (; Index + 4 <= Count; Index += 4) {
+		int Pair[4];
+		// Compare against zero rather than using max, so NaNs become zero as they do for SSE.
+		float32x4_t Alpha = vld1q_f32(Values + Index);
+		Alpha = vbslq_f32(vcgtq_f32(Alpha, Zero), Alpha, Zero);
+		Alpha = vminq_f32(Alpha, One);
+		const float32x4_t Position = vmulq_f32(Alpha, ScaleLanes);
+		const int32x4_t PairLanes = vminq_s32(vcvtq_s32_f32(Position), LastPairLanes);
+		const float32x4_t Fraction = vsubq_f32(Position, vcvtq_f32_s32(PairLanes));
+		vst1q_s32(Pair, PairLanes);
+
+		const float32x4_t Pairs01 = vcombine_f32(vld1_f32(Pairs + Pair[0] * 2), vld1_f32(Pairs + Pair[1] * 2));
+		const float32x4_t Pairs23 = vcombine_f32(vld1_f32(Pairs + Pair[2] * 2), vld1_f32(Pairs + Pair[3] * 2));
+		const float32x4x2_t Split = vuzpq_f32(Pairs01, Pairs23);
+		vst1q_f32(Out + Index, vmlaq_f32(Split.val[0], Split.val[1], Fraction));
+	}
+#endif
+
+	for (; Index < Count; ++Index) {
+		const float Value = Values[Index];
+		const float Alpha = !(Value > 0.0f) ? 0.0f : Value < 1.0f ? Value : 1.0f;
+		const float Position = Alpha * Scale;
+		int Pair = (int)Position;
+		if (Pair > LastPair) {
+			Pair = LastPair;
+		}
+		Out[Index] = Pairs[Pair * 2] + Pairs[Pair * 2 + 1] * (Position - (float)Pair);
+	}
+}
@@ -0,0 +1,316 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ToolkitCore/MeshAdjacency.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string.h>
+
+/// The number of vertices or triangles each task of *Build* works through.
+static const int AdjacencyTaskSize = 16 * 1024;
+
+/// Run tasks with a *ParallelFor*, or one after another without one.
+static void RunTasks(const FMeshAdjacency::FParallelFor &ParallelFor, int TaskCount, const std::function<void(int Task)> &Task)
+{
+	if (ParallelFor) {
+		ParallelFor(TaskCount, Task);
+	} else {
+		for (int TaskIndex = 0; TaskIndex < TaskCount; ++TaskIndex) {
+			Task(TaskIndex);
+		}
+	}
+}
+
+/// Return the number of tasks needed to cover *Count* items.
+static int GetTaskCount(int Count)
+{
+	return (Count + AdjacencyTaskSize - 1) / AdjacencyTaskSize;
+}
+
+/// Sort a row, which is usually short enough for an insertion sort to beat *std::sort*.
+static void SortRow(int *First, int *Last)
+{
+	if (Last - First > 32) {
+		std::sort(First, Last);
+		return;
+	}
+	for (int *Entry = First + 1; Entry < Last; ++Entry) {
+		const int Value = *Entry;
+		int *Hole = Entry;
+		for (; Hole > First && Hole[-1] > Value; --Hole) {
+			*Hole = Hole[-1];
+		}
+		*Hole = Value;
+	}
+}
+
+/// Turn counts into the offsets of rows, with one more offset than there are counts.
+static void CountsToOffsets(const std::vector<int> &Counts, std::vector<int> &OutOffsets)
+{
+	const int Count = (int)Counts.size();
+	OutOffsets.resize((size_t)Count + 1);
+	int Offset = 0;
+	for (int Index = 0; Index < Count; ++Index) {
+		OutOffsets[Index] = Offset;
+		Offset += Counts[Index];
+	}
+	OutOffsets[Count] = Offset;
+}
+
+void FMeshAdjacency::Build(const FSource *Sources, int SourceCount, bool bWeld, const FParallelFor &ParallelFor)
+{
+	Reset();
+	bWelded = bWeld;
+
+	// Where each section's vertices and triangles start in the numbering across every section.
+	std::vector<int> FirstVertices((size_t)SourceCount + 1);
+	std::vector<int> FirstTriangles((size_t)SourceCount + 1);
+	for (int SourceIndex = 0; SourceIndex < SourceCount; ++SourceIndex) {
+		FirstVertices[SourceIndex + 1] = FirstVertices[SourceIndex] + Sources[SourceIndex].VertexCount;
+		FirstTriangles[SourceIndex + 1] = FirstTriangles[SourceIndex] + Sources[SourceIndex].TriangleCount;
+	}
+	const int VertexCount = FirstVertices[SourceCount];
+	TriangleCount = FirstTriangles[SourceCount];
+
+	Representatives.resize(VertexCount);
+	if (bWeld) {
+		Weld(Sources, SourceCount, FirstVertices);
+	} else {
+		for (int Vertex = 0; Vertex < VertexCount; ++Vertex) {
+			Representatives[Vertex] = Vertex;
+		}
+	}
+
+	// The corners of every triangle as representatives, with -1 for a triangle with an index
+	// outside its section and for a corner on the same vertex as an earlier one.
+	std::vector<int> Corners((size_t)TriangleCount * 3);
+	RunTasks(ParallelFor, GetTaskCount(TriangleCount), [&](int Task) {
+		const int First = Task * AdjacencyTaskSize;
+		const int Last = std::min(First + AdjacencyTaskSize, TriangleCount);
+		int SourceIndex = (int)(std::upper_bound(FirstTriangles.begin(), FirstTriangles.end(), First) - FirstTriangles.begin()) - 1;
+		for (int Triangle = First; Triangle < Last; ++Triangle) {
+			while (Triangle >= FirstTriangles[SourceIndex + 1]) {
+				++SourceIndex;
+			}
+			const FSource &Source = Sources[SourceIndex];
+			const int *Indices = Source.Triangles + (Triangle - FirstTriangles[SourceIndex]) * 3;
+			int *TriangleCorners = Corners.data() + Triangle * 3;
+			if ((unsigned)Indices[0] >= (unsigned)Source.VertexCount || (unsigned)Indices[1] >= (unsigned)Source.VertexCount ||
+				(unsigned)Indices[2] >= (unsigned)Source.VertexCount) {
+				TriangleCorners[0] = TriangleCorners[1] = TriangleCorners[2] = -1;
+				continue;
+			}
+			const int FirstVertex = FirstVertices[SourceIndex];
+			const int Corner0 = Representatives[FirstVertex + Indices[0]];
+			const int Corner1 = Representatives[FirstVertex + Indices[1]];
+			const int Corner2 = Representatives[FirstVertex + Indices[2]];
+			TriangleCorners[0] = Corner0;
+			TriangleCorners[1] = Corner1 != Corner0 ? Corner1 : -1;
+			TriangleCorners[2] = (Corner2 != Corner0 && Corner2 != Corner1) ? Corner2 : -1;
+		}
+	});
+
+	// The corners are sorted into rows with a counting sort split in two, so that no two tasks
+	// write to the same place.  Each task of triangles first counts and then copies its corners
+	// into blocks of vertices, and then each block is sorted into rows on its own.  As every
+	// step keeps the corners in order, each row comes out in order of triangle.
+	const int CornerTaskCount = GetTaskCount(TriangleCount * 3);
+	const int BlockCount = GetTaskCount(VertexCount);
+	std::vector<int> TaskBlockOffsets((size_t)CornerTaskCount * BlockCount);
+	RunTasks(ParallelFor, CornerTaskCount, [&](int Task) {
+		int *BlockCounts = TaskBlockOffsets.data() + (size_t)Task * BlockCount;
+		const int Last = std::min((Task + 1) * AdjacencyTaskSize, TriangleCount * 3);
+		for (int Corner = Task * AdjacencyTaskSize; Corner < Last; ++Corner) {
+			if (Corners[Corner] >= 0) {
+				++BlockCounts[Corners[Corner] / AdjacencyTaskSize];
+			}
+		}
+	});
+	std::vector<int> BlockOffsets((size_t)BlockCount + 1);
+	int Offset = 0;
+	for (int Block = 0; Block < BlockCount; ++Block) {
+		BlockOffsets[Block] = Offset;
+		for (int Task = 0; Task < CornerTaskCount; ++Task) {
+			const int Count = TaskBlockOffsets[(size_t)Task * BlockCount + Block];
+			TaskBlockOffsets[(size_t)Task * BlockCount + Block] = Offset;
+			Offset += Count;
+		}
+	}
+	BlockOffsets[BlockCount] = Offset;
+
+	std::vector<int> BlockCorners(Offset);
+	RunTasks(ParallelFor, CornerTaskCount, [&](int Task) {
+		int *Next = TaskBlockOffsets.data() + (size_t)Task * BlockCount;
+		const int Last = std::min((Task + 1) * AdjacencyTaskSize, TriangleCount * 3);
+		for (int Corner = Task * AdjacencyTaskSize; Corner < Last; ++Corner) {
+			if (Corners[Corner] >= 0) {
+				BlockCorners[Next[Corners[Corner] / AdjacencyTaskSize]++] = Corner;
+			}
+		}
+	});
+
+	VertexTriangleOffsets.resize((size_t)VertexCount + 1);
+	VertexTriangles.resize(Offset);
+	VertexTriangleOffsets[VertexCount] = Offset;
+	RunTasks(ParallelFor, BlockCount, [&](int Block) {
+		const int First = Block * AdjacencyTaskSize;
+		const int Last = std::min(First + AdjacencyTaskSize, VertexCount);
+		std::vector<int> Next(Last - First);
+		for (int Entry = BlockOffsets[Block]; Entry < BlockOffsets[Block + 1]; ++Entry) {
+			++Next[Corners[BlockCorners[Entry]] - First];
+		}
+		int RowOffset = BlockOffsets[Block];
+		for (int Vertex = First; Vertex < Last; ++Vertex) {
+			const int Count = Next[Vertex - First];
+			VertexTriangleOffsets[Vertex] = RowOffset;
+			Next[Vertex - First] = RowOffset;
+			RowOffset += Count;
+		}
+		for (int Entry = BlockOffsets[Block]; Entry < BlockOffsets[Block + 1]; ++Entry) {
+			const int Corner = BlockCorners[Entry];
+			VertexTriangles[Next[Corners[Corner] - First]++] = Corner / 3;
+		}
+	});
+
+	// The neighbours of a vertex are the other corners of its triangles.  Each task gathers the
+	// rows for its vertices into a buffer of its own, which are copied into place once the
+	// offsets are known.  A triangle adds at most two neighbours, which bounds the buffer.
+	const int NeighbourTaskCount = GetTaskCount(VertexCount);
+	std::vector<int> NeighbourCounts(VertexCount);
+	std::vector<std::unique_ptr<int[]>> TaskNeighbours(NeighbourTaskCount);
+	RunTasks(ParallelFor, NeighbourTaskCount, [&](int Task) {
+		const int First = Task * AdjacencyTaskSize;
+		const int Last = std::min(First + AdjacencyTaskSize, VertexCount);
+		TaskNeighbours[Task].reset(new int[(size_t)(VertexTriangleOffsets[Last] - VertexTriangleOffsets[First]) * 2]);
+		int *Row = TaskNeighbours[Task].get();
+		for (int Vertex = First; Vertex < Last; ++Vertex) {
+			int *RowEnd = Row;
+			for (int Entry = VertexTriangleOffsets[Vertex]; Entry < VertexTriangleOffsets[Vertex + 1]; ++Entry) {
+				const int *TriangleCorners = Corners.data() + VertexTriangles[Entry] * 3;
+				for (int Corner = 0; Corner < 3; ++Corner) {
+					const int Neighbour = TriangleCorners[Corner];
+					if (Neighbour >= 0 && Neighbour != Vertex) {
+						*RowEnd++ = Neighbour;
+					}
+				}
+			}
+			SortRow(Row, RowEnd);
+			RowEnd = std::unique(Row, RowEnd);
+			NeighbourCounts[Vertex] = (int)(RowEnd - Row);
+			Row = RowEnd;
+		}
+	});
+	CountsToOffsets(NeighbourCounts, VertexNeighbourOffsets);
+	VertexNeighbours.resize(VertexNeighbourOffsets[VertexCount]);
+	RunTasks(ParallelFor, NeighbourTaskCount, [&](int Task) {
+		const int First = Task * AdjacencyTaskSize;
+		const int Last = std::min(First + AdjacencyTaskSize, VertexCount);
+		std::copy(
+			TaskNeighbours[Task].get(), TaskNeighbours[Task].get() + (VertexNeighbourOffsets[Last] - VertexNeighbourOffsets[First]),
+			VertexNeighbours.begin() + VertexNeighbourOffsets[First]
+		);
+		TaskNeighbours[Task].reset();
+	});
+
+	// Group the welded vertices by representative, in increasing order within each group.
+	if (bWeld) {
+		WeldedCopyOffsets.assign((size_t)VertexCount + 1, 0);
+		for (int Vertex = 0; Vertex < VertexCount; ++Vertex) {
+			++WeldedCopyOffsets[Representatives[Vertex] + 1];
+		}
+		for (int Vertex = 0; Vertex < VertexCount; ++Vertex) {
+			WeldedCopyOffsets[Vertex + 1] += WeldedCopyOffsets[Vertex];
+		}
+		WeldedCopies.resize(VertexCount);
+		std::vector<int> Next(WeldedCopyOffsets.begin(), WeldedCopyOffsets.end() - 1);
+		for (int Vertex = 0; Vertex < VertexCount; ++Vertex) {
+			WeldedCopies[Next[Representatives[Vertex]]++] = Vertex;
+		}
+	}
+}
+
+void FMeshAdjacency::Weld(const FSource *Sources, int SourceCount, const std::vector<int> &FirstVertices)
+{
+	// An open addressed hash table of positions, holding the first vertex found at each.  This is
+	// the one step done on a single thread, as the first vertex at a position has to win.
+	struct FEntry
+	{
+		uint32_t Bits[3];
+		int Vertex;
+	};
+	const int VertexCount = FirstVertices[SourceCount];
+	size_t TableSize = 16;
+	while (TableSize < (size_t)VertexCount * 2) {
+		TableSize *= 2;
+	}
+	std::vector<FEntry> Table(TableSize);
+	for (FEntry &Entry : Table) {
+		Entry.Vertex = -1;
+	}
+
+	for (int SourceIndex = 0; SourceIndex < SourceCount; ++SourceIndex) {
+		const FSource &Source = Sources[SourceIndex];
+		for (int LocalVertex = 0; LocalVertex < Source.VertexCount; ++LocalVertex) {
+			// Adding zero turns -0 into 0, so they weld.
+			uint32_t Bits[3];
+			for (int Axis = 0; Axis < 3; ++Axis) {
+				const float Coordinate = Source.Positions[LocalVertex * 3 + Axis] + 0.0f;
+				memcpy(&Bits[Axis], &Coordinate, sizeof(Coordinate));
+			}
+			// The differences between nearby positions are in the high bits of the floats, so these
+			// are mixed all the way down to the low bits used for the slot.
+			uint64_t Hash = (Bits[0] * 0x9E3779B97F4A7C15ull) ^ (Bits[1] * 0xC2B2AE3D27D4EB4Full) ^ (Bits[2] * 0x165667B19E3779F9ull);
+			Hash ^= Hash >> 33;
+			Hash *= 0xFF51AFD7ED558CCDull;
+			Hash ^= Hash >> 33;
+
+			const int Vertex = FirstVertices[SourceIndex] + LocalVertex;
+			size_t Slot = (size_t)Hash & (TableSize - 1);
+			while (true) {
+				FEntry &Entry = Table[Slot];
+				if (Entry.Vertex < 0) {
+					memcpy(Entry.Bits, Bits, sizeof(Bits));
+					Entry.Vertex = Vertex;
+					Representatives[Vertex] = Vertex;
+					break;
+				}
+				if (memcmp(Entry.Bits, Bits, sizeof(Bits)) == 0) {
+					Representatives[Vertex] = Entry.Vertex;
+					break;
+				}
+				Slot = (Slot + 1) & (TableSize - 1);
+			}
+		}
+	}
+}
+
+void FMeshAdjacency::Reset()
+{
+	bWelded = false;
+	TriangleCount = 0;
+	std::vector<int>().swap(Representatives);
+	std::vector<int>().swap(WeldedCopyOffsets);
+	std::vector<int>().swap(WeldedCopies);
+	std::vector<int>().swap(VertexNeighbourOffsets);
+	std::vector<int>().swap(VertexNeighbours);
+	std::vector<int>().swap(VertexTriangleOffsets);
+	std::vector<int>().swap(VertexTriangles);
+}
+
+int FMeshAdjacency::GetWeldedCopies(int Vertex, const int *&OutCopies) const
+{
+	if (!bWelded) {
+		// Without welding each vertex is its own representative.
+		OutCopies = Representatives.data() + Vertex;
+		return 1;
+	}
+	const int Group = Representatives[Vertex];
+	OutCopies = WeldedCopies.data() + WeldedCopyOffsets[Group];
+	return WeldedCopyOffsets[Group + 1] - WeldedCopyOffsets[Group];
+}
+
+size_t FMeshAdjacency::GetMemorySize() const
+{
+	return (Representatives.size() + WeldedCopyOffsets.size() + WeldedCopies.size() + VertexNeighbourOffsets.size() +
+		VertexNeighbours.size() + VertexTriangleOffsets.size() + VertexTriangles.size()) * sizeof(int);
+}
@@ -0,0 +1,141 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ToolkitCore/NoiseKernels.h"
+#include "NoiseKernelsSIMD.h"
+
+#if NOISEKERNELS_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if NOISEKERNELS_X86
+/// Run CPUID for a leaf, writing EAX, EBX, ECX and EDX, or zeroes if the leaf isn't supported.
+static void ReadCPUID(unsigned int Leaf, unsigned int OutRegisters[4])
+{
+	OutRegisters[0] = OutRegisters[1] = OutRegisters[2] = OutRegisters[3] = 0;
+#if defined(_MSC_VER)
+	int Registers[4];
+	__cpuid(Registers, 0);
+	if ((unsigned int)Registers[0] < Leaf) {
+		return;
+	}
+	__cpuidex(Registers, (int)Leaf, 0);
+	for (int Index = 0; Index < 4; ++Index) {
+		OutRegisters[Index] = (unsigned int)Registers[Index];
+	}
+#else
+	if (__get_cpuid_max(0, nullptr) < Leaf) {
+		return;
+	}
+	__cpuid_count(Leaf, 0, OutRegisters[0], OutRegisters[1], OutRegisters[2], OutRegisters[3]);
+#endif
+}
+
+/// Return the OS-enabled state components from XCR0, which is only valid if OSXSAVE is set.
+static unsigned long long ReadXCR0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int Low, High;
+	__asm__ __volatile__("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+	return ((unsigned long long)High << 32) | Low;
+#endif
+}
+#endif
+
+static NoiseKernels::EInstructionSet DetectInstructionSet()
+{
+#if NOISEKERNELS_X86
+	unsigned int Features[4], ExtendedFeatures[4];
+	ReadCPUID(1, Features);
+	ReadCPUID(7, ExtendedFeatures);
+
+	const bool bSSE2 = (Features[3] & (1u << 26)) != 0;
+	const bool bOSXSAVE = (Features[2] & (1u << 27)) != 0;
+	const bool bAVX = (Features[2] & (1u << 28)) != 0;
+	const bool bAVX2 = (ExtendedFeatures[1] & (1u << 5)) != 0;
+
+	// The OS also has to save the YMM registers on context switches, or AVX can't be used.
+	if (bSSE2 && bOSXSAVE && bAVX && bAVX2 && (ReadXCR0() & 0x6) == 0x6) {
+		return NoiseKernels::EInstructionSet::AVX2;
+	}
+	if (bSSE2) {
+		return NoiseKernels::EInstructionSet::SSE2;
+	}
+#elif NOISEKERNELS_NEON
+	// NEON is only compiled in when the target guarantees it.
+	return NoiseKernels::EInstructionSet::NEON;
+#endif
+	return NoiseKernels::EInstructionSet::Scalar;
+}
+
+NoiseKernels::EInstructionSet NoiseKernels::GetSupportedInstructionSet()
+{
+	static const EInstructionSet Supported = DetectInstructionSet();
+	return Supported;
+}
+
+bool NoiseKernels::IsSupported(EInstructionSet InstructionSet)
+{
+	const EInstructionSet Supported = GetSupportedInstructionSet();
+	switch (InstructionSet) {
+	case EInstructionSet::Scalar:
+		return true;
+	case EInstructionSet::SSE2:
+		return Supported == EInstructionSet::SSE2 || Supported == EInstructionSet::AVX2;
+	default:
+		return InstructionSet == Supported;
+	}
+}
+
+const char *NoiseKernels::GetInstructionSetName(EInstructionSet InstructionSet)
+{
+	switch (InstructionSet) {
+	case EInstructionSet::Scalar:
+		return "Scalar";
+	case EInstructionSet::SSE2:
+		return "SSE2";
+	case EInstructionSet::AVX2:
+		return "AVX2";
+	case EInstructionSet::NEON:
+		return "NEON";
+	}
+	return "Unknown";
+}
+
+bool NoiseKernels::FillNoise(
+	EInstructionSet InstructionSet, const FNoiseSettings &Settings, int Dimensions, const float *const Coordinates[4],
+	int Stride, int Count, float *Output
+) {
+	if (Dimensions < 2 || Dimensions > 4 || !IsSupported(InstructionSet)) {
+		return false;
+	}
+	if (Dimensions == 4 && (Settings.Noise != FNoiseSettings::ENoise::Simplex || Settings.Fractal != FNoiseSettings::EFractal::None)) {
+		return false;
+	}
+	if (Count <= 0) {
+		return true;
+	}
+
+	switch (InstructionSet) {
+#if NOISEKERNELS_X86
+	case EInstructionSet::SSE2:
+		FillNoiseSSE2(Settings, Dimensions, Coordinates, Stride, Count, Output);
+		return true;
+	case EInstructionSet::AVX2:
+		FillNoiseAVX2(Settings, Dimensions, Coordinates, Stride, Count, Output);
+		return true;
+#endif
+#if NOISEKERNELS_NEON
+	case EInstructionSet::NEON:
+		FillNoiseNEON(Settings, Dimensions, Coordinates, Stride, Count, Output);
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,90 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "NoiseKernelsSIMD.h"
+
+#if NOISEKERNELS_X86
+
+#include <immintrin.h>
+#include <cmath>
+
+// Everything below is compiled for AVX2 without needing the whole module to be, it's only called
+// once GetSupportedInstructionSet() has checked the CPU.  FMA is deliberately left off so that
+// multiplies and adds are still rounded separately, as they are in the scalar code.  MSVC allows
+// the intrinsics anywhere, so it needs nothing here.
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace NoiseKernelsAVX2
+{
+	/// Eight lanes with AVX2, using its gathers for the table lookups.
+	struct FSIMD
+	{
+		static const int Width = 8;
+		typedef __m256 FFloat;
+		typedef __m256i FInt;
+
+		static FFloat Set(float Value) { return _mm256_set1_ps(Value); }
+		static FInt SetInt(int Value) { return _mm256_set1_epi32(Value); }
+
+		static FFloat Load(const float *Source, int Stride)
+		{
+			if (Stride == 1) {
+				return _mm256_loadu_ps(Source);
+			}
+			return _mm256_i32gather_ps(Source, _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(Stride)), 4);
+		}
+
+		static void Store(float *Destination, FFloat Value) { _mm256_storeu_ps(Destination, Value); }
+
+		static FFloat Add(FFloat A, FFloat B) { return _mm256_add_ps(A, B); }
+		static FFloat Sub(FFloat A, FFloat B) { return _mm256_sub_ps(A, B); }
+		static FFloat Mul(FFloat A, FFloat B) { return _mm256_mul_ps(A, B); }
+		static FFloat Abs(FFloat A) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), A); }
+
+		// Comparisons give masks with every bit set in the lanes where they're true.  They're
+		// ordered, so false for NaNs like the scalar comparisons.
+		static FFloat Less(FFloat A, FFloat B) { return _mm256_cmp_ps(A, B, _CMP_LT_OQ); }
+		static FFloat Greater(FFloat A, FFloat B) { return _mm256_cmp_ps(A, B, _CMP_GT_OQ); }
+		static FFloat GreaterEqual(FFloat A, FFloat B) { return _mm256_cmp_ps(A, B, _CMP_GE_OQ); }
+		static FFloat And(FFloat A, FFloat B) { return _mm256_and_ps(A, B); }
+		static FFloat Or(FFloat A, FFloat B) { return _mm256_or_ps(A, B); }
+
+		/// *Value* where *Mask* is clear, zero elsewhere
+		static FFloat AndNot(FFloat Mask, FFloat Value) { return _mm256_andnot_ps(Mask, Value); }
+
+		static FInt Truncate(FFloat A) { return _mm256_cvttps_epi32(A); }
+		static FFloat ToFloat(FInt A) { return _mm256_cvtepi32_ps(A); }
+		static FInt AsInt(FFloat Mask) { return _mm256_castps_si256(Mask); }
+
+		static FInt AddInt(FInt A, FInt B) { return _mm256_add_epi32(A, B); }
+		static FInt AndInt(FInt A, FInt B) { return _mm256_and_si256(A, B); }
+		static FInt AndNotInt(FInt Mask, FInt Value) { return _mm256_andnot_si256(Mask, Value); }
+		static FInt GreaterInt(FInt A, FInt B) { return _mm256_cmpgt_epi32(A, B); }
+
+		static FInt GatherInt(const int *Table, FInt Index) { return _mm256_i32gather_epi32(Table, Index, 4); }
+		static FFloat GatherFloat(const float *Table, FInt Index) { return _mm256_i32gather_ps(Table, Index, 4); }
+	};
+
+#include "NoiseKernelsImpl.inl"
+}
+
+void NoiseKernels::FillNoiseAVX2(const FNoiseSettings &Settings, int Dimensions, const float *const Coordinates[4], int Stride, int Count, float *Output)
+{
+	const NoiseKernelsAVX2::FNoiseBatch Batch(Settings);
+	Batch.Fill(Dimensions, Coordinates, Stride, Count, Output);
+
+	// Avoid the penalty for mixing AVX with SSE code compiled without VEX encoding.
+	_mm256_zeroupper();
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
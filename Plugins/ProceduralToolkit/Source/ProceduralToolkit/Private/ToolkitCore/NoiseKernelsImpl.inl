@@ -0,0 +1,624 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+// The vectorised noise kernels, written once in terms of *FSIMD* and included by each
+// instruction set's file inside its own namespace, after it's defined *FSIMD* and switched the
+// compiler over to that instruction set.  There's deliberately no include guard, and nothing is
+// included from here, so that each copy is compiled for its own instruction set.
+//
+// Every function follows its counterpart in FastNoise.cpp operation for operation, including
+// the order values are added in, so that the results match the scalar code.  The integer hashing
+// is exact, so lookups shared between corners give the same results as FastNoise doing them
+// again for each corner.
+
+typedef FSIMD::FFloat FFloat;
+typedef FSIMD::FInt FInt;
+typedef NoiseKernels::FNoiseSettings FNoiseSettings;
+
+// FastNoise's constants, calculated the same way so that they round the same.
+static const float SQRT3 = 1.7320508075688772935274463415059;
+static const float F2 = 0.5 * (SQRT3 - 1.0);
+static const float G2 = (3.0 - SQRT3) / 6.0;
+static const float F3 = 1 / float(3);
+static const float G3 = 1 / float(6);
+static const float F4 = (std::sqrt(float(5)) - 1) / 4;
+static const float G4 = (5 - std::sqrt(float(5))) / 2;
+static const float CUBIC_2D_BOUNDING = 1 / (1.5 * 1.5);
+static const float CUBIC_3D_BOUNDING = 1 / (1.5 * 1.5 * 1.5);
+
+/// Evaluates one noise setup for batches of points, FSIMD::Width at a time.
+class FNoiseBatch
+{
+public:
+	explicit FNoiseBatch(const FNoiseSettings &InSettings)
+		: Settings(InSettings)
+	{
+		// The tables are widened to ints once per batch so the gathers can read them directly, and
+		// the last permutation of each lookup is folded into the table it indexes so that it's
+		// one gather rather than two.
+		for (int Index = 0; Index < 512; ++Index) {
+			Perm[Index] = Settings.Perm[Index];
+			PermValues[Index] = Settings.ValueLUT[Settings.Perm[Index]];
+
+			const int Gradient = Settings.Perm12[Index];
+			PermGradX[Index] = Settings.GradX[Gradient];
+			PermGradY[Index] = Settings.GradY[Gradient];
+			PermGradZ[Index] = Settings.GradZ[Gradient];
+
+			const int Gradient4D = (Settings.Perm[Index] & 31) * 4;
+			for (int Axis = 0; Axis < 4; ++Axis) {
+				PermGrad4D[Axis][Index] = Settings.Grad4D[Gradient4D + Axis];
+			}
+		}
+		for (int Index = 0; Index < 256; ++Index) {
+			Simplex4D[Index] = Settings.Simplex4D[Index];
+		}
+	}
+
+	void Fill(int Dimensions, const float *const Coordinates[4], int Stride, int Count, float *Output) const
+	{
+		if (Dimensions == 4) {
+			Run<4, &FNoiseBatch::Simplex4, FNoiseSettings::EFractal::None>(Coordinates, Stride, Count, Output);
+			return;
+		}
+
+		const bool b2D = Dimensions == 2;
+		switch (Settings.Noise) {
+		case FNoiseSettings::ENoise::Value:
+			b2D ? RunFractal<2, &FNoiseBatch::Value2>(Coordinates, Stride, Count, Output) : RunFractal<3, &FNoiseBatch::Value3>(Coordinates, Stride, Count, Output);
+			break;
+		case FNoiseSettings::ENoise::Perlin:
+			b2D ? RunFractal<2, &FNoiseBatch::Perlin2>(Coordinates, Stride, Count, Output) : RunFractal<3, &FNoiseBatch::Perlin3>(Coordinates, Stride, Count, Output);
+			break;
+		case FNoiseSettings::ENoise::Simplex:
+			b2D ? RunFractal<2, &FNoiseBatch::Simplex2>(Coordinates, Stride, Count, Output) : RunFractal<3, &FNoiseBatch::Simplex3>(Coordinates, Stride, Count, Output);
+			break;
+		case FNoiseSettings::ENoise::Cubic:
+			b2D ? RunFractal<2, &FNoiseBatch::Cubic2>(Coordinates, Stride, Count, Output) : RunFractal<3, &FNoiseBatch::Cubic3>(Coordinates, Stride, Count, Output);
+			break;
+		}
+	}
+
+private:
+	/// A FastNoise Single* function, taking the permutation offset and the point's coordinates
+	typedef FFloat (FNoiseBatch::*FSingleFunction)(int Offset, const FFloat *Point) const;
+
+	template <int Dimensions, FSingleFunction Single>
+	void RunFractal(const float *const Coordinates[4], int Stride, int Count, float *Output) const
+	{
+		switch (Settings.Fractal) {
+		case FNoiseSettings::EFractal::None:
+			Run<Dimensions, Single, FNoiseSettings::EFractal::None>(Coordinates, Stride, Count, Output);
+			break;
+		case FNoiseSettings::EFractal::FBM:
+			Run<Dimensions, Single, FNoiseSettings::EFractal::FBM>(Coordinates, Stride, Count, Output);
+			break;
+		case FNoiseSettings::EFractal::Billow:
+			Run<Dimensions, Single, FNoiseSettings::EFractal::Billow>(Coordinates, Stride, Count, Output);
+			break;
+		case FNoiseSettings::EFractal::RigidMulti:
+			Run<Dimensions, Single, FNoiseSettings::EFractal::RigidMulti>(Coordinates, Stride, Count, Output);
+			break;
+		}
+	}
+
+	template <int Dimensions, FSingleFunction Single, FNoiseSettings::EFractal Fractal>
+	void Run(const float *const Coordinates[4], int Stride, int Count, float *Output) const
+	{
+		const FFloat Frequency = FSIMD::Set(Settings.Frequency);
+		FFloat Point[Dimensions];
+
+		int Index = 0;
+		for (; Index + FSIMD::Width <= Count; Index += FSIMD::Width) {
+			for (int Axis = 0; Axis < Dimensions; ++Axis) {
+				Point[Axis] = FSIMD::Mul(FSIMD::Load(Coordinates[Axis] + Index * Stride, Stride), Frequency);
+			}
+			FSIMD::Store(Output + Index, Evaluate<Dimensions, Single, Fractal>(Point));
+		}
+		if (Index == Count) {
+			return;
+		}
+
+		// Pad the last few points out to a whole vector by repeating the last one.
+		float Tail[Dimensions][FSIMD::Width];
+		float Results[FSIMD::Width];
+		for (int Axis = 0; Axis < Dimensions; ++Axis) {
+			for (int Lane = 0; Lane < FSIMD::Width; ++Lane) {
+				const int Source = Index + Lane < Count ? Index + Lane : Count - 1;
+				Tail[Axis][Lane] = Coordinates[Axis][Source * Stride];
+			}
+			Point[Axis] = FSIMD::Mul(FSIMD::Load(Tail[Axis], 1), Frequency);
+		}
+		FSIMD::Store(Results, Evaluate<Dimensions, Single, Fractal>(Point));
+		for (int Lane = 0; Index + Lane < Count; ++Lane) {
+			Output[Index + Lane] = Results[Lane];
+		}
+	}
+
+	/// The noise for a vector of points, which have already been scaled by the frequency.  This
+	/// follows FastNoise's Single*FractalFBM, Single*FractalBillow and Single*FractalRigidMulti.
+	template <int Dimensions, FSingleFunction Single, FNoiseSettings::EFractal Fractal>
+	FFloat Evaluate(FFloat *Point) const
+	{
+		if (Fractal == FNoiseSettings::EFractal::None) {
+			return (this->*Single)(0, Point);
+		}
+
+		const FFloat One = FSIMD::Set(1.0f);
+		const FFloat Two = FSIMD::Set(2.0f);
+		const FFloat Lacunarity = FSIMD::Set(Settings.Lacunarity);
+		const FFloat First = (this->*Single)(Settings.Perm[0], Point);
+		FFloat Sum = First;
+		if (Fractal == FNoiseSettings::EFractal::Billow) {
+			Sum = FSIMD::Sub(FSIMD::Mul(FSIMD::Abs(First), Two), One);
+		} else if (Fractal == FNoiseSettings::EFractal::RigidMulti) {
+			Sum = FSIMD::Sub(One, FSIMD::Abs(First));
+		}
+
+		float Amplitude = 1;
+		for (int Octave = 1; Octave < Settings.Octaves; ++Octave) {
+			for (int Axis = 0; Axis < Dimensions; ++Axis) {
+				Point[Axis] = FSIMD::Mul(Point[Axis], Lacunarity);
+			}
+			Amplitude *= Settings.Gain;
+
+			const FFloat Value = (this->*Single)(Settings.Perm[Octave], Point);
+			if (Fractal == FNoiseSettings::EFractal::FBM) {
+				Sum = FSIMD::Add(Sum, FSIMD::Mul(Value, FSIMD::Set(Amplitude)));
+			} else if (Fractal == FNoiseSettings::EFractal::Billow) {
+				Sum = FSIMD::Add(Sum, FSIMD::Mul(FSIMD::Sub(FSIMD::Mul(FSIMD::Abs(Value), Two), One), FSIMD::Set(Amplitude)));
+			} else {
+				Sum = FSIMD::Sub(Sum, FSIMD::Mul(FSIMD::Sub(One, FSIMD::Abs(Value)), FSIMD::Set(Amplitude)));
+			}
+		}
+
+		if (Fractal == FNoiseSettings::EFractal::RigidMulti) {
+			return Sum;
+		}
+		return FSIMD::Mul(Sum, FSIMD::Set(Settings.FractalBounding));
+	}
+
+	/// As FastFloor, which truncates and then takes one off anything that isn't >= 0.
+	static FInt Floor(FFloat Value)
+	{
+		const FInt NotNegative = FSIMD::AsInt(FSIMD::GreaterEqual(Value, FSIMD::Set(0.0f)));
+		return FSIMD::AddInt(FSIMD::Truncate(Value), FSIMD::AndNotInt(NotNegative, FSIMD::SetInt(-1)));
+	}
+
+	/// 1 where a mask is set, 0 elsewhere.
+	static FFloat OneIf(FFloat Mask)
+	{
+		return FSIMD::And(Mask, FSIMD::Set(1.0f));
+	}
+
+	/// 1 where a mask is clear, 0 elsewhere.
+	static FFloat OneIfNot(FFloat Mask)
+	{
+		return FSIMD::AndNot(Mask, FSIMD::Set(1.0f));
+	}
+
+	static FInt OneIntIf(FFloat Mask)
+	{
+		return FSIMD::AndInt(FSIMD::AsInt(Mask), FSIMD::SetInt(1));
+	}
+
+	static FInt OneIntIfNot(FFloat Mask)
+	{
+		return FSIMD::AndNotInt(FSIMD::AsInt(Mask), FSIMD::SetInt(1));
+	}
+
+	static FFloat Lerp(FFloat A, FFloat B, FFloat T)
+	{
+		return FSIMD::Add(A, FSIMD::Mul(T, FSIMD::Sub(B, A)));
+	}
+
+	static FFloat CubicLerp(FFloat A, FFloat B, FFloat C, FFloat D, FFloat T)
+	{
+		const FFloat AMinusB = FSIMD::Sub(A, B);
+		const FFloat P = FSIMD::Sub(FSIMD::Sub(D, C), AMinusB);
+		const FFloat TSquared = FSIMD::Mul(T, T);
+		const FFloat Cubic = FSIMD::Mul(FSIMD::Mul(TSquared, T), P);
+		const FFloat Quadratic = FSIMD::Mul(TSquared, FSIMD::Sub(AMinusB, P));
+		return FSIMD::Add(FSIMD::Add(FSIMD::Add(Cubic, Quadratic), FSIMD::Mul(T, FSIMD::Sub(C, A))), B);
+	}
+
+	/// The interpolation weight for the fraction of the way across a cell.
+	FFloat Interpolate(FFloat T) const
+	{
+		switch (Settings.Interp) {
+		case FNoiseSettings::EInterp::Hermite:
+			return FSIMD::Mul(FSIMD::Mul(T, T), FSIMD::Sub(FSIMD::Set(3.0f), FSIMD::Mul(FSIMD::Set(2.0f), T)));
+		case FNoiseSettings::EInterp::Quintic: {
+			const FFloat Inner = FSIMD::Add(FSIMD::Mul(T, FSIMD::Sub(FSIMD::Mul(T, FSIMD::Set(6.0f)), FSIMD::Set(15.0f))), FSIMD::Set(10.0f));
+			return FSIMD::Mul(FSIMD::Mul(FSIMD::Mul(T, T), T), Inner);
+		}
+		default:
+			return T;
+		}
+	}
+
+	/// One level of FastNoise's Index*D lookups: perm[(Cell & 255) + Previous].
+	FInt HashStep(FInt Cell, FInt Previous) const
+	{
+		return FSIMD::GatherInt(Perm, FSIMD::AddInt(FSIMD::AndInt(Cell, FSIMD::SetInt(255)), Previous));
+	}
+
+	/// The index of the last lookup of FastNoise's Index*D functions: (X & 255) + Hash.
+	static FInt LastIndex(FInt X, FInt Hash)
+	{
+		return FSIMD::AddInt(FSIMD::AndInt(X, FSIMD::SetInt(255)), Hash);
+	}
+
+	/// ValCoord*DFast, given the X cell and the hash of the other axes.
+	FFloat ValueAt(FInt X, FInt Hash) const
+	{
+		return FSIMD::GatherFloat(PermValues, LastIndex(X, Hash));
+	}
+
+	/// GradCoord2D, given the X cell and the hash of the other axes.
+	FFloat GradientAt(FInt X, FInt Hash, FFloat XD, FFloat YD) const
+	{
+		const FInt Index = LastIndex(X, Hash);
+		return FSIMD::Add(FSIMD::Mul(XD, FSIMD::GatherFloat(PermGradX, Index)), FSIMD::Mul(YD, FSIMD::GatherFloat(PermGradY, Index)));
+	}
+
+	/// GradCoord3D, given the X cell and the hash of the other axes.
+	FFloat GradientAt(FInt X, FInt Hash, FFloat XD, FFloat YD, FFloat ZD) const
+	{
+		const FInt Index = LastIndex(X, Hash);
+		const FFloat XY = FSIMD::Add(FSIMD::Mul(XD, FSIMD::GatherFloat(PermGradX, Index)), FSIMD::Mul(YD, FSIMD::GatherFloat(PermGradY, Index)));
+		return FSIMD::Add(XY, FSIMD::Mul(ZD, FSIMD::GatherFloat(PermGradZ, Index)));
+	}
+
+	/// GradCoord4D, given the X cell and the hash of the other axes.
+	FFloat GradientAt(FInt X, FInt Hash, FFloat XD, FFloat YD, FFloat ZD, FFloat WD) const
+	{
+		const FInt Index = LastIndex(X, Hash);
+		const FFloat XY = FSIMD::Add(FSIMD::Mul(XD, FSIMD::GatherFloat(PermGrad4D[0], Index)), FSIMD::Mul(YD, FSIMD::GatherFloat(PermGrad4D[1], Index)));
+		const FFloat XYZ = FSIMD::Add(XY, FSIMD::Mul(ZD, FSIMD::GatherFloat(PermGrad4D[2], Index)));
+		return FSIMD::Add(XYZ, FSIMD::Mul(WD, FSIMD::GatherFloat(PermGrad4D[3], Index)));
+	}
+
+	/// A simplex corner's contribution, t^4 * gradient where t = Radius - |d|^2 is positive.
+	static FFloat Falloff(FFloat T, FFloat Gradient)
+	{
+		const FFloat Outside = FSIMD::Less(T, FSIMD::Set(0.0f));
+		const FFloat Squared = FSIMD::Mul(T, T);
+		return FSIMD::AndNot(Outside, FSIMD::Mul(FSIMD::Mul(Squared, Squared), Gradient));
+	}
+
+	FFloat Value2(int Offset, const FFloat *Point) const
+	{
+		const FInt X0 = Floor(Point[0]);
+		const FInt Y0 = Floor(Point[1]);
+		const FInt One = FSIMD::SetInt(1);
+		const FInt X1 = FSIMD::AddInt(X0, One);
+		const FInt Y1 = FSIMD::AddInt(Y0, One);
+
+		const FFloat XS = Interpolate(FSIMD::Sub(Point[0], FSIMD::ToFloat(X0)));
+		const FFloat YS = Interpolate(FSIMD::Sub(Point[1], FSIMD::ToFloat(Y0)));
+
+		const FInt OffsetHash = FSIMD::SetInt(Offset);
+		const FInt H0 = HashStep(Y0, OffsetHash);
+		const FInt H1 = HashStep(Y1, OffsetHash);
+
+		const FFloat XF0 = Lerp(ValueAt(X0, H0), ValueAt(X1, H0), XS);
+		const FFloat XF1 = Lerp(ValueAt(X0, H1), ValueAt(X1, H1), XS);
+		return Lerp(XF0, XF1, YS);
+	}
+
+	FFloat Value3(int Offset, const FFloat *Point) const
+	{
+		const FInt X0 = Floor(Point[0]);
+		const FInt Y0 = Floor(Point[1]);
+		const FInt Z0 = Floor(Point[2]);
+		const FInt One = FSIMD::SetInt(1);
+		const FInt X1 = FSIMD::AddInt(X0, One);
+		const FInt Y1 = FSIMD::AddInt(Y0, One);
+		const FInt Z1 = FSIMD::AddInt(Z0, One);
+
+		const FFloat XS = Interpolate(FSIMD::Sub(Point[0], FSIMD::ToFloat(X0)));
+		const FFloat YS = Interpolate(FSIMD::Sub(Point[1], FSIMD::ToFloat(Y0)));
+		const FFloat ZS = Interpolate(FSIMD::Sub(Point[2], FSIMD::ToFloat(Z0)));
+
+		const FInt OffsetHash = FSIMD::SetInt(Offset);
+		const FInt HZ0 = HashStep(Z0, OffsetHash);
+		const FInt HZ1 = HashStep(Z1, OffsetHash);
+		const FInt H00 = HashStep(Y0, HZ0);
+		const FInt H10 = HashStep(Y1, HZ0);
+		const FInt H01 = HashStep(Y0, HZ1);
+		const FInt H11 = HashStep(Y1, HZ1);
+
+		const FFloat XF00 = Lerp(ValueAt(X0, H00), ValueAt(X1, H00), XS);
+		const FFloat XF10 = Lerp(ValueAt(X0, H10), ValueAt(X1, H10), XS);
+		const FFloat XF01 = Lerp(ValueAt(X0, H01), ValueAt(X1, H01), XS);
+		const FFloat XF11 = Lerp(ValueAt(X0, H11), ValueAt(X1, H11), XS);
+
+		const FFloat YF0 = Lerp(XF00, XF10, YS);
+		const FFloat YF1 = Lerp(XF01, XF11, YS);
+		return Lerp(YF0, YF1, ZS);
+	}
+
+	FFloat Perlin2(int Offset, const FFloat *Point) const
+	{
+		const FInt X0 = Floor(Point[0]);
+		const FInt Y0 = Floor(Point[1]);
+		const FInt One = FSIMD::SetInt(1);
+		const FInt X1 = FSIMD::AddInt(X0, One);
+		const FInt Y1 = FSIMD::AddInt(Y0, One);
+
+		const FFloat XD0 = FSIMD::Sub(Point[0], FSIMD::ToFloat(X0));
+		const FFloat YD0 = FSIMD::Sub(Point[1], FSIMD::ToFloat(Y0));
+		const FFloat XD1 = FSIMD::Sub(XD0, FSIMD::Set(1.0f));
+		const FFloat YD1 = FSIMD::Sub(YD0, FSIMD::Set(1.0f));
+		const FFloat XS = Interpolate(XD0);
+		const FFloat YS = Interpolate(YD0);
+
+		const FInt OffsetHash = FSIMD::SetInt(Offset);
+		const FInt H0 = HashStep(Y0, OffsetHash);
+		const FInt H1 = HashStep(Y1, OffsetHash);
+
+		const FFloat XF0 = Lerp(GradientAt(X0, H0, XD0, YD0), GradientAt(X1, H0, XD1, YD0), XS);
+		const FFloat XF1 = Lerp(GradientAt(X0, H1, XD0, YD1), GradientAt(X1, H1, XD1, YD1), XS);
+		return Lerp(XF0, XF1, YS);
+	}
+
+	FFloat Perlin3(int Offset, const FFloat *Point) const
+	{
+		const FInt X0 = Floor(Point[0]);
+		const FInt Y0 = Floor(Point[1]);
+		const FInt Z0 = Floor(Point[2]);
+		const FInt One = FSIMD::SetInt(1);
+		const FInt X1 = FSIMD::AddInt(X0, One);
+		const FInt Y1 = FSIMD::AddInt(Y0, One);
+		const FInt Z1 = FSIMD::AddInt(Z0, One);
+
+		const FFloat XD0 = FSIMD::Sub(Point[0], FSIMD::ToFloat(X0));
+		const FFloat YD0 = FSIMD::Sub(Point[1], FSIMD::ToFloat(Y0));
+		const FFloat ZD0 = FSIMD::Sub(Point[2], FSIMD::ToFloat(Z0));
+		const FFloat XD1 = FSIMD::Sub(XD0, FSIMD::Set(1.0f));
+		const FFloat YD1 = FSIMD::Sub(YD0, FSIMD::Set(1.0f));
+		const FFloat ZD1 = FSIMD::Sub(ZD0, FSIMD::Set(1.0f));
+		const FFloat XS = Interpolate(XD0);
+		const FFloat YS = Interpolate(YD0);
+		const FFloat ZS = Interpolate(ZD0);
+
+		const FInt OffsetHash = FSIMD::SetInt(Offset);
+		const FInt HZ0 = HashStep(Z0, OffsetHash);
+		const FInt HZ1 = HashStep(Z1, OffsetHash);
+		const FInt H00 = HashStep(Y0, HZ0);
+		const FInt H10 = HashStep(Y1, HZ0);
+		const FInt H01 = HashStep(Y0, HZ1);
+		const FInt H11 = HashStep(Y1, HZ1);
+
+		const FFloat XF00 = Lerp(GradientAt(X0, H00, XD0, YD0, ZD0), GradientAt(X1, H00, XD1, YD0, ZD0), XS);
+		const FFloat XF10 = Lerp(GradientAt(X0, H10, XD0, YD1, ZD0), GradientAt(X1, H10, XD1, YD1, ZD0), XS);
+		const FFloat XF01 = Lerp(GradientAt(X0, H01, XD0, YD0, ZD1), GradientAt(X1, H01, XD1, YD0, ZD1), XS);
+		const FFloat XF11 = Lerp(GradientAt(X0, H11, XD0, YD1, ZD1), GradientAt(X1, H11, XD1, YD1, ZD1), XS);
+
+		const FFloat YF0 = Lerp(XF00, XF10, YS);
+		const FFloat YF1 = Lerp(XF01, XF11, YS);
+		return Lerp(YF0, YF1, ZS);
+	}
+
+	FFloat Simplex2(int Offset, const FFloat *Point) const
+	{
+		FFloat T = FSIMD::Mul(FSIMD::Add(Point[0], Point[1]), FSIMD::Set(F2));
+		const FInt I = Floor(FSIMD::Add(Point[0], T));
+		const FInt J = Floor(FSIMD::Add(Point[1], T));
+
+		T = FSIMD::Mul(FSIMD::ToFloat(FSIMD::AddInt(I, J)), FSIMD::Set(G2));
+		const FFloat X0 = FSIMD::Sub(Point[0], FSIMD::Sub(FSIMD::ToFloat(I), T));
+		const FFloat Y0 = FSIMD::Sub(Point[1], FSIMD::Sub(FSIMD::ToFloat(J), T));
+
+		// The middle corner is along X if x0 > y0, otherwise along Y.
+		const FFloat AlongX = FSIMD::Greater(X0, Y0);
+		const FFloat X1 = FSIMD::Add(FSIMD::Sub(X0, OneIf(AlongX)), FSIMD::Set(G2));
+		const FFloat Y1 = FSIMD::Add(FSIMD::Sub(Y0, OneIfNot(AlongX)), FSIMD::Set(G2));
+		const FFloat X2 = FSIMD::Add(FSIMD::Sub(X0, FSIMD::Set(1.0f)), FSIMD::Set(2 * G2));
+		const FFloat Y2 = FSIMD::Add(FSIMD::Sub(Y0, FSIMD::Set(1.0f)), FSIMD::Set(2 * G2));
+
+		const FInt OffsetHash = FSIMD::SetInt(Offset);
+		const FInt One = FSIMD::SetInt(1);
+		const FInt I1 = FSIMD::AddInt(I, OneIntIf(AlongX));
+		const FInt J1 = FSIMD::AddInt(J, OneIntIfNot(AlongX));
+		const FInt I2 = FSIMD::AddInt(I, One);
+		const FInt J2 = FSIMD::AddInt(J, One);
+
+		const FFloat Radius = FSIMD::Set(0.5f);
+		const FFloat N0 = Falloff(
+			FSIMD::Sub(FSIMD::Sub(Radius, FSIMD::Mul(X0, X0)), FSIMD::Mul(Y0, Y0)),
+			GradientAt(I, HashStep(J, OffsetHash), X0, Y0)
+		);
+		const FFloat N1 = Falloff(
+			FSIMD::Sub(FSIMD::Sub(Radius, FSIMD::Mul(X1, X1)), FSIMD::Mul(Y1, Y1)),
+			GradientAt(I1, HashStep(J1, OffsetHash), X1, Y1)
+		);
+		const FFloat N2 = Falloff(
+			FSIMD::Sub(FSIMD::Sub(Radius, FSIMD::Mul(X2, X2)), FSIMD::Mul(Y2, Y2)),
+			GradientAt(I2, HashStep(J2, OffsetHash), X2, Y2)
+		);
+		return FSIMD::Mul(FSIMD::Set(70.0f), FSIMD::Add(FSIMD::Add(N0, N1), N2));
+	}
+
+	/// A corner of the 3D simplex, given its cell and offset from the point.
+	FFloat SimplexCorner(const FInt &OffsetHash, FInt I, FInt J, FInt K, FFloat X, FFloat Y, FFloat Z) const
+	{
+		const FFloat T = FSIMD::Sub(FSIMD::Sub(FSIMD::Sub(FSIMD::Set(0.6f), FSIMD::Mul(X, X)), FSIMD::Mul(Y, Y)), FSIMD::Mul(Z, Z));
+		return Falloff(T, GradientAt(I, HashStep(J, HashStep(K, OffsetHash)), X, Y, Z));
+	}
+
+	FFloat Simplex3(int Offset, const FFloat *Point) const
+	{
+		FFloat T = FSIMD::Mul(FSIMD::Add(FSIMD::Add(Point[0], Point[1]), Point[2]), FSIMD::Set(F3));
+		const FInt I = Floor(FSIMD::Add(Point[0], T));
+		const FInt J = Floor(FSIMD::Add(Point[1], T));
+		const FInt K = Floor(FSIMD::Add(Point[2], T));
+
+		T = FSIMD::Mul(FSIMD::ToFloat(FSIMD::AddInt(FSIMD::AddInt(I, J), K)), FSIMD::Set(G3));
+		const FFloat X0 = FSIMD::Sub(Point[0], FSIMD::Sub(FSIMD::ToFloat(I), T));
+		const FFloat Y0 = FSIMD::Sub(Point[1], FSIMD::Sub(FSIMD::ToFloat(J), T));
+		const FFloat Z0 = FSIMD::Sub(Point[2], FSIMD::Sub(FSIMD::ToFloat(K), T));
+
+		// FastNoise's branches picking the middle two corners, as masks.
+		const FFloat XY = FSIMD::GreaterEqual(X0, Y0);
+		const FFloat YZ = FSIMD::GreaterEqual(Y0, Z0);
+		const FFloat XZ = FSIMD::GreaterEqual(X0, Z0);
+		const FFloat I1 = FSIMD::And(XY, FSIMD::Or(YZ, XZ));
+		const FFloat J1 = FSIMD::AndNot(XY, YZ);
+		const FFloat NotK1 = FSIMD::Or(YZ, FSIMD::And(XY, XZ));
+		const FFloat I2 = FSIMD::Or(XY, FSIMD::And(YZ, XZ));
+		const FFloat NotJ2 = FSIMD::AndNot(YZ, XY);
+		const FFloat NotK2 = FSIMD::And(YZ, FSIMD::Or(XY, XZ));
+
+		const FFloat X1 = FSIMD::Add(FSIMD::Sub(X0, OneIf(I1)), FSIMD::Set(G3));
+		const FFloat Y1 = FSIMD::Add(FSIMD::Sub(Y0, OneIf(J1)), FSIMD::Set(G3));
+		const FFloat Z1 = FSIMD::Add(FSIMD::Sub(Z0, OneIfNot(NotK1)), FSIMD::Set(G3));
+		const FFloat X2 = FSIMD::Add(FSIMD::Sub(X0, OneIf(I2)), FSIMD::Set(2 * G3));
+		const FFloat Y2 = FSIMD::Add(FSIMD::Sub(Y0, OneIfNot(NotJ2)), FSIMD::Set(2 * G3));
+		const FFloat Z2 = FSIMD::Add(FSIMD::Sub(Z0, OneIfNot(NotK2)), FSIMD::Set(2 * G3));
+		const FFloat X3 = FSIMD::Add(FSIMD::Sub(X0, FSIMD::Set(1.0f)), FSIMD::Set(3 * G3));
+		const FFloat Y3 = FSIMD::Add(FSIMD::Sub(Y0, FSIMD::Set(1.0f)), FSIMD::Set(3 * G3));
+		const FFloat Z3 = FSIMD::Add(FSIMD::Sub(Z0, FSIMD::Set(1.0f)), FSIMD::Set(3 * G3));
+
+		const FInt OffsetHash = FSIMD::SetInt(Offset);
+		const FInt One = FSIMD::SetInt(1);
+		const FFloat N0 = SimplexCorner(OffsetHash, I, J, K, X0, Y0, Z0);
+		const FFloat N1 = SimplexCorner(
+			OffsetHash, FSIMD::AddInt(I, OneIntIf(I1)), FSIMD::AddInt(J, OneIntIf(J1)), FSIMD::AddInt(K, OneIntIfNot(NotK1)), X1, Y1, Z1
+		);
+		const FFloat N2 = SimplexCorner(
+			OffsetHash, FSIMD::AddInt(I, OneIntIf(I2)), FSIMD::AddInt(J, OneIntIfNot(NotJ2)), FSIMD::AddInt(K, OneIntIfNot(NotK2)), X2, Y2, Z2
+		);
+		const FFloat N3 = SimplexCorner(OffsetHash, FSIMD::AddInt(I, One), FSIMD::AddInt(J, One), FSIMD::AddInt(K, One), X3, Y3, Z3);
+		return FSIMD::Mul(FSIMD::Set(32.0f), FSIMD::Add(FSIMD::Add(FSIMD::Add(N0, N1), N2), N3));
+	}
+
+	/// A corner of the 4D simplex, given its cell and offset from the point.
+	FFloat SimplexCorner(const FInt &OffsetHash, const FInt *Cell, const FFloat *D) const
+	{
+		FFloat T = FSIMD::Set(0.6f);
+		for (int Axis = 0; Axis < 4; ++Axis) {
+			T = FSIMD::Sub(T, FSIMD::Mul(D[Axis], D[Axis]));
+		}
+		const FInt Hash = HashStep(Cell[1], HashStep(Cell[2], HashStep(Cell[3], OffsetHash)));
+		return Falloff(T, GradientAt(Cell[0], Hash, D[0], D[1], D[2], D[3]));
+	}
+
+	FFloat Simplex4(int Offset, const FFloat *Point) const
+	{
+		FFloat T = FSIMD::Mul(FSIMD::Add(FSIMD::Add(FSIMD::Add(Point[0], Point[1]), Point[2]), Point[3]), FSIMD::Set(F4));
+		FInt Cell[4];
+		for (int Axis = 0; Axis < 4; ++Axis) {
+			Cell[Axis] = Floor(FSIMD::Add(Point[Axis], T));
+		}
+
+		T = FSIMD::Mul(FSIMD::ToFloat(FSIMD::AddInt(FSIMD::AddInt(FSIMD::AddInt(Cell[0], Cell[1]), Cell[2]), Cell[3])), FSIMD::Set(G4));
+		FFloat D0[4];
+		for (int Axis = 0; Axis < 4; ++Axis) {
+			D0[Axis] = FSIMD::Sub(Point[Axis], FSIMD::Sub(FSIMD::ToFloat(Cell[Axis]), T));
+		}
+
+		// The index into SIMPLEX_4D from the order of the offsets, already multiplied by 4.
+		const FFloat Comparisons[6] = {
+			FSIMD::Greater(D0[0], D0[1]), FSIMD::Greater(D0[0], D0[2]), FSIMD::Greater(D0[1], D0[2]),
+			FSIMD::Greater(D0[0], D0[3]), FSIMD::Greater(D0[1], D0[3]), FSIMD::Greater(D0[2], D0[3])
+		};
+		FInt Lookup = FSIMD::SetInt(0);
+		for (int Bit = 0; Bit < 6; ++Bit) {
+			Lookup = FSIMD::AddInt(Lookup, FSIMD::AndInt(FSIMD::AsInt(Comparisons[Bit]), FSIMD::SetInt(128 >> Bit)));
+		}
+
+		// Corners 1 to 3 step along an axis where its SIMPLEX_4D entry is >= 3, 2 and 1.
+		FInt Steps[3][4];
+		for (int Axis = 0; Axis < 4; ++Axis) {
+			const FInt Rank = FSIMD::GatherInt(Simplex4D, FSIMD::AddInt(Lookup, FSIMD::SetInt(Axis)));
+			for (int Corner = 0; Corner < 3; ++Corner) {
+				Steps[Corner][Axis] = FSIMD::AndInt(FSIMD::GreaterInt(Rank, FSIMD::SetInt(2 - Corner)), FSIMD::SetInt(1));
+			}
+		}
+
+		const FInt OffsetHash = FSIMD::SetInt(Offset);
+		FFloat Sum = SimplexCorner(OffsetHash, Cell, D0);
+		for (int Corner = 0; Corner < 4; ++Corner) {
+			// The last corner steps along every axis.
+			const FFloat Shift = FSIMD::Set((Corner + 1) * G4);
+			FInt CornerCell[4];
+			FFloat D[4];
+			for (int Axis = 0; Axis < 4; ++Axis) {
+				const FInt Step = Corner < 3 ? Steps[Corner][Axis] : FSIMD::SetInt(1);
+				CornerCell[Axis] = FSIMD::AddInt(Cell[Axis], Step);
+				D[Axis] = FSIMD::Add(FSIMD::Sub(D0[Axis], FSIMD::ToFloat(Step)), Shift);
+			}
+			Sum = FSIMD::Add(Sum, SimplexCorner(OffsetHash, CornerCell, D));
+		}
+		return FSIMD::Mul(FSIMD::Set(27.0f), Sum);
+	}
+
+	FFloat Cubic2(int Offset, const FFloat *Point) const
+	{
+		const FInt X1 = Floor(Point[0]);
+		const FInt Y1 = Floor(Point[1]);
+		const FFloat XS = FSIMD::Sub(Point[0], FSIMD::ToFloat(X1));
+		const FFloat YS = FSIMD::Sub(Point[1], FSIMD::ToFloat(Y1));
+
+		const FInt OffsetHash = FSIMD::SetInt(Offset);
+		FInt X[4];
+		FFloat Rows[4];
+		for (int Index = 0; Index < 4; ++Index) {
+			X[Index] = FSIMD::AddInt(X1, FSIMD::SetInt(Index - 1));
+		}
+		for (int Row = 0; Row < 4; ++Row) {
+			const FInt Hash = HashStep(FSIMD::AddInt(Y1, FSIMD::SetInt(Row - 1)), OffsetHash);
+			Rows[Row] = CubicLerp(ValueAt(X[0], Hash), ValueAt(X[1], Hash), ValueAt(X[2], Hash), ValueAt(X[3], Hash), XS);
+		}
+		return FSIMD::Mul(CubicLerp(Rows[0], Rows[1], Rows[2], Rows[3], YS), FSIMD::Set(CUBIC_2D_BOUNDING));
+	}
+
+	FFloat Cubic3(int Offset, const FFloat *Point) const
+	{
+		const FInt X1 = Floor(Point[0]);
+		const FInt Y1 = Floor(Point[1]);
+		const FInt Z1 = Floor(Point[2]);
+		const FFloat XS = FSIMD::Sub(Point[0], FSIMD::ToFloat(X1));
+		const FFloat YS = FSIMD::Sub(Point[1], FSIMD::ToFloat(Y1));
+		const FFloat ZS = FSIMD::Sub(Point[2], FSIMD::ToFloat(Z1));
+
+		const FInt OffsetHash = FSIMD::SetInt(Offset);
+		FInt X[4], Y[4];
+		for (int Index = 0; Index < 4; ++Index) {
+			X[Index] = FSIMD::AddInt(X1, FSIMD::SetInt(Index - 1));
+			Y[Index] = FSIMD::AddInt(Y1, FSIMD::SetInt(Index - 1));
+		}
+
+		FFloat Layers[4];
+		for (int Layer = 0; Layer < 4; ++Layer) {
+			const FInt LayerHash = HashStep(FSIMD::AddInt(Z1, FSIMD::SetInt(Layer - 1)), OffsetHash);
+			FFloat Rows[4];
+			for (int Row = 0; Row < 4; ++Row) {
+				const FInt Hash = HashStep(Y[Row], LayerHash);
+				Rows[Row] = CubicLerp(ValueAt(X[0], Hash), ValueAt(X[1], Hash), ValueAt(X[2], Hash), ValueAt(X[3], Hash), XS);
+			}
+			Layers[Layer] = CubicLerp(Rows[0], Rows[1], Rows[2], Rows[3], YS);
+		}
+		return FSIMD::Mul(CubicLerp(Layers[0], Layers[1], Layers[2], Layers[3], ZS), FSIMD::Set(CUBIC_3D_BOUNDING));
+	}
+
+	const FNoiseSettings &Settings;
+
+	/// The permutation table as ints
+	int Perm[512];
+
+	/// VAL_LUT[perm[i]]
+	float PermValues[512];
+
+	/// GRAD_X/Y/Z[perm12[i]]
+	float PermGradX[512];
+	float PermGradY[512];
+	float PermGradZ[512];
+
+	/// Each axis of GRAD_4D[(perm[i] & 31) * 4]
+	float PermGrad4D[4][512];
+
+	/// SIMPLEX_4D as ints
+	int Simplex4D[256];
+};
@@ -0,0 +1,95 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "NoiseKernelsSIMD.h"
+
+#if NOISEKERNELS_NEON
+
+#include <arm_neon.h>
+#include <cmath>
+
+namespace NoiseKernelsNEON
+{
+	/// Four lanes with NEON, only using instructions ARMv7 has too.  There are no gathers so those
+	/// are done a lane at a time, and masks are kept in float registers like SSE's are.
+	struct FSIMD
+	{
+		static const int Width = 4;
+		typedef float32x4_t FFloat;
+		typedef int32x4_t FInt;
+
+		static FFloat Set(float Value) { return vdupq_n_f32(Value); }
+		static FInt SetInt(int Value) { return vdupq_n_s32(Value); }
+
+		static FFloat Load(const float *Source, int Stride)
+		{
+			if (Stride == 1) {
+				return vld1q_f32(Source);
+			}
+			const float Values[4] = { Source[0], Source[Stride], Source[Stride * 2], Source[Stride * 3] };
+			return vld1q_f32(Values);
+		}
+
+		static void Store(float *Destination, FFloat Value) { vst1q_f32(Destination, Value); }
+
+		static FFloat Add(FFloat A, FFloat B) { return vaddq_f32(A, B); }
+		static FFloat Sub(FFloat A, FFloat B) { return vsubq_f32(A, B); }
+		static FFloat Mul(FFloat A, FFloat B) { return vmulq_f32(A, B); }
+		static FFloat Abs(FFloat A) { return vabsq_f32(A); }
+
+		// Comparisons give masks with every bit set in the lanes where they're true.
+		static FFloat Less(FFloat A, FFloat B) { return vreinterpretq_f32_u32(vcltq_f32(A, B)); }
+		static FFloat Greater(FFloat A, FFloat B) { return vreinterpretq_f32_u32(vcgtq_f32(A, B)); }
+		static FFloat GreaterEqual(FFloat A, FFloat B) { return vreinterpretq_f32_u32(vcgeq_f32(A, B)); }
+
+		static FFloat And(FFloat A, FFloat B)
+		{
+			return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(A), vreinterpretq_u32_f32(B)));
+		}
+
+		static FFloat Or(FFloat A, FFloat B)
+		{
+			return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(A), vreinterpretq_u32_f32(B)));
+		}
+
+		/// *Value* where *Mask* is clear, zero elsewhere
+		static FFloat AndNot(FFloat Mask, FFloat Value)
+		{
+			return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(Value), vreinterpretq_u32_f32(Mask)));
+		}
+
+		static FInt Truncate(FFloat A) { return vcvtq_s32_f32(A); }
+		static FFloat ToFloat(FInt A) { return vcvtq_f32_s32(A); }
+		static FInt AsInt(FFloat Mask) { return vreinterpretq_s32_f32(Mask); }
+
+		static FInt AddInt(FInt A, FInt B) { return vaddq_s32(A, B); }
+		static FInt AndInt(FInt A, FInt B) { return vandq_s32(A, B); }
+		static FInt AndNotInt(FInt Mask, FInt Value) { return vbicq_s32(Value, Mask); }
+		static FInt GreaterInt(FInt A, FInt B) { return vreinterpretq_s32_u32(vcgtq_s32(A, B)); }
+
+		static FInt GatherInt(const int *Table, FInt Index)
+		{
+			int32_t Indices[4];
+			vst1q_s32(Indices, Index);
+			const int32_t Values[4] = { Table[Indices[0]], Table[Indices[1]], Table[Indices[2]], Table[Indices[3]] };
+			return vld1q_s32(Values);
+		}
+
+		static FFloat GatherFloat(const float *Table, FInt Index)
+		{
+			int32_t Indices[4];
+			vst1q_s32(Indices, Index);
+			const float Values[4] = { Table[Indices[0]], Table[Indices[1]], Table[Indices[2]], Table[Indices[3]] };
+			return vld1q_f32(Values);
+		}
+	};
+
+#include "NoiseKernelsImpl.inl"
+}
+
+void NoiseKernels::FillNoiseNEON(const FNoiseSettings &Settings, int Dimensions, const float *const Coordinates[4], int Stride, int Count, float *Output)
+{
+	const NoiseKernelsNEON::FNoiseBatch Batch(Settings);
+	Batch.Fill(Dimensions, Coordinates, Stride, Count, Output);
+}
+
+#endif
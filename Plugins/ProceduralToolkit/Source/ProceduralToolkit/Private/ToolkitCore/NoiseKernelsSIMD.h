@@ -0,0 +1,32 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include "ToolkitCore/NoiseKernels.h"
+
+// The instruction sets which can be compiled for on this platform.  Whether the CPU running the
+// code supports them is checked at runtime.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NOISEKERNELS_X86 1
+#else
+#define NOISEKERNELS_X86 0
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define NOISEKERNELS_NEON 1
+#else
+#define NOISEKERNELS_NEON 0
+#endif
+
+namespace NoiseKernels
+{
+	// Each of these is in its own file, compiled for its instruction set, and expects the
+	// arguments to have been checked by *NoiseKernels::FillNoise*.
+#if NOISEKERNELS_X86
+	void FillNoiseSSE2(const FNoiseSettings &Settings, int Dimensions, const float *const Coordinates[4], int Stride, int Count, float *Output);
+	void FillNoiseAVX2(const FNoiseSettings &Settings, int Dimensions, const float *const Coordinates[4], int Stride, int Count, float *Output);
+#endif
+#if NOISEKERNELS_NEON
+	void FillNoiseNEON(const FNoiseSettings &Settings, int Dimensions, const float *const Coordinates[4], int Stride, int Count, float *Output);
+#endif
+}
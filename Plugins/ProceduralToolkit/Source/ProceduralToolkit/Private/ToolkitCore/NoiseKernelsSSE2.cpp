@@ -0,0 +1,83 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "NoiseKernelsSIMD.h"
+
+#if NOISEKERNELS_X86
+
+#include <emmintrin.h>
+#include <cmath>
+
+namespace NoiseKernelsSSE2
+{
+	/// Four lanes with SSE2, which has no gathers so those are done a lane at a time.
+	struct FSIMD
+	{
+		static const int Width = 4;
+		typedef __m128 FFloat;
+		typedef __m128i FInt;
+
+		static FFloat Set(float Value) { return _mm_set1_ps(Value); }
+		static FInt SetInt(int Value) { return _mm_set1_epi32(Value); }
+
+		static FFloat Load(const float *Source, int Stride)
+		{
+			if (Stride == 1) {
+				return _mm_loadu_ps(Source);
+			}
+			return _mm_setr_ps(Source[0], Source[Stride], Source[Stride * 2], Source[Stride * 3]);
+		}
+
+		static void Store(float *Destination, FFloat Value) { _mm_storeu_ps(Destination, Value); }
+
+		static FFloat Add(FFloat A, FFloat B) { return _mm_add_ps(A, B); }
+		static FFloat Sub(FFloat A, FFloat B) { return _mm_sub_ps(A, B); }
+		static FFloat Mul(FFloat A, FFloat B) { return _mm_mul_ps(A, B); }
+		static FFloat Abs(FFloat A) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), A); }
+
+		// Comparisons give masks with every bit set in the lanes where they're true.
+		static FFloat Less(FFloat A, FFloat B) { return _mm_cmplt_ps(A, B); }
+		static FFloat Greater(FFloat A, FFloat B) { return _mm_cmpgt_ps(A, B); }
+		static FFloat GreaterEqual(FFloat A, FFloat B) { return _mm_cmpge_ps(A, B); }
+		static FFloat And(FFloat A, FFloat B) { return _mm_and_ps(A, B); }
+		static FFloat Or(FFloat A, FFloat B) { return _mm_or_ps(A, B); }
+
+		/// *Value* where *Mask* is clear, zero elsewhere
+		static FFloat AndNot(FFloat Mask, FFloat Value) { return _mm_andnot_ps(Mask, Value); }
+
+		static FInt Truncate(FFloat A) { return _mm_cvttps_epi32(A); }
+		static FFloat ToFloat(FInt A) { return _mm_cvtepi32_ps(A); }
+		static FInt AsInt(FFloat Mask) { return _mm_castps_si128(Mask); }
+
+		static FInt AddInt(FInt A, FInt B) { return _mm_add_epi32(A, B); }
+		static FInt AndInt(FInt A, FInt B) { return _mm_and_si128(A, B); }
+		static FInt AndNotInt(FInt Mask, FInt Value) { return _mm_andnot_si128(Mask, Value); }
+		static FInt GreaterInt(FInt A, FInt B) { return _mm_cmpgt_epi32(A, B); }
+
+		// The indices are moved out through registers, which is quicker than storing and reloading them.
+		static FInt GatherInt(const int *Table, FInt Index)
+		{
+			return _mm_setr_epi32(
+				Table[_mm_cvtsi128_si32(Index)], Table[_mm_cvtsi128_si32(_mm_shuffle_epi32(Index, 1))],
+				Table[_mm_cvtsi128_si32(_mm_shuffle_epi32(Index, 2))], Table[_mm_cvtsi128_si32(_mm_shuffle_epi32(Index, 3))]
+			);
+		}
+
+		static FFloat GatherFloat(const float *Table, FInt Index)
+		{
+			return _mm_setr_ps(
+				Table[_mm_cvtsi128_si32(Index)], Table[_mm_cvtsi128_si32(_mm_shuffle_epi32(Index, 1))],
+				Table[_mm_cvtsi128_si32(_mm_shuffle_epi32(Index, 2))], Table[_mm_cvtsi128_si32(_mm_shuffle_epi32(Index, 3))]
+			);
+		}
+	};
+
+#include "NoiseKernelsImpl.inl"
+}
+
+void NoiseKernels::FillNoiseSSE2(const FNoiseSettings &Settings, int Dimensions, const float *const Coordinates[4], int Stride, int Count, float *Output)
+{
+	const NoiseKernelsSSE2::FNoiseBatch Batch(Settings);
+	Batch.Fill(Dimensions, Coordinates, Stride, Count, Output);
+}
+
+#endif
@@ -0,0 +1,321 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ToolkitCore/NoiseVolumeCache.h"
+#include "FastNoise.h"
+#include <math.h>
+
+float FNoiseVolume::ChooseSpacing(const float BoxMin[3], const float BoxMax[3], int Resolution)
+{
+	float LongestSide = 0.0f;
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		const float Side = BoxMax[Axis] - BoxMin[Axis];
+		LongestSide = Side > LongestSide ? Side : LongestSide;
+	}
+	Resolution = Resolution < 2 ? 2 : Resolution;
+	const float Spacing = LongestSide / (Resolution - 1);
+	if (!(Spacing > 0.0f && Spacing < INFINITY)) {
+		return 1.0f;
+	}
+	int Exponent;
+	frexpf(Spacing, &Exponent);
+	return ldexpf(1.0f, Exponent - 1);
+}
+
+bool FNoiseVolume::FindSamples(const float BoxMin[3], const float BoxMax[3], float Spacing, int OutFirst[3], int OutDimensions[3])
+{
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		if (!(BoxMin[Axis] <= BoxMax[Axis] && BoxMin[Axis] > -INFINITY && BoxMax[Axis] < INFINITY)) {
+			return false;
+		}
+		const double First = floor((double)BoxMin[Axis] / Spacing);
+		double Last = ceil((double)BoxMax[Axis] / Spacing);
+
+		// Every axis gets at least two samples, so a flat box still has cells to interpolate across.
+		// Keeping the multiples within a float's precision keeps their positions exact.
+		Last = Last > First ? Last : First + 1.0;
+		if (First < -(double)(1 << 24) || Last > (double)(1 << 24)) {
+			return false;
+		}
+		OutFirst[Axis] = (int)First;
+		OutDimensions[Axis] = (int)(Last - First) + 1;
+	}
+	return true;
+}
+
+size_t FNoiseVolume::GetMemorySize(const float BoxMin[3], const float BoxMax[3], float Spacing)
+{
+	int First[3], Counts[3];
+	if (!FindSamples(BoxMin, BoxMax, Spacing, First, Counts)) {
+		return SIZE_MAX;
+	}
+	const double Size = (double)Counts[0] * Counts[1] * Counts[2] * sizeof(float);
+	return Size < (double)SIZE_MAX ? (size_t)Size : SIZE_MAX;
+}
+
+bool FNoiseVolume::Allocate(const float BoxMin[3], const float BoxMax[3], float InSpacing, size_t MaxMemorySize)
+{
+	Values.clear();
+	Dimensions[0] = Dimensions[1] = Dimensions[2] = 0;
+	MaxError = 0.0f;
+
+	if (GetMemorySize(BoxMin, BoxMax, InSpacing) > MaxMemorySize) {
+		return false;
+	}
+	Spacing = InSpacing;
+	FindSamples(BoxMin, BoxMax, Spacing, FirstSample, Dimensions);
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		Origin[Axis] = FirstSample[Axis] * Spacing;
+	}
+	Values.resize((size_t)Dimensions[0] * Dimensions[1] * Dimensions[2]);
+	return true;
+}
+
+void FNoiseVolume::BakeSlice(FastNoise &Noise, int Slice)
+{
+	// A row at a time, with Y and Z repeated so FillNoise can read them alongside X.
+	// The positions are worked out from whole multiples of the spacing, so every grid with the
+	// same spacing bakes exactly the same samples.
+	std::vector<float> X(Dimensions[0]), Y(Dimensions[0]), Z(Dimensions[0], (FirstSample[2] + Slice) * Spacing);
+	for (int Index = 0; Index < Dimensions[0]; ++Index) {
+		X[Index] = (FirstSample[0] + Index) * Spacing;
+	}
+	for (int Row = 0; Row < Dimensions[1]; ++Row) {
+		const float RowY = (FirstSample[1] + Row) * Spacing;
+		for (float &Value : Y) {
+			Value = RowY;
+		}
+		float *Output = Values.data() + ((size_t)Slice * Dimensions[1] + Row) * Dimensions[0];
+		Noise.FillNoise(X.data(), Y.data(), Z.data(), 1, Dimensions[0], Output);
+	}
+}
+
+bool FNoiseVolume::Contains(const float BoxMin[3], const float BoxMax[3]) const
+{
+	if (Values.empty()) {
+		return false;
+	}
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		if (!(BoxMin[Axis] >= Origin[Axis] && BoxMax[Axis] <= (FirstSample[Axis] + Dimensions[Axis] - 1) * Spacing)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void FNoiseVolume::GetBounds(float OutMin[3], float OutMax[3]) const
+{
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		OutMin[Axis] = Origin[Axis];
+		OutMax[Axis] = (FirstSample[Axis] + (Dimensions[Axis] > 0 ? Dimensions[Axis] - 1 : 0)) * Spacing;
+	}
+}
+
+/// Find the cell a coordinate along an axis is in and how far across it, clamped to the grid.
+///
+/// Scaling by the inverse of a power of two spacing is exact, so any grid with the spacing
+/// interpolates between the same two samples, at the same position to within rounding.
+static inline int ToNoiseVolumeCell(float Coordinate, float FirstSample, float InverseSpacing, int Dimension, float &OutFraction)
+{
+	const float Cell = Coordinate * InverseSpacing - FirstSample;
+	if (!(Cell > 0.0f)) {
+		OutFraction = 0.0f;
+		return 0;
+	}
+	if (Cell >= (float)(Dimension - 1)) {
+		OutFraction = 1.0f;
+		return Dimension - 2;
+	}
+	const int Index = (int)Cell;
+	OutFraction = Cell - Index;
+	return Index;
+}
+
+void FNoiseVolume::Sample(const float *Positions, int Count, float *OutWeights) const
+{
+	const float InverseSpacing = 1.0f / Spacing;
+	const size_t RowStride = Dimensions[0];
+	const size_t SliceStride = RowStride * Dimensions[1];
+	for (int Index = 0; Index < Count; ++Index) {
+		const float *Position = Positions + Index * 3;
+		float FX, FY, FZ;
+		const int CX = ToNoiseVolumeCell(Position[0], (float)FirstSample[0], InverseSpacing, Dimensions[0], FX);
+		const int CY = ToNoiseVolumeCell(Position[1], (float)FirstSample[1], InverseSpacing, Dimensions[1], FY);
+		const int CZ = ToNoiseVolumeCell(Position[2], (float)FirstSample[2], InverseSpacing, Dimensions[2], FZ);
+
+		const float *Corner = Values.data() + CZ * SliceStride + CY * RowStride + CX;
+		const float X00 = Corner[0] + (Corner[1] - Corner[0]) * FX;
+		const float X10 = Corner[RowStride] + (Corner[RowStride + 1] - Corner[RowStride]) * FX;
+		const float X01 = Corner[SliceStride] + (Corner[SliceStride + 1] - Corner[SliceStride]) * FX;
+		const float X11 = Corner[SliceStride + RowStride] + (Corner[SliceStride + RowStride + 1] - Corner[SliceStride + RowStride]) * FX;
+		const float Y0 = X00 + (X10 - X00) * FY;
+		const float Y1 = X01 + (X11 - X01) * FY;
+		OutWeights[Index] = Y0 + (Y1 - Y0) * FZ;
+	}
+}
+
+void FNoiseVolume::MeasureError(FastNoise &Noise)
+{
+	// The centres of up to 16 cells spread evenly along each axis.
+	static const int MaxChecks = 16;
+	std::vector<float> Centres[3];
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		const int Cells = Dimensions[Axis] - 1;
+		const int Checks = Cells < MaxChecks ? Cells : MaxChecks;
+		for (int Check = 0; Check < Checks; ++Check) {
+			const int Cell = (int)((long long)Check * Cells / Checks);
+			Centres[Axis].push_back((FirstSample[Axis] + Cell + 0.5f) * Spacing);
+		}
+	}
+
+	MaxError = 0.0f;
+	const int RowLength = (int)Centres[0].size();
+	std::vector<float> Y(RowLength), Z(RowLength), Positions((size_t)RowLength * 3), Expected(RowLength), Found(RowLength);
+	for (float CentreZ : Centres[2]) {
+		for (float CentreY : Centres[1]) {
+			for (int Index = 0; Index < RowLength; ++Index) {
+				Y[Index] = CentreY;
+				Z[Index] = CentreZ;
+				Positions[Index * 3] = Centres[0][Index];
+				Positions[Index * 3 + 1] = CentreY;
+				Positions[Index * 3 + 2] = CentreZ;
+			}
+			Noise.FillNoise(Centres[0].data(), Y.data(), Z.data(), 1, RowLength, Expected.data());
+			Sample(Positions.data(), RowLength, Found.data());
+			for (int Index = 0; Index < RowLength; ++Index) {
+				const float Error = fabsf(Found[Index] - Expected[Index]);
+				MaxError = Error > MaxError ? Error : MaxError;
+			}
+		}
+	}
+}
+
+void FNoiseVolume::ExpandBounds(const float *Positions, int Count, float InOutMin[3], float InOutMax[3])
+{
+	for (int Index = 0; Index < Count * 3; Index += 3) {
+		for (int Axis = 0; Axis < 3; ++Axis) {
+			const float Coordinate = Positions[Index + Axis];
+			InOutMin[Axis] = Coordinate < InOutMin[Axis] ? Coordinate : InOutMin[Axis];
+			InOutMax[Axis] = Coordinate > InOutMax[Axis] ? Coordinate : InOutMax[Axis];
+		}
+	}
+}
+
+std::shared_ptr<const FNoiseVolume> FNoiseVolumeCache::Find(
+	uint64_t Key, float Spacing, const float BoxMin[3], const float BoxMax[3], float OutBakeMin[3], float OutBakeMax[3]
+) {
+	std::lock_guard<std::mutex> Lock(Mutex);
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		OutBakeMin[Axis] = BoxMin[Axis];
+		OutBakeMax[Axis] = BoxMax[Axis];
+	}
+	const FEntry *Nearby = nullptr;
+	for (FEntry &Entry : Entries) {
+		if (Entry.Key != Key || Entry.Volume->GetSpacing() != Spacing) {
+			continue;
+		}
+		if (Entry.Volume->Contains(BoxMin, BoxMax)) {
+			Entry.LastUsed = ++UseCounter;
+			return Entry.Volume;
+		}
+		Nearby = Nearby ? Nearby : &Entry;
+	}
+
+	// Grow a volume to cover both boxes, so that a mesh moving about or meshes near one another
+	// settle on one volume, unless that would make it too big.  The spacing stays the same, so
+	// this only affects how often the noise is baked and not the results.
+	if (Nearby) {
+		float GrownMin[3], GrownMax[3];
+		Nearby->Volume->GetBounds(GrownMin, GrownMax);
+		for (int Axis = 0; Axis < 3; ++Axis) {
+			GrownMin[Axis] = BoxMin[Axis] < GrownMin[Axis] ? BoxMin[Axis] : GrownMin[Axis];
+			GrownMax[Axis] = BoxMax[Axis] > GrownMax[Axis] ? BoxMax[Axis] : GrownMax[Axis];
+		}
+		if (FNoiseVolume::GetMemorySize(GrownMin, GrownMax, Spacing) <= MemoryBudget / 4) {
+			for (int Axis = 0; Axis < 3; ++Axis) {
+				OutBakeMin[Axis] = GrownMin[Axis];
+				OutBakeMax[Axis] = GrownMax[Axis];
+			}
+		}
+	}
+	return nullptr;
+}
+
+bool FNoiseVolumeCache::Add(uint64_t Key, std::shared_ptr<const FNoiseVolume> Volume)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	// Volumes the new one covers are no use any more.
+	for (size_t Index = 0; Index < Entries.size();) {
+		const FEntry &Entry = Entries[Index];
+		float EntryMin[3], EntryMax[3];
+		Entry.Volume->GetBounds(EntryMin, EntryMax);
+		if (Entry.Key == Key && Entry.Volume->GetSpacing() == Volume->GetSpacing() && Volume->Contains(EntryMin, EntryMax)) {
+			MemoryUsed -= Entry.Volume->GetMemorySize();
+			Entries.erase(Entries.begin() + Index);
+		} else {
+			++Index;
+		}
+	}
+
+	const size_t Size = Volume->GetMemorySize();
+	if (Size > MemoryBudget) {
+		return false;
+	}
+	FEntry Entry;
+	Entry.Key = Key;
+	Entry.Volume = std::move(Volume);
+	Entry.LastUsed = ++UseCounter;
+	Entries.push_back(std::move(Entry));
+	MemoryUsed += Size;
+	Trim();
+	return true;
+}
+
+void FNoiseVolumeCache::Clear()
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Entries.clear();
+	MemoryUsed = 0;
+}
+
+void FNoiseVolumeCache::SetMemoryBudget(size_t InMemoryBudget)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	MemoryBudget = InMemoryBudget;
+	Trim();
+}
+
+size_t FNoiseVolumeCache::GetMemoryBudget() const
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	return MemoryBudget;
+}
+
+size_t FNoiseVolumeCache::GetMemoryUsed() const
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	return MemoryUsed;
+}
+
+void FNoiseVolumeCache::Trim()
+{
+	while (MemoryUsed > MemoryBudget && !Entries.empty()) {
+		size_t Oldest = 0;
+		for (size_t Index = 1; Index < Entries.size(); ++Index) {
+			if (Entries[Index].LastUsed < Entries[Oldest].LastUsed) {
+				Oldest = Index;
+			}
+		}
+		MemoryUsed -= Entries[Oldest].Volume->GetMemorySize();
+		Entries.erase(Entries.begin() + Oldest);
+	}
+}
+
+uint64_t FNoiseVolumeCache::HashBytes(const void *Data, size_t Size, uint64_t Hash)
+{
+	const unsigned char *Bytes = (const unsigned char *)Data;
+	for (size_t Index = 0; Index < Size; ++Index) {
+		Hash = (Hash ^ Bytes[Index]) * 1099511628211ull;
+	}
+	return Hash;
+}
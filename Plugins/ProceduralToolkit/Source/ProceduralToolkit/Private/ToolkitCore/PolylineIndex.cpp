@@ -0,0 +1,243 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ToolkitCore/PolylineIndex.h"
+#include <algorithm>
+#include <math.h>
+
+/// The most segments kept in a leaf of the hierarchy.
+static const int MaxLeafSegments = 4;
+
+/// Deep enough for any hierarchy built over an int's worth of segments.
+static const int MaxTreeDepth = 64;
+
+static inline float Dot(const float A[3], const float B[3])
+{
+	return A[0] * B[0] + A[1] * B[1] + A[2] * B[2];
+}
+
+/// Return the squared distance from a point to the closest point of a segment, which is written to *OutClosest*.
+static inline float ClosestPointOnSegment(const float Point[3], const float Start[3], const float End[3], float OutClosest[3])
+{
+	const float Segment[3] = { End[0] - Start[0], End[1] - Start[1], End[2] - Start[2] };
+	const float FromStart[3] = { Point[0] - Start[0], Point[1] - Start[1], Point[2] - Start[2] };
+	const float LengthSquared = Dot(Segment, Segment);
+	const float Projected = Dot(FromStart, Segment);
+	const float Along = (Projected <= 0.0f || LengthSquared <= 0.0f) ? 0.0f : (Projected >= LengthSquared) ? 1.0f : Projected / LengthSquared;
+
+	float DistanceSquared = 0.0f;
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		OutClosest[Axis] = Start[Axis] + Segment[Axis] * Along;
+		const float Offset = Point[Axis] - OutClosest[Axis];
+		DistanceSquared += Offset * Offset;
+	}
+	return DistanceSquared;
+}
+
+/// Return the squared distance from a point to a box, which is zero inside it.
+static inline float DistanceSquaredToBox(const float Point[3], const float BoxMin[3], const float BoxMax[3])
+{
+	float DistanceSquared = 0.0f;
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		const float Offset = Point[Axis] < BoxMin[Axis] ? BoxMin[Axis] - Point[Axis] : Point[Axis] > BoxMax[Axis] ? Point[Axis] - BoxMax[Axis] : 0.0f;
+		DistanceSquared += Offset * Offset;
+	}
+	return DistanceSquared;
+}
+
+/// Return how far a point is from the line through two others.
+static float DistanceFromChord(const float Point[3], const float Start[3], const float End[3])
+{
+	float Closest[3];
+	return sqrtf(ClosestPointOnSegment(Point, Start, End, Closest));
+}
+
+/// Add the points of a span of the curve after its start, splitting it until it's close enough.
+static void SampleSpan(
+	const std::function<void(float Parameter, float OutPoint[3])> &Evaluate, float StartParameter, const float Start[3],
+	float EndParameter, const float End[3], float Tolerance, int DepthLeft, std::vector<float> &OutPoints
+) {
+	const float MiddleParameter = (StartParameter + EndParameter) * 0.5f;
+	float Middle[3];
+	Evaluate(MiddleParameter, Middle);
+
+	bool bCloseEnough = (DepthLeft <= 0) || !(MiddleParameter > StartParameter && MiddleParameter < EndParameter);
+	if (!bCloseEnough && DistanceFromChord(Middle, Start, End) <= Tolerance) {
+		// The midpoint alone misses S-bends which cross the chord there, so check the quarters too.
+		float Quarter[3], ThreeQuarters[3];
+		Evaluate((StartParameter + MiddleParameter) * 0.5f, Quarter);
+		Evaluate((MiddleParameter + EndParameter) * 0.5f, ThreeQuarters);
+		bCloseEnough = DistanceFromChord(Quarter, Start, End) <= Tolerance && DistanceFromChord(ThreeQuarters, Start, End) <= Tolerance;
+	}
+
+	if (bCloseEnough) {
+		OutPoints.insert(OutPoints.end(), End, End + 3);
+		return;
+	}
+	SampleSpan(Evaluate, StartParameter, Start, MiddleParameter, Middle, Tolerance, DepthLeft - 1, OutPoints);
+	SampleSpan(Evaluate, MiddleParameter, Middle, EndParameter, End, Tolerance, DepthLeft - 1, OutPoints);
+}
+
+void FPolylineIndex::SampleCurve(
+	const std::function<void(float Parameter, float OutPoint[3])> &Evaluate, const float *Breaks, int BreakCount,
+	float Tolerance, int MaxDepth, std::vector<float> &OutPoints
+) {
+	OutPoints.clear();
+	if (BreakCount <= 0) {
+		return;
+	}
+
+	float Start[3];
+	Evaluate(Breaks[0], Start);
+	OutPoints.insert(OutPoints.end(), Start, Start + 3);
+	for (int Break = 1; Break < BreakCount; ++Break) {
+		float End[3];
+		Evaluate(Breaks[Break], End);
+		SampleSpan(Evaluate, Breaks[Break - 1], Start, Breaks[Break], End, Tolerance, MaxDepth, OutPoints);
+		Start[0] = End[0];
+		Start[1] = End[1];
+		Start[2] = End[2];
+	}
+}
+
+void FPolylineIndex::Build(const float *Points, int PointCount)
+{
+	Segments.clear();
+	Nodes.clear();
+	if (PointCount <= 0) {
+		return;
+	}
+
+	const int SegmentCount = PointCount > 1 ? PointCount - 1 : 1;
+	Segments.resize(SegmentCount);
+	for (int Index = 0; Index < SegmentCount; ++Index) {
+		const float *Start = Points + Index * 3;
+		const float *End = PointCount > 1 ? Start + 3 : Start;
+		for (int Axis = 0; Axis < 3; ++Axis) {
+			Segments[Index].Start[Axis] = Start[Axis];
+			Segments[Index].End[Axis] = End[Axis];
+		}
+	}
+
+	Nodes.reserve(2 * (SegmentCount / MaxLeafSegments + 1));
+	BuildNode(0, SegmentCount, 0);
+}
+
+int FPolylineIndex::BuildNode(int First, int Count, int Depth)
+{
+	const int NodeIndex = (int)Nodes.size();
+	Nodes.push_back(FNode());
+
+	FNode Node;
+	float CenterMin[3], CenterMax[3];
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		Node.BoundsMin[Axis] = CenterMin[Axis] = INFINITY;
+		Node.BoundsMax[Axis] = CenterMax[Axis] = -INFINITY;
+	}
+	for (int Index = First; Index < First + Count; ++Index) {
+		const FSegment &Segment = Segments[Index];
+		for (int Axis = 0; Axis < 3; ++Axis) {
+			const float Low = std::min(Segment.Start[Axis], Segment.End[Axis]);
+			const float High = std::max(Segment.Start[Axis], Segment.End[Axis]);
+			const float Center = (Low + High) * 0.5f;
+			Node.BoundsMin[Axis] = std::min(Node.BoundsMin[Axis], Low);
+			Node.BoundsMax[Axis] = std::max(Node.BoundsMax[Axis], High);
+			CenterMin[Axis] = std::min(CenterMin[Axis], Center);
+			CenterMax[Axis] = std::max(CenterMax[Axis], Center);
+		}
+	}
+
+	if (Count <= MaxLeafSegments || Depth >= MaxTreeDepth) {
+		Node.Index = First;
+		Node.SegmentCount = Count;
+		Nodes[NodeIndex] = Node;
+		return NodeIndex;
+	}
+
+	// Split at the median along the axis the segments are most spread out on.
+	int SplitAxis = 0;
+	for (int Axis = 1; Axis < 3; ++Axis) {
+		if (CenterMax[Axis] - CenterMin[Axis] > CenterMax[SplitAxis] - CenterMin[SplitAxis]) {
+			SplitAxis = Axis;
+		}
+	}
+	const int Half = Count / 2;
+	std::nth_element(
+		Segments.begin() + First, Segments.begin() + First + Half, Segments.begin() + First + Count,
+		[SplitAxis](const FSegment &A, const FSegment &B) {
+			return A.Start[SplitAxis] + A.End[SplitAxis] < B.Start[SplitAxis] + B.End[SplitAxis];
+		}
+	);
+
+	BuildNode(First, Half, Depth + 1);
+	Node.Index = BuildNode(First + Half, Count - Half, Depth + 1);
+	Node.SegmentCount = 0;
+	Nodes[NodeIndex] = Node;
+	return NodeIndex;
+}
+
+bool FPolylineIndex::FindClosestPoint(const float Point[3], float MaxDistance, float OutClosest[3], int &InOutSegmentHint) const
+{
+	if (Segments.empty()) {
+		return false;
+	}
+
+	// Start from the hinted segment so that more of the hierarchy can be skipped.
+	int BestSegment = -1;
+	float BestDistanceSquared = MaxDistance * MaxDistance;
+	if (InOutSegmentHint >= 0 && InOutSegmentHint < (int)Segments.size()) {
+		float Closest[3];
+		const FSegment &Hint = Segments[InOutSegmentHint];
+		const float DistanceSquared = ClosestPointOnSegment(Point, Hint.Start, Hint.End, Closest);
+		if (DistanceSquared <= BestDistanceSquared) {
+			BestDistanceSquared = DistanceSquared;
+			BestSegment = InOutSegmentHint;
+			OutClosest[0] = Closest[0];
+			OutClosest[1] = Closest[1];
+			OutClosest[2] = Closest[2];
+		}
+	}
+
+	int Stack[MaxTreeDepth + 1];
+	int StackSize = 0;
+	Stack[StackSize++] = 0;
+	while (StackSize > 0) {
+		const FNode &Node = Nodes[Stack[--StackSize]];
+		if (DistanceSquaredToBox(Point, Node.BoundsMin, Node.BoundsMax) >= BestDistanceSquared) {
+			continue;
+		}
+
+		if (Node.SegmentCount > 0) {
+			for (int Index = Node.Index; Index < Node.Index + Node.SegmentCount; ++Index) {
+				float Closest[3];
+				const float DistanceSquared = ClosestPointOnSegment(Point, Segments[Index].Start, Segments[Index].End, Closest);
+				if (DistanceSquared < BestDistanceSquared) {
+					BestDistanceSquared = DistanceSquared;
+					BestSegment = Index;
+					OutClosest[0] = Closest[0];
+					OutClosest[1] = Closest[1];
+					OutClosest[2] = Closest[2];
+				}
+			}
+			continue;
+		}
+
+		// Visit the nearer child first, which means pushing it last.
+		const int FirstChild = (int)(&Node - Nodes.data()) + 1;
+		const int SecondChild = Node.Index;
+		const float FirstDistance = DistanceSquaredToBox(Point, Nodes[FirstChild].BoundsMin, Nodes[FirstChild].BoundsMax);
+		const float SecondDistance = DistanceSquaredToBox(Point, Nodes[SecondChild].BoundsMin, Nodes[SecondChild].BoundsMax);
+		if (FirstDistance < SecondDistance) {
+			Stack[StackSize++] = SecondChild;
+			Stack[StackSize++] = FirstChild;
+		} else {
+			Stack[StackSize++] = FirstChild;
+			Stack[StackSize++] = SecondChild;
+		}
+	}
+
+	if (BestSegment < 0) {
+		return false;
+	}
+	InOutSegmentHint = BestSegment;
+	return true;
+}
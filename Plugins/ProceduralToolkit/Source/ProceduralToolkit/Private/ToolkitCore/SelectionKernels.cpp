@@ -0,0 +1,331 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ToolkitCore/SelectionKernels.h"
+#include "ToolkitCore/PolylineIndex.h"
+#include "ToolkitCore/VertexGrid.h"
+#include "FastNoise.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <utility>
+
+// The same tolerance FVector::Normalize uses.
+static const float NormalizeTolerance = 1.e-8f;
+
+/// Clamp a value to 0-1, in the same way as FMath::Clamp.
+static inline float Clamp01(float Value)
+{
+	return Value < 0.0f ? 0.0f : Value < 1.0f ? Value : 1.0f;
+}
+
+/// Map a distance to a weight, which is 1 inside *InnerRadius* and falls to 0 at *InnerRadius + SelectionRadius*.
+static inline float DistanceFalloff(float Distance, float InnerRadius, float SelectionRadius)
+{
+	return 1.0f - Clamp01((Distance - InnerRadius) / SelectionRadius);
+}
+
+static inline float Dot(const float A[3], const float B[3])
+{
+	return A[0] * B[0] + A[1] * B[1] + A[2] * B[2];
+}
+
+/// The largest share of the grid's vertices a query can expect to visit before it's quicker to
+/// just visit all of them.
+static const double MaxGridQueryFraction = 0.5;
+
+/// The number of weights calculated at a time before scattering them to the output.
+static const int GridScratchSize = 256;
+
+/// Where *SelectInGridBox* writes a weight for every vertex in the grid.
+struct FDenseGridOutput
+{
+	float *Weights;
+
+	void Begin(int VertexCount)
+	{
+		memset(Weights, 0, sizeof(float) * VertexCount);
+	}
+
+	void Add(int Index, float Weight)
+	{
+		Weights[Index] = Weight;
+	}
+
+	void End()
+	{
+	}
+};
+
+/// Where *SelectInGridBox* writes only the weights which aren't zero, sorted by index.
+struct FSparseGridOutput
+{
+	std::vector<int> &Indices;
+	std::vector<float> &Weights;
+	std::vector<std::pair<int, float>> Found;
+
+	FSparseGridOutput(std::vector<int> &InIndices, std::vector<float> &InWeights) : Indices(InIndices), Weights(InWeights)
+	{
+	}
+
+	void Begin(int)
+	{
+	}
+
+	void Add(int Index, float Weight)
+	{
+		if (Weight != 0.0f) {
+			Found.emplace_back(Index, Weight);
+		}
+	}
+
+	void End()
+	{
+		std::sort(Found.begin(), Found.end());
+		Indices.resize(Found.size());
+		Weights.resize(Found.size());
+		for (size_t Entry = 0; Entry < Found.size(); ++Entry) {
+			Indices[Entry] = Found[Entry].first;
+			Weights[Entry] = Found[Entry].second;
+		}
+	}
+};
+
+/// Run a selection through the grid over a box, if it's worth doing.
+///
+/// *Kernel* is called as `Kernel(const float *Positions, int Count, float *OutWeights)` on runs
+/// of the grid's positions, and the weights are passed to *Output* with their vertex indices.
+template <typename KernelType, typename OutputType>
+static bool SelectInGridBox(const FVertexGrid &Grid, const float BoxMin[3], const float BoxMax[3], KernelType Kernel, OutputType &Output)
+{
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		// This also rejects NaNs, which would otherwise give a box of every cell.
+		if (!(BoxMin[Axis] <= BoxMax[Axis])) {
+			return false;
+		}
+	}
+	const int VertexCount = Grid.GetVertexCount();
+	if (VertexCount == 0 || Grid.EstimateVertexCountInBox(BoxMin, BoxMax) > VertexCount * MaxGridQueryFraction) {
+		return false;
+	}
+
+	Output.Begin(VertexCount);
+	Grid.ForEachCellInBox(BoxMin, BoxMax, [&Output, &Kernel](const float *Positions, const int *Indices, int Count) {
+		float Scratch[GridScratchSize];
+		for (int First = 0; First < Count; First += GridScratchSize) {
+			const int PieceCount = (Count - First) < GridScratchSize ? (Count - First) : GridScratchSize;
+			Kernel(Positions + First * 3, PieceCount, Scratch);
+			for (int Index = 0; Index < PieceCount; ++Index) {
+				Output.Add(Indices[First + Index], Scratch[Index]);
+			}
+		}
+	});
+	Output.End();
+	return true;
+}
+
+/// Find the box around the part of the grid the *SelectNear* kernel can give weight to.
+static bool GetNearBox(const float Center[3], float InnerRadius, float OuterRadius, float OutBoxMin[3], float OutBoxMax[3])
+{
+	// Vertices outside of the outer radius only get a weight of 0 when it's bigger than the inner one.
+	if (!(OuterRadius > InnerRadius) || !(OuterRadius < INFINITY)) {
+		return false;
+	}
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		OutBoxMin[Axis] = Center[Axis] - OuterRadius;
+		OutBoxMax[Axis] = Center[Axis] + OuterRadius;
+	}
+	return true;
+}
+
+/// Find the box around the part of the grid the *SelectNearLine* kernel can give weight to.
+static bool GetNearLineBox(
+	const float LineStart[3], const float LineEnd[3], float InnerRadius, float OuterRadius, float OutBoxMin[3], float OutBoxMax[3]
+) {
+	if (!(OuterRadius > InnerRadius) || !(OuterRadius < INFINITY)) {
+		return false;
+	}
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		OutBoxMin[Axis] = (LineStart[Axis] < LineEnd[Axis] ? LineStart[Axis] : LineEnd[Axis]) - OuterRadius;
+		OutBoxMax[Axis] = (LineStart[Axis] > LineEnd[Axis] ? LineStart[Axis] : LineEnd[Axis]) + OuterRadius;
+	}
+	return true;
+}
+
+void SelectionKernels::SelectNear(const float *Positions, int Count, const float Center[3], float InnerRadius, float OuterRadius, float *OutWeights)
+{
+	const float SelectionRadius = OuterRadius - InnerRadius;
+	for (int Index = 0; Index < Count; ++Index) {
+		const float *Vertex = Positions + Index * 3;
+		const float Relative[3] = { Vertex[0] - Center[0], Vertex[1] - Center[1], Vertex[2] - Center[2] };
+		OutWeights[Index] = DistanceFalloff(sqrtf(Dot(Relative, Relative)), InnerRadius, SelectionRadius);
+	}
+}
+
+void SelectionKernels::SelectNearLine(
+	const float *Positions, int Count, const float LineStart[3], const float LineEnd[3], bool bLineIsInfinite,
+	float InnerRadius, float OuterRadius, float *OutWeights
+) {
+	const float SelectionRadius = OuterRadius - InnerRadius;
+	const float Line[3] = { LineEnd[0] - LineStart[0], LineEnd[1] - LineStart[1], LineEnd[2] - LineStart[2] };
+	const float LineLengthSquared = Dot(Line, Line);
+
+	for (int Index = 0; Index < Count; ++Index) {
+		const float *Vertex = Positions + Index * 3;
+		const float FromStart[3] = { Vertex[0] - LineStart[0], Vertex[1] - LineStart[1], Vertex[2] - LineStart[2] };
+
+		// Find how far along the line the closest point is, as FMath::ClosestPointOnLine and
+		// FMath::ClosestPointOnInfiniteLine do.
+		float Along;
+		if (bLineIsInfinite) {
+			Along = (LineLengthSquared < NormalizeTolerance) ? 0.0f : Dot(FromStart, Line) / LineLengthSquared;
+		} else {
+			const float Projected = Dot(FromStart, Line);
+			Along = (Projected <= 0.0f) ? 0.0f : (Projected >= LineLengthSquared) ? 1.0f : Projected / LineLengthSquared;
+		}
+
+		const float Offset[3] = { FromStart[0] - Line[0] * Along, FromStart[1] - Line[1] * Along, FromStart[2] - Line[2] * Along };
+		OutWeights[Index] = DistanceFalloff(sqrtf(Dot(Offset, Offset)), InnerRadius, SelectionRadius);
+	}
+}
+
+void SelectionKernels::SelectNearPolyline(
+	const FPolylineIndex &Polyline, const float *Positions, int Count, const float *QueryMatrix,
+	float InnerRadius, float OuterRadius, float *OutWeights
+) {
+	const float SelectionRadius = OuterRadius - InnerRadius;
+
+	// Neighbouring vertices are usually closest to the same segment, so each search starts from the last one's.
+	int SegmentHint = 0;
+	for (int Index = 0; Index < Count; ++Index) {
+		const float *Vertex = Positions + Index * 3;
+		float Query[3] = { Vertex[0], Vertex[1], Vertex[2] };
+		if (QueryMatrix) {
+			for (int Row = 0; Row < 3; ++Row) {
+				const float *MatrixRow = QueryMatrix + Row * 4;
+				Query[Row] = MatrixRow[0] * Vertex[0] + MatrixRow[1] * Vertex[1] + MatrixRow[2] * Vertex[2] + MatrixRow[3];
+			}
+		}
+
+		// The distance is measured from the vertex rather than the query point, so anything further
+		// from the query point than the outer radius plus the gap between the two has no weight.
+		const float Moved[3] = { Query[0] - Vertex[0], Query[1] - Vertex[1], Query[2] - Vertex[2] };
+		float Closest[3];
+		if (!Polyline.FindClosestPoint(Query, OuterRadius + sqrtf(Dot(Moved, Moved)), Closest, SegmentHint)) {
+			OutWeights[Index] = 0.0f;
+			continue;
+		}
+		const float Offset[3] = { Vertex[0] - Closest[0], Vertex[1] - Closest[1], Vertex[2] - Closest[2] };
+		OutWeights[Index] = DistanceFalloff(sqrtf(Dot(Offset, Offset)), InnerRadius, SelectionRadius);
+	}
+}
+
+void SelectionKernels::SelectFacing(
+	const float *Normals, int Count, const float Facing[3], float InnerRadiusInDegrees, float OuterRadiusInDegrees,
+	float *OutWeights
+) {
+	const float SelectionRadius = OuterRadiusInDegrees - InnerRadiusInDegrees;
+	const float RadiansToDegrees = 180.0f / 3.1415926535897932f;
+
+	for (int Index = 0; Index < Count; ++Index) {
+		const float *Normal = Normals + Index * 3;
+		const float LengthSquared = Dot(Normal, Normal);
+		if (LengthSquared <= NormalizeTolerance) {
+			OutWeights[Index] = 0.0f;
+			continue;
+		}
+
+		// Clamp the cosine as rounding can push it just outside of the range acos accepts.
+		const float Cosine = Dot(Normal, Facing) / sqrtf(LengthSquared);
+		const float AngleToNormal = acosf(Cosine < -1.0f ? -1.0f : Cosine > 1.0f ? 1.0f : Cosine) * RadiansToDegrees;
+		OutWeights[Index] = DistanceFalloff(AngleToNormal, InnerRadiusInDegrees, SelectionRadius);
+	}
+}
+
+void SelectionKernels::SelectLinear(
+	const float *Positions, int Count, const float LineStart[3], const float LineEnd[3], bool bLimitToLine,
+	float *OutWeights
+) {
+	const float Line[3] = { LineEnd[0] - LineStart[0], LineEnd[1] - LineStart[1], LineEnd[2] - LineStart[2] };
+	const float LineLengthSquared = Dot(Line, Line);
+	const float LineLength = sqrtf(LineLengthSquared);
+
+	for (int Index = 0; Index < Count; ++Index) {
+		const float *Vertex = Positions + Index * 3;
+		const float FromStart[3] = { Vertex[0] - LineStart[0], Vertex[1] - LineStart[1], Vertex[2] - LineStart[2] };
+		const float Projected = Dot(FromStart, Line);
+
+		// If the closest point is one of the end points then return the limits.
+		if (Projected >= LineLengthSquared) {
+			OutWeights[Index] = bLimitToLine ? 0.0f : 1.0f;
+		}
+		else if (Projected <= 0.0f) {
+			OutWeights[Index] = 0.0f;
+		}
+		else {
+			// The distance from the start to the closest point, as a ratio of the line's length.
+			const float Along = Projected / LineLengthSquared;
+			const float ToClosest[3] = { Line[0] * Along, Line[1] * Along, Line[2] * Along };
+			OutWeights[Index] = sqrtf(Dot(ToClosest, ToClosest)) / LineLength;
+		}
+	}
+}
+
+void SelectionKernels::SelectByNoise(FastNoise &Noise, const float *Positions, int Count, float *OutWeights)
+{
+	// The positions are interleaved XYZ, so each coordinate is every third float.
+	Noise.FillNoise(Positions, Positions + 1, Positions + 2, 3, Count, OutWeights);
+}
+
+bool SelectionKernels::SelectNear(const FVertexGrid &Grid, const float Center[3], float InnerRadius, float OuterRadius, float *OutWeights)
+{
+	float BoxMin[3], BoxMax[3];
+	FDenseGridOutput Output = { OutWeights };
+	return GetNearBox(Center, InnerRadius, OuterRadius, BoxMin, BoxMax) && SelectInGridBox(
+		Grid, BoxMin, BoxMax, [Center, InnerRadius, OuterRadius](const float *Positions, int Count, float *Weights) {
+			SelectNear(Positions, Count, Center, InnerRadius, OuterRadius, Weights);
+		},
+		Output
+	);
+}
+
+bool SelectionKernels::SelectNear(
+	const FVertexGrid &Grid, const float Center[3], float InnerRadius, float OuterRadius,
+	std::vector<int> &OutIndices, std::vector<float> &OutWeights
+) {
+	float BoxMin[3], BoxMax[3];
+	FSparseGridOutput Output(OutIndices, OutWeights);
+	return GetNearBox(Center, InnerRadius, OuterRadius, BoxMin, BoxMax) && SelectInGridBox(
+		Grid, BoxMin, BoxMax, [Center, InnerRadius, OuterRadius](const float *Positions, int Count, float *Weights) {
+			SelectNear(Positions, Count, Center, InnerRadius, OuterRadius, Weights);
+		},
+		Output
+	);
+}
+
+bool SelectionKernels::SelectNearLine(
+	const FVertexGrid &Grid, const float LineStart[3], const float LineEnd[3], float InnerRadius, float OuterRadius,
+	float *OutWeights
+) {
+	float BoxMin[3], BoxMax[3];
+	FDenseGridOutput Output = { OutWeights };
+	return GetNearLineBox(LineStart, LineEnd, InnerRadius, OuterRadius, BoxMin, BoxMax) && SelectInGridBox(
+		Grid, BoxMin, BoxMax, [LineStart, LineEnd, InnerRadius, OuterRadius](const float *Positions, int Count, float *Weights) {
+			SelectNearLine(Positions, Count, LineStart, LineEnd, false, InnerRadius, OuterRadius, Weights);
+		},
+		Output
+	);
+}
+
+bool SelectionKernels::SelectNearLine(
+	const FVertexGrid &Grid, const float LineStart[3], const float LineEnd[3], float InnerRadius, float OuterRadius,
+	std::vector<int> &OutIndices, std::vector<float> &OutWeights
+) {
+	float BoxMin[3], BoxMax[3];
+	FSparseGridOutput Output(OutIndices, OutWeights);
+	return GetNearLineBox(LineStart, LineEnd, InnerRadius, OuterRadius, BoxMin, BoxMax) && SelectInGridBox(
+		Grid, BoxMin, BoxMax, [LineStart, LineEnd, InnerRadius, OuterRadius](const float *Positions, int Count, float *Weights) {
+			SelectNearLine(Positions, Count, LineStart, LineEnd, false, InnerRadius, OuterRadius, Weights);
+		},
+		Output
+	);
+}
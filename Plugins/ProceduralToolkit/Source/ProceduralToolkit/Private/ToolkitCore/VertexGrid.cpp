@@ -0,0 +1,170 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ToolkitCore/VertexGrid.h"
+#include <math.h>
+
+/// Work out the number of cells along each axis for a cell size.
+static double CountCells(const float Extents[3], double CellSize, int OutDimensions[3])
+{
+	double CellCount = 1.0;
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		const double AxisCells = ceil(Extents[Axis] / CellSize);
+		OutDimensions[Axis] = AxisCells < 1.0 ? 1 : (int)AxisCells;
+		CellCount *= OutDimensions[Axis];
+	}
+	return CellCount;
+}
+
+/// Find the cell along an axis for a coordinate, clamped to the grid.
+///
+/// This is written so that NaNs and infinities clamp rather than overflowing the cast.
+static inline int ToCell(float Coordinate, float Minimum, float InverseCellSize, int Dimension)
+{
+	const float Cell = (Coordinate - Minimum) * InverseCellSize;
+	if (!(Cell > 0.0f)) {
+		return 0;
+	}
+	if (Cell >= (float)(Dimension - 1)) {
+		return Dimension - 1;
+	}
+	return (int)Cell;
+}
+
+void FVertexGrid::Build(const FSource *Sources, int SourceCount, int VerticesPerCell)
+{
+	Reset();
+
+	int VertexCount = 0;
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		BoundsMin[Axis] = INFINITY;
+		BoundsMax[Axis] = -INFINITY;
+	}
+	for (int SourceIndex = 0; SourceIndex < SourceCount; ++SourceIndex) {
+		const FSource &Source = Sources[SourceIndex];
+		VertexCount += Source.VertexCount;
+		for (int Index = 0; Index < Source.VertexCount * 3; Index += 3) {
+			for (int Axis = 0; Axis < 3; ++Axis) {
+				const float Coordinate = Source.Positions[Index + Axis];
+				BoundsMin[Axis] = Coordinate < BoundsMin[Axis] ? Coordinate : BoundsMin[Axis];
+				BoundsMax[Axis] = Coordinate > BoundsMax[Axis] ? Coordinate : BoundsMax[Axis];
+			}
+		}
+	}
+	if (VertexCount == 0) {
+		return;
+	}
+
+	// Find the smallest cube cells which give no more than the target number of cells.  Searching
+	// for this rather than using the volume means flat and thin meshes still get sensible cells.
+	const double TargetCellCount = (VertexCount / (VerticesPerCell > 0 ? VerticesPerCell : 1)) + 1;
+	float Extents[3];
+	float MaxExtent = 0.0f;
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		Extents[Axis] = BoundsMax[Axis] - BoundsMin[Axis];
+		if (!(Extents[Axis] < INFINITY)) {
+			// Infinite or NaN positions, so there's no sensible grid.  Use a single cell.
+			Extents[0] = Extents[1] = Extents[2] = 0.0f;
+			MaxExtent = 0.0f;
+			break;
+		}
+		MaxExtent = Extents[Axis] > MaxExtent ? Extents[Axis] : MaxExtent;
+	}
+
+	double CellSize = 1.0;
+	if (MaxExtent > 0.0f) {
+		double TooSmall = MaxExtent / TargetCellCount;
+		double BigEnough = MaxExtent;
+		for (int Iteration = 0; Iteration < 32; ++Iteration) {
+			const double Middle = (TooSmall + BigEnough) * 0.5;
+			int MiddleDimensions[3];
+			if (CountCells(Extents, Middle, MiddleDimensions) <= TargetCellCount) {
+				BigEnough = Middle;
+			} else {
+				TooSmall = Middle;
+			}
+		}
+		CellSize = BigEnough;
+	}
+	CountCells(Extents, CellSize, Dimensions);
+	InverseCellSize = (float)(1.0 / CellSize);
+
+	// Counting sort of the vertices by cell.
+	const int CellCount = Dimensions[0] * Dimensions[1] * Dimensions[2];
+	std::vector<int> VertexCells(VertexCount);
+	CellStarts.assign(CellCount + 1, 0);
+	int VertexIndex = 0;
+	for (int SourceIndex = 0; SourceIndex < SourceCount; ++SourceIndex) {
+		const FSource &Source = Sources[SourceIndex];
+		for (int Index = 0; Index < Source.VertexCount; ++Index, ++VertexIndex) {
+			const float *Position = Source.Positions + Index * 3;
+			const int CellX = ToCell(Position[0], BoundsMin[0], InverseCellSize, Dimensions[0]);
+			const int CellY = ToCell(Position[1], BoundsMin[1], InverseCellSize, Dimensions[1]);
+			const int CellZ = ToCell(Position[2], BoundsMin[2], InverseCellSize, Dimensions[2]);
+			const int Cell = (CellZ * Dimensions[1] + CellY) * Dimensions[0] + CellX;
+			VertexCells[VertexIndex] = Cell;
+			++CellStarts[Cell + 1];
+		}
+	}
+	for (int Cell = 0; Cell < CellCount; ++Cell) {
+		MaxCellVertexCount = CellStarts[Cell + 1] > MaxCellVertexCount ? CellStarts[Cell + 1] : MaxCellVertexCount;
+		CellStarts[Cell + 1] += CellStarts[Cell];
+	}
+
+	SortedPositions.resize(VertexCount * 3);
+	SortedIndices.resize(VertexCount);
+	std::vector<int> NextInCell(CellStarts.begin(), CellStarts.end() - 1);
+	VertexIndex = 0;
+	for (int SourceIndex = 0; SourceIndex < SourceCount; ++SourceIndex) {
+		const FSource &Source = Sources[SourceIndex];
+		for (int Index = 0; Index < Source.VertexCount; ++Index, ++VertexIndex) {
+			const int Slot = NextInCell[VertexCells[VertexIndex]]++;
+			SortedPositions[Slot * 3 + 0] = Source.Positions[Index * 3 + 0];
+			SortedPositions[Slot * 3 + 1] = Source.Positions[Index * 3 + 1];
+			SortedPositions[Slot * 3 + 2] = Source.Positions[Index * 3 + 2];
+			SortedIndices[Slot] = Source.FirstIndex + Index;
+		}
+	}
+}
+
+void FVertexGrid::Reset()
+{
+	Dimensions[0] = Dimensions[1] = Dimensions[2] = 0;
+	MaxCellVertexCount = 0;
+	std::vector<int>().swap(CellStarts);
+	std::vector<float>().swap(SortedPositions);
+	std::vector<int>().swap(SortedIndices);
+}
+
+bool FVertexGrid::GetCellRange(const float BoxMin[3], const float BoxMax[3], int OutCellMin[3], int OutCellMax[3]) const
+{
+	if (SortedIndices.empty()) {
+		return false;
+	}
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		if (BoxMax[Axis] < BoundsMin[Axis] || BoxMin[Axis] > BoundsMax[Axis]) {
+			return false;
+		}
+
+		// Positions are put in cells using the same calculation, and it never decreases as the
+		// coordinate increases, so every vertex inside the box is inside this range of cells.
+		OutCellMin[Axis] = ToCell(BoxMin[Axis], BoundsMin[Axis], InverseCellSize, Dimensions[Axis]);
+		OutCellMax[Axis] = ToCell(BoxMax[Axis], BoundsMin[Axis], InverseCellSize, Dimensions[Axis]);
+		if (OutCellMax[Axis] < OutCellMin[Axis]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+double FVertexGrid::EstimateVertexCountInBox(const float BoxMin[3], const float BoxMax[3]) const
+{
+	int CellMin[3], CellMax[3];
+	if (!GetCellRange(BoxMin, BoxMax, CellMin, CellMax)) {
+		return 0.0;
+	}
+	double Fraction = 1.0;
+	for (int Axis = 0; Axis < 3; ++Axis) {
+		Fraction *= (double)(CellMax[Axis] - CellMin[Axis] + 1) / Dimensions[Axis];
+	}
+	return Fraction * GetVertexCount();
+}
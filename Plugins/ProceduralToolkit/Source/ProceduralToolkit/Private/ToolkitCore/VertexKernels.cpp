@@ -0,0 +1,380 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ToolkitCore/VertexKernels.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERTEXKERNELS_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define VERTEXKERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(VERTEXKERNELS_SSE) || defined(VERTEXKERNELS_NEON)
+#define VERTEXKERNELS_SIMD 1
+#else
+#define VERTEXKERNELS_SIMD 0
+#endif
+
+// The same tolerance FVector::Normalize uses.
+static const float NormalizeTolerance = 1.e-8f;
+
+#if defined(VERTEXKERNELS_SSE)
+
+typedef __m128 Float4;
+
+static inline Float4 Load4(const float *Data) { return _mm_loadu_ps(Data); }
+static inline Float4 Set4(float Value) { return _mm_set1_ps(Value); }
+static inline Float4 Add4(Float4 A, Float4 B) { return _mm_add_ps(A, B); }
+static inline Float4 Sub4(Float4 A, Float4 B) { return _mm_sub_ps(A, B); }
+static inline Float4 Mul4(Float4 A, Float4 B) { return _mm_mul_ps(A, B); }
+static inline Float4 Div4(Float4 A, Float4 B) { return _mm_div_ps(A, B); }
+static inline Float4 Sqrt4(Float4 A) { return _mm_sqrt_ps(A); }
+static inline Float4 Greater4(Float4 A, Float4 B) { return _mm_cmpgt_ps(A, B); }
+static inline Float4 Select4(Float4 Mask, Float4 IfTrue, Float4 IfFalse)
+{
+	return _mm_or_ps(_mm_and_ps(Mask, IfTrue), _mm_andnot_ps(Mask, IfFalse));
+}
+
+/// Load four XYZ vertices and transpose them into X, Y, and Z registers.
+static inline void LoadXYZ4(const float *Data, Float4 &X, Float4 &Y, Float4 &Z)
+{
+	const Float4 A = _mm_loadu_ps(Data);		// x0 y0 z0 x1
+	const Float4 B = _mm_loadu_ps(Data + 4);	// y1 z1 x2 y2
+	const Float4 C = _mm_loadu_ps(Data + 8);	// z2 x3 y3 z3
+	X = _mm_shuffle_ps(_mm_shuffle_ps(A, A, _MM_SHUFFLE(3, 3, 0, 0)), _mm_shuffle_ps(B, C, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+	Y = _mm_shuffle_ps(_mm_shuffle_ps(A, B, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(B, C, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	Z = _mm_shuffle_ps(_mm_shuffle_ps(A, B, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(C, C, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+/// Load four 16 bit codes as floats.
+static inline Float4 LoadCodes4(const uint16_t *Codes)
+{
+	return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(Codes)), _mm_setzero_si128()));
+}
+
+/// Load four 8 bit codes as floats.
+static inline Float4 LoadCodes4(const uint8_t *Codes)
+{
+	int Packed;
+	memcpy(&Packed, Codes, sizeof(Packed));
+	const __m128i Zero = _mm_setzero_si128();
+	return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(Packed), Zero), Zero));
+}
+
+/// Transpose X, Y, and Z registers back into four XYZ vertices and store them.
+static inline void StoreXYZ4(float *Data, Float4 X, Float4 Y, Float4 Z)
+{
+	_mm_storeu_ps(Data, _mm_shuffle_ps(_mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(Z, X, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+	_mm_storeu_ps(Data + 4, _mm_shuffle_ps(_mm_shuffle_ps(Y, Z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(X, Y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+	_mm_storeu_ps(Data + 8, _mm_shuffle_ps(_mm_shuffle_ps(Z, X, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(Y, Z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+#elif defined(VERTEXKERNELS_NEON)
+
+typedef float32x4_t Float4;
+
+static inline Float4 Load4(const float *Data) { return vld1q_f32(Data); }
+static inline Float4 Set4(float Value) { return vdupq_n_f32(Value); }
+static inline Float4 Add4(Float4 A, Float4 B) { return vaddq_f32(A, B); }
+static inline Float4 Sub4(Float4 A, Float4 B) { return vsubq_f32(A, B); }
+static inline Float4 Mul4(Float4 A, Float4 B) { return vmulq_f32(A, B); }
+static inline Float4 Greater4(Float4 A, Float4 B) { return vreinterpretq_f32_u32(vcgtq_f32(A, B)); }
+static inline Float4 Select4(Float4 Mask, Float4 IfTrue, Float4 IfFalse)
+{
+	return vbslq_f32(vreinterpretq_u32_f32(Mask), IfTrue, IfFalse);
+}
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+static inline Float4 Div4(Float4 A, Float4 B) { return vdivq_f32(A, B); }
+static inline Float4 Sqrt4(Float4 A) { return vsqrtq_f32(A); }
+#else
+// ARMv7 NEON has no divide or square root, so refine the reciprocal estimates.
+static inline Float4 Div4(Float4 A, Float4 B)
+{
+	Float4 Reciprocal = vrecpeq_f32(B);
+	Reciprocal = vmulq_f32(vrecpsq_f32(B, Reciprocal), Reciprocal);
+	Reciprocal = vmulq_f32(vrecpsq_f32(B, Reciprocal), Reciprocal);
+	return vmulq_f32(A, Reciprocal);
+}
+static inline Float4 Sqrt4(Float4 A)
+{
+	Float4 InvSqrt = vrsqrteq_f32(A);
+	InvSqrt = vmulq_f32(vrsqrtsq_f32(vmulq_f32(A, InvSqrt), InvSqrt), InvSqrt);
+	InvSqrt = vmulq_f32(vrsqrtsq_f32(vmulq_f32(A, InvSqrt), InvSqrt), InvSqrt);
+	// Avoid 0 * inf for zero-length inputs.
+	return Select4(Greater4(A, vdupq_n_f32(0.0f)), vmulq_f32(A, InvSqrt), vdupq_n_f32(0.0f));
+}
+#endif
+
+/// Load four XYZ vertices and transpose them into X, Y, and Z registers.
+static inline void LoadXYZ4(const float *Data, Float4 &X, Float4 &Y, Float4 &Z)
+{
+	const float32x4x3_t Loaded = vld3q_f32(Data);
+	X = Loaded.val[0];
+	Y = Loaded.val[1];
+	Z = Loaded.val[2];
+}
+
+/// Load four 16 bit codes as floats.
+static inline Float4 LoadCodes4(const uint16_t *Codes)
+{
+	return vcvtq_f32_u32(vmovl_u16(vld1_u16(Codes)));
+}
+
+/// Load four 8 bit codes as floats.
+static inline Float4 LoadCodes4(const uint8_t *Codes)
+{
+	uint32_t Packed;
+	memcpy(&Packed, Codes, sizeof(Packed));
+	return vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(Packed))))));
+}
+
+/// Transpose X, Y, and Z registers back into four XYZ vertices and store them.
+static inline void StoreXYZ4(float *Data, Float4 X, Float4 Y, Float4 Z)
+{
+	float32x4x3_t ToStore;
+	ToStore.val[0] = X;
+	ToStore.val[1] = Y;
+	ToStore.val[2] = Z;
+	vst3q_f32(Data, ToStore);
+}
+
+#endif
+
+#if VERTEXKERNELS_SIMD
+/// Load the weights for four vertices, or full strength if there are no weights.
+///
+/// Quantized codes are widened to 32 bit integers and converted in the register, so they're
+/// read from memory at their stored size.  The precision is the same for every call a kernel
+/// makes, so the branch costs next to nothing.
+static inline Float4 LoadWeights4(const FWeightStream &Weights, int Index)
+{
+	switch (Weights.Precision) {
+	case EWeightPrecision::UInt16:
+		return Add4(Set4(Weights.Min), Mul4(LoadCodes4(static_cast<const uint16_t *>(Weights.Data) + Index), Set4(Weights.Step)));
+	case EWeightPrecision::UInt8:
+		return Add4(Set4(Weights.Min), Mul4(LoadCodes4(static_cast<const uint8_t *>(Weights.Data) + Index), Set4(Weights.Step)));
+	default:
+		return Weights ? Load4(Weights.GetFloats() + Index) : Set4(1.0f);
+	}
+}
+#endif
+
+void VertexKernels::Translate(float *Positions, int Count, const float Delta[3], FWeightStream Weights)
+{
+	int Index = 0;
+#if VERTEXKERNELS_SIMD
+	const Float4 DeltaX = Set4(Delta[0]);
+	const Float4 DeltaY = Set4(Delta[1]);
+	const Float4 DeltaZ = Set4(Delta[2]);
+	for (; Index + 4 <= Count; Index += 4) {
+		float *Vertex = Positions + Index * 3;
+		Float4 X, Y, Z;
+		LoadXYZ4(Vertex, X, Y, Z);
+		const Float4 Weight = LoadWeights4(Weights, Index);
+		X = Add4(X, Mul4(DeltaX, Weight));
+		Y = Add4(Y, Mul4(DeltaY, Weight));
+		Z = Add4(Z, Mul4(DeltaZ, Weight));
+		StoreXYZ4(Vertex, X, Y, Z);
+	}
+#endif
+	for (; Index < Count; ++Index) {
+		float *Vertex = Positions + Index * 3;
+		const float Weight = Weights ? Weights[Index] : 1.0f;
+		Vertex[0] += Delta[0] * Weight;
+		Vertex[1] += Delta[1] * Weight;
+		Vertex[2] += Delta[2] * Weight;
+	}
+}
+
+void VertexKernels::Affine(float *Positions, int Count, const float Matrix[12], FWeightStream Weights)
+{
+	int Index = 0;
+#if VERTEXKERNELS_SIMD
+	Float4 M[12];
+	for (int Element = 0; Element < 12; ++Element) {
+		M[Element] = Set4(Matrix[Element]);
+	}
+	for (; Index + 4 <= Count; Index += 4) {
+		float *Vertex = Positions + Index * 3;
+		Float4 X, Y, Z;
+		LoadXYZ4(Vertex, X, Y, Z);
+		const Float4 Weight = LoadWeights4(Weights, Index);
+		const Float4 TargetX = Add4(Add4(Mul4(M[0], X), Mul4(M[1], Y)), Add4(Mul4(M[2], Z), M[3]));
+		const Float4 TargetY = Add4(Add4(Mul4(M[4], X), Mul4(M[5], Y)), Add4(Mul4(M[6], Z), M[7]));
+		const Float4 TargetZ = Add4(Add4(Mul4(M[8], X), Mul4(M[9], Y)), Add4(Mul4(M[10], Z), M[11]));
+		X = Add4(X, Mul4(Sub4(TargetX, X), Weight));
+		Y = Add4(Y, Mul4(Sub4(TargetY, Y), Weight));
+		Z = Add4(Z, Mul4(Sub4(TargetZ, Z), Weight));
+		StoreXYZ4(Vertex, X, Y, Z);
+	}
+#endif
+	for (; Index < Count; ++Index) {
+		float *Vertex = Positions + Index * 3;
+		const float Weight = Weights ? Weights[Index] : 1.0f;
+		const float X = Vertex[0];
+		const float Y = Vertex[1];
+		const float Z = Vertex[2];
+		const float TargetX = Matrix[0] * X + Matrix[1] * Y + Matrix[2] * Z + Matrix[3];
+		const float TargetY = Matrix[4] * X + Matrix[5] * Y + Matrix[6] * Z + Matrix[7];
+		const float TargetZ = Matrix[8] * X + Matrix[9] * Y + Matrix[10] * Z + Matrix[11];
+		Vertex[0] = X + (TargetX - X) * Weight;
+		Vertex[1] = Y + (TargetY - Y) * Weight;
+		Vertex[2] = Z + (TargetZ - Z) * Weight;
+	}
+}
+
+void VertexKernels::ComposeAffine(const float First[12], const float Second[12], float OutMatrix[12])
+{
+	// Second * First, with the implied bottom row of 0 0 0 1.
+	for (int Row = 0; Row < 3; ++Row) {
+		for (int Column = 0; Column < 4; ++Column) {
+			float Value = (Column == 3) ? Second[Row * 4 + 3] : 0.0f;
+			for (int Inner = 0; Inner < 3; ++Inner) {
+				Value += Second[Row * 4 + Inner] * First[Inner * 4 + Column];
+			}
+			OutMatrix[Row * 4 + Column] = Value;
+		}
+	}
+}
+
+void VertexKernels::AddScaledDirection(float *Positions, const float *Directions, int Count, float Offset, FWeightStream Weights)
+{
+	int Index = 0;
+#if VERTEXKERNELS_SIMD
+	const Float4 OffsetSplat = Set4(Offset);
+	for (; Index + 4 <= Count; Index += 4) {
+		float *Vertex = Positions + Index * 3;
+		Float4 X, Y, Z, DirectionX, DirectionY, DirectionZ;
+		LoadXYZ4(Vertex, X, Y, Z);
+		LoadXYZ4(Directions + Index * 3, DirectionX, DirectionY, DirectionZ);
+		const Float4 Scale = Mul4(OffsetSplat, LoadWeights4(Weights, Index));
+		X = Add4(X, Mul4(DirectionX, Scale));
+		Y = Add4(Y, Mul4(DirectionY, Scale));
+		Z = Add4(Z, Mul4(DirectionZ, Scale));
+		StoreXYZ4(Vertex, X, Y, Z);
+	}
+#endif
+	for (; Index < Count; ++Index) {
+		float *Vertex = Positions + Index * 3;
+		const float *Direction = Directions + Index * 3;
+		const float Scale = Offset * (Weights ? Weights[Index] : 1.0f);
+		Vertex[0] += Direction[0] * Scale;
+		Vertex[1] += Direction[1] * Scale;
+		Vertex[2] += Direction[2] * Scale;
+	}
+}
+
+void VertexKernels::Spherize(float *Positions, int Count, const float Center[3], float Radius, float Strength, FWeightStream Weights)
+{
+	int Index = 0;
+#if VERTEXKERNELS_SIMD
+	const Float4 CenterX = Set4(Center[0]);
+	const Float4 CenterY = Set4(Center[1]);
+	const Float4 CenterZ = Set4(Center[2]);
+	const Float4 RadiusSplat = Set4(Radius);
+	const Float4 StrengthSplat = Set4(Strength);
+	const Float4 Tolerance = Set4(NormalizeTolerance);
+	const Float4 One = Set4(1.0f);
+	for (; Index + 4 <= Count; Index += 4) {
+		float *Vertex = Positions + Index * 3;
+		Float4 X, Y, Z;
+		LoadXYZ4(Vertex, X, Y, Z);
+		const Float4 RelativeX = Sub4(X, CenterX);
+		const Float4 RelativeY = Sub4(Y, CenterY);
+		const Float4 RelativeZ = Sub4(Z, CenterZ);
+		const Float4 LengthSquared = Add4(Add4(Mul4(RelativeX, RelativeX), Mul4(RelativeY, RelativeY)), Mul4(RelativeZ, RelativeZ));
+		const Float4 CanNormalize = Greater4(LengthSquared, Tolerance);
+		// Use a length of one for anything we can't normalize so the divide is safe, it's masked out below.
+		const Float4 Length = Select4(CanNormalize, Sqrt4(LengthSquared), One);
+		const Float4 Alpha = Mul4(StrengthSplat, LoadWeights4(Weights, Index));
+		const Float4 TargetLength = Add4(Length, Mul4(Sub4(RadiusSplat, Length), Alpha));
+		const Float4 Ratio = Div4(TargetLength, Length);
+		X = Select4(CanNormalize, Add4(CenterX, Mul4(RelativeX, Ratio)), X);
+		Y = Select4(CanNormalize, Add4(CenterY, Mul4(RelativeY, Ratio)), Y);
+		Z = Select4(CanNormalize, Add4(CenterZ, Mul4(RelativeZ, Ratio)), Z);
+		StoreXYZ4(Vertex, X, Y, Z);
+	}
+#endif
+	for (; Index < Count; ++Index) {
+		float *Vertex = Positions + Index * 3;
+		const float RelativeX = Vertex[0] - Center[0];
+		const float RelativeY = Vertex[1] - Center[1];
+		const float RelativeZ = Vertex[2] - Center[2];
+		const float LengthSquared = RelativeX * RelativeX + RelativeY * RelativeY + RelativeZ * RelativeZ;
+		if (LengthSquared > NormalizeTolerance) {
+			const float Length = sqrtf(LengthSquared);
+			const float Alpha = Strength * (Weights ? Weights[Index] : 1.0f);
+			const float TargetLength = Length + (Radius - Length) * Alpha;
+			const float Ratio = TargetLength / Length;
+			Vertex[0] = Center[0] + RelativeX * Ratio;
+			Vertex[1] = Center[1] + RelativeY * Ratio;
+			Vertex[2] = Center[2] + RelativeZ * Ratio;
+		}
+	}
+}
+
+void VertexKernels::LerpTo(float *Positions, const float *Targets, int Count, float Alpha, FWeightStream Weights)
+{
+	int Index = 0;
+#if VERTEXKERNELS_SIMD
+	const Float4 AlphaSplat = Set4(Alpha);
+	for (; Index + 4 <= Count; Index += 4) {
+		float *Vertex = Positions + Index * 3;
+		Float4 X, Y, Z, TargetX, TargetY, TargetZ;
+		LoadXYZ4(Vertex, X, Y, Z);
+		LoadXYZ4(Targets + Index * 3, TargetX, TargetY, TargetZ);
+		const Float4 Blend = Mul4(AlphaSplat, LoadWeights4(Weights, Index));
+		X = Add4(X, Mul4(Sub4(TargetX, X), Blend));
+		Y = Add4(Y, Mul4(Sub4(TargetY, Y), Blend));
+		Z = Add4(Z, Mul4(Sub4(TargetZ, Z), Blend));
+		StoreXYZ4(Vertex, X, Y, Z);
+	}
+#endif
+	for (; Index < Count; ++Index) {
+		float *Vertex = Positions + Index * 3;
+		const float *Target = Targets + Index * 3;
+		const float Blend = Alpha * (Weights ? Weights[Index] : 1.0f);
+		Vertex[0] += (Target[0] - Vertex[0]) * Blend;
+		Vertex[1] += (Target[1] - Vertex[1]) * Blend;
+		Vertex[2] += (Target[2] - Vertex[2]) * Blend;
+	}
+}
+
+void VertexKernels::RotateAroundAxis(float *Positions, int Count, const float Center[3], const float Axis[3], float AngleInDegrees, FWeightStream Weights)
+{
+	// This follows FVector::RotateAngleAxis, with the vertex made relative to the closest point on the axis.
+	const float XX = Axis[0] * Axis[0];
+	const float YY = Axis[1] * Axis[1];
+	const float ZZ = Axis[2] * Axis[2];
+	const float XY = Axis[0] * Axis[1];
+	const float YZ = Axis[1] * Axis[2];
+	const float ZX = Axis[2] * Axis[0];
+	const float DegreesToRadians = 3.1415926535897932f / 180.0f;
+
+	for (int Index = 0; Index < Count; ++Index) {
+		float *Vertex = Positions + Index * 3;
+		const float Along = (Vertex[0] - Center[0]) * Axis[0] + (Vertex[1] - Center[1]) * Axis[1] + (Vertex[2] - Center[2]) * Axis[2];
+		const float ClosestX = Center[0] + Axis[0] * Along;
+		const float ClosestY = Center[1] + Axis[1] * Along;
+		const float ClosestZ = Center[2] + Axis[2] * Along;
+		const float X = Vertex[0] - ClosestX;
+		const float Y = Vertex[1] - ClosestY;
+		const float Z = Vertex[2] - ClosestZ;
+
+		const float Angle = AngleInDegrees * (Weights ? Weights[Index] : 1.0f) * DegreesToRadians;
+		const float S = sinf(Angle);
+		const float C = cosf(Angle);
+		const float OMC = 1.0f - C;
+		const float XS = Axis[0] * S;
+		const float YS = Axis[1] * S;
+		const float ZS = Axis[2] * S;
+
+		Vertex[0] = ClosestX + (OMC * XX + C) * X + (OMC * XY - ZS) * Y + (OMC * ZX + YS) * Z;
+		Vertex[1] = ClosestY + (OMC * XY + ZS) * X + (OMC * YY + C) * Y + (OMC * YZ - XS) * Z;
+		Vertex[2] = ClosestZ + (OMC * ZX - YS) * X + (OMC * YZ + XS) * Y + (OMC * ZZ + C) * Z;
+	}
+}
@@ -0,0 +1,305 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ToolkitCore/WeightExpression.h"
+#include <algorithm>
+#include <unordered_map>
+
+/// Make an operation with up to four parameters.
+static FWeightOperation MakeWeightOperation(FWeightOperation::EType Type, float P0 = 0.0f, float P1 = 0.0f, float P2 = 0.0f, float P3 = 0.0f)
+{
+	FWeightOperation Operation;
+	Operation.Type = Type;
+	Operation.Parameters[0] = P0;
+	Operation.Parameters[1] = P1;
+	Operation.Parameters[2] = P2;
+	Operation.Parameters[3] = P3;
+	return Operation;
+}
+
+FWeightOperation FWeightOperation::MakeFill(float Value)
+{
+	return MakeWeightOperation(EType::Fill, Value);
+}
+
+FWeightOperation FWeightOperation::MakeClamp(float Min, float Max)
+{
+	return MakeWeightOperation(EType::Clamp, Min, Max);
+}
+
+FWeightOperation FWeightOperation::MakeEase(WeightKernels::EEaseFunction EaseFunction, int Steps, float BlendExp)
+{
+	FWeightOperation Operation = MakeWeightOperation(EType::Ease, BlendExp);
+	Operation.EaseFunction = EaseFunction;
+	Operation.Steps = Steps;
+	return Operation;
+}
+
+FWeightOperation FWeightOperation::MakeAddScalar(float Scalar)
+{
+	return MakeWeightOperation(EType::AddScalar, Scalar);
+}
+
+FWeightOperation FWeightOperation::MakeSubtractScalar(float Scalar)
+{
+	return MakeWeightOperation(EType::SubtractScalar, Scalar);
+}
+
+FWeightOperation FWeightOperation::MakeSubtractFromScalar(float Scalar)
+{
+	return MakeWeightOperation(EType::SubtractFromScalar, Scalar);
+}
+
+FWeightOperation FWeightOperation::MakeMultiplyScalar(float Scalar)
+{
+	return MakeWeightOperation(EType::MultiplyScalar, Scalar);
+}
+
+FWeightOperation FWeightOperation::MakeDivideScalar(float Scalar)
+{
+	return MakeWeightOperation(EType::DivideScalar, Scalar);
+}
+
+FWeightOperation FWeightOperation::MakeOneMinus()
+{
+	return MakeWeightOperation(EType::OneMinus);
+}
+
+FWeightOperation FWeightOperation::MakeMaxScalar(float Scalar)
+{
+	return MakeWeightOperation(EType::MaxScalar, Scalar);
+}
+
+FWeightOperation FWeightOperation::MakeMinScalar(float Scalar)
+{
+	return MakeWeightOperation(EType::MinScalar, Scalar);
+}
+
+FWeightOperation FWeightOperation::MakeLerpScalar(float Scalar, float Alpha)
+{
+	return MakeWeightOperation(EType::LerpScalar, Scalar, Alpha);
+}
+
+FWeightOperation FWeightOperation::MakeRemapRange(float CurrentMin, float CurrentMax, float NewMin, float NewMax)
+{
+	return MakeWeightOperation(EType::RemapRange, CurrentMin, CurrentMax, NewMin, NewMax);
+}
+
+FWeightOperation FWeightOperation::MakeMap(std::function<void(const float *Values, int Count, float *Out)> Function)
+{
+	FWeightOperation Operation = MakeWeightOperation(EType::Map);
+	Operation.Function = std::move(Function);
+	return Operation;
+}
+
+FWeightOperation FWeightOperation::MakeBinary(EType Type, float Alpha)
+{
+	return MakeWeightOperation(Type, Alpha);
+}
+
+void FWeightOperation::Apply(const float *A, const float *B, int Count, float *Out) const
+{
+	const float *P = Parameters;
+	switch (Type) {
+	case EType::Fill:				WeightKernels::Fill(Out, Count, P[0]); break;
+	case EType::Clamp:				WeightKernels::Clamp(A, Count, P[0], P[1], Out); break;
+	case EType::Ease:				WeightKernels::Ease(A, Count, EaseFunction, Steps, P[0], Out); break;
+	case EType::AddScalar:			WeightKernels::AddScalar(A, Count, P[0], Out); break;
+	case EType::SubtractScalar:		WeightKernels::SubtractScalar(A, Count, P[0], Out); break;
+	case EType::SubtractFromScalar:	WeightKernels::SubtractFromScalar(P[0], A, Count, Out); break;
+	case EType::MultiplyScalar:		WeightKernels::MultiplyScalar(A, Count, P[0], Out); break;
+	case EType::DivideScalar:		WeightKernels::DivideScalar(A, Count, P[0], Out); break;
+	case EType::OneMinus:			WeightKernels::OneMinus(A, Count, Out); break;
+	case EType::MaxScalar:			WeightKernels::MaxScalar(A, Count, P[0], Out); break;
+	case EType::MinScalar:			WeightKernels::MinScalar(A, Count, P[0], Out); break;
+	case EType::LerpScalar:			WeightKernels::LerpScalar(A, Count, P[0], P[1], Out); break;
+	case EType::RemapRange:			WeightKernels::RemapRange(A, Count, P[0], P[1], P[2], P[3], Out); break;
+	case EType::Map:				Function(A, Count, Out); break;
+	case EType::Add:				WeightKernels::Add(A, B, Count, Out); break;
+	case EType::Subtract:			WeightKernels::Subtract(A, B, Count, Out); break;
+	case EType::Multiply:			WeightKernels::Multiply(A, B, Count, Out); break;
+	case EType::Divide:				WeightKernels::Divide(A, B, Count, Out); break;
+	case EType::Max:				WeightKernels::Max(A, B, Count, Out); break;
+	case EType::Min:				WeightKernels::Min(A, B, Count, Out); break;
+	case EType::Lerp:				WeightKernels::Lerp(A, B, Count, P[0], Out); break;
+	}
+}
+
+FWeightExpression::FPtr FWeightExpression::MakeSource(const void *Source, int Size)
+{
+	std::shared_ptr<FWeightExpression> Node = std::make_shared<FWeightExpression>();
+	Node->Source = Source;
+	Node->Size = Size;
+	return Node;
+}
+
+FWeightExpression::FPtr FWeightExpression::Make(const FWeightOperation &Operation, int Size, FPtr A, FPtr B)
+{
+	std::shared_ptr<FWeightExpression> Node = std::make_shared<FWeightExpression>();
+	Node->Operation = Operation;
+	Node->Size = Size;
+	Node->Inputs[0] = std::move(A);
+	Node->Inputs[1] = std::move(B);
+	return Node;
+}
+
+FWeightProgram::FWeightProgram(const FWeightExpression::FPtr &Root)
+{
+	if (Root) {
+		Size = Root->GetSize();
+		AddSteps(Root.get());
+		AssignBuffers();
+	}
+}
+
+void FWeightProgram::AddSteps(const FWeightExpression *Root)
+{
+	// A depth first walk with an explicit stack, as a long chain of operations built up in a
+	// loop could be deeper than the call stack allows.  Each node gets its step once all of its
+	// inputs have theirs.
+	std::unordered_map<const FWeightExpression *, int> NodeSteps;
+	std::vector<const FWeightExpression *> Stack(1, Root);
+
+	while (!Stack.empty()) {
+		const FWeightExpression *Node = Stack.back();
+		if (NodeSteps.count(Node)) {
+			Stack.pop_back();
+			continue;
+		}
+
+		FStep Step;
+		Step.Node = Node;
+		Step.Inputs[0] = Step.Inputs[1] = -1;
+		Step.Source = -1;
+		Step.Buffer = -1;
+
+		if (Node->GetSource()) {
+			// Leaves for the same source are the same weights, so they share a step.
+			const int Source = (int)(std::find(Sources.begin(), Sources.end(), Node->GetSource()) - Sources.begin());
+			if (Source < (int)Sources.size()) {
+				SourceSizes[Source] = std::max(SourceSizes[Source], Node->GetSize());
+				for (size_t Index = 0; Index < Steps.size(); ++Index) {
+					if (Steps[Index].Source == Source) {
+						NodeSteps[Node] = (int)Index;
+						break;
+					}
+				}
+				Stack.pop_back();
+				continue;
+			}
+			Sources.push_back(Node->GetSource());
+			SourceSizes.push_back(Node->GetSize());
+			Step.Source = Source;
+		} else {
+			bool bInputsReady = true;
+			for (int Input = Node->GetOperation().GetInputCount() - 1; Input >= 0; --Input) {
+				auto InputStep = NodeSteps.find(Node->GetInput(Input).get());
+				if (InputStep == NodeSteps.end()) {
+					Stack.push_back(Node->GetInput(Input).get());
+					bInputsReady = false;
+				} else {
+					Step.Inputs[Input] = InputStep->second;
+				}
+			}
+			if (!bInputsReady) {
+				continue;
+			}
+		}
+
+		NodeSteps[Node] = (int)Steps.size();
+		Steps.push_back(Step);
+		Stack.pop_back();
+	}
+}
+
+void FWeightProgram::AssignBuffers()
+{
+	// Find the last step reading each result, after which its chunk can be reused.
+	std::vector<int> LastUse(Steps.size(), -1);
+	for (size_t Index = 0; Index < Steps.size(); ++Index) {
+		for (int Input : Steps[Index].Inputs) {
+			if (Input >= 0) {
+				LastUse[Input] = (int)Index;
+			}
+		}
+	}
+
+	// Inputs are released before the result is assigned, so a step can write over an input it's
+	// the last reader of, which the kernels allow.
+	std::vector<int> FreeBuffers;
+	const int Root = (int)Steps.size() - 1;
+	for (int Index = 0; Index <= Root; ++Index) {
+		FStep &Step = Steps[Index];
+		for (int Input = 0; Input < 2; ++Input) {
+			const int InputStep = Step.Inputs[Input];
+			const bool bRepeated = Input == 1 && InputStep == Step.Inputs[0];
+			if (InputStep >= 0 && LastUse[InputStep] == Index && !bRepeated) {
+				FreeBuffers.push_back(Steps[InputStep].Buffer);
+			}
+		}
+		if (Index == Root) {
+			break;
+		}
+		if (FreeBuffers.empty()) {
+			Step.Buffer = BufferCount++;
+		} else {
+			Step.Buffer = FreeBuffers.back();
+			FreeBuffers.pop_back();
+		}
+	}
+}
+
+int FWeightProgram::GetOperationCount() const
+{
+	int Count = 0;
+	for (const FStep &Step : Steps) {
+		Count += Step.Source < 0 ? 1 : 0;
+	}
+	return Count;
+}
+
+/// Copy a chunk of a source's weights, filling in the zeroes between the stored weights of a sparse source.
+static void ExpandWeightSource(const FWeightProgram::FSource &Source, int First, int Count, float *Out)
+{
+	if (Source.Dense) {
+		WeightKernels::Dequantize(Source.Dense + First, Count, Out);
+		return;
+	}
+	WeightKernels::Fill(Out, Count, 0.0f);
+	const int *End = Source.SparseIndices + Source.SparseCount;
+	for (const int *Index = std::lower_bound(Source.SparseIndices, End, First); Index != End && *Index < First + Count; ++Index) {
+		Out[*Index - First] = Source.SparseWeights[Index - Source.SparseIndices];
+	}
+}
+
+void FWeightProgram::Evaluate(const FSource *SourceWeights, int First, int Count, float *Out) const
+{
+	if (Steps.empty()) {
+		return;
+	}
+
+	std::vector<float> Scratch((size_t)BufferCount * ChunkSize);
+	std::vector<const float *> Results(Steps.size());
+	const size_t Root = Steps.size() - 1;
+
+	for (int ChunkStart = First; ChunkStart < First + Count; ChunkStart += ChunkSize) {
+		const int ChunkCount = std::min(ChunkSize, First + Count - ChunkStart);
+		for (size_t Index = 0; Index <= Root; ++Index) {
+			const FStep &Step = Steps[Index];
+			float *Result = Index == Root ? Out + (ChunkStart - First) : Scratch.data() + (size_t)Step.Buffer * ChunkSize;
+
+			if (Step.Source >= 0) {
+				const FSource &Source = SourceWeights[Step.Source];
+				if (Source.Dense.GetFloats() && Index != Root) {
+					Results[Index] = Source.Dense.GetFloats() + ChunkStart;
+					continue;
+				}
+				ExpandWeightSource(Source, ChunkStart, ChunkCount, Result);
+			} else {
+				const float *A = Step.Inputs[0] >= 0 ? Results[Step.Inputs[0]] : nullptr;
+				const float *B = Step.Inputs[1] >= 0 ? Results[Step.Inputs[1]] : nullptr;
+				Step.Node->GetOperation().Apply(A, B, ChunkCount, Result);
+			}
+			Results[Index] = Result;
+		}
+	}
+}
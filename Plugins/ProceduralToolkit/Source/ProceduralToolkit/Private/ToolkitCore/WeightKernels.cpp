@@ -0,0 +1,746 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ToolkitCore/WeightKernels.h"
+#include <limits>
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WEIGHTKERNELS_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define WEIGHTKERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(WEIGHTKERNELS_SSE) || defined(WEIGHTKERNELS_NEON)
+#define WEIGHTKERNELS_SIMD 1
+#else
+#define WEIGHTKERNELS_SIMD 0
+#endif
+
+// The easing functions are written once against a set of lanes, which is either a single float
+// or a SIMD register of them, so the weights left over after the SIMD registers get exactly the
+// same results.  The Floor of each only needs to handle values which fit in an int.
+
+/// A single float, for the weights left over and platforms without SIMD.
+struct FWeightLanesScalar
+{
+	static const int Width = 1;
+	typedef float FFloat;
+	typedef bool FMask;
+
+	static FFloat Load(const float *Source) { return *Source; }
+	static void Store(float *Destination, FFloat Value) { *Destination = Value; }
+	static FFloat Set(float Value) { return Value; }
+
+	static FFloat Add(FFloat A, FFloat B) { return A + B; }
+	static FFloat Sub(FFloat A, FFloat B) { return A - B; }
+	static FFloat Mul(FFloat A, FFloat B) { return A * B; }
+	static FFloat Div(FFloat A, FFloat B) { return A / B; }
+	static FFloat Sqrt(FFloat A) { return sqrtf(A); }
+	static FFloat Pow(FFloat A, float Exponent) { return powf(A, Exponent); }
+	static FFloat Min(FFloat A, FFloat B) { return A < B ? A : B; }
+	static FFloat Max(FFloat A, FFloat B) { return A > B ? A : B; }
+
+	static FMask Less(FFloat A, FFloat B) { return A < B; }
+	static FMask LessEqual(FFloat A, FFloat B) { return A <= B; }
+	static FMask Equal(FFloat A, FFloat B) { return A == B; }
+	static FFloat Select(FMask Mask, FFloat IfTrue, FFloat IfFalse) { return Mask ? IfTrue : IfFalse; }
+
+	static FFloat Floor(FFloat A)
+	{
+		const FFloat Truncated = (FFloat)(int)A;
+		return Truncated > A ? Truncated - 1.0f : Truncated;
+	}
+
+	/// 2^N for a whole number N from -126 to 127
+	static FFloat Exp2Int(FFloat N)
+	{
+		const int Bits = ((int)N + 127) << 23;
+		FFloat Result;
+		memcpy(&Result, &Bits, sizeof(Result));
+		return Result;
+	}
+};
+
+#if defined(WEIGHTKERNELS_SSE)
+
+/// Four floats in an SSE2 register.
+struct FWeightLanesSIMD
+{
+	static const int Width = 4;
+	typedef __m128 FFloat;
+	typedef __m128 FMask;
+
+	static FFloat Load(const float *Source) { return _mm_loadu_ps(Source); }
+	static void Store(float *Destination, FFloat Value) { _mm_storeu_ps(Destination, Value); }
+	static FFloat Set(float Value) { return _mm_set1_ps(Value); }
+
+	static FFloat Add(FFloat A, FFloat B) { return _mm_add_ps(A, B); }
+	static FFloat Sub(FFloat A, FFloat B) { return _mm_sub_ps(A, B); }
+	static FFloat Mul(FFloat A, FFloat B) { return _mm_mul_ps(A, B); }
+	static FFloat Div(FFloat A, FFloat B) { return _mm_div_ps(A, B); }
+	static FFloat Sqrt(FFloat A) { return _mm_sqrt_ps(A); }
+	static FFloat Min(FFloat A, FFloat B) { return _mm_min_ps(A, B); }
+	static FFloat Max(FFloat A, FFloat B) { return _mm_max_ps(A, B); }
+
+	static FMask Less(FFloat A, FFloat B) { return _mm_cmplt_ps(A, B); }
+	static FMask LessEqual(FFloat A, FFloat B) { return _mm_cmple_ps(A, B); }
+	static FMask Equal(FFloat A, FFloat B) { return _mm_cmpeq_ps(A, B); }
+	static FFloat Select(FMask Mask, FFloat IfTrue, FFloat IfFalse)
+	{
+		return _mm_or_ps(_mm_and_ps(Mask, IfTrue), _mm_andnot_ps(Mask, IfFalse));
+	}
+
+	static FFloat Floor(FFloat A)
+	{
+		// SSE2 has no floor, so truncate and correct the negative values.
+		const FFloat Truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(A));
+		return _mm_sub_ps(Truncated, _mm_and_ps(_mm_cmpgt_ps(Truncated, A), _mm_set1_ps(1.0f)));
+	}
+
+	static FFloat Exp2Int(FFloat N)
+	{
+		return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(N), _mm_set1_epi32(127)), 23));
+	}
+
+	static FFloat Pow(FFloat A, float Exponent)
+	{
+		float Lanes[Width];
+		Store(Lanes, A);
+		for (int Lane = 0; Lane < Width; ++Lane) {
+			Lanes[Lane] = powf(Lanes[Lane], Exponent);
+		}
+		return Load(Lanes);
+	}
+};
+
+#elif defined(WEIGHTKERNELS_NEON)
+
+/// Four floats in a NEON register.
+struct FWeightLanesSIMD
+{
+	static const int Width = 4;
+	typedef float32x4_t FFloat;
+	typedef uint32x4_t FMask;
+
+	static FFloat Load(const float *Source) { return vld1q_f32(Source); }
+	static void Store(float *Destination, FFloat Value) { vst1q_f32(Destination, Value); }
+	static FFloat Set(float Value) { return vdupq_n_f32(Value); }
+
+	static FFloat Add(FFloat A, FFloat B) { return vaddq_f32(A, B); }
+	static FFloat Sub(FFloat A, FFloat B) { return vsubq_f32(A, B); }
+	static FFloat Mul(FFloat A, FFloat B) { return vmulq_f32(A, B); }
+	static FFloat Min(FFloat A, FFloat B) { return vminq_f32(A, B); }
+	static FFloat Max(FFloat A, FFloat B) { return vmaxq_f32(A, B); }
+
+	static FMask Less(FFloat A, FFloat B) { return vcltq_f32(A, B); }
+	static FMask LessEqual(FFloat A, FFloat B) { return vcleq_f32(A, B); }
+	static FMask Equal(FFloat A, FFloat B) { return vceqq_f32(A, B); }
+	static FFloat Select(FMask Mask, FFloat IfTrue, FFloat IfFalse) { return vbslq_f32(Mask, IfTrue, IfFalse); }
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+	static FFloat Div(FFloat A, FFloat B) { return vdivq_f32(A, B); }
+	static FFloat Sqrt(FFloat A) { return vsqrtq_f32(A); }
+#else
+	// ARMv7 NEON has no divide or square root, so refine the reciprocal estimates.
+	static FFloat Div(FFloat A, FFloat B)
+	{
+		FFloat Reciprocal = vrecpeq_f32(B);
+		Reciprocal = vmulq_f32(vrecpsq_f32(B, Reciprocal), Reciprocal);
+		Reciprocal = vmulq_f32(vrecpsq_f32(B, Reciprocal), Reciprocal);
+		return vmulq_f32(A, Reciprocal);
+	}
+	static FFloat Sqrt(FFloat A)
+	{
+		FFloat InvSqrt = vrsqrteq_f32(A);
+		InvSqrt = vmulq_f32(vrsqrtsq_f32(vmulq_f32(A, InvSqrt), InvSqrt), InvSqrt);
+		InvSqrt = vmulq_f32(vrsqrtsq_f32(vmulq_f32(A, InvSqrt), InvSqrt), InvSqrt);
+		// Avoid 0 * inf for zero inputs.
+		return vbslq_f32(vcgtq_f32(A, vdupq_n_f32(0.0f)), vmulq_f32(A, InvSqrt), vdupq_n_f32(0.0f));
+	}
+#endif
+
+	static FFloat Floor(FFloat A)
+	{
+		const FFloat Truncated = vcvtq_f32_s32(vcvtq_s32_f32(A));
+		const uint32x4_t Correction = vandq_u32(vcgtq_f32(Truncated, A), vreinterpretq_u32_f32(vdupq_n_f32(1.0f)));
+		return vsubq_f32(Truncated, vreinterpretq_f32_u32(Correction));
+	}
+
+	static FFloat Exp2Int(FFloat N)
+	{
+		return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(N), vdupq_n_s32(127)), 23));
+	}
+
+	static FFloat Pow(FFloat A, float Exponent)
+	{
+		float Lanes[Width];
+		Store(Lanes, A);
+		for (int Lane = 0; Lane < Width; ++Lane) {
+			Lanes[Lane] = powf(Lanes[Lane], Exponent);
+		}
+		return Load(Lanes);
+	}
+};
+
+#endif
+
+/// sin(X * Pi / 2), which is a quarter turn for every 1 of X.
+///
+/// X is reduced to R, within a quarter turn of zero, and a whole number of half turns, each of
+/// which flips the sign.  sin(R * Pi / 2) is then an odd polynomial fitted to within 1e-8.
+template <typename L>
+static inline typename L::FFloat SinQuarterTurns(typename L::FFloat X)
+{
+	const typename L::FFloat HalfTurns = L::Floor(L::Add(L::Mul(X, L::Set(0.5f)), L::Set(0.5f)));
+	const typename L::FFloat R = L::Sub(X, L::Add(HalfTurns, HalfTurns));
+	const typename L::FFloat Odd = L::Sub(HalfTurns, L::Add(L::Floor(L::Mul(HalfTurns, L::Set(0.5f))), L::Floor(L::Mul(HalfTurns, L::Set(0.5f)))));
+	const typename L::FFloat Sign = L::Sub(L::Set(1.0f), L::Add(Odd, Odd));
+
+	const typename L::FFloat R2 = L::Mul(R, R);
+	typename L::FFloat Polynomial = L::Set(0.00015148591f);
+	Polynomial = L::Add(L::Mul(Polynomial, R2), L::Set(-0.0046737684f));
+	Polynomial = L::Add(L::Mul(Polynomial, R2), L::Set(0.079689680f));
+	Polynomial = L::Add(L::Mul(Polynomial, R2), L::Set(-0.64596371f));
+	Polynomial = L::Add(L::Mul(Polynomial, R2), L::Set(1.5707963f));
+	return L::Mul(Sign, L::Mul(R, Polynomial));
+}
+
+/// 2^X, with X clamped to the range of normal floats.
+///
+/// X is split into a whole number, which goes straight into the exponent, and a fraction from 0
+/// to 1 whose power of two is a polynomial fitted to within 1e-7.  Whole numbers are exact.
+template <typename L>
+static inline typename L::FFloat Exp2(typename L::FFloat X)
+{
+	X = L::Min(L::Max(X, L::Set(-126.0f)), L::Set(127.0f));
+	const typename L::FFloat Whole = L::Floor(X);
+	const typename L::FFloat Fraction = L::Sub(X, Whole);
+
+	typename L::FFloat Polynomial = L::Set(0.0018671306f);
+	Polynomial = L::Add(L::Mul(Polynomial, Fraction), L::Set(0.0090170290f));
+	Polynomial = L::Add(L::Mul(Polynomial, Fraction), L::Set(0.055799914f));
+	Polynomial = L::Add(L::Mul(Polynomial, Fraction), L::Set(0.24016445f));
+	Polynomial = L::Add(L::Mul(Polynomial, Fraction), L::Set(0.69315131f));
+	Polynomial = L::Add(L::Mul(Polynomial, Fraction), L::Set(1.0f));
+	return L::Mul(Polynomial, L::Exp2Int(Whole));
+}
+
+/// X^Exponent, multiplied out for the small whole number exponents the templates are
+/// instantiated for and using powf for anything else, which *Exponent* 0 stands for.
+template <int Exponent, typename L>
+static inline typename L::FFloat Power(typename L::FFloat X, float BlendExp)
+{
+	if (Exponent == 0) {
+		return L::Pow(X, BlendExp);
+	}
+	typename L::FFloat Result = X;
+	for (int Multiply = 1; Multiply < Exponent; ++Multiply) {
+		Result = L::Mul(Result, X);
+	}
+	return Result;
+}
+
+// The FMath::Interp* easing functions between 0 and 1, where Lerp(0, 1, Alpha) is just Alpha.
+// Each is a type so the loop in *EaseWeights* can be specialised for it.
+
+/// The parameters of *WeightKernels::Ease* the easing functions use
+struct FEaseParameters
+{
+	int Steps;
+	float BlendExp;
+};
+
+struct FEaseLinear
+{
+	template <typename L>
+	static typename L::FFloat Apply(typename L::FFloat Alpha, const FEaseParameters &)
+	{
+		return Alpha;
+	}
+};
+
+struct FEaseStep
+{
+	template <typename L>
+	static typename L::FFloat Apply(typename L::FFloat Alpha, const FEaseParameters &Parameters)
+	{
+		// Steps of 1 or less are always zero, which *Ease* handles before getting here.
+		const float StepsAsFloat = (float)Parameters.Steps;
+		const typename L::FFloat Stepped = L::Div(L::Floor(L::Mul(Alpha, L::Set(StepsAsFloat))), L::Set(StepsAsFloat - 1.0f));
+		return L::Select(
+			L::LessEqual(Alpha, L::Set(0.0f)), L::Set(0.0f),
+			L::Select(L::LessEqual(L::Set(1.0f), Alpha), L::Set(1.0f), Stepped)
+		);
+	}
+};
+
+struct FEaseSinIn
+{
+	template <typename L>
+	static typename L::FFloat Apply(typename L::FFloat Alpha, const FEaseParameters &)
+	{
+		// 1 - cos, with the cos being a sin a quarter turn on.
+		return L::Sub(L::Set(1.0f), SinQuarterTurns<L>(L::Add(Alpha, L::Set(1.0f))));
+	}
+};
+
+struct FEaseSinOut
+{
+	template <typename L>
+	static typename L::FFloat Apply(typename L::FFloat Alpha, const FEaseParameters &)
+	{
+		return SinQuarterTurns<L>(Alpha);
+	}
+};
+
+template <int Exponent>
+struct FEaseIn
+{
+	template <typename L>
+	static typename L::FFloat Apply(typename L::FFloat Alpha, const FEaseParameters &Parameters)
+	{
+		return Power<Exponent, L>(Alpha, Parameters.BlendExp);
+	}
+};
+
+template <int Exponent>
+struct FEaseOut
+{
+	template <typename L>
+	static typename L::FFloat Apply(typename L::FFloat Alpha, const FEaseParameters &Parameters)
+	{
+		return L::Sub(L::Set(1.0f), Power<Exponent, L>(L::Sub(L::Set(1.0f), Alpha), Parameters.BlendExp));
+	}
+};
+
+struct FEaseExpoIn
+{
+	template <typename L>
+	static typename L::FFloat Apply(typename L::FFloat Alpha, const FEaseParameters &)
+	{
+		const typename L::FFloat Eased = Exp2<L>(L::Mul(L::Set(10.0f), L::Sub(Alpha, L::Set(1.0f))));
+		return L::Select(L::Equal(Alpha, L::Set(0.0f)), L::Set(0.0f), Eased);
+	}
+};
+
+struct FEaseExpoOut
+{
+	template <typename L>
+	static typename L::FFloat Apply(typename L::FFloat Alpha, const FEaseParameters &)
+	{
+		const typename L::FFloat Eased = L::Sub(L::Set(1.0f), Exp2<L>(L::Mul(L::Set(-10.0f), Alpha)));
+		return L::Select(L::Equal(Alpha, L::Set(1.0f)), L::Set(1.0f), Eased);
+	}
+};
+
+struct FEaseCircularIn
+{
+	template <typename L>
+	static typename L::FFloat Apply(typename L::FFloat Alpha, const FEaseParameters &)
+	{
+		return L::Sub(L::Set(1.0f), L::Sqrt(L::Sub(L::Set(1.0f), L::Mul(Alpha, Alpha))));
+	}
+};
+
+struct FEaseCircularOut
+{
+	template <typename L>
+	static typename L::FFloat Apply(typename L::FFloat Alpha, const FEaseParameters &)
+	{
+		Alpha = L::Sub(Alpha, L::Set(1.0f));
+		return L::Sqrt(L::Sub(L::Set(1.0f), L::Mul(Alpha, Alpha)));
+	}
+};
+
+/// Combine an in and an out function into an in-out one, in the same way as FMath.
+template <typename InType, typename OutType>
+struct FEaseInOut
+{
+	template <typename L>
+	static typename L::FFloat Apply(typename L::FFloat Alpha, const FEaseParameters &Parameters)
+	{
+		const typename L::FFloat Half = L::Set(0.5f);
+		const typename L::FFloat Doubled = L::Add(Alpha, Alpha);
+		const typename L::FFloat In = L::Mul(InType::template Apply<L>(Doubled, Parameters), Half);
+		const typename L::FFloat Out = L::Add(L::Mul(OutType::template Apply<L>(L::Sub(Doubled, L::Set(1.0f)), Parameters), Half), Half);
+		return L::Select(L::Less(Alpha, Half), In, Out);
+	}
+};
+
+/// Apply an easing function to every weight, a SIMD register at a time and then one at a time.
+template <typename EaseType>
+static void EaseWeights(const float *Values, int Count, const FEaseParameters &Parameters, float *Out)
+{
+	int Index = 0;
+#if WEIGHTKERNELS_SIMD
+	for (; Index + FWeightLanesSIMD::Width <= Count; Index += FWeightLanesSIMD::Width) {
+		FWeightLanesSIMD::Store(Out + Index, EaseType::template Apply<FWeightLanesSIMD>(FWeightLanesSIMD::Load(Values + Index), Parameters));
+	}
+#endif
+	for (; Index < Count; ++Index) {
+		Out[Index] = EaseType::template Apply<FWeightLanesScalar>(Values[Index], Parameters);
+	}
+}
+
+/// Apply an easing function taking an exponent, picking the version for a small whole number
+/// exponent if *BlendExp* is one.
+template <template <int> class EaseType>
+static void EaseWeightsWithExponent(const float *Values, int Count, const FEaseParameters &Parameters, float *Out)
+{
+	const int WholeExponent = (Parameters.BlendExp >= 1.0f && Parameters.BlendExp <= 4.0f) ? (int)Parameters.BlendExp : 0;
+	switch (WholeExponent == Parameters.BlendExp ? WholeExponent : 0) {
+	case 1: EaseWeights<EaseType<1>>(Values, Count, Parameters, Out); break;
+	case 2: EaseWeights<EaseType<2>>(Values, Count, Parameters, Out); break;
+	case 3: EaseWeights<EaseType<3>>(Values, Count, Parameters, Out); break;
+	case 4: EaseWeights<EaseType<4>>(Values, Count, Parameters, Out); break;
+	default: EaseWeights<EaseType<0>>(Values, Count, Parameters, Out); break;
+	}
+}
+
+/// Combines *FEaseIn* and *FEaseOut* for the same exponent
+template <int Exponent>
+struct FEaseInOutPower : FEaseInOut<FEaseIn<Exponent>, FEaseOut<Exponent>>
+{
+};
+
+/// Apply a per-weight function over the whole array.
+template <typename FunctionType>
+static inline void Transform(const float *Values, int Count, float *Out, FunctionType Function)
+{
+	for (int Index = 0; Index < Count; ++Index) {
+		Out[Index] = Function(Values[Index]);
+	}
+}
+
+/// Apply a function of two weights over the whole of both arrays.
+template <typename FunctionType>
+static inline void Transform(const float *A, const float *B, int Count, float *Out, FunctionType Function)
+{
+	for (int Index = 0; Index < Count; ++Index) {
+		Out[Index] = Function(A[Index], B[Index]);
+	}
+}
+
+void WeightKernels::Clamp(const float *Values, int Count, float Min, float Max, float *Out)
+{
+	Transform(Values, Count, Out, [Min, Max](float Value) { return Value < Min ? Min : Value < Max ? Value : Max; });
+}
+
+void WeightKernels::Ease(const float *Values, int Count, EEaseFunction Function, int Steps, float BlendExp, float *Out)
+{
+	// The function is picked once, each getting a loop of its own specialised for it.
+	FEaseParameters Parameters;
+	Parameters.Steps = Steps;
+	Parameters.BlendExp = BlendExp;
+	switch (Function) {
+	case EEaseFunction::Step:
+		if (Steps <= 1) {
+			Fill(Out, Count, 0.0f);
+		} else {
+			EaseWeights<FEaseStep>(Values, Count, Parameters, Out);
+		}
+		break;
+	case EEaseFunction::SinusoidalIn:
+		EaseWeights<FEaseSinIn>(Values, Count, Parameters, Out);
+		break;
+	case EEaseFunction::SinusoidalOut:
+		EaseWeights<FEaseSinOut>(Values, Count, Parameters, Out);
+		break;
+	case EEaseFunction::SinusoidalInOut:
+		EaseWeights<FEaseInOut<FEaseSinIn, FEaseSinOut>>(Values, Count, Parameters, Out);
+		break;
+	case EEaseFunction::EaseIn:
+		EaseWeightsWithExponent<FEaseIn>(Values, Count, Parameters, Out);
+		break;
+	case EEaseFunction::EaseOut:
+		EaseWeightsWithExponent<FEaseOut>(Values, Count, Parameters, Out);
+		break;
+	case EEaseFunction::EaseInOut:
+		EaseWeightsWithExponent<FEaseInOutPower>(Values, Count, Parameters, Out);
+		break;
+	case EEaseFunction::ExpoIn:
+		EaseWeights<FEaseExpoIn>(Values, Count, Parameters, Out);
+		break;
+	case EEaseFunction::ExpoOut:
+		EaseWeights<FEaseExpoOut>(Values, Count, Parameters, Out);
+		break;
+	case EEaseFunction::ExpoInOut:
+		EaseWeights<FEaseInOut<FEaseExpoIn, FEaseExpoOut>>(Values, Count, Parameters, Out);
+		break;
+	case EEaseFunction::CircularIn:
+		EaseWeights<FEaseCircularIn>(Values, Count, Parameters, Out);
+		break;
+	case EEaseFunction::CircularOut:
+		EaseWeights<FEaseCircularOut>(Values, Count, Parameters, Out);
+		break;
+	case EEaseFunction::CircularInOut:
+		EaseWeights<FEaseInOut<FEaseCircularIn, FEaseCircularOut>>(Values, Count, Parameters, Out);
+		break;
+	default:
+		// Linear, which leaves the weights as they are.
+		EaseWeights<FEaseLinear>(Values, Count, Parameters, Out);
+		break;
+	}
+}
+
+void WeightKernels::Add(const float *A, const float *B, int Count, float *Out)
+{
+	Transform(A, B, Count, Out, [](float ValueA, float ValueB) { return ValueA + ValueB; });
+}
+
+void WeightKernels::AddScalar(const float *Values, int Count, float Scalar, float *Out)
+{
+	Transform(Values, Count, Out, [Scalar](float Value) { return Value + Scalar; });
+}
+
+void WeightKernels::Subtract(const float *A, const float *B, int Count, float *Out)
+{
+	Transform(A, B, Count, Out, [](float ValueA, float ValueB) { return ValueA - ValueB; });
+}
+
+void WeightKernels::SubtractScalar(const float *Values, int Count, float Scalar, float *Out)
+{
+	Transform(Values, Count, Out, [Scalar](float Value) { return Value - Scalar; });
+}
+
+void WeightKernels::SubtractFromScalar(float Scalar, const float *Values, int Count, float *Out)
+{
+	Transform(Values, Count, Out, [Scalar](float Value) { return Scalar - Value; });
+}
+
+void WeightKernels::Multiply(const float *A, const float *B, int Count, float *Out)
+{
+	Transform(A, B, Count, Out, [](float ValueA, float ValueB) { return ValueA * ValueB; });
+}
+
+void WeightKernels::MultiplyScalar(const float *Values, int Count, float Scalar, float *Out)
+{
+	Transform(Values, Count, Out, [Scalar](float Value) { return Value * Scalar; });
+}
+
+void WeightKernels::Divide(const float *A, const float *B, int Count, float *Out)
+{
+	Transform(A, B, Count, Out, [](float ValueA, float ValueB) { return ValueA / ValueB; });
+}
+
+void WeightKernels::DivideScalar(const float *Values, int Count, float Scalar, float *Out)
+{
+	Transform(Values, Count, Out, [Scalar](float Value) { return Value / Scalar; });
+}
+
+void WeightKernels::OneMinus(const float *Values, int Count, float *Out)
+{
+	Transform(Values, Count, Out, [](float Value) { return 1.0f - Value; });
+}
+
+void WeightKernels::Fill(float *Out, int Count, float Value)
+{
+	for (int Index = 0; Index < Count; ++Index) {
+		Out[Index] = Value;
+	}
+}
+
+void WeightKernels::Max(const float *A, const float *B, int Count, float *Out)
+{
+	Transform(A, B, Count, Out, [](float ValueA, float ValueB) { return (ValueA >= ValueB) ? ValueA : ValueB; });
+}
+
+void WeightKernels::Min(const float *A, const float *B, int Count, float *Out)
+{
+	Transform(A, B, Count, Out, [](float ValueA, float ValueB) { return (ValueA <= ValueB) ? ValueA : ValueB; });
+}
+
+void WeightKernels::MaxScalar(const float *Values, int Count, float Scalar, float *Out)
+{
+	Transform(Values, Count, Out, [Scalar](float Value) { return (Value >= Scalar) ? Value : Scalar; });
+}
+
+void WeightKernels::MinScalar(const float *Values, int Count, float Scalar, float *Out)
+{
+	Transform(Values, Count, Out, [Scalar](float Value) { return (Value <= Scalar) ? Value : Scalar; });
+}
+
+void WeightKernels::Lerp(const float *A, const float *B, int Count, float Alpha, float *Out)
+{
+	Transform(A, B, Count, Out, [Alpha](float ValueA, float ValueB) { return ValueA + Alpha * (ValueB - ValueA); });
+}
+
+void WeightKernels::LerpScalar(const float *Values, int Count, float Scalar, float Alpha, float *Out)
+{
+	Transform(Values, Count, Out, [Scalar, Alpha](float Value) { return Value + Alpha * (Scalar - Value); });
+}
+
+/// The number of weights *Statistics* adds up in floats before adding them to the total
+static const int StatisticsSumBlockSize = 1024;
+
+void WeightKernels::Statistics(const float *Values, int Count, FWeightStatistics &Out)
+{
+	Out = FWeightStatistics();
+	if (Count <= 0) {
+		return;
+	}
+
+	// Weights which aren't less or more than the smallest or largest so far, which includes NaNs,
+	// leave them as they are.
+	float CurrentMin = Values[0];
+	float CurrentMax = Values[0];
+	double Sum = 0.0;
+	int NonZeroCount = 0;
+	int Index = 0;
+
+#if defined(WEIGHTKERNELS_SSE)
+	if (Count >= 4) {
+		const __m128 Zero = _mm_setzero_ps();
+		__m128 MinLanes = _mm_set1_ps(CurrentMin);
+		__m128 MaxLanes = _mm_set1_ps(CurrentMax);
+		__m128i NonZeroLanes = _mm_setzero_si128();
+		while (Index + 4 <= Count) {
+			const int BlockEnd = Index + ((Count - Index < StatisticsSumBlockSize ? Count - Index : StatisticsSumBlockSize) & ~3);
+			__m128 SumLanes = Zero;
+			for (; Index < BlockEnd; Index += 4) {
+				// Min and max return their second operand if either is a NaN.
+				const __m128 Value = _mm_loadu_ps(Values + Index);
+				MinLanes = _mm_min_ps(Value, MinLanes);
+				MaxLanes = _mm_max_ps(Value, MaxLanes);
+				SumLanes = _mm_add_ps(SumLanes, Value);
+				// Each comparison that's true is -1.
+				NonZeroLanes = _mm_sub_epi32(NonZeroLanes, _mm_castps_si128(_mm_cmpneq_ps(Value, Zero)));
+			}
+			float Lanes[4];
+			_mm_storeu_ps(Lanes, SumLanes);
+			Sum += (double)Lanes[0] + (double)Lanes[1] + (double)Lanes[2] + (double)Lanes[3];
+		}
+
+		float MinLane[4], MaxLane[4];
+		int NonZeroLane[4];
+		_mm_storeu_ps(MinLane, MinLanes);
+		_mm_storeu_ps(MaxLane, MaxLanes);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(NonZeroLane), NonZeroLanes);
+		for (int Lane = 0; Lane < 4; ++Lane) {
+			CurrentMin = MinLane[Lane] < CurrentMin ? MinLane[Lane] : CurrentMin;
+			CurrentMax = MaxLane[Lane] > CurrentMax ? MaxLane[Lane] : CurrentMax;
+			NonZeroCount += NonZeroLane[Lane];
+		}
+	}
+#elif defined(WEIGHTKERNELS_NEON)
+	if (Count >= 4) {
+		const float32x4_t Zero = vdupq_n_f32(0.0f);
+		float32x4_t MinLanes = vdupq_n_f32(CurrentMin);
+		float32x4_t MaxLanes = vdupq_n_f32(CurrentMax);
+		uint32x4_t NonZeroLanes = vdupq_n_u32(0);
+		while (Index + 4 <= Count) {
+			const int BlockEnd = Index + ((Count - Index < StatisticsSumBlockSize ? Count - Index : StatisticsSumBlockSize) & ~3);
+			float32x4_t SumLanes = Zero;
+			for (; Index < BlockEnd; Index += 4) {
+				// NEON's min and max return NaNs, so compare and select to skip them as SSE does.
+				const float32x4_t Value = vld1q_f32(Values + Index);
+				MinLanes = vbslq_f32(vcltq_f32(Value, MinLanes), Value, MinLanes);
+				MaxLanes = vbslq_f32(vcgtq_f32(Value, MaxLanes), Value, MaxLanes);
+				SumLanes = vaddq_f32(SumLanes, Value);
+				// Each comparison that's true is all ones, so count the ones that aren't equal.
+				NonZeroLanes = vsubq_u32(NonZeroLanes, vmvnq_u32(vceqq_f32(Value, Zero)));
+			}
+			float Lanes[4];
+			vst1q_f32(Lanes, SumLanes);
+			Sum += (double)Lanes[0] + (double)Lanes[1] + (double)Lanes[2] + (double)Lanes[3];
+		}
+
+		float MinLane[4], MaxLane[4];
+		uint32_t NonZeroLane[4];
+		vst1q_f32(MinLane, MinLanes);
+		vst1q_f32(MaxLane, MaxLanes);
+		vst1q_u32(NonZeroLane, NonZeroLanes);
+		for (int Lane = 0; Lane < 4; ++Lane) {
+			CurrentMin = MinLane[Lane] < CurrentMin ? MinLane[Lane] : CurrentMin;
+			CurrentMax = MaxLane[Lane] > CurrentMax ? MaxLane[Lane] : CurrentMax;
+			NonZeroCount += (int)NonZeroLane[Lane];
+		}
+	}
+#endif
+
+	float TailSum = 0.0f;
+	for (; Index < Count; ++Index) {
+		const float Value = Values[Index];
+		CurrentMin = Value < CurrentMin ? Value : CurrentMin;
+		CurrentMax = Value > CurrentMax ? Value : CurrentMax;
+		TailSum += Value;
+		NonZeroCount += Value != 0.0f ? 1 : 0;
+	}
+
+	Out.Min = CurrentMin;
+	Out.Max = CurrentMax;
+	Out.Sum = Sum + TailSum;
+	Out.NonZeroCount = NonZeroCount;
+	Out.Count = Count;
+}
+
+void WeightKernels::MinMax(const float *Values, int Count, float &OutMin, float &OutMax)
+{
+	FWeightStatistics Found;
+	Statistics(Values, Count, Found);
+	OutMin = Found.Min;
+	OutMax = Found.Max;
+}
+
+void WeightKernels::RemapRange(const float *Values, int Count, float CurrentMin, float CurrentMax, float NewMin, float NewMax, float *Out)
+{
+	const float Scale = (NewMax - NewMin) / (CurrentMax - CurrentMin);
+	Transform(Values, Count, Out, [CurrentMin, Scale, NewMin](float Value) { return (Value - CurrentMin) * Scale + NewMin; });
+}
+
+
+/// Quantize weights to codes of any unsigned integer type, returning the step between codes.
+template <typename CodeType>
+static inline float QuantizeCodes(const float *Values, int Count, float Min, float Max, CodeType *Out)
+{
+	const float MaxCode = (float)std::numeric_limits<CodeType>::max();
+	if (!(Max > Min)) {
+		memset(Out, 0, Count * sizeof(CodeType));
+		return 0.0f;
+	}
+	const float Scale = MaxCode / (Max - Min);
+	for (int Index = 0; Index < Count; ++Index) {
+		const float Code = (Values[Index] - Min) * Scale + 0.5f;
+		Out[Index] = (CodeType)(Code <= 0.0f ? 0.0f : Code >= MaxCode ? MaxCode : Code);
+	}
+	return (Max - Min) / MaxCode;
+}
+
+/// Turn codes of any unsigned integer type back into weights.
+template <typename CodeType>
+static inline void DequantizeCodes(const CodeType *Codes, int Count, float Min, float Step, float *Out)
+{
+	for (int Index = 0; Index < Count; ++Index) {
+		Out[Index] = Min + Codes[Index] * Step;
+	}
+}
+
+float WeightKernels::Quantize(const float *Values, int Count, float Min, float Max, uint16_t *Out)
+{
+	return QuantizeCodes(Values, Count, Min, Max, Out);
+}
+
+float WeightKernels::Quantize(const float *Values, int Count, float Min, float Max, uint8_t *Out)
+{
+	return QuantizeCodes(Values, Count, Min, Max, Out);
+}
+
+void WeightKernels::Dequantize(const FWeightStream &Values, int Count, float *Out)
+{
+	switch (Values.Precision) {
+	case EWeightPrecision::UInt16:
+		DequantizeCodes(static_cast<const uint16_t *>(Values.Data), Count, Values.Min, Values.Step, Out);
+		break;
+	case EWeightPrecision::UInt8:
+		DequantizeCodes(static_cast<const uint8_t *>(Values.Data), Count, Values.Min, Values.Step, Out);
+		break;
+	default:
+		if (Values.GetFloats() != Out) {
+			memcpy(Out, Values.GetFloats(), Count * sizeof(float));
+		}
+		break;
+	}
+}
@@ -0,0 +1,41 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#include "ProceduralToolkit.h"
+#include "Async/ParallelFor.h"
+#include "VertexChunks.h"
+
+void MakeVertexChunks(
+	const TArray<FSectionGeometry> &Sections, const TArray<int32> &SectionVertexOffsets, int32 ChunkSize,
+	TArray<FVertexChunk> &OutChunks
+) {
+	check(SectionVertexOffsets.Num() == Sections.Num() + 1);
+	OutChunks.Reset();
+	ChunkSize = FMath::Max(ChunkSize, 1);
+
+	for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); ++SectionIndex) {
+		const int32 SectionVertexCount = Sections[SectionIndex].vertices.Num();
+		for (int32 FirstVertex = 0; FirstVertex < SectionVertexCount; FirstVertex += ChunkSize) {
+			FVertexChunk Chunk;
+			Chunk.SectionIndex = SectionIndex;
+			Chunk.FirstVertex = FirstVertex;
+			Chunk.VertexCount = FMath::Min(ChunkSize, SectionVertexCount - FirstVertex);
+			Chunk.FirstWeightIndex = SectionVertexOffsets[SectionIndex] + FirstVertex;
+			OutChunks.Add(Chunk);
+		}
+	}
+}
+
+void ParallelForVertexChunks(
+	const TArray<FSectionGeometry> &Sections, const TArray<int32> &SectionVertexOffsets,
+	int32 ChunkSize, bool bAllowParallel,
+	TFunctionRef<void(const FVertexChunk &Chunk)> Function
+) {
+	TArray<FVertexChunk> Chunks;
+	MakeVertexChunks(Sections, SectionVertexOffsets, ChunkSize, Chunks);
+
+	// Small meshes aren't worth the cost of waking up the worker threads.
+	const bool bForceSingleThread = !bAllowParallel || Chunks.Num() <= 1;
+	ParallelFor(Chunks.Num(), [&Chunks, &Function](int32 ChunkIndex) {
+		Function(Chunks[ChunkIndex]);
+	}, bForceSingleThread);
+}
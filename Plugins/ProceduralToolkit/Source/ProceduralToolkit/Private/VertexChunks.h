@@ -0,0 +1,54 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include "SectionGeometry.h"
+
+/// A range of vertices within one section, used to split per-vertex work across threads.
+struct FVertexChunk
+{
+	/// The index of the section the vertices belong to
+	int32 SectionIndex;
+
+	/// The index of the first vertex within the section
+	int32 FirstVertex;
+
+	/// The number of vertices in the chunk
+	int32 VertexCount;
+
+	/// The index of the first vertex across the whole geometry, which is also the index of
+	/// its weight in a *SelectionSet*
+	int32 FirstWeightIndex;
+};
+
+/// Split the vertices of all of the sections into chunks of at most *ChunkSize* vertices.
+///
+/// Chunks never span sections, so small sections will produce smaller chunks.
+///
+/// \param Sections					The sections to split
+/// \param SectionVertexOffsets		The index of the first vertex of each section across the whole
+///									geometry, as returned by UMeshGeometry::GetSectionVertexOffsets
+/// \param ChunkSize				The maximum number of vertices in each chunk
+/// \param OutChunks				The chunks, in order through the sections
+void MakeVertexChunks(
+	const TArray<FSectionGeometry> &Sections, const TArray<int32> &SectionVertexOffsets, int32 ChunkSize,
+	TArray<FVertexChunk> &OutChunks
+);
+
+/// Call a function for every chunk of vertices, spreading the chunks across the task graph's
+/// worker threads.
+///
+/// If there's only a single chunk, or *bAllowParallel* is false, the chunks are processed in
+/// order on the calling thread instead.  The function must only touch data belonging to the
+/// chunk it's passed.
+///
+/// \param Sections					The sections to process
+/// \param SectionVertexOffsets		The index of the first vertex of each section across the whole geometry
+/// \param ChunkSize				The maximum number of vertices each call should handle
+/// \param bAllowParallel			Whether the work can be spread across threads
+/// \param Function					The function to call for each chunk
+void ParallelForVertexChunks(
+	const TArray<FSectionGeometry> &Sections, const TArray<int32> &SectionVertexOffsets,
+	int32 ChunkSize, bool bAllowParallel,
+	TFunctionRef<void(const FVertexChunk &Chunk)> Function
+);
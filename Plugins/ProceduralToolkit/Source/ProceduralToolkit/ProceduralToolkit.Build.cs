@@ -6,7 +6,10 @@ public class ProceduralToolkit : ModuleRules
 {
 	public ProceduralToolkit(ReadOnlyTargetRules targetRules)
 	{
-		
+		// The engine-free core (FastNoise and ToolkitCore) doesn't include the module's precompiled
+		// header, so that it can also be built by the standalone CMake project.
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
 		PublicIncludePaths.AddRange(
 			new string[] {
 				"ProceduralToolkit/Public"
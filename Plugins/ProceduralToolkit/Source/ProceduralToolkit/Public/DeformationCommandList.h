@@ -0,0 +1,143 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include "SectionGeometry.h"
+#include "SelectionSet.h"
+#include "DeformationCommandList.generated.h"
+
+/// The different kinds of deformation which can be recorded in a *DeformationCommandList*.
+///
+/// Several of the *MeshGeometry* transforms share a kind, for example *Rotate*, *Scale*,
+/// *Transform* and *ScaleAlongAxis* are all recorded as *Affine*.
+enum class EDeformationCommandType : uint8
+{
+	Translate,
+	Affine,
+	Inflate,
+	Spherize,
+	RotateAroundAxis
+};
+
+/// A single deformation recorded by *MeshGeometry*, ready to be executed later.
+///
+/// The parameters are stored generically and their meaning depends on the *Type*:
+/// * **Translate**: *Vector0* is the delta.
+/// * **Affine**: *Matrix* is the 3x4 row-major matrix used by VertexKernels::Affine.
+/// * **Inflate**: *Scalar0* is the offset along the normal.
+/// * **Spherize**: *Vector0* is the center, *Scalar0* the radius and *Scalar1* the strength.
+/// * **RotateAroundAxis**: *Vector0* is the center, *Vector1* the normalized axis and *Scalar0*
+///   the angle in degrees.
+USTRUCT()
+struct FDeformationCommand
+{
+	GENERATED_USTRUCT_BODY()
+
+	/// The kind of deformation
+	EDeformationCommandType Type = EDeformationCommandType::Translate;
+
+	/// The matrix for *Affine* commands
+	float Matrix[12];
+
+	/// The first vector parameter
+	FVector Vector0 = FVector::ZeroVector;
+
+	/// The second vector parameter
+	FVector Vector1 = FVector::ZeroVector;
+
+	/// The first scalar parameter
+	float Scalar0 = 0.0f;
+
+	/// The second scalar parameter
+	float Scalar1 = 0.0f;
+
+	/// The SelectionSet weighting the deformation, or *nullptr* for full strength.
+	///
+	/// This is a UPROPERTY so that the SelectionSet can't be garbage collected while
+	/// the command is waiting to be executed.
+	UPROPERTY()
+		USelectionSet *Selection = nullptr;
+
+	/// Apply this deformation to a range of vertices in a section.
+	///
+	/// \param Section				The section to deform
+	/// \param FirstVertex			The index of the first vertex in the section to deform
+	/// \param VertexCount			The number of vertices to deform
+	/// \param FirstWeightIndex		The index of the first vertex's weight in *Selection*
+	void Execute(FSectionGeometry &Section, int32 FirstVertex, int32 VertexCount, int32 FirstWeightIndex) const;
+
+	/// Try to fold another command into this one so they can be applied as a single operation.
+	///
+	/// This is only possible for unweighted *Translate* and *Affine* commands, which combine
+	/// into a single *Affine* command.
+	///
+	/// \param Next			The command to be applied after this one
+	/// \return *True* if *Next* has been merged into this command, *False* if not
+	bool TryMerge(const FDeformationCommand &Next);
+
+private:
+	/// *Execute* for a sparse *Selection*, only visiting the vertices it selects.
+	void ExecuteSparse(FSectionGeometry &Section, int32 FirstVertex, int32 VertexCount, int32 FirstWeightIndex) const;
+
+	/// Run the kernel for this command over packed positions.
+	///
+	/// \param Positions		VertexCount XYZ triples, modified in place
+	/// \param Normals			The matching normals, only read by *Inflate*
+	/// \param VertexCount		The number of vertices
+	/// \param Weights			The weight for each vertex, which may be quantized, or *nullptr* for full strength
+	void ExecuteKernel(float *Positions, const float *Normals, int32 VertexCount, FWeightStream Weights) const;
+};
+
+/// A list of deformations recorded by *MeshGeometry* which can be executed together.
+///
+/// Rather than making a full pass over the geometry for every deformation the vertices are
+/// processed in small chunks, with every command applied to a chunk while it's still in the
+/// cache before moving on to the next one.
+///
+/// SelectionSets are read when the list is executed, not when the commands were recorded, so
+/// they shouldn't be modified in between.
+USTRUCT()
+struct FDeformationCommandList
+{
+	GENERATED_USTRUCT_BODY()
+
+	/// Add a command to the end of the list, merging it with the previous command if possible.
+	///
+	/// \param Command		The command to add
+	void Add(const FDeformationCommand &Command);
+
+	/// Apply all of the commands to the sections in a single pass, and then empty the list.
+	///
+	/// The vertices are split into batches which are deformed in parallel.
+	///
+	/// \param Sections					The sections to deform
+	/// \param SectionVertexOffsets		The index of each section's first weight in a SelectionSet
+	/// \param BatchSize				The number of vertices handled by each worker thread at a time
+	/// \param bAllowParallel			Whether the batches can be spread across threads
+	void Execute(TArray<FSectionGeometry> &Sections, const TArray<int32> &SectionVertexOffsets, int32 BatchSize, bool bAllowParallel);
+
+	/// Apply all of the commands to the sections without emptying the list.
+	///
+	/// As this doesn't modify the list it can be run off the game thread, as long as the list
+	/// isn't changed until it's finished.
+	///
+	/// \see Execute
+	void Apply(TArray<FSectionGeometry> &Sections, const TArray<int32> &SectionVertexOffsets, int32 BatchSize, bool bAllowParallel) const;
+
+	/// Return *True* if any of the commands read the normals, such as *Inflate*.
+	bool NeedsNormals() const;
+
+	/// Discard all of the commands without applying them.
+	void Reset();
+
+	/// Return the number of commands waiting to be executed.
+	int32 Num() const;
+
+	/// Return *True* if there are no commands waiting to be executed.
+	bool IsEmpty() const;
+
+private:
+	/// The commands, in the order they'll be applied
+	UPROPERTY()
+		TArray<FDeformationCommand> Commands;
+};
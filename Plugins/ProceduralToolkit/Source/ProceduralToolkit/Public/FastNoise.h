@@ -36,6 +36,9 @@
 
 #define FN_CELLULAR_INDEX_MAX 3
 
+// PaulG: For the vectorised versions of FillNoise(...)
+#include "ToolkitCore/NoiseKernels.h"
+
 #ifdef FN_USE_DOUBLES
 typedef double FN_DECIMAL;
 #else
@@ -171,9 +174,28 @@ public:
 	void GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z);
 	void GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z);
 
+	// PaulG: Batch versions of GetNoise(...), writing one value to output for each of count points.
+	// The noise and fractal types are switched on once per call rather than once per point.
+	// Each coordinate is read every stride values, so separate x/y/z arrays use a stride of 1 and
+	// interleaved XYZ positions use x = positions, y = positions + 1, z = positions + 2 with a
+	// stride of 3.  The results are the same as calling GetNoise(...) for each point.
+	void FillNoise(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, int stride, int count, FN_DECIMAL* output);
+	void FillNoise(const FN_DECIMAL* x, const FN_DECIMAL* y, int stride, int count, FN_DECIMAL* output);
+
+	// PaulG: FillNoise(...) evaluates several points at once using SSE2, AVX2 or NEON for Value,
+	// Perlin, Simplex and Cubic noise and their FBM, Billow and RigidMulti fractals.  The results
+	// match GetNoise(...) to within NoiseKernels::Tolerance.  This picks the instruction set, with
+	// Scalar going point by point, and anything the CPU doesn't support falling back to that.
+	// Default: the best the CPU supports, see NoiseKernels::GetSupportedInstructionSet()
+	void SetInstructionSet(NoiseKernels::EInstructionSet instructionSet) { m_instructionSet = instructionSet; }
+	NoiseKernels::EInstructionSet GetInstructionSet() const { return m_instructionSet; }
+
 	//4D
 	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w);
 
+	// PaulG: Batch version of the 4D GetSimplex(...), as FillNoise(...)
+	void FillSimplex(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, const FN_DECIMAL* w, int stride, int count, FN_DECIMAL* output);
+
 	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w);
 	FN_DECIMAL GetWhiteNoiseInt(int x, int y, int z, int w);
 
@@ -192,6 +214,8 @@ protected:
 	FractalType m_fractalType = FBM;
 	FN_DECIMAL m_fractalBounding;
 
+	NoiseKernels::EInstructionSet m_instructionSet = NoiseKernels::GetSupportedInstructionSet();
+
 	CellularDistanceFunction m_cellularDistanceFunction = Euclidean;
 	CellularReturnType m_cellularReturnType = CellValue;
 	FastNoise* m_cellularNoiseLookup = nullptr;
@@ -259,6 +283,9 @@ protected:
 	//4D
 	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w);
 private:
+	// PaulG: Try FillNoise(...) with the vectorised kernels, returning false if they don't handle the settings.
+	bool FillNoiseVectorized(int dimensions, const FN_DECIMAL* const coordinates[4], int stride, int count, FN_DECIMAL* output) const;
+
 	inline unsigned char Index2D_12(unsigned char offset, int x, int y);
 	inline unsigned char Index3D_12(unsigned char offset, int x, int y, int z);
 	inline unsigned char Index4D_32(unsigned char offset, int x, int y, int z, int w);
@@ -37,6 +37,9 @@
 /// angle of rotation.  If in doubt look at the actual implementation for the function in
 /// *MeshGeometry*.
 
+/// Signature for *OnAsyncDeformationComplete*.
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FAsyncDeformationCompleteSignature, UMeshDeformationComponent *, MeshDeformationComponent);
+
 /// \see UActorComponent
 /// \see MeshGeometry
 /// \see SelectionSet
@@ -49,6 +52,15 @@ public:
 	/// Sets default values for this component's properties
 	UMeshDeformationComponent();
 
+	/// Checks for deformations started by *ExecuteDeformationBatchAsync* finishing.
+	///
+	/// The component only ticks while there are deformations in progress.
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+
+	/// Called when deformations started by *ExecuteDeformationBatchAsync* have been applied.
+	UPROPERTY(BlueprintAssignable, Category = MeshDeformationComponent)
+		FAsyncDeformationCompleteSignature OnAsyncDeformationComplete;
+
 	/// This is the mesh geometry currently stored within the component
 	UPROPERTY(BlueprintReadonly, Category = MeshDeformationComponent)
 		UMeshGeometry *MeshGeometry = nullptr;
@@ -71,7 +83,8 @@ public:
 
 	/// Write the current geometry to a *ProceduralMeshComponent*.
 	/// 
-	/// This will rebuild the mesh, completely replacing any geometry it has there.
+	/// The first time this is called it will rebuild the mesh, completely replacing any geometry it
+	/// has there.  After that only the sections and attributes which have changed are updated.
 	///
 	/// \param MeshDeformationComponent		This component (Out param, helps with method chaining)
 	/// \param ProceduralMeshComponent		The target *ProceduralMeshComponent
@@ -84,6 +97,70 @@ public:
 			bool CreateCollision
 		);
 
+	/// Take a snapshot of the current geometry which can later be restored.
+	///
+	/// \return The snapshot, or *nullptr* if there's no geometry loaded
+	/// \see MeshGeometry::Snapshot
+	UFUNCTION(BlueprintCallable, Category = MeshDeformationComponent)
+		UMeshGeometrySnapshot *Snapshot();
+
+	/// Return the geometry to the state it was in when a snapshot was taken.
+	///
+	/// \param MeshDeformationComponent		This component (Out param, helps with method chaining)
+	/// \param Snapshot						A snapshot previously taken from this component
+	/// \return *True* if the geometry was restored, *False* if not
+	/// \see MeshGeometry::Restore
+	UFUNCTION(BlueprintCallable, Category = MeshDeformationComponent)
+		bool Restore(
+			UMeshDeformationComponent *&MeshDeformationComponent,
+			UMeshGeometrySnapshot *Snapshot
+		);
+
+	/// Start recording deformations so they can be applied together in a single pass.
+	///
+	/// \param MeshDeformationComponent		This component (Out param, helps with method chaining)
+	/// \see MeshGeometry::BeginDeformationBatch
+	UFUNCTION(BlueprintCallable, Category = MeshDeformationComponent)
+		void BeginDeformationBatch(UMeshDeformationComponent *&MeshDeformationComponent);
+
+	/// Stop recording deformations and apply all of those recorded since *BeginDeformationBatch*.
+	///
+	/// \param MeshDeformationComponent		This component (Out param, helps with method chaining)
+	/// \see MeshGeometry::ExecuteDeformationBatch
+	UFUNCTION(BlueprintCallable, Category = MeshDeformationComponent)
+		void ExecuteDeformationBatch(UMeshDeformationComponent *&MeshDeformationComponent);
+
+	/// Stop recording deformations and apply those recorded since *BeginDeformationBatch* on a
+	/// worker thread, continuing once they've been applied.
+	///
+	/// The geometry keeps its current vertices until the deformations have finished, and they're
+	/// then swapped in at the start of a frame.  *OnAsyncDeformationComplete* is also called at
+	/// that point.  SelectionSets used by the deformations shouldn't be changed until then.
+	///
+	/// \param MeshDeformationComponent		This component (Out param, helps with method chaining)
+	/// \param LatentInfo					The latent action info, filled in by Blueprint
+	/// \see MeshGeometry::ExecuteDeformationBatchAsync
+	UFUNCTION(BlueprintCallable, Category = MeshDeformationComponent, meta = (Latent, LatentInfo = "LatentInfo"))
+		void ExecuteDeformationBatchAsync(UMeshDeformationComponent *&MeshDeformationComponent, FLatentActionInfo LatentInfo);
+
+	/// Return whether deformations started by *ExecuteDeformationBatchAsync* are still in progress.
+	///
+	/// \return *True* if there are deformations in progress
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshDeformationComponent)
+		bool IsAsyncDeformationInProgress() const;
+
+	/// Block until deformations started by *ExecuteDeformationBatchAsync* finish, and apply them.
+	///
+	/// \param MeshDeformationComponent		This component (Out param, helps with method chaining)
+	UFUNCTION(BlueprintCallable, Category = MeshDeformationComponent)
+		void WaitForAsyncDeformation(UMeshDeformationComponent *&MeshDeformationComponent);
+
+	/// Apply the result of *ExecuteDeformationBatchAsync* if it's ready, and call
+	/// *OnAsyncDeformationComplete* if it has been applied.
+	///
+	/// This is called every tick while deformations are in progress.
+	void UpdateAsyncDeformation();
+
 	/// Selects all of the vertices at full strength.
 	///
 	/// /return A *SelectionSet* with full strength
@@ -115,11 +192,14 @@ public:
 	///						will be selected at maximum strength.
 	/// \param OuterRadius	The outer radius, all points further from the spline than this distance
 	///						will not be selected
+	/// \param Tolerance	How far the spline can be from the polyline it's sampled into before
+	///						measuring, which is roughly the most the distances can be out by
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshDeformationComponent)
 		USelectionSet *SelectNearSpline(
 			USplineComponent *Spline,
 			float InnerRadius = 0,
-			float OuterRadius = 100
+			float OuterRadius = 100,
+			float Tolerance = 1.0f
 		);
 
 	/// Selects vertices near a line segment with the provided start/end points.
@@ -188,6 +268,43 @@ public:
 			ECellularDistanceFunction CellularDistanceFunction = ECellularDistanceFunction::Euclidian
 		);
 
+	/// Selects vertices based on a noise function, looked up from a volume the noise has been baked into.
+	///
+	/// The first call for some noise settings bakes the noise into a 3D grid over the geometry's
+	/// bounds, and later calls with the same settings, on this geometry or any other, interpolate
+	/// from the grid rather than evaluating the noise again.  This is much faster for fractal
+	/// noise, but smooths out detail finer than the grid spacing so the result is only close to
+	/// *SelectByNoise*'s.  A geometry outside the grid causes it to be rebaked over a box covering both.
+	///
+	/// The volumes are shared by every geometry, and the least recently used are dropped once they
+	/// take more than the memory budget set by *UMeshGeometry::SetNoiseCacheMemoryBudget*.  If a volume wouldn't fit
+	/// in the budget this is the same as *SelectByNoise*.
+	///
+	/// \param Seed							The seed for the random number generator
+	/// \param Frequency					The frequency of the noise, the higher the value the more detail
+	/// \param NoiseInterpolation			The interpolation used to smooth between noise values
+	/// \param NoiseType					The type of noise we're using
+	/// \param FractalOctaves				The number of fractal octaves to apply
+	/// \param FractalLacunarity			Set the fractal lacunarity, the higher the value the more space the
+	///										the fractal will fill up
+	/// \param FractalGain					The strength of the fractal
+	/// \param FractalType					The type of fractal being used
+	/// \param CellularDistanceFunction		The function used to calculate the value for a given point.
+	/// \param Resolution					The number of samples along the longest side of the volume
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshDeformationComponent)
+		USelectionSet *SelectByNoiseCached(
+			int32 Seed = 1337,
+			float Frequency = 0.01,
+			ENoiseInterpolation NoiseInterpolation = ENoiseInterpolation::Quintic,
+			ENoiseType NoiseType = ENoiseType::Simplex,
+			uint8 FractalOctaves = 3,
+			float FractalLacunarity = 2.0,
+			float FractalGain = 0.5,
+			EFractalType FractalType = EFractalType::FBM,
+			ECellularDistanceFunction CellularDistanceFunction = ECellularDistanceFunction::Euclidian,
+			int32 Resolution = 64
+		);
+
 	/// Select vertices from a texture.
 	///
 	/// Black in the channel = Unselected, White = Fully selected.  Uses UV0 for texture access as that's
@@ -401,4 +518,8 @@ public:
 			float Alpha = 0.0,
 			USelectionSet *Selection = nullptr
 		);
+
+private:
+	/// Whether *OnAsyncDeformationComplete* still needs to be called for the last async deformation
+	bool bAsyncDeformationPending = false;
 };
\ No newline at end of file
@@ -7,8 +7,13 @@
 #include "Math/TransformNonVectorized.h"
 #include "Runtime/Engine/Classes/Components/SplineComponent.h"
 #include "ProceduralMeshComponent.h"
+#include "Async/Future.h"
 #include "SelectionSet.h"
 #include "FastNoise.h"
+#include "DeformationCommandList.h"
+#include "MeshGeometrySnapshot.h"
+#include "ToolkitCore/MeshAdjacency.h"
+#include "ToolkitCore/VertexGrid.h"
 #include "MeshGeometry.generated.h"
 
 /// A copy of FastNoise's Interp enum made available to Blueprint.
@@ -78,6 +83,63 @@ enum class ETextureChannel : uint8 {
 /// \todo Think ahead to other procedural tools - Should the "Select" functions be renamed SelectVerts?
 /// \todo Should Selects return nullptr or empty array?  (Should return nullptr and the further bits should check SelectionSet)
 
+/// The change tracking for a single section of a *MeshGeometry*.
+struct FMeshGeometrySectionState
+{
+	/// The version of each attribute, indexed by *EMeshGeometryAttribute*
+	int32 AttributeVersions[MeshGeometryAttributeCount];
+
+	/// The attributes changed since *ClearDirty* was called
+	uint8 DirtyAttributes;
+
+	FMeshGeometrySectionState() : DirtyAttributes(0)
+	{
+		FMemory::Memzero(AttributeVersions);
+	}
+};
+
+/// What a *MeshGeometry* last wrote to a *ProceduralMeshComponent*.
+struct FMeshGeometryOutputState
+{
+	/// The component written to
+	TWeakObjectPtr<UProceduralMeshComponent> Component;
+
+	/// Whether collision was created
+	bool bCollision = false;
+
+	/// The version of each attribute of each section when it was written
+	TArray<int32> AttributeVersions;
+};
+
+/// A *Select* result kept by a *MeshGeometry* so it can be returned again while nothing it was
+/// made from has changed.
+USTRUCT()
+struct FMeshGeometryCachedSelection
+{
+	GENERATED_USTRUCT_BODY()
+
+	/// The *Select* function which made the selection
+	FName Function;
+
+	/// The function's arguments, along with any settings which affect the result
+	TArray<uint8> Arguments;
+
+	/// A hash of *Arguments*, to save comparing them all
+	uint32 ArgumentsHash = 0;
+
+	/// The attribute the selection was made from
+	EMeshGeometryAttribute Attribute = EMeshGeometryAttribute::Positions;
+
+	/// The version of *Attribute* for each section when the selection was made
+	TArray<int32> Versions;
+
+	/// When the selection was last returned, for dropping the least recently used
+	int32 LastUsed = 0;
+
+	/// The selection's weights, shared with every SelectionSet the selection has been returned as
+	FSelectionSetSharedWeightsPtr Weights;
+};
+
 /// This class stores the geometry for a mesh which can then be mutated by the
 /// methods provided to allow a range of topological deformations.
 ///
@@ -86,7 +148,6 @@ enum class ETextureChannel : uint8 {
 ///
 /// \see MeshDeformationComponent
 ///
-/// \todo Copy/cache MeshGeometry - allows us to do part of it and go back
 /// \todo Lerp - Blend between two MeshGeometrys
 /// \todo SplineLerp - Lerps along a spline where the binormals drive the spline tangents and normals drive the spline
 ///                    direction.
@@ -108,6 +169,52 @@ public:
 	UPROPERTY(BlueprintReadonly)
 		TArray<FSectionGeometry> sections;
 
+	/// The number of vertices processed by each worker thread at a time.
+	///
+	/// The *Select* functions and deformations split the vertices of each section into batches of
+	/// this size and spread them across threads.  Meshes with only a single batch are processed
+	/// on the calling thread.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MeshGeometry, meta = (ClampMin = "1"))
+		int32 ParallelBatchSize = 8192;
+
+	/// Whether processing can be spread across threads, if not everything is processed on the
+	/// calling thread.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MeshGeometry)
+		bool bAllowParallel = true;
+
+	/// Whether *SelectNear* and *SelectNearLine* can use a spatial index of the vertices.
+	///
+	/// The index is built when the same positions are selected from a second time, and is thrown
+	/// away as soon as they change, so it only costs memory and time on meshes which are selected
+	/// from repeatedly without being deformed in between.  Small meshes never use it.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MeshGeometry)
+		bool bUseSpatialIndex = true;
+
+	/// Whether *SelectNear* and *SelectNearLine* return sparse SelectionSets, which only store the
+	/// weights of the vertices they select.
+	///
+	/// This saves memory and time when selecting a small part of a large mesh, as the transforms
+	/// and the *SelectionSetBPLibrary* then only visit the selected vertices.  Blueprints which
+	/// read a SelectionSet's weights directly need to call *EnsureDense* on it first.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MeshGeometry)
+		bool bProduceSparseSelections = false;
+
+	/// Whether the *Select* functions can return the selection they made before when called again
+	/// with the same arguments, rather than making it again.
+	///
+	/// A selection is only returned again if the vertices it was made from haven't changed since.
+	/// Every caller gets a SelectionSet of its own sharing the selection's weights, which copies
+	/// them the first time it's changed, so changing one never changes another.  Blueprints which
+	/// read a SelectionSet's weights directly need to call *EnsureDense* on it first.
+	/// *SelectNearSpline* and *SelectByTexture* are never cached as the spline or texture can
+	/// change without the geometry knowing.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MeshGeometry)
+		bool bCacheSelections = true;
+
+	/// The most selections kept for *bCacheSelections*, the least recently used are dropped after that.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = MeshGeometry, meta = (ClampMin = "0"))
+		int32 MaxCachedSelections = 16;
+
 	/// Default constructor- creates an empty mesh.
 	UMeshGeometry();
 
@@ -123,7 +230,13 @@ public:
 
 	/// Write the current geometry to a *ProceduralMeshComponent*.
 	/// 
-	/// This will rebuild the mesh, completely replacing any geometry it has there.
+	/// The first time this is called for a *ProceduralMeshComponent* it will rebuild the mesh,
+	/// completely replacing any geometry it has there.  After that only the sections which have
+	/// changed are sent, and unless their triangles or number of vertices changed only the attributes
+	/// which changed are uploaded with *UpdateMeshSection_LinearColor*.  Switching to a different
+	/// *ProceduralMeshComponent* or collision setting causes a full rebuild.
+	///
+	/// This assumes nothing else modifies the *ProceduralMeshComponent* in between calls.
 	///
 	/// \param proceduralMeshComponent		The target *ProceduralMeshComponent
 	/// \param createCollision				Whether to create a collision shape for it
@@ -155,6 +268,198 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
 		FString GetSummary() const;
 
+	/// Return the index of the first vertex of a section across the whole geometry.
+	///
+	/// This is also the index of the section's first weight in a *SelectionSet*, so the weights
+	/// for a section run from this to the offset of the next section.
+	///
+	/// \param SectionIndex		The section to look up
+	/// \return The index of the section's first vertex
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
+		int32 GetSectionVertexOffset(int32 SectionIndex) const;
+
+	/// Return the index of the first vertex of every section across the whole geometry.
+	///
+	/// There's one more entry than there are sections, with the last being the total vertex count.
+	/// This is cached, and only rebuilt when the topology changes.
+	const TArray<int32> &GetSectionVertexOffsets() const;
+
+	/// Return a pointer to the weights for a section within a *SelectionSet*.
+	///
+	/// The SelectionSet can't be sparse, deferred, or quantized, see *USelectionSet::EnsureDense*.
+	///
+	/// \param Selection			The SelectionSet, which can be *nullptr*
+	/// \param SectionIndex		The section to get the weights for
+	/// \return The section's first weight, or *nullptr* if there's no SelectionSet
+	const float *GetSectionWeights(const USelectionSet *Selection, int32 SectionIndex) const;
+
+	/// Let the geometry know that sections or vertices have been added or removed.
+	///
+	/// This only needs calling when *sections* has been modified directly from C++.
+	void MarkTopologyChanged();
+
+	/// Return which vertices and triangles each vertex is connected to, for smoothing, growing
+	/// selections, and recomputing normals.
+	///
+	/// This is built the first time it's asked for and kept until the triangles change or
+	/// *MarkTopologyChanged* is called.  With welding the copies of a vertex split along a UV seam
+	/// are treated as one.  Their positions are only compared when it's built, so the copies stay
+	/// welded however the mesh is deformed afterwards.
+	///
+	/// \param bWelded			Whether to treat vertices with exactly the same position as one
+	/// \return The adjacency, which is valid until the next call
+	const FMeshAdjacency &GetAdjacency(bool bWelded = false);
+
+	/// Take a snapshot of the current geometry which can later be passed to *Restore*.
+	///
+	/// This is cheap as nothing is copied until the geometry is changed, and then only the
+	/// sections and attributes which change are copied.  Any recorded deformations are applied
+	/// before the snapshot is taken.
+	///
+	/// \return The snapshot
+	UFUNCTION(BlueprintCallable, Category = MeshGeometry)
+		UMeshGeometrySnapshot *Snapshot();
+
+	/// Return the geometry to the state it was in when a snapshot was taken.
+	///
+	/// Any deformations recorded but not yet applied are discarded.  The snapshot can be restored
+	/// again later.
+	///
+	/// \param Snapshot					A snapshot previously taken from this geometry
+	/// \return *True* if the geometry was restored, *False* if not
+	UFUNCTION(BlueprintCallable, Category = MeshGeometry)
+		bool Restore(UMeshGeometrySnapshot *Snapshot);
+
+	/// Let any snapshots copy a section's data before it's changed, and give the attributes new versions.
+	///
+	/// All of the functions on this class do this themselves, this only needs calling when
+	/// *sections* is modified directly from C++.
+	///
+	/// \param SectionIndex				The section about to be changed
+	/// \param AttributeMask			The attributes about to be changed, see *GetAttributeMask*
+	void PrepareSectionForWrite(int32 SectionIndex, uint8 AttributeMask);
+
+	/// Return the version of an attribute of a section.
+	///
+	/// Every time an attribute is changed it's given a new version, higher than any version
+	/// given before, so comparing this with a previously stored version shows whether the
+	/// attribute has changed since.
+	///
+	/// \param SectionIndex				The section to check
+	/// \param Attribute				The attribute to check
+	/// \return The attribute's version, or zero for a section that doesn't exist
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
+		int32 GetAttributeVersion(int32 SectionIndex, EMeshGeometryAttribute Attribute) const;
+
+	/// Return the highest version of any attribute of a section.
+	///
+	/// \param SectionIndex				The section to check
+	/// \return The section's version, or zero for a section that doesn't exist
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
+		int32 GetSectionVersion(int32 SectionIndex) const;
+
+	/// Return the most recent version given to any attribute of the geometry.
+	///
+	/// If this hasn't changed then nothing in the geometry has changed.
+	///
+	/// \return The latest version
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
+		int32 GetLatestVersion() const;
+
+	/// Return whether an attribute of a section has changed since *ClearDirty* was last called.
+	///
+	/// \param SectionIndex				The section to check
+	/// \param Attribute				The attribute to check
+	/// \return *True* if the attribute has changed
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
+		bool IsAttributeDirty(int32 SectionIndex, EMeshGeometryAttribute Attribute) const;
+
+	/// Return whether any attribute of a section has changed since *ClearDirty* was last called.
+	///
+	/// \param SectionIndex				The section to check
+	/// \return *True* if the section has changed
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
+		bool IsSectionDirty(int32 SectionIndex) const;
+
+	/// Return the mask of attributes of a section which have changed since *ClearDirty* was last called.
+	///
+	/// \param SectionIndex				The section to check
+	/// \return The changed attributes, see *GetAttributeMask*
+	uint8 GetDirtyAttributes(int32 SectionIndex) const;
+
+	/// Mark every section as clean.
+	///
+	/// Versions aren't affected by this, and *UpdateProceduralMeshComponent* uses versions so this
+	/// doesn't affect what it updates.
+	UFUNCTION(BlueprintCallable, Category = MeshGeometry)
+		void ClearDirty();
+
+	/// Start recording deformations rather than applying them immediately.
+	///
+	/// *Translate*, *Rotate*, *Scale*, *Transform*, *Spherize*, *Inflate*, *ScaleAlongAxis* and
+	/// *RotateAroundAxis* are recorded until *ExecuteDeformationBatch* is called, and are then
+	/// applied in a single pass over the vertices rather than one pass each.  Consecutive unweighted
+	/// *Translate*, *Rotate*, *Scale*, *Transform* and *ScaleAlongAxis* calls are combined into a
+	/// single transformation.
+	///
+	/// Anything which needs up to date vertices, such as the *Select* functions, *Jitter*, *Lerp* and
+	/// *UpdateProceduralMeshComponent*, will apply the recorded deformations first.
+	///
+	/// SelectionSets passed to recorded deformations are only read when the batch is applied, so
+	/// they shouldn't be changed until then.
+	UFUNCTION(BlueprintCallable, Category = MeshGeometry)
+		void BeginDeformationBatch();
+
+	/// Stop recording deformations and apply all of those recorded since *BeginDeformationBatch*.
+	UFUNCTION(BlueprintCallable, Category = MeshGeometry)
+		void ExecuteDeformationBatch();
+
+	/// Return whether deformations are currently being recorded by *BeginDeformationBatch*.
+	///
+	/// \return *True* if deformations are being recorded, *False* if they're applied immediately
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
+		bool IsRecordingDeformations() const;
+
+	/// Apply any recorded deformations without ending the batch.
+	///
+	/// This is called automatically by anything that reads the vertices, and only needs calling
+	/// directly when accessing *sections* from C++.
+	void FlushDeformations();
+
+	/// Stop recording deformations and apply those recorded on a worker thread.
+	///
+	/// The deformations are applied to a copy of the vertices, which replaces the geometry's own
+	/// vertices when *PollAsyncDeformation* sees the work has finished.  Until then the geometry
+	/// carries on returning the vertices from before the batch, so it can still be output and
+	/// selected from.
+	///
+	/// Anything which changes the vertices waits for the batch to finish first.  Recorded
+	/// SelectionSets shouldn't be changed until it has finished.
+	void ExecuteDeformationBatchAsync();
+
+	/// Return whether deformations started with *ExecuteDeformationBatchAsync* are still to be applied.
+	///
+	/// \return *True* if there are deformations in progress
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
+		bool IsAsyncDeformationInProgress() const;
+
+	/// Swap in the result of *ExecuteDeformationBatchAsync* if the worker thread has finished.
+	///
+	/// This needs calling on the game thread, usually once per frame.
+	///
+	/// \return *True* if the deformations finished and have been applied by this call
+	bool PollAsyncDeformation();
+
+	/// Block until the deformations started with *ExecuteDeformationBatchAsync* finish, and then apply them.
+	void WaitForAsyncDeformation();
+
+	/// Make sure no worker thread is still using the geometry when it's destroyed.
+	virtual void BeginDestroy() override;
+
+	/// Drop every selection kept by *bCacheSelections*.
+	UFUNCTION(BlueprintCallable, Category = MeshGeometry)
+		void ClearSelectionCache();
+
 	/// Selects all of the vertices at full strength.
 	///
 	/// \return A *SelectionSet* with full strength
@@ -183,8 +488,10 @@ public:
 	///						will be selected at maximum strength.
 	/// \param outerRadius	The outer radius, all points further from the spline than this distance
 	///						will not be selected
+	/// \param tolerance	How far the spline can be from the polyline it's sampled into before
+	///						measuring, which is roughly the most the distances can be out by
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
-		USelectionSet *SelectNearSpline(USplineComponent *spline, FTransform transform, float innerRadius = 0, float outerRadius = 100);
+		USelectionSet *SelectNearSpline(USplineComponent *spline, FTransform transform, float innerRadius = 0, float outerRadius = 100, float tolerance = 1.0f);
 
 	/// Selects vertices near a line segment with the provided start/end points.
 	///
@@ -242,6 +549,78 @@ public:
 			ECellularDistanceFunction CellularDistanceFunction = ECellularDistanceFunction::Euclidian
 		);
 
+	/// Selects vertices based on a noise function, looked up from a volume the noise has been baked into.
+	///
+	/// The first call for some noise settings bakes the noise into a 3D grid over the geometry's
+	/// bounds, and later calls with the same settings, on this geometry or any other, interpolate
+	/// from the grid rather than evaluating the noise again.  This is much faster for fractal
+	/// noise, but smooths out detail finer than the grid spacing so the result is only close to
+	/// *SelectByNoise*'s, *GetNoiseCacheError* says how close and baking logs it too.
+	///
+	/// The grid spacing comes from this geometry's bounds alone, rounded down to a power of two, and
+	/// the samples sit on multiples of it, so the result doesn't depend on what other geometries have
+	/// baked.  A small geometry outside an existing grid grows it, a large one gets its own.
+	///
+	/// The volumes are shared by every geometry, and the least recently used are dropped once they
+	/// take more than the memory budget set by *SetNoiseCacheMemoryBudget*.  If a volume wouldn't fit
+	/// in the budget this is the same as *SelectByNoise*.
+	///
+	/// \param Seed							The seed for the random number generator
+	/// \param Frequency					The frequency of the noise, the higher the value the more detail
+	/// \param NoiseInterpolation			The interpolation used to smooth between noise values
+	/// \param NoiseType					The type of noise we're using
+	/// \param FractalOctaves				The number of fractal octaves to apply
+	/// \param FractalLacunarity			Set the fractal lacunarity, the higher the value the more space the
+	///										the fractal will fill up
+	/// \param FractalGain					The strength of the fractal
+	/// \param FractalType					The type of fractal being used
+	/// \param CellularDistanceFunction		The function used to calculate the value for a given point.
+	/// \param Resolution					The least number of samples along the longest side of the geometry's bounds
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
+		USelectionSet *SelectByNoiseCached(
+			int32 Seed = 1337,
+			float Frequency = 0.01,
+			ENoiseInterpolation NoiseInterpolation = ENoiseInterpolation::Quintic,
+			ENoiseType NoiseType = ENoiseType::Simplex,
+			uint8 FractalOctaves = 3,
+			float FractalLacunarity = 2.0,
+			float FractalGain = 0.5,
+			EFractalType FractalType = EFractalType::FBM,
+			ECellularDistanceFunction CellularDistanceFunction = ECellularDistanceFunction::Euclidian,
+			int32 Resolution = 64
+		);
+
+	/// Return how far the volume *SelectByNoiseCached* samples from is from the noise, baking it if needed.
+	///
+	/// This is the largest difference found at the centres of the grid's cells, where the interpolation
+	/// is furthest from the baked samples.  It's 0 if the volume wouldn't fit in the memory budget, as
+	/// then the noise is evaluated directly.  The parameters are as *SelectByNoiseCached*.
+	///
+	/// \return The largest difference between the noise and the volume
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometry)
+		float GetNoiseCacheError(
+			int32 Seed = 1337,
+			float Frequency = 0.01,
+			ENoiseInterpolation NoiseInterpolation = ENoiseInterpolation::Quintic,
+			ENoiseType NoiseType = ENoiseType::Simplex,
+			uint8 FractalOctaves = 3,
+			float FractalLacunarity = 2.0,
+			float FractalGain = 0.5,
+			EFractalType FractalType = EFractalType::FBM,
+			ECellularDistanceFunction CellularDistanceFunction = ECellularDistanceFunction::Euclidian,
+			int32 Resolution = 64
+		);
+
+	/// Drop every noise volume baked by *SelectByNoiseCached*.
+	UFUNCTION(BlueprintCallable, Category = MeshGeometry)
+		static void ClearNoiseCache();
+
+	/// Set the most memory the noise volumes baked by *SelectByNoiseCached* can take, 64MB by default.
+	///
+	/// \param MegaBytes					The memory budget in megabytes
+	UFUNCTION(BlueprintCallable, Category = MeshGeometry)
+		static void SetNoiseCacheMemoryBudget(int32 MegaBytes = 64);
+
 	/// Select vertices from a texture.
 	///
 	/// Black in the channel = Unselected, White = Fully selected.  Uses UV0 for texture access as that's
@@ -379,4 +758,113 @@ public:
 	/// \param Selection					The SelectionSet which controls the blend between the two MeshGeometry items
 	UFUNCTION(BlueprintCallable, Category = MeshGeometry)
 		void Lerp(UMeshGeometry *TargetMeshGeometry, float Alpha = 0.0, USelectionSet *Selection = nullptr);
+
+private:
+	/// Deformations recorded by *BeginDeformationBatch* which haven't been applied yet
+	UPROPERTY()
+		FDeformationCommandList PendingDeformations;
+
+	/// Whether deformations are being recorded rather than applied immediately
+	bool bRecordingDeformations = false;
+
+	/// Cached result for *GetSectionVertexOffsets*
+	mutable TArray<int32> SectionVertexOffsets;
+
+	/// Whether *SectionVertexOffsets* is up to date
+	mutable bool bSectionVertexOffsetsValid = false;
+
+	/// The commands being executed by *ExecuteDeformationBatchAsync*, this is a UPROPERTY to
+	/// keep their SelectionSets from being garbage collected
+	UPROPERTY()
+		FDeformationCommandList AsyncDeformations;
+
+	/// The copy of the sections which *ExecuteDeformationBatchAsync* deforms
+	TArray<FSectionGeometry> AsyncBackBuffer;
+
+	/// Signals when the worker thread has finished with *AsyncBackBuffer*
+	TFuture<void> AsyncDeformationResult;
+
+	/// Whether *AsyncBackBuffer* is waiting to be swapped in
+	bool bAsyncDeformationInProgress = false;
+
+	/// Swap the finished *AsyncBackBuffer* vertices into the sections.
+	void CompleteAsyncDeformation();
+
+	/// Snapshots taken from this geometry, which may have since been destroyed
+	TArray<TWeakObjectPtr<UMeshGeometrySnapshot>> LiveSnapshots;
+
+	/// Record a deformation if we're in a batch, otherwise apply it immediately.
+	void ApplyDeformation(const FDeformationCommand &Command);
+
+	/// The change tracking for each section
+	TArray<FMeshGeometrySectionState> SectionStates;
+
+	/// The most recent version given to any attribute
+	int32 LatestVersion = 0;
+
+	/// What was last written to each *ProceduralMeshComponent* by *UpdateProceduralMeshComponent*
+	TArray<FMeshGeometryOutputState> OutputStates;
+
+	/// The grid of vertex positions used by the distance-based *Select* functions
+	FVertexGrid SpatialIndex;
+
+	/// The positions version of each section when *SpatialIndex* was built
+	TArray<int32> SpatialIndexVersions;
+
+	/// The positions version of each section when the spatial index was last asked for
+	TArray<int32> SpatialIndexRequestVersions;
+
+	/// The adjacency for *GetAdjacency*, without and with welding
+	FMeshAdjacency Adjacency[2];
+
+	/// The triangles version of each section when each adjacency was built
+	TArray<int32> AdjacencyVersions[2];
+
+	/// The section vertex offsets when each adjacency was built
+	TArray<int32> AdjacencyVertexOffsets[2];
+
+	/// Whether each adjacency has been built since *MarkTopologyChanged* was last called
+	bool bAdjacencyValid[2] = { false, false };
+
+	/// Get the positions version of each section.
+	void GetPositionsVersions(TArray<int32> &OutVersions) const;
+
+	/// Get the version of an attribute for each section.
+	void GetAttributeVersions(EMeshGeometryAttribute Attribute, TArray<int32> &OutVersions) const;
+
+	/// The selections kept for *bCacheSelections*
+	TArray<FMeshGeometryCachedSelection> CachedSelections;
+
+	/// Incremented whenever a cached selection is used, for finding the least recently used
+	int32 SelectionCacheUseCount = 0;
+
+	/// Return a SelectionSet sharing the weights of the selection made before by a *Select* function
+	/// with the same arguments if it's still valid, otherwise call *Select* and share the weights
+	/// of what it returns.  Nothing is copied either way.
+	///
+	/// \param Function			The name of the *Select* function
+	/// \param Attribute			The attribute the selection is made from
+	/// \param Arguments			The function's arguments and any settings which affect the result
+	/// \param Select				Makes the selection
+	USelectionSet *FindOrAddCachedSelection(
+		FName Function, EMeshGeometryAttribute Attribute, TArray<uint8> &&Arguments, TFunctionRef<USelectionSet *()> Select
+	);
+
+	/// Return the spatial index if it's worth using, building it if needed.
+	///
+	/// This returns nullptr when the index is turned off, the mesh is small, or the positions
+	/// haven't yet been selected from twice without changing.
+	const FVertexGrid *GetSpatialIndex();
+
+	/// Give attributes of a section a new version and mark them as dirty.
+	void MarkSectionModified(int32 SectionIndex, uint8 AttributeMask);
+
+	/// Call *PrepareSectionForWrite* for every section.
+	void PrepareAllSectionsForWrite(uint8 AttributeMask);
+
+	/// Give every snapshot which doesn't have its own copy of the attributes of a section a copy.
+	///
+	/// If *bMoveData* is set the data is moved out of the section rather than copied, which is
+	/// used when the section is about to be thrown away.
+	void CaptureSectionForSnapshots(int32 SectionIndex, uint8 AttributeMask, bool bMoveData);
 };
@@ -0,0 +1,80 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include "UObject/NoExportTypes.h"
+#include "SectionGeometry.h"
+#include "MeshGeometrySnapshot.generated.h"
+
+class UMeshGeometry;
+
+/// The data captured by a snapshot for a single section.
+///
+/// Each attribute is only captured when the *MeshGeometry* is about to change it, until then
+/// the pointer is null and the snapshot's data is the same as the live geometry.  Buffers are
+/// shared between all of the snapshots which captured them at the same time.
+struct FMeshGeometrySectionSnapshot
+{
+	TSharedPtr<TArray<FVector>> Vertices;
+	TSharedPtr<TArray<FVector>> Normals;
+	TSharedPtr<TArray<FProcMeshTangent>> Tangents;
+	TSharedPtr<TArray<FVector2D>> UVs;
+	TSharedPtr<TArray<FLinearColor>> VertexColors;
+	TSharedPtr<TArray<int32>> Triangles;
+};
+
+/// Call a function for each attribute with its *EMeshGeometryAttribute*, the matching member of
+/// *FSectionGeometry*, and the matching member of *FMeshGeometrySectionSnapshot*.
+///
+/// This allows code handling all of the attributes to be written once, regardless of their types.
+template <typename FunctionType>
+void ForEachSnapshotAttribute(FunctionType Function)
+{
+	Function(EMeshGeometryAttribute::Positions, &FSectionGeometry::vertices, &FMeshGeometrySectionSnapshot::Vertices);
+	Function(EMeshGeometryAttribute::Normals, &FSectionGeometry::normals, &FMeshGeometrySectionSnapshot::Normals);
+	Function(EMeshGeometryAttribute::Tangents, &FSectionGeometry::tangents, &FMeshGeometrySectionSnapshot::Tangents);
+	Function(EMeshGeometryAttribute::UVs, &FSectionGeometry::uvs, &FMeshGeometrySectionSnapshot::UVs);
+	Function(EMeshGeometryAttribute::Colors, &FSectionGeometry::vertexColors, &FMeshGeometrySectionSnapshot::VertexColors);
+	Function(EMeshGeometryAttribute::Triangles, &FSectionGeometry::triangles, &FMeshGeometrySectionSnapshot::Triangles);
+}
+
+/// A checkpoint of a *MeshGeometry* which it can later be restored to.
+///
+/// Taking a snapshot doesn't copy any of the geometry.  Instead the *MeshGeometry* keeps track of
+/// its snapshots and copies a section's data into them just before that data is changed, so only
+/// sections which are actually modified are ever copied.  Restoring moves the copied data back
+/// into the geometry where possible.
+///
+/// A snapshot can only be restored to the *MeshGeometry* it was taken from.
+///
+/// \see MeshGeometry::Snapshot
+/// \see MeshGeometry::Restore
+UCLASS(BlueprintType)
+class PROCEDURALTOOLKIT_API UMeshGeometrySnapshot : public UObject
+{
+	GENERATED_BODY()
+
+	friend class UMeshGeometry;
+
+public:
+	/// Return the *MeshGeometry* this snapshot was taken from.
+	///
+	/// \return The source geometry, or *nullptr* if it no longer exists
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometrySnapshot)
+		UMeshGeometry *GetSourceGeometry() const;
+
+	/// Return the number of section attributes which have been copied into this snapshot.
+	///
+	/// This is mainly for debug purposes, a fresh snapshot will return zero.
+	///
+	/// \return The number of captured attribute buffers
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = MeshGeometrySnapshot)
+		int32 GetCapturedAttributeCount() const;
+
+private:
+	/// The geometry the snapshot was taken from
+	TWeakObjectPtr<UMeshGeometry> SourceGeometry;
+
+	/// The data captured for each section the geometry had when the snapshot was taken
+	TArray<FMeshGeometrySectionSnapshot> Sections;
+};
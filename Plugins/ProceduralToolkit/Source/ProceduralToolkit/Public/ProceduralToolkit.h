@@ -19,4 +19,8 @@ public:
 
 	/// Called when the module is removed from memory
 	virtual void ShutdownModule() override;
+
+private:
+	/// The end of frame callback trimming the SelectionSet weight pool
+	FDelegateHandle TrimWeightPoolHandle;
 };
\ No newline at end of file
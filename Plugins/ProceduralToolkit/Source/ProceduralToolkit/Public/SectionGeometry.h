@@ -5,6 +5,32 @@
 #include "ProceduralMeshComponent.h"	// Needed for FProcMeshTangent
 #include "SectionGeometry.generated.h"
 
+/// The different kinds of data stored for each section of geometry.
+///
+/// These are used to track which parts of the geometry have been changed, with sets of them being
+/// stored as a bitmask built with *GetAttributeMask*.
+UENUM(BlueprintType)
+enum class EMeshGeometryAttribute : uint8 {
+	Positions			UMETA(DisplayName = "Positions"),
+	Normals				UMETA(DisplayName = "Normals"),
+	Tangents			UMETA(DisplayName = "Tangents"),
+	UVs					UMETA(DisplayName = "UVs"),
+	Colors				UMETA(DisplayName = "Colors"),
+	Triangles			UMETA(DisplayName = "Triangles")
+};
+
+/// The number of values in *EMeshGeometryAttribute*
+static const int32 MeshGeometryAttributeCount = 6;
+
+/// A mask with every *EMeshGeometryAttribute* set
+static const uint8 AllMeshGeometryAttributes = (1 << MeshGeometryAttributeCount) - 1;
+
+/// Get the bit for an attribute within an attribute mask.
+inline uint8 GetAttributeMask(EMeshGeometryAttribute Attribute)
+{
+	return 1 << (uint8)Attribute;
+}
+
 /// This struct stores all of the data for a single section of geometry
 /// and is basically all of the results from *UKismetProceduralMeshLibrary::GetSectionFromStaticMesh*,
 /// or passed into *ProceduralMeshComponent::CreateMeshSection_LinearColor*,
@@ -51,4 +77,19 @@ struct FSectionGeometry {
 		tangents = TArray<FProcMeshTangent>();
 		vertexColors = TArray<FLinearColor>();
 	}
-};
\ No newline at end of file
+};
+
+// The kernels in the toolkit work on tightly packed XYZ floats, which is exactly how a TArray<FVector> is stored.
+static_assert(sizeof(FVector) == 3 * sizeof(float), "FVector is expected to be three packed floats");
+
+/// Get the raw XYZ float data for an array of vectors, such as *vertices* or *normals*.
+inline float *GetVectorArrayData(TArray<FVector> &Vectors)
+{
+	return reinterpret_cast<float *>(Vectors.GetData());
+}
+
+/// Get the raw XYZ float data for an array of vectors, such as *vertices* or *normals*.
+inline const float *GetVectorArrayData(const TArray<FVector> &Vectors)
+{
+	return reinterpret_cast<const float *>(Vectors.GetData());
+}
@@ -4,8 +4,77 @@
 
 #include "UObject/NoExportTypes.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "ToolkitCore/WeightExpression.h"
 #include "SelectionSet.generated.h"
 
+/// How the weights of a SelectionSet are stored, see *USelectionSet::Quantize*.
+UENUM(BlueprintType)
+enum class ESelectionSetPrecision : uint8
+{
+	/// A float for each weight
+	Float,
+
+	/// 16 bits for each weight, spread evenly over the range of the weights
+	UInt16,
+
+	/// 8 bits for each weight, spread evenly over the range of the weights
+	UInt8
+};
+
+/// The statistics of the weights of a SelectionSet, see *USelectionSet::GetStatistics*.
+USTRUCT(BlueprintType)
+struct PROCEDURALTOOLKIT_API FSelectionSetStatistics
+{
+	GENERATED_BODY()
+
+	/// The smallest weight, 0 for an empty set
+	UPROPERTY(BlueprintReadOnly, Category = SelectionSet)
+		float Min = 0.0f;
+
+	/// The largest weight, 0 for an empty set
+	UPROPERTY(BlueprintReadOnly, Category = SelectionSet)
+		float Max = 0.0f;
+
+	/// The total of the weights
+	UPROPERTY(BlueprintReadOnly, Category = SelectionSet)
+		float Sum = 0.0f;
+
+	/// The average weight, 0 for an empty set
+	UPROPERTY(BlueprintReadOnly, Category = SelectionSet)
+		float Mean = 0.0f;
+
+	/// The number of weights which aren't 0
+	UPROPERTY(BlueprintReadOnly, Category = SelectionSet)
+		int32 NonZeroCount = 0;
+
+	/// The number of weights
+	UPROPERTY(BlueprintReadOnly, Category = SelectionSet)
+		int32 Count = 0;
+};
+
+/// The weights of a SelectionSet moved out of it so that other SelectionSets can read them too,
+/// see *USelectionSet::Share*.
+///
+/// Nothing changes these while they're shared.  A set about to change its weights takes them
+/// back first, copying them unless no other set is using them.
+struct PROCEDURALTOOLKIT_API FSelectionSetSharedWeights
+{
+	/// Give the arrays back to the pool.
+	~FSelectionSetSharedWeights();
+
+	bool bSparse = false;
+	int32 SparseSize = 0;
+	ESelectionSetPrecision Precision = ESelectionSetPrecision::Float;
+	float QuantizedMin = 0.0f;
+	float QuantizedStep = 0.0f;
+	TArray<float> Weights;
+	TArray<int32> SparseIndices;
+	TArray<float> SparseWeights;
+	TArray<uint8> QuantizedWeights;
+};
+
+typedef TSharedPtr<FSelectionSetSharedWeights> FSelectionSetSharedWeightsPtr;
+
 /// This stores a set of weightings for a selection set.
 ///
 /// The initial use for this is to provide the vertex weightins for *MeshGeometry*, but
@@ -14,6 +83,34 @@
 /// The *SelectionSetBPLibrary* contains a lot of helper functions for this which allow
 /// selection sets to be modified.
 ///
+/// A set can also be sparse, storing only the weights which aren't zero as sorted index and
+/// weight pairs, which keeps selections of a small part of a large mesh small.  These are only
+/// produced when asked for with *UMeshGeometry::bProduceSparseSelections*.  The transforms and
+/// the *SelectionSetBPLibrary* work with sparse sets directly, anything else that needs the
+/// *weights* array should call *EnsureDense* first.
+///
+/// A set can also be deferred, which is what the *SelectionSetBPLibrary* returns when
+/// *SetDeferredEvaluation* is on.  A deferred set holds the expression its weights come from
+/// rather than the weights, and evaluates it in a single pass the first time a transform or
+/// *EnsureDense* needs them.  The sets it reads are captured when the expression is built, by
+/// sharing their weights, so modifying them in between doesn't change the result.
+///
+/// A dense set can also be quantized, storing each weight in 8 or 16 bits rather than a float.
+/// The transforms, the *SelectionSetBPLibrary*, and deferred sets read quantized weights
+/// directly, turning them back into floats as they're loaded.
+///
+/// A set can also share its weights with other sets, which is how *UMeshGeometry* hands out the
+/// selections it caches without copying them.  Reading a shared set reads the shared weights,
+/// and the first change made to it copies them so the change is its own.
+///
+/// The memory for the weights comes from a pool shared by every SelectionSet, and goes back to
+/// it when the set is destroyed or emptied, so SelectionSets created and thrown away over and
+/// over reuse the same memory.  See *SetWeightPoolMemoryBudget*.
+///
+/// Every change made through the functions here gives the set a new *Revision*, so anything
+/// holding on to a set can tell whether it's been modified since.  Anything writing to *weights*
+/// directly should call *MarkModified* after.
+///
 /// \todo Add a Type enum to allow SelectionSets to be used for more than just vertices.
 /// \todo Add a method to check the type/weight count so that we can check if a SelectionSet
 ///       can be used
@@ -25,8 +122,182 @@ class PROCEDURALTOOLKIT_API USelectionSet : public UObject
 	
 public:
 	/// The weights this set contains.
+	///
+	/// This is empty while the set is sparse, deferred, quantized, or shared, see *EnsureDense*.
 	UPROPERTY(BlueprintReadWrite, Category = SelectionSet)
 		TArray<float> weights;
+
+	/// Return the number of weights in the set, whether it's sparse or not.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = SelectionSet)
+		int32 Num() const;
+
+	/// Return *True* if the set is storing only its non-zero weights.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = SelectionSet)
+		bool IsSparse() const;
+
+	/// Make sure *weights* holds every weight, evaluating a deferred set, converting a sparse or
+	/// quantized set, or copying the weights of a shared set if needed.
+	///
+	/// This should be called before reading or writing *weights* directly on a set which might
+	/// be sparse, deferred, quantized, or shared.
+	UFUNCTION(BlueprintCallable, Category = SelectionSet)
+		USelectionSet *EnsureDense();
+
+	/// Return the number of times the set has been modified.
+	///
+	/// This changes whenever the weights do, so comparing it with a previously stored revision
+	/// shows whether the set has changed since.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = SelectionSet)
+		int32 GetRevision() const;
+
+	/// Give the set a new *Revision*, which needs calling after writing to *weights* directly.
+	///
+	/// \return The set, for chaining
+	UFUNCTION(BlueprintCallable, Category = SelectionSet)
+		USelectionSet *MarkModified();
+
+	/// Return *True* if the set's weights are an expression which hasn't been evaluated yet.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = SelectionSet)
+		bool IsDeferred() const;
+
+	/// Evaluate a deferred set's expression into *weights*, leaving it dense.  This does nothing
+	/// to a set which isn't deferred.
+	///
+	/// \return The set, for chaining
+	UFUNCTION(BlueprintCallable, Category = SelectionSet)
+		USelectionSet *Evaluate();
+
+	/// Change how the weights of a dense set are stored, saving memory at the cost of precision.
+	///
+	/// Quantized weights are stored as 8 or 16 bit codes spread evenly between the smallest and
+	/// largest weights, taking a quarter or a half of the memory of floats.  8 bits is accurate to
+	/// within 1/510 of that range, which is plenty for weights blending a deformation.  A sparse
+	/// set already only stores the weights it needs and is left as it is, and *Float* turns a
+	/// quantized set back into floats.
+	///
+	/// \param InPrecision		How to store the weights
+	/// \return The set, for chaining
+	UFUNCTION(BlueprintCallable, Category = SelectionSet)
+		USelectionSet *Quantize(ESelectionSetPrecision InPrecision = ESelectionSetPrecision::UInt8);
+
+	/// Return how the set's weights are stored.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = SelectionSet)
+		ESelectionSetPrecision GetPrecision() const;
+
+	/// Return *True* if the set is reading weights it shares with other sets, see *Share*.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = SelectionSet)
+		bool IsShared() const;
+
+	/// Move the weights out of the set so that other sets can share them, see *SetShared*.
+	///
+	/// Nothing is copied, the set goes on reading the same weights from where they've been moved
+	/// to until it's next changed.  A deferred set is evaluated first, and a set which is already
+	/// shared returns the weights it's sharing.
+	///
+	/// \return The weights, which mustn't be changed
+	FSelectionSetSharedWeightsPtr Share();
+
+	/// Make this a set reading shared weights, replacing anything it held before.
+	///
+	/// \param Weights		The weights, from *Share*
+	void SetShared(const FSelectionSetSharedWeightsPtr &Weights);
+
+	/// Return the weights of a dense set, which may be quantized.  The set can't be sparse or
+	/// deferred.
+	FWeightStream GetWeightStream() const;
+
+	/// Return the smallest and largest weights of a quantized set, which are the weights its
+	/// lowest and highest codes stand for.
+	void GetQuantizedRange(float &OutMin, float &OutMax) const;
+
+	/// Return the smallest, largest, total, and average weights of the set, and how many aren't 0.
+	///
+	/// These are found in a single pass over the weights, split across threads for large sets.
+	/// For a sparse, quantized, or shared set they're kept until the set's *Revision* changes, so
+	/// asking again for an unmodified set is free, but *weights* can be written to directly so a
+	/// dense set of its own is always searched again.  A deferred set is evaluated first, and a sparse set's zeros
+	/// count without being expanded.
+	const FSelectionSetStatistics &GetStatistics();
+
+	/// Make this a deferred set, replacing anything it held before.
+	///
+	/// \param Expression		The expression for the weights, whose sources are the SelectionSets it reads
+	/// \param References		The SelectionSets and anything else the expression reads, kept alive until it's evaluated
+	void SetDeferred(FWeightExpression::FPtr Expression, TArray<UObject *> &&References);
+
+	/// Return the expression of a deferred set.
+	const FWeightExpression::FPtr &GetDeferredExpression() const
+	{
+		return DeferredExpression;
+	}
+
+	/// Return everything the expression of a deferred set reads.
+	const TArray<UObject *> &GetDeferredReferences() const
+	{
+		return DeferredReferences;
+	}
+
+	/// Make this a copy of another set, replacing anything it held before.  The weights are
+	/// copied as they're stored, so a sparse, quantized, or deferred set stays that way, and the
+	/// weights of a shared set are shared rather than copied.
+	///
+	/// \param Source			The set to copy, which can't be this set
+	void CopyFrom(const USelectionSet *Source);
+
+	/// Make this a sparse set, replacing anything it held before.
+	///
+	/// \param Size			The number of weights the set represents
+	/// \param Indices		The indices of the weights which are stored, in increasing order
+	/// \param Weights		The weight for each of *Indices*, with every other weight being zero
+	void SetSparse(int32 Size, TArray<int32> &&Indices, TArray<float> &&Weights);
+
+	/// Make this a dense set of *Size* weights, replacing anything it held before, and return the
+	/// weights for the caller to fill in.
+	///
+	/// Memory the set already has is kept rather than freed, so a set written over again and
+	/// again doesn't allocate once it's big enough, and otherwise the memory comes from the pool.
+	/// Unless the set is growing the weights it already had stay as they were, which lets a dense
+	/// set be written over in place.
+	///
+	/// \return The first of *Size* weights
+	float *ResetDense(int32 Size);
+
+	/// Make this a sparse set storing *Count* weights, replacing anything it held before, for the
+	/// caller to fill in.  As with *ResetDense* the set's memory is reused and what a sparse set
+	/// already stored stays as it was, unless it's growing.
+	///
+	/// \param Size			The number of weights the set represents
+	/// \param Count			The number of weights stored
+	/// \param OutIndices		Where to write the indices of the stored weights, in increasing order
+	/// \param OutWeights		Where to write the stored weights
+	void ResetSparse(int32 Size, int32 Count, int32 *&OutIndices, float *&OutWeights);
+
+	/// Return the indices of the stored weights of a sparse set, in increasing order.
+	const TArray<int32> &GetSparseIndices() const
+	{
+		return SharedWeights.IsValid() ? SharedWeights->SparseIndices : SparseIndices;
+	}
+
+	/// Return the stored weights of a sparse set, matching *GetSparseIndices*.
+	const TArray<float> &GetSparseWeights() const
+	{
+		return SharedWeights.IsValid() ? SharedWeights->SparseWeights : SparseWeights;
+	}
+
+	/// Find the stored weights of a sparse set which fall within a range of indices.
+	///
+	/// \param FirstIndex		The first index of the range
+	/// \param Count			The number of indices in the range
+	/// \param OutBegin			The position of the first stored weight in the range
+	/// \param OutEnd			The position after the last stored weight in the range
+	void GetSparseRange(int32 FirstIndex, int32 Count, int32 &OutBegin, int32 &OutEnd) const;
+
+	/// Return every weight, using *Scratch* to expand a sparse or quantized set without changing
+	/// it.  The set can't be deferred.
+	///
+	/// \param Scratch			Storage for the expanded weights, only used if the set is sparse or quantized
+	/// \return The first of *Num* weights
+	const float *GetDenseWeights(TArray<float> &Scratch) const;
 	
 	/// Creates a selection set of the size provided with zero weights.
 	/// \param size			The number of items in the selection set
@@ -53,4 +324,89 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = SelectionSet)
 		USelectionSet *RandomizeWeights(FRandomStream randomStream, float minWeight = 0, float maxWeight = 1);
+
+	/// Set the most memory the pool of weight arrays kept for reuse can take, 64MB by default.
+	///
+	/// \param MegaBytes			The memory budget in megabytes
+	UFUNCTION(BlueprintCallable, Category = SelectionSet)
+		static void SetWeightPoolMemoryBudget(int32 MegaBytes = 64);
+
+	/// Free every weight array kept for reuse.
+	UFUNCTION(BlueprintCallable, Category = SelectionSet)
+		static void EmptyWeightPool();
+
+	/// Give the weights back to the pool.
+	virtual void BeginDestroy() override;
+
+private:
+	/// Take back the weights of a shared set, so it can change them without changing any other set's.
+	void Unshare();
+
+	/// Return the weights of a dense set, its own or the ones it shares.
+	const TArray<float> &GetStoredWeights() const
+	{
+		return SharedWeights.IsValid() ? SharedWeights->Weights : weights;
+	}
+
+	/// Return the codes of a quantized set, its own or the ones it shares.
+	const TArray<uint8> &GetQuantizedCodes() const
+	{
+		return SharedWeights.IsValid() ? SharedWeights->QuantizedWeights : QuantizedWeights;
+	}
+
+	/// Incremented by *MarkModified*
+	int32 Revision = 0;
+
+	/// Whether the set is sparse, in which case the weights are in *SparseIndices* and *SparseWeights*
+	UPROPERTY()
+		bool bSparse = false;
+
+	/// The number of weights a sparse set represents
+	UPROPERTY()
+		int32 SparseSize = 0;
+
+	/// The indices of the stored weights of a sparse set, in increasing order
+	UPROPERTY()
+		TArray<int32> SparseIndices;
+
+	/// The stored weights of a sparse set
+	UPROPERTY()
+		TArray<float> SparseWeights;
+
+	/// How the weights of a dense set are stored, with the codes being in *QuantizedWeights*
+	/// unless this is *Float*
+	UPROPERTY()
+		ESelectionSetPrecision Precision = ESelectionSetPrecision::Float;
+
+	/// The codes of a quantized set, one or two bytes for each weight
+	UPROPERTY()
+		TArray<uint8> QuantizedWeights;
+
+	/// The weight a code of zero stands for
+	UPROPERTY()
+		float QuantizedMin = 0.0f;
+
+	/// The difference in weight between one code and the next
+	UPROPERTY()
+		float QuantizedStep = 0.0f;
+
+	/// The expression the weights of a deferred set come from, or null if the set isn't deferred
+	FWeightExpression::FPtr DeferredExpression;
+
+	/// The weights a shared set reads in place of *weights*, *SparseIndices*, *SparseWeights* and
+	/// *QuantizedWeights*, or null if the set isn't shared.  The other members describing the
+	/// weights are kept the same as the shared ones.
+	FSelectionSetSharedWeightsPtr SharedWeights;
+
+	/// The statistics *GetStatistics* last found, which are for the weights at *StatisticsRevision*
+	FSelectionSetStatistics Statistics;
+
+	/// The *Revision* *Statistics* were found at, if *bStatisticsValid*
+	int32 StatisticsRevision = 0;
+
+	bool bStatisticsValid = false;
+
+	/// The objects *DeferredExpression* reads, so they aren't garbage collected before it's evaluated
+	UPROPERTY()
+		TArray<UObject *> DeferredReferences;
 };
@@ -13,6 +13,17 @@
 /// These methods are designed to return modified values of SelectionSets rather than
 /// change the values provided to them.
 ///
+/// Each of them also has an *Into* version which writes the result to a SelectionSet provided
+/// rather than a new one, which can be one of its inputs.  Memory the output set already has is
+/// reused, so math run every frame into the same sets doesn't create any objects or allocate
+/// once they're big enough.  These always work out the weights straight away.
+///
+/// With *SetDeferredEvaluation* on they don't work out any weights at all, they return deferred
+/// SelectionSets recording what to do instead.  A graph of these nodes then becomes a single
+/// expression, evaluated in one pass with no intermediate weight arrays when a transform uses
+/// the result, see *USelectionSet::IsDeferred*.  *Randomize* is always evaluated straight away,
+/// and *RemapToRange* evaluates its input to find its range.
+///
 /// \todo RemapToRange - Set an absolute min/max and remap based on them, useful for the noise functions
 UCLASS()
 class PROCEDURALTOOLKIT_API USelectionSetBPLibrary : public UBlueprintFunctionLibrary
@@ -20,6 +31,25 @@ class PROCEDURALTOOLKIT_API USelectionSetBPLibrary : public UBlueprintFunctionLi
 	GENERATED_BODY()
 	
 public:
+	/// **Math|SelectionSet|Set Deferred Evaluation**: Choose whether the SelectionSet math nodes return deferred SelectionSets.
+	///
+	/// This is off by default.  Deep graphs of nodes are faster with it on, as they're evaluated
+	/// in a single pass.  The SelectionSets they read are captured when the nodes run, sharing
+	/// their weights rather than copying them, so modifying one afterwards doesn't change the
+	/// result.  Only then are its weights copied, see *USelectionSet::Share*.
+	///
+	/// \param bDeferred	Whether to defer evaluation
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Set Deferred Evaluation", Category = "Math|SelectionSet")
+	)
+		static void SetDeferredEvaluation(bool bDeferred);
+
+	/// **Math|SelectionSet|Is Deferred Evaluation Enabled**: Return whether the SelectionSet math nodes return deferred SelectionSets.
+	UFUNCTION(BlueprintPure,
+		meta = (DisplayName = "Is Deferred Evaluation Enabled", Category = "Math|SelectionSet")
+	)
+		static bool IsDeferredEvaluationEnabled();
+
 	/// **Math|SelectionSet|Clamp (SelectionSet)**: Clamp all values i7n the set to the minimum and maximum provided.
 	///
 	/// \param Value	The SelectionSet to clamp
@@ -31,6 +61,15 @@ public:
 	)
 		static USelectionSet *Clamp(USelectionSet *Value, float Min=0, float Max=1);
 
+	/// **Math|SelectionSet|Clamp (SelectionSet) Into**: As *Clamp (SelectionSet)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Clamp (SelectionSet) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *ClampInto(USelectionSet *Value, USelectionSet *Output, float Min=0, float Max=1);
+
 	/// **Math|SelectionSet|Ease (SelectionSet)**: Apply an easing function to all values in SelectionSet
 	///
 	/// \param Value		The SelectionSet to apply the easing function to
@@ -42,6 +81,15 @@ public:
 		meta = (DisplayName = "Ease (SelectionSet)", Category = "Math|SelectionSet")
 	)
 		static USelectionSet *Ease(USelectionSet *Value, EEasingFunc::Type EaseFunction = EEasingFunc::Linear, int32 Steps = 2, float BlendExp = 2.0f);
+
+	/// **Math|SelectionSet|Ease (SelectionSet) Into**: As *Ease (SelectionSet)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Ease (SelectionSet) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *EaseInto(USelectionSet *Value, USelectionSet *Output, EEasingFunc::Type EaseFunction = EEasingFunc::Linear, int32 Steps = 2, float BlendExp = 2.0f);
 	
 	/// **Math|SelectionSet|SelectionSet + SelectionSet**: Add two SelectionSets together
 	///
@@ -54,6 +102,15 @@ public:
 	)
 		static USelectionSet *Add_SelectionSets(USelectionSet *A, USelectionSet *B);
 
+	/// **Math|SelectionSet|SelectionSet + SelectionSet Into**: As *SelectionSet + SelectionSet*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *A* or *B* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "SelectionSet + SelectionSet Into", Keywords = "+ add plus", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Add_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output);
+
 	/// **Math|SelectionSet|SelectionSet - SelectionSet**: Subtract one SelectionSet from another
 	///
 	/// \param A			The SelectionSet to subtract from (*A*-B)
@@ -65,6 +122,15 @@ public:
 	)
 		static USelectionSet *Subtract_SelectionSets(USelectionSet *A, USelectionSet *B);
 
+	/// **Math|SelectionSet|SelectionSet - SelectionSet Into**: As *SelectionSet - SelectionSet*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *A* or *B* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "SelectionSet - SelectionSet Into", Keywords = "+ add plus", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Subtract_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output);
+
 	/// **Math|SelectionSet|SelectionSet + Float**: Add a constant Float to all values of a SelectionSet
 	///
 	/// \param Value		The SelectionSet to add the constant to (*Value* + Float)
@@ -76,6 +142,15 @@ public:
 	)
 		static USelectionSet *Add_FloatToSelectionSet(USelectionSet *Value, float Float=0);
 
+	/// **Math|SelectionSet|SelectionSet + Float Into**: As *SelectionSet + Float*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "SelectionSet + Float Into", Keywords = "+ add plus", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Add_FloatToSelectionSetInto(USelectionSet *Value, USelectionSet *Output, float Float=0);
+
 	/// **Math|SelectionSet|SelectionSet - float**: Subtract a constant Float from all values of a SelectionSet
 	///
 	/// \param Value		The SelectionSet to subtract the constant from (*Value* - Float)
@@ -87,6 +162,15 @@ public:
 	)
 		static USelectionSet *Subtract_FloatFromSelectionSet(USelectionSet *Value, float Float=0);
 
+	/// **Math|SelectionSet|SelectionSet - Float Into**: As *SelectionSet - Float*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "SelectionSet - Float Into", Keywords = "- subtract minus", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Subtract_FloatFromSelectionSetInto(USelectionSet *Value, USelectionSet *Output, float Float=0);
+
 	/// **Math|SelectionSet|Float - SelectionSet**: Subtract the values of a SelectionSet from a constant Float
 	///
 	/// \param Float		The Float to subtract the SelectionSet from (*Float* - Value)
@@ -98,6 +182,15 @@ public:
 	)
 		static USelectionSet *Subtract_SelectionSetFromFloat(float Float, USelectionSet *Value);
 
+	/// **Math|SelectionSet|Float - SelectionSet Into**: As *Float - SelectionSet*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Float - SelectionSet Into", Keywords = "+ add plus", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Subtract_SelectionSetFromFloatInto(float Float, USelectionSet *Value, USelectionSet *Output);
+
 	/// **Math|SelectionSet|SelectionSet \* SelectionSet**: Multiplies the values of two SelectionSets
 	///
 	/// \param A			The first SelectionSet to multiply (*A*\*B)
@@ -109,6 +202,15 @@ public:
 	)
 		static USelectionSet *Multiply_SelectionSets(USelectionSet *A, USelectionSet *B);
 
+	/// **Math|SelectionSet|SelectionSet * SelectionSet Into**: As *SelectionSet * SelectionSet*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *A* or *B* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "SelectionSet * SelectionSet Into", Keywords = "* multiply", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Multiply_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output);
+
 	/// **Math|SelectionSet|SelectionSet * Float**: Multiplies the values of a SelectionSet by a Float
 	///
 	/// \param Value		The SelectionSet to multiply by the float (*Value* \* Float)
@@ -120,6 +222,15 @@ public:
 	)
 		static USelectionSet *Multiply_SelctionSetByFloat(USelectionSet *Value, float Float=1);
 
+	/// **Math|SelectionSet|SelectionSet * Float Into**: As *SelectionSet * Float*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "SelectionSet * Float Into", Keywords = "* multiply", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Multiply_SelectionSetByFloatInto(USelectionSet *Value, USelectionSet *Output, float Float=1);
+
 	/// **Math|SelectionSet|SelectionSet / SelectionSet**: Divides the values from one SelectionSet by those of another
 	///
 	/// \param A			The SelectionSet to divide
@@ -131,6 +242,15 @@ public:
 	)
 		static USelectionSet *Divide_SelectionSets(USelectionSet *A, USelectionSet *B);
 
+	/// **Math|SelectionSet|SelectionSet / SelectionSet Into**: As *SelectionSet / SelectionSet*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *A* or *B* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "SelectionSet / SelectionSet Into", Keywords = "/ divide division", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Divide_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output);
+
 	/// **Math|SelectionSet|SelectionSet / Float**: Divides the values from a SelectionSet by a Float
 	///
 	/// \param Value			The SelectionSet to divide (*A*/B)
@@ -142,6 +262,15 @@ public:
 	)
 		static USelectionSet *Divide_SelctionSetByFloat(USelectionSet *Value, float Float = 1);
 
+	/// **Math|SelectionSet|SelectionSet / Float Into**: As *SelectionSet / Float*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "SelectionSet / Float Into", Keywords = "/ divide division", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Divide_SelectionSetByFloatInto(USelectionSet *Value, USelectionSet *Output, float Float = 1);
+
 
 	/// **Math|SelectionSet|OneMinus**: Returns a SelectionSet with values 1- those of another SelectionSet
 	///
@@ -154,6 +283,15 @@ public:
 	)
 		static USelectionSet *OneMinus(USelectionSet *Value);
 
+	/// **Math|SelectionSet|OneMinus (SelectionSet) Into**: As *OneMinus (SelectionSet)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "OneMinus (SelectionSet) Into", Keywords = "oneminus minus - negate", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *OneMinusInto(USelectionSet *Value, USelectionSet *Output);
+
 	/// **Math|SelectionSet|Set**: Set all values of a SelectionSet to the same Float
 	///
 	/// This can be used to create new SelectionSets to be combined with the original, and will
@@ -168,6 +306,15 @@ public:
 	)
 		static USelectionSet *Set(USelectionSet *Value, float Float=0);
 
+	/// **Math|SelectionSet|Set (SelectionSet) Into**: As *Set (SelectionSet)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Set (SelectionSet) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *SetInto(USelectionSet *Value, USelectionSet *Output, float Float=0);
+
 	/// **Math|SelectionSet|Randomize**: Randomizes a SelectionSet's values between two limits
 	///
 	/// \param Value		The source SelectionSet
@@ -180,6 +327,15 @@ public:
 	)
 		static USelectionSet *Randomize(USelectionSet *Value, FRandomStream RandomStream, float Min=0, float Max=1);
 
+	/// **Math|SelectionSet|Randomize (SelectionSet) Into**: As *Randomize (SelectionSet)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Randomize (SelectionSet) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *RandomizeInto(USelectionSet *Value, USelectionSet *Output, FRandomStream RandomStream, float Min=0, float Max=1);
+
 	/// **Math|SelectionSet|Max (SelectionSet, SelectionSet)**: Return the maximum value from two SelectionSets
 	///
 	/// This can be used to combine two SelectionSets with the 'highest' value for height map manipulation and so on.
@@ -192,6 +348,15 @@ public:
 	)
 		static USelectionSet *Max_SelectionSets(USelectionSet *A, USelectionSet *B);
 
+	/// **Math|SelectionSet|Max (SelectionSet, SelectionSet) Into**: As *Max (SelectionSet, SelectionSet)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *A* or *B* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Max (SelectionSet, SelectionSet) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Max_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output);
+
 	/// **Math|SelectionSet|Min (SelectionSet, SelectionSet)**: Return the minimum value from two SelectionSets
 	///
 	/// This can be used to combine two SelectionSets with the 'lowest' value for height map manipulation and so on.
@@ -204,6 +369,15 @@ public:
 	)
 		static USelectionSet *Min_SelectionSets(USelectionSet *A, USelectionSet *B);
 
+	/// **Math|SelectionSet|Min (SelectionSet, SelectionSet) Into**: As *Min (SelectionSet, SelectionSet)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *A* or *B* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Min (SelectionSet, SelectionSet) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Min_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output);
+
 	/// **Math|SelectionSet|Max (Float)**: Return the maximum of a SelectionSet and a Float
 	///
 	/// This can be viewed as the 'bottom half' of a clamp, making sure all values of a SelectionSet
@@ -217,6 +391,15 @@ public:
 	)
 		static USelectionSet *Max_SelectionSetAgainstFloat(USelectionSet *Value, float Float);
 
+	/// **Math|SelectionSet|Max (SelectionSet, Float) Into**: As *Max (SelectionSet, Float)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Max (SelectionSet, Float) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Max_SelectionSetAgainstFloatInto(USelectionSet *Value, USelectionSet *Output, float Float);
+
 
 	/// **Math|SelectionSet|Min (Float)**: Return the minimum of a SelectionSet and a Float
 	///
@@ -231,6 +414,15 @@ public:
 	)
 		static USelectionSet *Min_SelectionSetAgainstFloat(USelectionSet *Value, float Float);
 
+	/// **Math|SelectionSet|Min (SelectionSet, Float) Into**: As *Min (SelectionSet, Float)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Min (SelectionSet, Float) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Min_SelectionSetAgainstFloatInto(USelectionSet *Value, USelectionSet *Output, float Float);
+
 	/// **Math|SelectionSet|Lerp(SelectionSet)**: Apply a lerp to blend two SelectionSets together
 	///
 	/// \param A		The first SelectionSet to apply the lerp to
@@ -241,6 +433,15 @@ public:
 	)
 		static USelectionSet *Lerp_SelectionSets(USelectionSet *A, USelectionSet *B, float Alpha=0);
 
+	/// **Math|SelectionSet|Lerp (SelectionSet) Into**: As *Lerp (SelectionSet)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *A* or *B* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Lerp (SelectionSet) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Lerp_SelectionSetsInto(USelectionSet *A, USelectionSet *B, USelectionSet *Output, float Alpha=0);
+
 	/// **Math|SelectionSet|Lerp(SelectionSet, Float)**: Apply a lerp to blend a SelectionSet against a Float
 	///
 	/// \param Value	The first SelectionSet to apply the lerp to
@@ -252,11 +453,24 @@ public:
 	)
 		static USelectionSet *Lerp_SelectionSetWithFloat(USelectionSet *Value, float Float, float Alpha = 0);
 
+	/// **Math|SelectionSet|Lerp (SelectionSet, Float) Into**: As *Lerp (SelectionSet, Float)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Lerp (SelectionSet, Float) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Lerp_SelectionSetWithFloatInto(USelectionSet *Value, USelectionSet *Output, float Float, float Alpha = 0);
+
 	/// **Math|SelectionSet|RemapToCurve(SelectionSet, Curve)**: Remap the values of a SelectionSet to a CurveFloat
 	///
 	/// The remap will return the T=0 value of the Curve for Weight=0, and the T=Max value of the Curve for Weight=1,
 	/// and values in between will be suitably scaled.
 	///
+	/// The Curve is baked into a table of evenly spaced samples the first time it's used, and again
+	/// whenever its keys change, and weights from 0 to 1 are looked up in the table rather than the
+	/// Curve.  See *SetCurveLookupResolution* and *GetCurveLookupError*.
+	///
 	/// \param Value	The SelectionSet to apply the remap to
 	/// \param Curve	The CurveFloat to shape the remap
 	/// \return The result of the SelectionSet remapped to the Curve
@@ -265,6 +479,38 @@ public:
 	)
 		static USelectionSet *Remap_SelectionSetToCurve(USelectionSet *Value, UCurveFloat *Curve);
 
+	/// **Math|SelectionSet|RemapToCurve (SelectionSet, Curve) Into**: As *RemapToCurve (SelectionSet, Curve)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "RemapToCurve (SelectionSet, Curve) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Remap_SelectionSetToCurveInto(USelectionSet *Value, USelectionSet *Output, UCurveFloat *Curve);
+
+	/// **Math|SelectionSet|Set Curve Lookup Resolution**: Set the number of samples *RemapToCurve* bakes Curves into.
+	///
+	/// More samples follow sharp features of a Curve more closely for a little more memory, the
+	/// lookups themselves cost the same.  Curves already baked are baked again when next used.
+	///
+	/// \param Resolution	The number of samples, 1024 by default, or 0 to read the Curves directly
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "Set Curve Lookup Resolution", Category = "Math|SelectionSet")
+	)
+		static void SetCurveLookupResolution(int32 Resolution = 1024);
+
+	/// **Math|SelectionSet|Get Curve Lookup Error**: Return how far *RemapToCurve*'s table for a Curve is from the Curve.
+	///
+	/// This is the largest difference found between the table and the Curve at points between the
+	/// samples, baking the table if it hasn't been already.
+	///
+	/// \param Curve	The CurveFloat
+	/// \return			The largest difference, or 0 if the lookups are off or there's no Curve
+	UFUNCTION(BlueprintPure,
+		meta = (DisplayName = "Get Curve Lookup Error", Category = "Math|SelectionSet")
+	)
+		static float GetCurveLookupError(UCurveFloat *Curve);
+
 	/// **Math|SelectionSetRemapToRange(SelectionSet, float, float)**: Remaps all of the values between a new min/max
 	///
 	/// This goes through all of the weightings in the SelectionSet and remaps the lowest one to Min, the highest one
@@ -273,6 +519,9 @@ public:
 	/// This can be useful when dealing with SelectionSets from noise functions and other such effects where there's
 	/// no guarantee to the range, and remap it to 0-1 ready for use.
 	///
+	/// The range comes from *Get Selection Statistics*, so remapping the same unmodified SelectionSet again
+	/// doesn't need to search it.
+	///
 	/// \param Value	The SelectionSet to remap
 	///	\param Min		The minimum value to remap to
 	/// \param Max		The maximum value to remap to
@@ -281,4 +530,24 @@ public:
 		meta = (DisplayName = "RemapToRange (SelectionSet, float, float)", Category = "Math|SelectionSet")
 	)
 		static USelectionSet *Remap_Range(USelectionSet *Value, float Min = 0.0f, float Max = 1.0f);
+
+	/// **Math|SelectionSet|RemapToRange (SelectionSet, float, float) Into**: As *RemapToRange (SelectionSet, float, float)*, writing the result to an existing SelectionSet.
+	///
+	/// \param Output	The SelectionSet to write the result to, which can be *Value* to change it in place
+	/// \return			*Output*, or a new SelectionSet if *Output* isn't provided
+	UFUNCTION(BlueprintCallable,
+		meta = (DisplayName = "RemapToRange (SelectionSet, float, float) Into", Category = "Math|SelectionSet")
+	)
+		static USelectionSet *Remap_RangeInto(USelectionSet *Value, USelectionSet *Output, float Min = 0.0f, float Max = 1.0f);
+
+	/// **Math|SelectionSet|Get Selection Statistics**: Return the smallest, largest, total, and average weights of a SelectionSet, and how many aren't 0.
+	///
+	/// These are kept on sparse and quantized SelectionSets until they're modified, see *USelectionSet::GetStatistics*.
+	///
+	/// \param Value	The SelectionSet
+	/// \return			Its statistics, or all zeros if there's no SelectionSet
+	UFUNCTION(BlueprintPure,
+		meta = (DisplayName = "Get Selection Statistics", Category = "Math|SelectionSet")
+	)
+		static FSelectionSetStatistics GetSelectionStatistics(USelectionSet *Value);
 };
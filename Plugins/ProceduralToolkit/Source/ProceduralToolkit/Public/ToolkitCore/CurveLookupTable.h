@@ -0,0 +1,60 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/// A curve from 0 to 1 baked into a table of evenly spaced samples, which is then looked up with
+/// linear interpolation.
+///
+/// Looking up the table costs the same whatever the curve, so it's far cheaper than finding the
+/// keys either side of each weight and interpolating them.  The result is an approximation which
+/// cuts the corners of detail finer than the spacing of the samples, *GetMaxError* says by how much.
+///
+/// This is part of the toolkit's engine-free core.
+class FCurveLookupTable
+{
+public:
+	/// Sample a curve into the table, replacing anything it held before, and measure how far the
+	/// table is from the curve between the samples.
+	///
+	/// \param Evaluate			Returns the curve's value for a weight from 0 to 1
+	/// \param Resolution		The number of samples, at least 2
+	void Bake(const std::function<float(float Alpha)> &Evaluate, int Resolution);
+
+	/// Return the number of samples in the table, or 0 if it hasn't been baked.
+	int GetResolution() const
+	{
+		return (int)(Entries.size() / 2);
+	}
+
+	/// Return the furthest the table was from the curve at the points checked between the
+	/// samples, a quarter, half, and three quarters of the way between each pair.
+	float GetMaxError() const
+	{
+		return MaxError;
+	}
+
+	/// Return the number of bytes the table takes.
+	size_t GetMemorySize() const
+	{
+		return Entries.size() * sizeof(float);
+	}
+
+	/// Look up the curve for weights.  Weights outside 0 to 1, and NaNs, get the value at the
+	/// nearest end of the table, so the caller needs to handle those if the curve carries on.
+	///
+	/// \param Values			The weights to look up
+	/// \param Count			The number of weights
+	/// \param Out				The curve's value for each weight, which may be the same array as *Values*
+	void Sample(const float *Values, int Count, float *Out) const;
+
+private:
+	/// Each sample followed by the difference to the next one, so a lookup reads a single pair.
+	/// The last sample's difference is zero.
+	std::vector<float> Entries;
+
+	float MaxError = 0.0f;
+};
@@ -0,0 +1,155 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/// Which vertices and triangles each vertex of a mesh is connected to, stored in compressed
+/// sparse rows: the entries for vertex *V* run from *Offsets[V]* to *Offsets[V + 1]*.
+///
+/// Vertices are numbered across every section in turn, as they are for the weights of a
+/// SelectionSet, and triangles likewise.  Each row is sorted and has no repeats.
+///
+/// A mesh split along UV seams has several vertices at the same position, which aren't connected
+/// by any triangle.  Built with welding, vertices with exactly the same position are treated as
+/// one, so smoothing or growing a selection carries across the seams.  The vertex with the lowest
+/// index at each position stands in for the rest: rows list the welded vertices by these, and
+/// every vertex in a group has the group's row.
+///
+/// This is part of the toolkit's engine-free core.  It's a copy of the connectivity, so it needs
+/// rebuilding whenever the triangles change.
+class FMeshAdjacency
+{
+public:
+	/// The triangles and positions of one section.
+	struct FSource
+	{
+		/// Three vertex indices for each triangle, within the section
+		const int *Triangles;
+
+		int TriangleCount;
+
+		/// XYZ triples, only read when welding
+		const float *Positions;
+
+		int VertexCount;
+	};
+
+	/// Runs *TaskCount* tasks, which may be in parallel, and returns once they've all finished.
+	typedef std::function<void(int TaskCount, const std::function<void(int Task)> &Task)> FParallelFor;
+
+	/// Build the adjacency, replacing anything it held before.
+	///
+	/// Triangles with an index outside of their section are left out, and a triangle with two
+	/// corners on the same vertex only counts once for it.
+	///
+	/// \param Sources			The sections
+	/// \param SourceCount		The number of sections
+	/// \param bWeld			Whether to treat vertices with exactly the same position as one
+	/// \param ParallelFor		Runs the tasks the build is split into, or null to run them in turn
+	void Build(const FSource *Sources, int SourceCount, bool bWeld, const FParallelFor &ParallelFor = nullptr);
+
+	/// Empty the adjacency and free its memory.
+	void Reset();
+
+	/// Return the number of vertices, across every section.
+	int GetVertexCount() const
+	{
+		return (int)Representatives.size();
+	}
+
+	/// Return the number of triangles, across every section.
+	int GetTriangleCount() const
+	{
+		return TriangleCount;
+	}
+
+	/// Return whether this was built with welding.
+	bool IsWelded() const
+	{
+		return bWelded;
+	}
+
+	/// Return the vertex standing in for a vertex's welded group, which is the vertex itself
+	/// without welding or if no other vertex shares its position.
+	int GetRepresentative(int Vertex) const
+	{
+		return Representatives[Vertex];
+	}
+
+	/// Return the vertices sharing an edge with a vertex, through *OutNeighbours*.
+	///
+	/// \return The number of neighbours
+	int GetVertexNeighbours(int Vertex, const int *&OutNeighbours) const
+	{
+		const int Row = Representatives[Vertex];
+		OutNeighbours = VertexNeighbours.data() + VertexNeighbourOffsets[Row];
+		return VertexNeighbourOffsets[Row + 1] - VertexNeighbourOffsets[Row];
+	}
+
+	/// Return the triangles using a vertex, through *OutTriangles*.
+	///
+	/// \return The number of triangles
+	int GetVertexTriangles(int Vertex, const int *&OutTriangles) const
+	{
+		const int Row = Representatives[Vertex];
+		OutTriangles = VertexTriangles.data() + VertexTriangleOffsets[Row];
+		return VertexTriangleOffsets[Row + 1] - VertexTriangleOffsets[Row];
+	}
+
+	/// Return the vertices welded together with a vertex, including itself, through *OutCopies*.
+	/// Without welding that's just the vertex itself.
+	///
+	/// \return The number of vertices in the group
+	int GetWeldedCopies(int Vertex, const int *&OutCopies) const;
+
+	/// Return the rows of vertex neighbours, with one more offset than there are vertices.  The
+	/// rows of welded vertices which aren't the representative of their group are empty.
+	const std::vector<int> &GetVertexNeighbourOffsets() const
+	{
+		return VertexNeighbourOffsets;
+	}
+
+	const std::vector<int> &GetVertexNeighbourIndices() const
+	{
+		return VertexNeighbours;
+	}
+
+	/// Return the rows of vertex triangles, laid out as *GetVertexNeighbourOffsets*.
+	const std::vector<int> &GetVertexTriangleOffsets() const
+	{
+		return VertexTriangleOffsets;
+	}
+
+	const std::vector<int> &GetVertexTriangleIndices() const
+	{
+		return VertexTriangles;
+	}
+
+	/// Return the number of bytes the adjacency takes.
+	size_t GetMemorySize() const;
+
+private:
+	/// Find the representative of every vertex.
+	void Weld(const FSource *Sources, int SourceCount, const std::vector<int> &FirstVertices);
+
+	bool bWelded = false;
+
+	int TriangleCount = 0;
+
+	/// The vertex standing in for each vertex's welded group
+	std::vector<int> Representatives;
+
+	/// The vertices of each welded group, by representative, in the same layout as the rows.
+	/// This is empty without welding.
+	std::vector<int> WeldedCopyOffsets;
+	std::vector<int> WeldedCopies;
+
+	std::vector<int> VertexNeighbourOffsets;
+	std::vector<int> VertexNeighbours;
+
+	std::vector<int> VertexTriangleOffsets;
+	std::vector<int> VertexTriangles;
+};
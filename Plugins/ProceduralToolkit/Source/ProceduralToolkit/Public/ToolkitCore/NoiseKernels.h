@@ -0,0 +1,107 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+/// Vectorised versions of FastNoise's Value, Perlin, Simplex and Cubic noise and their fractals,
+/// which evaluate 4 or 8 points at once and are used by *FastNoise::FillNoise*.
+///
+/// There's an SSE2, AVX2 and NEON version, and the best one the CPU supports is picked at
+/// runtime.  Each one does the same floating point operations in the same order as FastNoise's
+/// scalar code, so the results match it to within *Tolerance*.  On x86 they're identical, the
+/// tolerance allows for compilers which fuse multiplies and adds differently on other platforms.
+///
+/// This is part of the toolkit's engine-free core.
+namespace NoiseKernels
+{
+	/// The largest difference from FastNoise's scalar results expected, for noise in the range -1 to 1.
+	const float Tolerance = 1.0e-5f;
+
+	/// The ways of evaluating several points at once, with *Scalar* being one at a time
+	enum class EInstructionSet : unsigned char
+	{
+		Scalar,
+		SSE2,
+		AVX2,
+		NEON
+	};
+
+	/// Return the best instruction set the CPU running this supports.  The CPU is only checked once.
+	EInstructionSet GetSupportedInstructionSet();
+
+	/// Return whether the CPU running this supports an instruction set.
+	bool IsSupported(EInstructionSet InstructionSet);
+
+	/// Return the name of an instruction set, for logging.
+	const char *GetInstructionSetName(EInstructionSet InstructionSet);
+
+	/// The noise to evaluate, copied from a FastNoise along with pointers to its tables.
+	struct FNoiseSettings
+	{
+		enum class ENoise : unsigned char
+		{
+			Value,
+			Perlin,
+			Simplex,
+			Cubic
+		};
+
+		enum class EFractal : unsigned char
+		{
+			None,
+			FBM,
+			Billow,
+			RigidMulti
+		};
+
+		enum class EInterp : unsigned char
+		{
+			Linear,
+			Hermite,
+			Quintic
+		};
+
+		ENoise Noise;
+		EFractal Fractal;
+		EInterp Interp;
+
+		float Frequency;
+		int Octaves;
+		float Lacunarity;
+		float Gain;
+		float FractalBounding;
+
+		/// The permutation tables, 512 entries each
+		const unsigned char *Perm;
+		const unsigned char *Perm12;
+
+		/// The 256 values Value and Cubic noise pick from
+		const float *ValueLUT;
+
+		/// The 12 gradients for 2D and 3D noise
+		const float *GradX;
+		const float *GradY;
+		const float *GradZ;
+
+		/// The 32 gradients for 4D noise as XYZW
+		const float *Grad4D;
+
+		/// The 4D Simplex lookup table of 256 entries
+		const unsigned char *Simplex4D;
+	};
+
+	/// Evaluate noise for a batch of points, as FastNoise's *GetNoise* or 4D *GetSimplex* would.
+	///
+	/// \param InstructionSet		The instruction set to use, *Scalar* isn't handled here
+	/// \param Settings				The noise to evaluate
+	/// \param Dimensions			2, 3 or 4, with 4 only supported for Simplex noise without a fractal
+	/// \param Coordinates			The arrays for each axis, as many as *Dimensions*
+	/// \param Stride				How far apart each point's coordinates are in the arrays, 3 for XYZ triples
+	/// \param Count				The number of points
+	/// \param Output				The noise for each point
+	/// \return False without writing anything if the instruction set isn't supported, or the
+	///			settings aren't handled, so the caller needs to evaluate the points itself
+	bool FillNoise(
+		EInstructionSet InstructionSet, const FNoiseSettings &Settings, int Dimensions, const float *const Coordinates[4],
+		int Stride, int Count, float *Output
+	);
+}
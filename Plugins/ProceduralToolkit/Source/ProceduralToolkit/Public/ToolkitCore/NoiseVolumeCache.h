@@ -0,0 +1,190 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class FastNoise;
+
+/// Noise baked into a 3D grid over a box, which is then looked up with trilinear interpolation.
+///
+/// Sampling the grid costs the same whatever the noise, so for fractal noise with several
+/// octaves it's far cheaper than evaluating the noise again.  The result is an approximation
+/// which smooths out detail finer than the grid spacing, *MeasureError* says by how much.
+///
+/// Samples are always on whole multiples of the spacing, so two grids with the same spacing have
+/// the same samples where they overlap and give the same result for any position both cover.
+///
+/// This is part of the toolkit's engine-free core.
+class FNoiseVolume
+{
+public:
+	/// Return the spacing giving at least *Resolution* samples along the longest side of a box,
+	/// rounded down to a power of two.  This only depends on the box, so the grid for a box is
+	/// the same whatever other grids have been made before it.
+	static float ChooseSpacing(const float BoxMin[3], const float BoxMax[3], int Resolution);
+
+	/// Size the grid to cover a box with samples *Spacing* apart along every axis.  The values
+	/// are left to *BakeSlice*.
+	///
+	/// \return False if the box is inverted or isn't finite, or the grid would take more than *MaxMemorySize* bytes
+	bool Allocate(const float BoxMin[3], const float BoxMax[3], float Spacing, size_t MaxMemorySize);
+
+	/// Return the number of bytes a grid covering a box would take, or *SIZE_MAX* if it can't
+	/// be allocated at all.
+	static size_t GetMemorySize(const float BoxMin[3], const float BoxMax[3], float Spacing);
+
+	/// Return the number of slices along Z, each of which can be baked on its own thread.
+	int GetSliceCount() const
+	{
+		return Dimensions[2];
+	}
+
+	/// Evaluate the noise for one slice of the grid.  *Noise* is only read, so the slices can
+	/// be baked in parallel from the same FastNoise.
+	void BakeSlice(FastNoise &Noise, int Slice);
+
+	/// Return whether a box is entirely inside the grid.
+	bool Contains(const float BoxMin[3], const float BoxMax[3]) const;
+
+	/// Look up the noise for positions.  Positions outside the grid get the value at its edge.
+	///
+	/// \param Positions		Count XYZ triples
+	/// \param Count			The number of positions
+	/// \param OutWeights		The noise for each position
+	void Sample(const float *Positions, int Count, float *OutWeights) const;
+
+	/// Return the box the grid covers.
+	void GetBounds(float OutMin[3], float OutMax[3]) const;
+
+	/// Return the distance between samples.
+	float GetSpacing() const
+	{
+		return Spacing;
+	}
+
+	/// Find how far the baked grid is from the noise, comparing them at the centres of up to
+	/// 16 cells along each axis, which is where interpolation strays furthest from the samples.
+	void MeasureError(FastNoise &Noise);
+
+	/// Return the largest difference *MeasureError* found.
+	float GetMaxError() const
+	{
+		return MaxError;
+	}
+
+	/// Return the number of samples along an axis.
+	int GetDimension(int Axis) const
+	{
+		return Dimensions[Axis];
+	}
+
+	/// Return the number of bytes the grid takes, once allocated.
+	size_t GetMemorySize() const
+	{
+		return (size_t)Dimensions[0] * Dimensions[1] * Dimensions[2] * sizeof(float);
+	}
+
+	/// Grow a box to contain positions, for finding the box to bake over.
+	static void ExpandBounds(const float *Positions, int Count, float InOutMin[3], float InOutMax[3]);
+
+private:
+	/// Find the samples covering a box, as whole multiples of the spacing.
+	///
+	/// \return False if the box is inverted or isn't finite, or is too far from the origin for the spacing
+	static bool FindSamples(const float BoxMin[3], const float BoxMax[3], float Spacing, int OutFirst[3], int OutDimensions[3]);
+
+	/// The position of the first sample, which is *FirstSample* times *Spacing*
+	float Origin[3] = { 0.0f, 0.0f, 0.0f };
+
+	/// The multiple of the spacing the first sample is at
+	int FirstSample[3] = { 0, 0, 0 };
+
+	/// The distance between samples along every axis
+	float Spacing = 1.0f;
+
+	/// The number of samples along each axis, at least 2
+	int Dimensions[3] = { 0, 0, 0 };
+
+	/// The samples, with X varying fastest and then Y
+	std::vector<float> Values;
+
+	/// The largest difference *MeasureError* found
+	float MaxError = 0.0f;
+};
+
+/// Baked noise volumes kept between queries, so noise with the same settings selected over and
+/// over, on one mesh or many, is only baked once.
+///
+/// Volumes are found by a key for the noise settings and their spacing, which comes from the box
+/// being queried and never changes once a volume is baked.  A query outside every volume with
+/// its spacing grows one of them to cover both boxes, as long as it stays under a quarter of
+/// the budget, and otherwise bakes a new volume over just its own box.  Either way the spacing
+/// is the same, so a query gets the same result whichever volume answers it.  Once the volumes
+/// take more than the memory budget the least recently used ones are dropped.
+///
+/// This is thread-safe, and volumes which are dropped stay alive until nothing is using them.
+class FNoiseVolumeCache
+{
+public:
+	explicit FNoiseVolumeCache(size_t InMemoryBudget = 64 * 1024 * 1024)
+		: MemoryBudget(InMemoryBudget)
+	{
+	}
+
+	/// Find the volume for some settings covering a box, marking it as recently used.
+	///
+	/// \param Key				The hash of the noise settings, see *HashBytes*
+	/// \param Spacing			The spacing of the volume, see *FNoiseVolume::ChooseSpacing*
+	/// \param BoxMin			The minimum corner of the box to cover
+	/// \param BoxMax			The maximum corner of the box to cover
+	/// \param OutBakeMin		If there's no volume covering the box, the minimum corner to bake a new one over
+	/// \param OutBakeMax		If there's no volume covering the box, the maximum corner to bake a new one over
+	/// \return The volume, or null if it needs baking and passing to *Add*
+	std::shared_ptr<const FNoiseVolume> Find(
+		uint64_t Key, float Spacing, const float BoxMin[3], const float BoxMax[3], float OutBakeMin[3], float OutBakeMax[3]
+	);
+
+	/// Add a newly baked volume, replacing any for the same key and spacing which it covers, and
+	/// drop the least recently used volumes until the rest fit in the budget.
+	///
+	/// \return False if the volume is bigger than the whole budget, in which case it isn't kept
+	bool Add(uint64_t Key, std::shared_ptr<const FNoiseVolume> Volume);
+
+	/// Drop every volume.
+	void Clear();
+
+	/// Set the most memory the volumes can take, dropping volumes if they now take more.
+	void SetMemoryBudget(size_t InMemoryBudget);
+
+	size_t GetMemoryBudget() const;
+
+	/// Return the memory taken by the volumes being kept.
+	size_t GetMemoryUsed() const;
+
+	/// Return a 64-bit FNV-1a hash of some bytes, for making keys from noise settings.
+	static uint64_t HashBytes(const void *Data, size_t Size, uint64_t Hash = 14695981039346656037ull);
+
+private:
+	struct FEntry
+	{
+		uint64_t Key;
+		std::shared_ptr<const FNoiseVolume> Volume;
+
+		/// The value of *UseCounter* when this was last used
+		uint64_t LastUsed;
+	};
+
+	/// Drop the least recently used entries until the rest fit in the budget.  Called with *Mutex* held.
+	void Trim();
+
+	mutable std::mutex Mutex;
+	std::vector<FEntry> Entries;
+	size_t MemoryBudget;
+	size_t MemoryUsed = 0;
+	uint64_t UseCounter = 0;
+};
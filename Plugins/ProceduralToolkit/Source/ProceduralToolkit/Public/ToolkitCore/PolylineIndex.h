@@ -0,0 +1,88 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+/// A polyline with a bounding volume hierarchy over its segments, used to find the closest
+/// point on a curve such as a spline without searching the whole curve.
+///
+/// The curve is sampled once with *SampleCurve*, then each query walks down the hierarchy and
+/// skips any group of segments whose bounding box is further away than the best point so far.
+///
+/// This is part of the toolkit's engine-free core.
+class FPolylineIndex
+{
+public:
+	/// Sample a curve into a polyline, adding points until it stays within *Tolerance* of the curve.
+	///
+	/// Each span between two breaks is split in half until the curve's midpoint and quarter
+	/// points are all within *Tolerance* of the straight segment, or until it's been split
+	/// *MaxDepth* times.  The breaks are always sampled, so corners at them are kept.
+	///
+	/// \param Evaluate			Writes the curve's position for a parameter, such as distance along a spline
+	/// \param Breaks			The parameters to split the curve at, in increasing order
+	/// \param BreakCount		The number of breaks, at least 2
+	/// \param Tolerance		The furthest the polyline should be from the curve
+	/// \param MaxDepth			The most times a span between two breaks can be split
+	/// \param OutPoints		The sampled points as XYZ triples
+	static void SampleCurve(
+		const std::function<void(float Parameter, float OutPoint[3])> &Evaluate, const float *Breaks, int BreakCount,
+		float Tolerance, int MaxDepth, std::vector<float> &OutPoints
+	);
+
+	/// Build the hierarchy over a polyline, replacing anything it held before.
+	///
+	/// \param Points			The points of the polyline as XYZ triples
+	/// \param PointCount		The number of points, a single point is treated as a segment of zero length
+	void Build(const float *Points, int PointCount);
+
+	/// Return the number of segments in the polyline.
+	int GetSegmentCount() const
+	{
+		return (int)Segments.size();
+	}
+
+	/// Find the closest point on the polyline to a point, if it's within a distance of it.
+	///
+	/// \param Point				The point to search from
+	/// \param MaxDistance			How far to search, parts of the polyline further away than
+	///								this are skipped.  This can be infinite.
+	/// \param OutClosest			The closest point on the polyline
+	/// \param InOutSegmentHint		The segment to try first, which is updated to the one the
+	///								closest point is on.  Passing the result of a query for a
+	///								nearby point speeds up the search.
+	/// \return False if no part of the polyline is within *MaxDistance*, or it's empty
+	bool FindClosestPoint(const float Point[3], float MaxDistance, float OutClosest[3], int &InOutSegmentHint) const;
+
+private:
+	/// A segment of the polyline
+	struct FSegment
+	{
+		float Start[3];
+		float End[3];
+	};
+
+	/// A node of the hierarchy, with its children stored after it
+	struct FNode
+	{
+		float BoundsMin[3];
+		float BoundsMax[3];
+
+		/// For a leaf the index of the first segment in *Segments*, otherwise the index of the second child
+		int Index;
+
+		/// For a leaf the number of segments, otherwise 0
+		int SegmentCount;
+	};
+
+	/// Build the node for a range of *Segments*, sorting them as needed, and return its index.
+	int BuildNode(int First, int Count, int Depth);
+
+	/// The segments, sorted so that each leaf's are together
+	std::vector<FSegment> Segments;
+
+	/// The nodes, with the root first
+	std::vector<FNode> Nodes;
+};
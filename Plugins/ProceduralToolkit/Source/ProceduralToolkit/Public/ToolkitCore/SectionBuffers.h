@@ -0,0 +1,53 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/// The data for a single section of geometry, stored in plain arrays.
+///
+/// This is the engine-free equivalent of *FSectionGeometry* for code built without the engine,
+/// such as the plugin's standalone CMake project.  Vectors are stored as tightly packed XYZ
+/// floats and UVs as packed UV pairs, which is the layout the kernels in *ToolkitCore* work on
+/// and the same as the memory of the *FSectionGeometry* arrays.
+struct FSectionBuffers
+{
+	/// The vertex positions, as XYZ triples
+	std::vector<float> Positions;
+
+	/// The vertex normals as XYZ triples, either empty or one for each vertex
+	std::vector<float> Normals;
+
+	/// The vertex UVs as UV pairs, either empty or one for each vertex
+	std::vector<float> UVs;
+
+	/// The triangles, as three vertex indices each
+	std::vector<int> Triangles;
+
+	/// Return the number of vertices in the section.
+	int GetVertexCount() const
+	{
+		return (int)(Positions.size() / 3);
+	}
+
+	/// Return the number of triangles in the section.
+	int GetTriangleCount() const
+	{
+		return (int)(Triangles.size() / 3);
+	}
+};
+
+/// Calculate the index of the first vertex of each section across all of the sections, with a
+/// final entry for the total vertex count.
+///
+/// This matches *UMeshGeometry::GetSectionVertexOffsets*, and gives the index of each section's
+/// first weight in a selection covering all of the sections.
+inline void GetSectionVertexOffsets(const std::vector<FSectionBuffers> &Sections, std::vector<int> &OutOffsets)
+{
+	OutOffsets.resize(Sections.size() + 1);
+	OutOffsets[0] = 0;
+	for (size_t SectionIndex = 0; SectionIndex < Sections.size(); ++SectionIndex) {
+		OutOffsets[SectionIndex + 1] = OutOffsets[SectionIndex] + Sections[SectionIndex].GetVertexCount();
+	}
+}
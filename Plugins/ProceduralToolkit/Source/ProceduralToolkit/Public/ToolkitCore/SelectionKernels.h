@@ -0,0 +1,155 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include <vector>
+
+class FastNoise;
+class FPolylineIndex;
+class FVertexGrid;
+
+/// Kernels which calculate the weights for the *Select* functions of *MeshGeometry*.
+///
+/// Like *VertexKernels* these work on tightly packed XYZ floats and don't depend on the engine,
+/// so they're part of the toolkit's core and are built by the plugin's standalone CMake project.
+/// *MeshGeometry* splits its vertices into chunks and calls these for each chunk.
+///
+/// Each kernel writes one weight per vertex to *OutWeights*, in the range 0-1 unless stated.
+namespace SelectionKernels
+{
+	/// Weight vertices by their distance from a point.
+	///
+	/// Vertices within *InnerRadius* get a weight of 1, those beyond *OuterRadius* get 0, and
+	/// those between fall off linearly.
+	///
+	/// \param Positions		Count XYZ triples
+	/// \param Count			The number of vertices
+	/// \param Center			The point to measure distance from
+	/// \param InnerRadius		The distance within which vertices are fully selected
+	/// \param OuterRadius		The distance beyond which vertices are unselected
+	/// \param OutWeights		Count weights to write
+	void SelectNear(const float *Positions, int Count, const float Center[3], float InnerRadius, float OuterRadius, float *OutWeights);
+
+	/// Weight vertices by their distance from a line, with the same falloff as *SelectNear*.
+	///
+	/// \param Positions		Count XYZ triples
+	/// \param Count			The number of vertices
+	/// \param LineStart		The start of the line
+	/// \param LineEnd			The end of the line
+	/// \param bLineIsInfinite	Whether the line continues past its start and end points
+	/// \param InnerRadius		The distance within which vertices are fully selected
+	/// \param OuterRadius		The distance beyond which vertices are unselected
+	/// \param OutWeights		Count weights to write
+	void SelectNearLine(
+		const float *Positions, int Count, const float LineStart[3], const float LineEnd[3], bool bLineIsInfinite,
+		float InnerRadius, float OuterRadius, float *OutWeights
+	);
+
+	/// Weight vertices by their distance from a polyline, such as a sampled spline, with the same
+	/// falloff as *SelectNear*.
+	///
+	/// The closest point is searched for from each vertex transformed by *QueryMatrix*, which puts
+	/// it in the polyline's space, but the distance is measured from the untransformed vertex.
+	/// When the two spaces match pass a null matrix.
+	///
+	/// \param Polyline		The polyline to measure distance from
+	/// \param Positions		Count XYZ triples
+	/// \param Count			The number of vertices
+	/// \param QueryMatrix		A 3x4 row-major matrix from vertex space to the polyline's, or null
+	/// \param InnerRadius		The distance within which vertices are fully selected
+	/// \param OuterRadius		The distance beyond which vertices are unselected
+	/// \param OutWeights		Count weights to write
+	void SelectNearPolyline(
+		const FPolylineIndex &Polyline, const float *Positions, int Count, const float *QueryMatrix,
+		float InnerRadius, float OuterRadius, float *OutWeights
+	);
+
+	/// Weight vertices by the angle between their normal and a direction.
+	///
+	/// Normals which can't be normalized get a weight of 0.
+	///
+	/// \param Normals				Count XYZ triples
+	/// \param Count				The number of vertices
+	/// \param Facing				The direction to compare against, which must be normalized
+	/// \param InnerRadiusInDegrees	The angle within which vertices are fully selected
+	/// \param OuterRadiusInDegrees	The angle beyond which vertices are unselected
+	/// \param OutWeights			Count weights to write
+	void SelectFacing(
+		const float *Normals, int Count, const float Facing[3], float InnerRadiusInDegrees, float OuterRadiusInDegrees,
+		float *OutWeights
+	);
+
+	/// Weight vertices by how far along a line they are, from 0 at the start to 1 at the end.
+	///
+	/// The line should be at least 0.1 units long.
+	///
+	/// \param Positions		Count XYZ triples
+	/// \param Count			The number of vertices
+	/// \param LineStart		The start of the line
+	/// \param LineEnd			The end of the line
+	/// \param bLimitToLine		Whether vertices beyond the end of the line get a weight of 0 rather than 1
+	/// \param OutWeights		Count weights to write
+	void SelectLinear(
+		const float *Positions, int Count, const float LineStart[3], const float LineEnd[3], bool bLimitToLine,
+		float *OutWeights
+	);
+
+	/// Weight vertices by sampling 3D noise at their positions.
+	///
+	/// The weights are the raw noise values, which are roughly in the range -1 to 1.  *Noise* is
+	/// only read so the same object can be used by several threads at once.
+	///
+	/// \param Noise			The configured noise generator
+	/// \param Positions		Count XYZ triples
+	/// \param Count			The number of vertices
+	/// \param OutWeights		Count weights to write
+	void SelectByNoise(FastNoise &Noise, const float *Positions, int Count, float *OutWeights);
+
+	/// *SelectNear*, but only visiting the vertices in the grid cells within *OuterRadius* of the point.
+	///
+	/// Every other weight is set to 0 in bulk.  The grid's vertex indices must cover 0 to the
+	/// number of vertices in the grid minus one, and that's the number of weights written.
+	///
+	/// This returns false without writing anything when using the grid wouldn't help, such as when
+	/// the radii mean every vertex has some weight or the query covers most of the grid, and the
+	/// caller should use the plain version instead.
+	///
+	/// \param Grid			The grid over the vertex positions
+	/// \param Center			The point to measure distance from
+	/// \param InnerRadius		The distance within which vertices are fully selected
+	/// \param OuterRadius		The distance beyond which vertices are unselected
+	/// \param OutWeights		A weight per vertex in the grid
+	bool SelectNear(const FVertexGrid &Grid, const float Center[3], float InnerRadius, float OuterRadius, float *OutWeights);
+
+	/// The grid version of *SelectNear*, only returning the weights which aren't zero.
+	///
+	/// \param OutIndices		The indices of the vertices with weight, in increasing order
+	/// \param OutWeights		The weight of each of *OutIndices*
+	bool SelectNear(
+		const FVertexGrid &Grid, const float Center[3], float InnerRadius, float OuterRadius,
+		std::vector<int> &OutIndices, std::vector<float> &OutWeights
+	);
+
+	/// *SelectNearLine* for a line which isn't infinite, using the grid in the same way as the
+	/// grid version of *SelectNear*.
+	///
+	/// \param Grid			The grid over the vertex positions
+	/// \param LineStart		The start of the line
+	/// \param LineEnd			The end of the line
+	/// \param InnerRadius		The distance within which vertices are fully selected
+	/// \param OuterRadius		The distance beyond which vertices are unselected
+	/// \param OutWeights		A weight per vertex in the grid
+	bool SelectNearLine(
+		const FVertexGrid &Grid, const float LineStart[3], const float LineEnd[3], float InnerRadius, float OuterRadius,
+		float *OutWeights
+	);
+
+	/// The grid version of *SelectNearLine*, only returning the weights which aren't zero.
+	///
+	/// \param OutIndices		The indices of the vertices with weight, in increasing order
+	/// \param OutWeights		The weight of each of *OutIndices*
+	bool SelectNearLine(
+		const FVertexGrid &Grid, const float LineStart[3], const float LineEnd[3], float InnerRadius, float OuterRadius,
+		std::vector<int> &OutIndices, std::vector<float> &OutWeights
+	);
+}
@@ -0,0 +1,112 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include <vector>
+
+/// A uniform grid of cells over a set of vertex positions, used to find the vertices near a
+/// point or line without visiting every vertex.
+///
+/// The vertices are sorted by cell and each cell's positions are stored together, along with
+/// the original index of each vertex, so a query only reads the memory of the cells it touches.
+/// The cell size is picked so that there's a handful of vertices in each occupied cell.
+///
+/// This is part of the toolkit's engine-free core.  The grid is a copy of the positions, so it
+/// needs rebuilding whenever they change.
+class FVertexGrid
+{
+public:
+	/// A run of positions to add to the grid, such as the vertices of one section.
+	struct FSource
+	{
+		/// XYZ triples
+		const float *Positions;
+
+		/// The number of vertices
+		int VertexCount;
+
+		/// The index reported for the first vertex, with the rest following on
+		int FirstIndex;
+	};
+
+	/// Build the grid, replacing anything it held before.
+	///
+	/// \param Sources				The runs of positions to add
+	/// \param SourceCount			The number of runs
+	/// \param VerticesPerCell		The average number of vertices to aim for in each cell
+	void Build(const FSource *Sources, int SourceCount, int VerticesPerCell = 8);
+
+	/// Empty the grid and free its memory.
+	void Reset();
+
+	/// Return the number of vertices in the grid.
+	int GetVertexCount() const
+	{
+		return (int)SortedIndices.size();
+	}
+
+	/// Return the largest number of vertices in any one cell.
+	int GetMaxCellVertexCount() const
+	{
+		return MaxCellVertexCount;
+	}
+
+	/// Return roughly how many vertices lie in the cells overlapping a box, without visiting them.
+	///
+	/// This assumes the vertices are spread evenly through the grid's bounds, and is meant for
+	/// deciding whether a query is worth doing at all.
+	double EstimateVertexCountInBox(const float BoxMin[3], const float BoxMax[3]) const;
+
+	/// Call a function for every non-empty cell overlapping a box.
+	///
+	/// The function is passed the cell's positions as XYZ triples, the matching vertex indices,
+	/// and the number of vertices in the cell: `Function(const float *Positions, const int *Indices, int Count)`.
+	/// Vertices in those cells may be outside of the box.
+	template <typename FunctionType>
+	void ForEachCellInBox(const float BoxMin[3], const float BoxMax[3], FunctionType Function) const
+	{
+		int CellMin[3], CellMax[3];
+		if (!GetCellRange(BoxMin, BoxMax, CellMin, CellMax)) {
+			return;
+		}
+		for (int Z = CellMin[2]; Z <= CellMax[2]; ++Z) {
+			for (int Y = CellMin[1]; Y <= CellMax[1]; ++Y) {
+				// Cells along X are next to each other, so a row is one run of vertices.
+				const int RowStart = (Z * Dimensions[1] + Y) * Dimensions[0];
+				const int First = CellStarts[RowStart + CellMin[0]];
+				const int Last = CellStarts[RowStart + CellMax[0] + 1];
+				if (First < Last) {
+					Function(SortedPositions.data() + First * 3, SortedIndices.data() + First, Last - First);
+				}
+			}
+		}
+	}
+
+private:
+	/// Get the range of cells overlapping a box, returning false if it misses the grid entirely.
+	bool GetCellRange(const float BoxMin[3], const float BoxMax[3], int OutCellMin[3], int OutCellMax[3]) const;
+
+	/// The minimum corner of the grid
+	float BoundsMin[3] = { 0.0f, 0.0f, 0.0f };
+
+	/// The maximum corner of the vertices' bounds
+	float BoundsMax[3] = { 0.0f, 0.0f, 0.0f };
+
+	/// One over the length of each side of a cell
+	float InverseCellSize = 1.0f;
+
+	/// The number of cells along each axis
+	int Dimensions[3] = { 0, 0, 0 };
+
+	/// The index in *SortedIndices* of the first vertex of each cell, with a final entry for the end
+	std::vector<int> CellStarts;
+
+	/// The positions as XYZ triples, sorted by cell
+	std::vector<float> SortedPositions;
+
+	/// The index of each vertex in *SortedPositions*
+	std::vector<int> SortedIndices;
+
+	/// The size of the biggest cell
+	int MaxCellVertexCount = 0;
+};
@@ -0,0 +1,98 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include "ToolkitCore/WeightStream.h"
+
+/// SIMD kernels for the per-vertex transformations in *MeshGeometry*.
+///
+/// These work on raw float data rather than engine types so that the same code can be used
+/// by anything that stores positions as tightly packed XYZ triples, which is the layout of
+/// a `TArray<FVector>`.
+///
+/// Each kernel processes vertices four at a time.  The 12 floats of four consecutive vertices
+/// are loaded into three registers and transposed into X, Y, and Z registers, the operation is
+/// applied to all four vertices at once, and the result is transposed back and stored.  Any
+/// remaining vertices are processed with equivalent scalar code.
+///
+/// SSE2 is used on x86/x64 and NEON on ARM, with a plain scalar fallback for anything else.
+///
+/// This is part of the toolkit's core, which doesn't depend on the engine and is also built by
+/// the plugin's standalone CMake project.
+///
+/// All *Weights* parameters are one weight per vertex controlling the strength of the operation,
+/// and can be *nullptr* to apply the operation at full strength.  Quantized weights are turned
+/// back into floats four at a time as they're loaded.
+namespace VertexKernels
+{
+	/// Move positions by a constant delta.
+	///
+	/// \param Positions		Count XYZ triples, modified in place
+	/// \param Count			The number of vertices
+	/// \param Delta			The XYZ offset to apply
+	/// \param Weights			Optional per-vertex weights
+	void Translate(float *Positions, int Count, const float Delta[3], FWeightStream Weights);
+
+	/// Apply an affine transformation to positions.
+	///
+	/// The matrix is stored as three rows of four floats, so the transformed X is
+	/// `Matrix[0]*X + Matrix[1]*Y + Matrix[2]*Z + Matrix[3]` and so on.  The weights
+	/// blend between the original and transformed positions.
+	///
+	/// \param Positions		Count XYZ triples, modified in place
+	/// \param Count			The number of vertices
+	/// \param Matrix			The 3x4 row-major matrix
+	/// \param Weights			Optional per-vertex weights
+	void Affine(float *Positions, int Count, const float Matrix[12], FWeightStream Weights);
+
+	/// Combine two affine transformations into one which applies *First* and then *Second*,
+	/// so unweighted transformations can be applied in a single pass.
+	///
+	/// \param First			The 3x4 row-major matrix applied first
+	/// \param Second			The 3x4 row-major matrix applied second
+	/// \param OutMatrix		The combined 3x4 row-major matrix, which mustn't be either input
+	void ComposeAffine(const float First[12], const float Second[12], float OutMatrix[12]);
+
+	/// Move positions along a per-vertex direction, as used by *Inflate*.
+	///
+	/// \param Positions		Count XYZ triples, modified in place
+	/// \param Directions		Count XYZ triples giving the direction for each vertex
+	/// \param Count			The number of vertices
+	/// \param Offset			The distance to move along each direction
+	/// \param Weights			Optional per-vertex weights
+	void AddScaledDirection(float *Positions, const float *Directions, int Count, float Offset, FWeightStream Weights);
+
+	/// Move positions towards the surface of a sphere.
+	///
+	/// Positions at the center of the sphere are left where they are.
+	///
+	/// \param Positions		Count XYZ triples, modified in place
+	/// \param Count			The number of vertices
+	/// \param Center			The center of the sphere
+	/// \param Radius			The radius of the sphere
+	/// \param Strength			The overall strength, multiplied by each vertex's weight
+	/// \param Weights			Optional per-vertex weights
+	void Spherize(float *Positions, int Count, const float Center[3], float Radius, float Strength, FWeightStream Weights);
+
+	/// Blend positions towards a matching set of target positions.
+	///
+	/// \param Positions		Count XYZ triples, modified in place
+	/// \param Targets			Count XYZ triples to blend towards
+	/// \param Count			The number of vertices
+	/// \param Alpha			The overall blend, multiplied by each vertex's weight
+	/// \param Weights			Optional per-vertex weights
+	void LerpTo(float *Positions, const float *Targets, int Count, float Alpha, FWeightStream Weights);
+
+	/// Rotate positions around an axis passing through a point.
+	///
+	/// The weights scale the angle of rotation, which isn't something a matrix can express, so
+	/// this kernel is scalar.
+	///
+	/// \param Positions		Count XYZ triples, modified in place
+	/// \param Count			The number of vertices
+	/// \param Center			A point on the axis of rotation
+	/// \param Axis				The direction of the axis, which must be normalized
+	/// \param AngleInDegrees	The angle to rotate by, multiplied by each vertex's weight
+	/// \param Weights			Optional per-vertex weights
+	void RotateAroundAxis(float *Positions, int Count, const float Center[3], const float Axis[3], float AngleInDegrees, FWeightStream Weights);
+}
@@ -0,0 +1,232 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include "ToolkitCore/WeightKernels.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+/// One of the per-weight operations of *WeightKernels* along with its parameters, so it can be
+/// applied straight away or recorded in a *FWeightExpression* to be applied later.
+///
+/// This is part of the toolkit's engine-free core.
+struct FWeightOperation
+{
+	enum class EType : unsigned char
+	{
+		// No inputs
+		Fill,
+
+		// One input
+		Clamp,
+		Ease,
+		AddScalar,
+		SubtractScalar,
+		SubtractFromScalar,
+		MultiplyScalar,
+		DivideScalar,
+		OneMinus,
+		MaxScalar,
+		MinScalar,
+		LerpScalar,
+		RemapRange,
+		Map,
+
+		// Two inputs
+		Add,
+		Subtract,
+		Multiply,
+		Divide,
+		Max,
+		Min,
+		Lerp
+	};
+
+	EType Type = EType::Fill;
+
+	/// The parameters, in the order the *WeightKernels* function takes them
+	float Parameters[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	/// The easing function and steps for *Ease*
+	WeightKernels::EEaseFunction EaseFunction = WeightKernels::EEaseFunction::Linear;
+	int Steps = 0;
+
+	/// The function for *Map*, which is passed an array of weights and somewhere to write the results
+	std::function<void(const float *Values, int Count, float *Out)> Function;
+
+	static FWeightOperation MakeFill(float Value);
+	static FWeightOperation MakeClamp(float Min, float Max);
+	static FWeightOperation MakeEase(WeightKernels::EEaseFunction EaseFunction, int Steps, float BlendExp);
+	static FWeightOperation MakeAddScalar(float Scalar);
+	static FWeightOperation MakeSubtractScalar(float Scalar);
+	static FWeightOperation MakeSubtractFromScalar(float Scalar);
+	static FWeightOperation MakeMultiplyScalar(float Scalar);
+	static FWeightOperation MakeDivideScalar(float Scalar);
+	static FWeightOperation MakeOneMinus();
+	static FWeightOperation MakeMaxScalar(float Scalar);
+	static FWeightOperation MakeMinScalar(float Scalar);
+	static FWeightOperation MakeLerpScalar(float Scalar, float Alpha);
+	static FWeightOperation MakeRemapRange(float CurrentMin, float CurrentMax, float NewMin, float NewMax);
+	static FWeightOperation MakeMap(std::function<void(const float *Values, int Count, float *Out)> Function);
+	static FWeightOperation MakeBinary(EType Type, float Alpha = 0.0f);
+
+	/// Return the number of arrays of weights the operation reads, 0 to 2.
+	int GetInputCount() const
+	{
+		return Type == EType::Fill ? 0 : Type < EType::Add ? 1 : 2;
+	}
+
+	/// Apply the operation to *Count* weights.  *Out* may be the same array as an input.
+	///
+	/// \param A			The first input, if the operation has one
+	/// \param B			The second input, if the operation has two
+	/// \param Count		The number of weights
+	/// \param Out			The results
+	void Apply(const float *A, const float *B, int Count, float *Out) const;
+};
+
+/// A node of an expression over arrays of weights, built up by recording operations rather than
+/// applying them.
+///
+/// Nodes are immutable and shared, so an expression using the result of another node more than
+/// once is a graph rather than a tree, and each node is only evaluated once by *FWeightProgram*.
+/// The leaves are sources, which are only identified by a pointer here and are looked up when
+/// the expression is evaluated.
+class FWeightExpression
+{
+public:
+	typedef std::shared_ptr<const FWeightExpression> FPtr;
+
+	/// Make a leaf reading the weights of a source.
+	///
+	/// \param Source		Identifies the source when evaluating, two leaves with the same source are the same weights
+	/// \param Size			The number of weights the source has
+	static FPtr MakeSource(const void *Source, int Size);
+
+	/// Make a node applying an operation to the results of other nodes.
+	///
+	/// \param Operation	The operation
+	/// \param Size			The number of weights the result has, no more than any of the inputs have
+	/// \param A			The first input, if the operation has one
+	/// \param B			The second input, if the operation has two
+	static FPtr Make(const FWeightOperation &Operation, int Size, FPtr A = nullptr, FPtr B = nullptr);
+
+	int GetSize() const
+	{
+		return Size;
+	}
+
+	const void *GetSource() const
+	{
+		return Source;
+	}
+
+	const FWeightOperation &GetOperation() const
+	{
+		return Operation;
+	}
+
+	const FPtr &GetInput(int Index) const
+	{
+		return Inputs[Index];
+	}
+
+private:
+	FWeightOperation Operation;
+	const void *Source = nullptr;
+	int Size = 0;
+	FPtr Inputs[2];
+};
+
+/// A *FWeightExpression* flattened into the order its nodes need evaluating in.
+///
+/// This evaluates the expression a chunk of weights at a time, with every node of the chunk
+/// evaluated before moving on, so the intermediate results only ever need a chunk's worth of
+/// storage each and stay in the cache.  That turns an expression of N operations from N passes
+/// over the whole array, each writing a new array, into a single pass.  The scratch chunks are
+/// shared between nodes once their results aren't needed.
+class FWeightProgram
+{
+public:
+	/// The weights of a source, either every weight or just the non-zero ones of a sparse set
+	struct FSource
+	{
+		/// Every weight, or null for a sparse source.  Quantized weights are turned back into
+		/// floats a chunk at a time.
+		FWeightStream Dense;
+
+		/// The indices of the stored weights of a sparse source, in increasing order
+		const int *SparseIndices;
+
+		/// The stored weights of a sparse source
+		const float *SparseWeights;
+
+		/// The number of stored weights of a sparse source
+		int SparseCount;
+	};
+
+	/// The number of weights each node is evaluated for at a time
+	static const int ChunkSize = 1024;
+
+	explicit FWeightProgram(const FWeightExpression::FPtr &Root);
+
+	/// Return the number of weights the expression gives.
+	int GetSize() const
+	{
+		return Size;
+	}
+
+	/// Return the sources the expression reads, which *Evaluate* needs the weights of in the same order.
+	const std::vector<const void *> &GetSources() const
+	{
+		return Sources;
+	}
+
+	/// Return the number of weights the expression needs from each source, matching *GetSources*.
+	const std::vector<int> &GetSourceSizes() const
+	{
+		return SourceSizes;
+	}
+
+	/// Return the number of operations the expression applies, counting shared nodes once.
+	int GetOperationCount() const;
+
+	/// Evaluate a range of the weights.  This only reads the program, so ranges can be evaluated
+	/// on different threads at once.
+	///
+	/// \param SourceWeights	The weights of each of *GetSources*
+	/// \param First			The first weight to evaluate
+	/// \param Count			The number of weights to evaluate
+	/// \param Out				The *Count* results
+	void Evaluate(const FSource *SourceWeights, int First, int Count, float *Out) const;
+
+private:
+	struct FStep
+	{
+		const FWeightExpression *Node;
+
+		/// The step each input comes from
+		int Inputs[2];
+
+		/// The index into *Sources* for a leaf
+		int Source;
+
+		/// The scratch chunk the result is written to.  The root writes to the output instead, and
+		/// leaves for dense sources are read in place.
+		int Buffer;
+	};
+
+	/// Add the steps for a node and everything it reads, inputs first.
+	void AddSteps(const FWeightExpression *Root);
+
+	/// Share scratch chunks between steps whose results aren't needed at the same time.
+	void AssignBuffers();
+
+	/// The nodes in the order they're evaluated, with the root last
+	std::vector<FStep> Steps;
+	std::vector<const void *> Sources;
+	std::vector<int> SourceSizes;
+	int BufferCount = 0;
+	int Size = 0;
+};
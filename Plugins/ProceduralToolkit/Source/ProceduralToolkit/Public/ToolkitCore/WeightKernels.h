@@ -0,0 +1,169 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include "ToolkitCore/WeightStream.h"
+
+/// Kernels for the per-weight math of *SelectionSetBPLibrary*.
+///
+/// These work on plain float arrays so they're part of the toolkit's engine-free core, with the
+/// Blueprint library creating the output *SelectionSet* and calling into them.  The math matches
+/// the *FMath* functions the library used, so results are unchanged, apart from *Ease*.
+///
+/// All of the kernels write *Count* weights to *Out*, which may be the same array as an input.
+namespace WeightKernels
+{
+	/// The easing functions supported by *Ease*.
+	///
+	/// These are in the same order as the engine's *EEasingFunc::Type* so one can be cast to the other.
+	enum class EEaseFunction : unsigned char
+	{
+		Linear,
+		Step,
+		SinusoidalIn,
+		SinusoidalOut,
+		SinusoidalInOut,
+		EaseIn,
+		EaseOut,
+		EaseInOut,
+		ExpoIn,
+		ExpoOut,
+		ExpoInOut,
+		CircularIn,
+		CircularOut,
+		CircularInOut
+	};
+
+	/// Out = Clamp(Values, Min, Max)
+	void Clamp(const float *Values, int Count, float Min, float Max, float *Out);
+
+	/// Apply an easing function to each weight, as *FMath::InterpEaseIn* and friends do between 0 and 1.
+	///
+	/// The weights are eased several at a time with SIMD, using polynomials in place of the sin and
+	/// exponential functions, which are within 1e-6 of *FMath* for weights from 0 to 1.
+	///
+	/// \param Values			The weights to ease
+	/// \param Count			The number of weights
+	/// \param Function			The easing function
+	/// \param Steps			The number of steps, only used by *Step*
+	/// \param BlendExp			The exponent, only used by *EaseIn*, *EaseOut*, and *EaseInOut*
+	/// \param Out				The eased weights
+	void Ease(const float *Values, int Count, EEaseFunction Function, int Steps, float BlendExp, float *Out);
+
+	/// Out = A + B
+	void Add(const float *A, const float *B, int Count, float *Out);
+
+	/// Out = Values + Scalar
+	void AddScalar(const float *Values, int Count, float Scalar, float *Out);
+
+	/// Out = A - B
+	void Subtract(const float *A, const float *B, int Count, float *Out);
+
+	/// Out = Values - Scalar
+	void SubtractScalar(const float *Values, int Count, float Scalar, float *Out);
+
+	/// Out = Scalar - Values
+	void SubtractFromScalar(float Scalar, const float *Values, int Count, float *Out);
+
+	/// Out = A * B
+	void Multiply(const float *A, const float *B, int Count, float *Out);
+
+	/// Out = Values * Scalar
+	void MultiplyScalar(const float *Values, int Count, float Scalar, float *Out);
+
+	/// Out = A / B
+	void Divide(const float *A, const float *B, int Count, float *Out);
+
+	/// Out = Values / Scalar
+	void DivideScalar(const float *Values, int Count, float Scalar, float *Out);
+
+	/// Out = 1 - Values
+	void OneMinus(const float *Values, int Count, float *Out);
+
+	/// Out = Value
+	void Fill(float *Out, int Count, float Value);
+
+	/// Out = Max(A, B)
+	void Max(const float *A, const float *B, int Count, float *Out);
+
+	/// Out = Min(A, B)
+	void Min(const float *A, const float *B, int Count, float *Out);
+
+	/// Out = Max(Values, Scalar)
+	void MaxScalar(const float *Values, int Count, float Scalar, float *Out);
+
+	/// Out = Min(Values, Scalar)
+	void MinScalar(const float *Values, int Count, float Scalar, float *Out);
+
+	/// Out = Lerp(A, B, Alpha)
+	void Lerp(const float *A, const float *B, int Count, float Alpha, float *Out);
+
+	/// Out = Lerp(Values, Scalar, Alpha)
+	void LerpScalar(const float *Values, int Count, float Scalar, float Alpha, float *Out);
+
+	/// What *Statistics* finds about some weights
+	struct FWeightStatistics
+	{
+		/// The smallest and largest weights, both 0 if there are none
+		float Min = 0.0f;
+		float Max = 0.0f;
+
+		double Sum = 0.0;
+
+		/// The number of weights which aren't 0
+		int NonZeroCount = 0;
+
+		/// The number of weights
+		int Count = 0;
+
+		/// Add the statistics of more weights, such as another part of the same array.
+		void Combine(const FWeightStatistics &Other)
+		{
+			if (Other.Count == 0) {
+				return;
+			}
+			Min = (Count == 0 || Other.Min < Min) ? Other.Min : Min;
+			Max = (Count == 0 || Other.Max > Max) ? Other.Max : Max;
+			Sum += Other.Sum;
+			NonZeroCount += Other.NonZeroCount;
+			Count += Other.Count;
+		}
+	};
+
+	/// Find the smallest, largest, and sum of the weights, and how many aren't 0, in a single pass.
+	///
+	/// The sum is added up in floats a block at a time and the blocks in doubles, so it stays
+	/// accurate for millions of weights.
+	///
+	/// \param Values			The weights
+	/// \param Count			The number of weights, which can be 0
+	/// \param Out				The statistics
+	void Statistics(const float *Values, int Count, FWeightStatistics &Out);
+
+	/// Find the smallest and largest weights.
+	///
+	/// \param Values			The weights, there must be at least one
+	/// \param Count			The number of weights
+	/// \param OutMin			The smallest weight
+	/// \param OutMax			The largest weight
+	void MinMax(const float *Values, int Count, float &OutMin, float &OutMax);
+
+	/// Linearly remap weights from the range CurrentMin-CurrentMax to NewMin-NewMax.
+	///
+	/// CurrentMin and CurrentMax must differ.
+	void RemapRange(const float *Values, int Count, float CurrentMin, float CurrentMax, float NewMin, float NewMax, float *Out);
+
+	/// Quantize weights to the nearest of 65536 codes spread evenly from Min to Max, which should
+	/// be the range of the weights as found by *MinMax*.
+	///
+	/// \return The *Step* of a *FWeightStream* reading the codes
+	float Quantize(const float *Values, int Count, float Min, float Max, uint16_t *Out);
+
+	/// Quantize weights to the nearest of 256 codes spread evenly from Min to Max.
+	///
+	/// \return The *Step* of a *FWeightStream* reading the codes
+	float Quantize(const float *Values, int Count, float Min, float Max, uint8_t *Out);
+
+	/// Out = Values, turning quantized weights back into floats
+	void Dequantize(const FWeightStream &Values, int Count, float *Out);
+}
@@ -0,0 +1,107 @@
+// (c)2017 Paul Golds, released under MIT License.
+
+#pragma once
+
+#include <stdint.h>
+
+/// How the weights read through a *FWeightStream* are stored.
+///
+/// These are in the same order as *ESelectionSetPrecision* so one can be cast to the other.
+enum class EWeightPrecision : unsigned char
+{
+	/// A float for each weight
+	Float,
+
+	/// A 16 bit code for each weight, spread evenly over the range of the weights
+	UInt16,
+
+	/// An 8 bit code for each weight, spread evenly over the range of the weights
+	UInt8
+};
+
+/// A read-only view of an array of weights, stored either as floats or as quantized codes.
+///
+/// A quantized weight is the integer code *Code* standing for the weight *Min + Code * Step*,
+/// which quarters or halves the memory the weights take for a little precision.  The kernels
+/// taking a stream turn the codes back into weights as they load them, so quantized weights are
+/// never expanded into an array of floats.
+///
+/// This converts implicitly from a float pointer, including *nullptr* for no weights, so the
+/// kernels taking a stream are called with a plain array of weights just as before.
+///
+/// This is part of the toolkit's engine-free core.
+struct FWeightStream
+{
+	/// The floats or codes, or null for no weights
+	const void *Data = nullptr;
+
+	EWeightPrecision Precision = EWeightPrecision::Float;
+
+	/// The weight a code of zero stands for
+	float Min = 0.0f;
+
+	/// The difference in weight between one code and the next
+	float Step = 0.0f;
+
+	FWeightStream()
+	{
+	}
+
+	FWeightStream(const float *Weights)
+		: Data(Weights)
+	{
+	}
+
+	FWeightStream(const uint16_t *Codes, float InMin, float InStep)
+		: Data(Codes), Precision(EWeightPrecision::UInt16), Min(InMin), Step(InStep)
+	{
+	}
+
+	FWeightStream(const uint8_t *Codes, float InMin, float InStep)
+		: Data(Codes), Precision(EWeightPrecision::UInt8), Min(InMin), Step(InStep)
+	{
+	}
+
+	/// Return *True* if there are weights.
+	explicit operator bool() const
+	{
+		return Data != nullptr;
+	}
+
+	/// Return the weights if they're stored as floats, otherwise null.
+	const float *GetFloats() const
+	{
+		return Precision == EWeightPrecision::Float ? static_cast<const float *>(Data) : nullptr;
+	}
+
+	/// Return a single weight.
+	float operator[](int Index) const
+	{
+		switch (Precision) {
+		case EWeightPrecision::UInt16:
+			return Min + static_cast<const uint16_t *>(Data)[Index] * Step;
+		case EWeightPrecision::UInt8:
+			return Min + static_cast<const uint8_t *>(Data)[Index] * Step;
+		default:
+			return static_cast<const float *>(Data)[Index];
+		}
+	}
+
+	/// Return the stream starting *Offset* weights further on, as with a pointer.
+	FWeightStream operator+(int Offset) const
+	{
+		FWeightStream Result = *this;
+		switch (Precision) {
+		case EWeightPrecision::UInt16:
+			Result.Data = static_cast<const uint16_t *>(Data) + Offset;
+			break;
+		case EWeightPrecision::UInt8:
+			Result.Data = static_cast<const uint8_t *>(Data) + Offset;
+			break;
+		default:
+			Result.Data = static_cast<const float *>(Data) + Offset;
+			break;
+		}
+		return Result;
+	}
+};